@@ -42,6 +42,19 @@ function(COMPILER_FLAGS_APPEND scope add_val conflict_match)
     endif ()
 endfunction(COMPILER_FLAGS_APPEND)
 
+# The pixel loops of the software paths (format conversion, RGBA to I420,
+# layer blending) are plain loops left to the auto-vectorizer, which not all
+# compilers run at -O2.  Source properties are per directory: call this in
+# each directory with a target that builds these sources.
+function(VECTORIZE_PIXEL_LOOPS)
+    set_source_files_properties(
+            ${PROJECT_SOURCE_DIR}/shell/backend/frame_stream.cc
+            ${PROJECT_SOURCE_DIR}/shell/backend/headless/software_compositor.cc
+            ${PROJECT_SOURCE_DIR}/shell/backend/wayland_software/shm_rows.cc
+            PROPERTIES COMPILE_OPTIONS -ftree-vectorize
+    )
+endfunction(VECTORIZE_PIXEL_LOOPS)
+
 set(CMAKE_CXX_STANDARD_REQUIRED ON)
 set(CMAKE_CXX_STANDARD 17)
 # set(CMAKE_CXX_EXTENSIONS OFF)
@@ -77,6 +77,11 @@ else ()
     option(BUILD_BACKEND_WAYLAND_VULKAN "Build Backend for Vulkan" ON)
 endif ()
 
+#
+# Software
+#
+option(BUILD_BACKEND_WAYLAND_SOFTWARE "Build Backend for software rendering to wl_shm" OFF)
+
 #
 # DRM
 #
@@ -88,12 +93,23 @@ option(BUILD_BACKEND_WAYLAND_LEASED_DRM "Build Wayland Leased DRM backend" OFF)
 #
 option(BUILD_BACKEND_HEADLESS_EGL "Build Headless EGL Backend" OFF)
 if (BUILD_BACKEND_HEADLESS_EGL)
+    option(BUILD_HEADLESS_OSMESA "Build Headless Backend on OSMesa instead of surfaceless EGL" OFF)
     find_package(PkgConfig)
-    pkg_check_modules(OSMESA osmesa glesv2 egl IMPORTED_TARGET REQUIRED)
+    if (BUILD_HEADLESS_OSMESA)
+        pkg_check_modules(HEADLESS_GL osmesa glesv2 egl IMPORTED_TARGET REQUIRED)
+    else ()
+        pkg_check_modules(HEADLESS_GL glesv2 egl IMPORTED_TARGET REQUIRED)
+    endif ()
 endif ()
 
 option(DEBUG_PLATFORM_MESSAGES "Debug platform messages" OFF)
 
+#
+# Tracing
+#
+option(ENABLE_TRACING "Record embedder trace events (Chrome JSON / Perfetto)" OFF)
+MESSAGE(STATUS "Enable Tracing ......... ${ENABLE_TRACING}")
+
 #
 # Crash Handler
 #
@@ -140,6 +156,15 @@ MESSAGE(STATUS "Build Unit Tests ....... ${BUILD_UNIT_TESTS}")
 option(UNIT_TEST_SAVE_GOLDENS "Generate Golden Images" OFF)
 MESSAGE(STATUS "Generate Golden Images.. ${UNIT_TEST_SAVE_GOLDENS}")
 
+#
+# Benchmarks
+#
+option(BUILD_BENCHMARKS "Build Benchmarks" OFF)
+MESSAGE(STATUS "Build Benchmarks ....... ${BUILD_BENCHMARKS}")
+if (BUILD_BENCHMARKS)
+    find_package(benchmark REQUIRED)
+endif ()
+
 #
 # Sanitizers
 #
@@ -15,10 +15,13 @@
 
 #include "app.h"
 
-#include <thread>
+#include <chrono>
+
+#include <unistd.h>
 
 #include "config/common.h"
 
+#include "event_loop.h"
 #include "view/flutter_view.h"
 #include "wayland/display.h"
 
@@ -63,39 +66,59 @@ App::App(const std::vector<Configuration::Config>& configs)
   m_watch_dog = std::make_unique<Watchdog>();
 #endif
 
+  m_signal_fd = EventLoop::CreateWakeupFd();
+  m_wayland_display->GetEventLoop()->AddFd(m_signal_fd, EPOLLIN, on_signal,
+                                           nullptr);
+
   SPDLOG_DEBUG("-App::App");
 }
 
+App::~App() {
+  m_wayland_display->GetEventLoop()->RemoveFd(m_signal_fd);
+  close(m_signal_fd);
+}
+
+void App::on_signal(void* /* data */, const int fd, uint32_t /* events */) {
+  // the caller checks its signal flags once Loop() returns
+  EventLoop::Drain(fd);
+}
+
+void App::DumpInputLatency() const {
+  for (auto const& view : m_views) {
+    view->DumpInputLatency();
+  }
+}
+
 int App::Loop() const {
-  const auto start_time =
-      std::chrono::duration_cast<std::chrono::milliseconds>(
-          std::chrono::steady_clock::now().time_since_epoch())
-          .count();
+  // Block until the display, a repeat timer, a view wakeup or a plugin fd is
+  // ready.  Only views with fd-less work need the loop to poll.
+  int timeout_ms = -1;
+  for (auto const& view : m_views) {
+    if (view->NeedsPolling()) {
+      timeout_ms = kPollIntervalMs;
+      break;
+    }
+  }
+#if BUILD_WATCHDOG
+  if (timeout_ms < 0 || timeout_ms > kWatchdogPetIntervalMs) {
+    timeout_ms = kWatchdogPetIntervalMs;
+  }
+#endif
 
-  const auto ret = m_wayland_display->PollEvents();
+  const auto ret = m_wayland_display->PollEvents(timeout_ms);
 
   for (auto const& view : m_views) {
     view->RunTasks();
   }
 
-  if (m_wayland_display->m_repeat_timer)
-    m_wayland_display->m_repeat_timer->wait_event();
+#if BUILD_WATCHDOG
+  m_watch_dog->pet();
+#endif
 
   const auto end_time = std::chrono::duration_cast<std::chrono::milliseconds>(
                             std::chrono::steady_clock::now().time_since_epoch())
                             .count();
 
-  const auto elapsed = end_time - start_time;
-
-  const auto sleep_time = 16 - elapsed;
-
-  if (sleep_time > 0) {
-#if BUILD_WATCHDOG
-    m_watch_dog->pet();
-#endif
-    std::this_thread::sleep_for(std::chrono::milliseconds(sleep_time));
-  }
-
   for (auto const& i : m_views) {
     i->DrawFps(end_time);
   }
@@ -105,10 +128,12 @@ int App::Loop() const {
 
 #if BUILD_BACKEND_HEADLESS_EGL
 
-GLubyte* App::getViewRenderBuf(int i) {
+FrameCapture::FrameRef App::AcquireViewFrame(int i,
+                                             const uint64_t after_sequence) {
   return reinterpret_cast<HeadlessBackend*>(
              m_views[static_cast<unsigned long>(i)]->GetBackend())
-      ->getHeadlessBuffer();
+      ->GetFrameCapture()
+      .Acquire(after_sequence);
 }
 
 #endif
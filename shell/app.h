@@ -23,20 +23,31 @@
 #include "view/flutter_view.h"
 #include "watchdog.h"
 
+#if BUILD_BACKEND_HEADLESS_EGL
+#include "backend/frame_capture.h"
+#endif
+
 class Display;
 
 class WaylandWindow;
 
 class App final {
  public:
+  /// main loop poll period while a view has work that is not fd driven
+  static constexpr int kPollIntervalMs = 16;
+  /// upper bound on blocking so the watchdog keeps being pet when idle
+  static constexpr int kWatchdogPetIntervalMs = 1000;
+
   explicit App(const std::vector<Configuration::Config>& configs);
 
   App(const App&) = delete;
 
   const App& operator=(const App&) = delete;
 
+  ~App();
+
   /**
-   * @brief One frame in the loop
+   * @brief One iteration of the event driven main loop
    * @return int
    * @retval Number of dispatched events
    * @relation
@@ -44,12 +55,42 @@ class App final {
    */
   NODISCARD int Loop() const;
 
+  /**
+   * @brief Log the input latency histograms of every view
+   * @return void
+   * @relation
+   * flutter
+   */
+  void DumpInputLatency() const;
+
+  /**
+   * @brief Wakeup fd of the main loop
+   * @return int
+   * @retval An eventfd, writing to it returns Loop() even if no other fd is
+   * ready.  Safe to write from a signal handler
+   * @relation
+   * internal
+   */
+  NODISCARD int GetSignalFd() const { return m_signal_fd; }
+
 #if BUILD_BACKEND_HEADLESS_EGL
-  uint8_t* getViewRenderBuf(int i);
+  /**
+   * @brief Pin the latest frame presented by a headless view
+   * @param[in] i View index
+   * @param[in] after_sequence Only return a frame newer than this
+   * @return FrameCapture::FrameRef
+   * @retval Empty when no newer frame has been presented
+   * @relation
+   * flutter
+   */
+  FrameCapture::FrameRef AcquireViewFrame(int i, uint64_t after_sequence = 0);
 #endif
 
  private:
   std::shared_ptr<Display> m_wayland_display;
   std::vector<std::unique_ptr<FlutterView>> m_views;
   std::unique_ptr<Watchdog> m_watch_dog;
+  int m_signal_fd;
+
+  static void on_signal(void* data, int fd, uint32_t events);
 };
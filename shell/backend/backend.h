@@ -31,6 +31,7 @@ class Backend {
     Headless,
     WaylandEgl,
     WaylandVulkan,
+    WaylandSoftware,
     WaylandLeasedDrm,
     DrmKms,
   };
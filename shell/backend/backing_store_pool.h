@@ -0,0 +1,204 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <optional>
+#include <utility>
+
+#include "config/common.h"
+
+/**
+ * @brief Compositor backing stores kept for reuse once the engine collects
+ * them.
+ *
+ * Stores are keyed by size and format.  Free stores are kept most recently
+ * released first; the least recently released are destroyed when the pooled
+ * bytes exceed the budget or when one has not been reused for max_idle_frames
+ * frames.  A pool holds a handful of stores, so a scan is all a lookup needs.
+ *
+ * Not thread safe: the compositor callbacks all run on the raster thread.
+ */
+template <typename Resource>
+class BackingStorePool {
+ public:
+  struct Key {
+    uint32_t width;
+    uint32_t height;
+    /// backend specific pixel format
+    uint32_t format;
+
+    bool operator==(const Key& other) const {
+      return width == other.width && height == other.height &&
+             format == other.format;
+    }
+  };
+
+  struct Stats {
+    /// handed to the engine and not collected yet
+    size_t live_bytes;
+    /// free for reuse
+    size_t pooled_bytes;
+    size_t pooled;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+  };
+
+  using Destroy = std::function<void(Resource&)>;
+
+  /**
+   * @brief Create a pool
+   * @param[in] max_pooled_bytes Budget of the free stores
+   * @param[in] max_idle_frames Frames a free store is kept without reuse
+   * @param[in] destroy Releases the resources of a store
+   * @relation
+   * flutter
+   */
+  BackingStorePool(const size_t max_pooled_bytes,
+                   const uint32_t max_idle_frames,
+                   Destroy destroy)
+      : m_max_pooled_bytes(max_pooled_bytes),
+        m_max_idle_frames(max_idle_frames),
+        m_destroy(std::move(destroy)) {}
+
+  ~BackingStorePool() { Clear(); }
+
+  BackingStorePool(const BackingStorePool&) = delete;
+  BackingStorePool& operator=(const BackingStorePool&) = delete;
+
+  /**
+   * @brief Take a free store of key
+   * @param[in] key Size and format
+   * @return std::optional<Resource>
+   * @retval Store most recently released with key
+   * @retval std::nullopt None free, the caller creates one and reports it
+   * with Created()
+   * @relation
+   * flutter
+   */
+  std::optional<Resource> Acquire(const Key& key) {
+    for (auto it = m_free.begin(); it != m_free.end(); ++it) {
+      if (it->key == key) {
+        std::optional<Resource> resource(std::move(it->resource));
+        m_stats.pooled_bytes -= it->bytes;
+        m_stats.live_bytes += it->bytes;
+        m_free.erase(it);
+        m_stats.hits++;
+        return resource;
+      }
+    }
+    m_stats.misses++;
+    return std::nullopt;
+  }
+
+  /**
+   * @brief Account for a store created after a miss
+   * @param[in] bytes Memory of the store
+   * @return void
+   * @relation
+   * flutter
+   */
+  void Created(const size_t bytes) { m_stats.live_bytes += bytes; }
+
+  /**
+   * @brief Return a store collected by the engine
+   * @param[in] key Size and format the store was created with
+   * @param[in] resource Store
+   * @param[in] bytes Memory of the store, as given to Created()
+   * @return void
+   * @relation
+   * flutter
+   */
+  void Release(const Key& key, Resource resource, const size_t bytes) {
+    m_stats.live_bytes -= bytes;
+    m_stats.pooled_bytes += bytes;
+    m_free.push_front({key, std::move(resource), bytes, m_frame});
+    while (m_stats.pooled_bytes > m_max_pooled_bytes) {
+      Evict();
+    }
+  }
+
+  /**
+   * @brief Forget a live store that is destroyed instead of released
+   * @param[in] bytes Memory of the store, as given to Created()
+   * @return void
+   * @relation
+   * flutter
+   */
+  void Dropped(const size_t bytes) { m_stats.live_bytes -= bytes; }
+
+  /**
+   * @brief Age the free stores, called once per presented frame
+   * @return void
+   * @relation
+   * flutter
+   */
+  void EndFrame() {
+    m_frame++;
+    while (!m_free.empty() &&
+           m_frame - m_free.back().frame > m_max_idle_frames) {
+      Evict();
+    }
+  }
+
+  /**
+   * @brief Destroy all free stores
+   * @return void
+   * @relation
+   * flutter
+   */
+  void Clear() {
+    while (!m_free.empty()) {
+      Evict();
+    }
+  }
+
+  NODISCARD Stats GetStats() const {
+    auto stats = m_stats;
+    stats.pooled = m_free.size();
+    return stats;
+  }
+
+ private:
+  struct Entry {
+    Key key;
+    Resource resource;
+    size_t bytes;
+    /// frame the store was released in
+    uint64_t frame;
+  };
+
+  size_t m_max_pooled_bytes;
+  uint32_t m_max_idle_frames;
+  Destroy m_destroy;
+  /// most recently released first
+  std::list<Entry> m_free;
+  uint64_t m_frame{};
+  Stats m_stats{};
+
+  void Evict() {
+    auto& entry = m_free.back();
+    m_destroy(entry.resource);
+    m_stats.pooled_bytes -= entry.bytes;
+    m_stats.evictions++;
+    m_free.pop_back();
+  }
+};
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "damage_region.h"
+
+#include <algorithm>
+
+namespace {
+
+bool IsEmpty(const FlutterRect& rect) {
+  return !(rect.right > rect.left && rect.bottom > rect.top);
+}
+
+double AreaOf(const FlutterRect& rect) {
+  return IsEmpty(rect) ? 0
+                       : (rect.right - rect.left) * (rect.bottom - rect.top);
+}
+
+bool Contains(const FlutterRect& outer, const FlutterRect& inner) {
+  return outer.left <= inner.left && outer.top <= inner.top &&
+         outer.right >= inner.right && outer.bottom >= inner.bottom;
+}
+
+FlutterRect Union(const FlutterRect& a, const FlutterRect& b) {
+  return {std::min(a.left, b.left), std::min(a.top, b.top),
+          std::max(a.right, b.right), std::max(a.bottom, b.bottom)};
+}
+
+FlutterRect Intersect(const FlutterRect& a, const FlutterRect& b) {
+  return {std::max(a.left, b.left), std::max(a.top, b.top),
+          std::min(a.right, b.right), std::min(a.bottom, b.bottom)};
+}
+
+}  // namespace
+
+void DamageRegion::Add(FlutterRect rect) {
+  if (IsEmpty(rect)) {
+    return;
+  }
+
+  // merging grows |rect|, so rescan from the start after each merge
+  for (size_t i = 0; i < m_count;) {
+    const auto& existing = m_rects[i];
+    if (Contains(existing, rect)) {
+      return;
+    }
+    if (Contains(rect, existing)) {
+      Remove(i);
+      continue;
+    }
+    const auto covered = AreaOf(existing) + AreaOf(rect) -
+                         AreaOf(Intersect(existing, rect));
+    const auto bounds = Union(existing, rect);
+    if (AreaOf(bounds) <= covered * kMergeRatio) {
+      rect = bounds;
+      Remove(i);
+      i = 0;
+      continue;
+    }
+    i++;
+  }
+
+  if (m_count < kMaxRects) {
+    m_rects[m_count++] = rect;
+    return;
+  }
+
+  // full, merge the two rects whose bounds waste the least area
+  std::array<FlutterRect, kMaxRects + 1> rects{};
+  std::copy(m_rects.begin(), m_rects.end(), rects.begin());
+  rects[kMaxRects] = rect;
+  size_t best_a = 0;
+  size_t best_b = 1;
+  double best_waste = 0;
+  for (size_t a = 0; a < rects.size(); a++) {
+    for (size_t b = a + 1; b < rects.size(); b++) {
+      const auto waste = AreaOf(Union(rects[a], rects[b])) -
+                         AreaOf(rects[a]) - AreaOf(rects[b]);
+      if ((a == 0 && b == 1) || waste < best_waste) {
+        best_a = a;
+        best_b = b;
+        best_waste = waste;
+      }
+    }
+  }
+  rects[best_a] = Union(rects[best_a], rects[best_b]);
+  rects[best_b] = rects[kMaxRects];
+  std::copy(rects.begin(), rects.begin() + kMaxRects, m_rects.begin());
+}
+
+void DamageRegion::Add(const FlutterDamage& damage) {
+  if (damage.damage == nullptr) {
+    return;
+  }
+  for (size_t i = 0; i < damage.num_rects; i++) {
+    Add(damage.damage[i]);
+  }
+}
+
+void DamageRegion::Add(const DamageRegion& other) {
+  for (size_t i = 0; i < other.m_count; i++) {
+    Add(other.m_rects[i]);
+  }
+}
+
+double DamageRegion::Area() const {
+  double area = 0;
+  for (size_t i = 0; i < m_count; i++) {
+    area += AreaOf(m_rects[i]);
+  }
+  return area;
+}
+
+void DamageRegion::Export(FlutterDamage* damage) {
+  if (m_count == 0) {
+    // no rects makes the engine repaint everything, an empty rect does not
+    m_rects[0] = {};
+  }
+  for (size_t i = 1; i < m_count; i++) {
+    m_rects[0] = Union(m_rects[0], m_rects[i]);
+  }
+  m_count = std::min(m_count, size_t{1});
+  damage->struct_size = sizeof(FlutterDamage);
+  damage->damage = m_rects.data();
+  damage->num_rects = 1;
+}
+
+void DamageHistory::Push(const DamageRegion& frame) {
+  m_head = (m_head + 1) % kMaxFrames;
+  m_frames[m_head] = frame;
+  m_count = std::min(m_count + 1, kMaxFrames);
+}
+
+bool DamageHistory::Accumulate(const int age, DamageRegion* out) const {
+  out->Clear();
+  if (age <= 0 || static_cast<size_t>(age - 1) > m_count) {
+    return false;
+  }
+  for (size_t i = 0; i < static_cast<size_t>(age - 1); i++) {
+    out->Add(m_frames[(m_head + kMaxFrames - i) % kMaxFrames]);
+  }
+  return true;
+}
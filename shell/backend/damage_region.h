@@ -0,0 +1,153 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "config/common.h"
+
+#include "flutter/shell/platform/embedder/embedder.h"
+
+/**
+ * @brief Damage made of up to kMaxRects rectangles, in fixed storage.
+ *
+ * Added rectangles are merged with an existing one when that wastes little
+ * area, so two small updates at opposite corners stay two rectangles instead
+ * of one covering the screen.  Once all slots are taken a new rectangle is
+ * merged with the one whose bounds grow the least.
+ */
+class DamageRegion {
+ public:
+  static constexpr size_t kMaxRects = 8;
+  /// merge two rects when their bounds cover at most this much more area
+  static constexpr double kMergeRatio = 1.25;
+
+  DamageRegion() = default;
+
+  /**
+   * @brief Build a region from engine damage
+   * @param[in] damage Damage reported by the engine
+   * @relation
+   * flutter
+   */
+  explicit DamageRegion(const FlutterDamage& damage) { Add(damage); }
+
+  void Clear() { m_count = 0; }
+
+  /**
+   * @brief Add a rectangle, empty rectangles are ignored
+   * @param[in] rect Rectangle to add
+   * @return void
+   * @relation
+   * flutter
+   */
+  void Add(FlutterRect rect);
+
+  /**
+   * @brief Add all rectangles of engine damage
+   * @param[in] damage Damage reported by the engine
+   * @return void
+   * @relation
+   * flutter
+   */
+  void Add(const FlutterDamage& damage);
+
+  /**
+   * @brief Add all rectangles of another region
+   * @param[in] other Region to add
+   * @return void
+   * @relation
+   * flutter
+   */
+  void Add(const DamageRegion& other);
+
+  NODISCARD bool empty() const { return m_count == 0; }
+
+  NODISCARD size_t size() const { return m_count; }
+
+  NODISCARD const FlutterRect* data() const { return m_rects.data(); }
+
+  NODISCARD const FlutterRect& operator[](const size_t index) const {
+    return m_rects[index];
+  }
+
+  /**
+   * @brief Sum of the rectangle areas
+   * @return double
+   * @relation
+   * flutter
+   */
+  NODISCARD double Area() const;
+
+  /**
+   * @brief Reduce this region to its bounds and point |damage| at them
+   *
+   * The engine only reads the first rectangle of existing damage, so the
+   * bounds are handed over as one rectangle to cover all of the region.
+   * @param[out] damage Damage handed to the engine, valid while this region
+   * is unchanged
+   * @return void
+   * @relation
+   * flutter
+   */
+  void Export(FlutterDamage* damage);
+
+ private:
+  void Remove(size_t index) { m_rects[index] = m_rects[--m_count]; }
+
+  std::array<FlutterRect, kMaxRects> m_rects{};
+  size_t m_count{};
+};
+
+/**
+ * @brief Frame damage of the most recent frames, in fixed storage.
+ *
+ * Used to compute the damage a back buffer is missing from its buffer age.
+ */
+class DamageHistory {
+ public:
+  static constexpr size_t kMaxFrames = 10;
+
+  /**
+   * @brief Record the damage of a presented frame
+   * @param[in] frame Frame damage
+   * @return void
+   * @relation
+   * flutter
+   */
+  void Push(const DamageRegion& frame);
+
+  /**
+   * @brief Damage accumulated since a buffer of |age| was last rendered
+   * @param[in] age Buffer age, 1 is the previous frame
+   * @param[out] out Accumulated damage
+   * @return bool
+   * @retval true |out| holds the damage
+   * @retval false Unknown age or history too short, repaint everything
+   * @relation
+   * flutter
+   */
+  bool Accumulate(int age, DamageRegion* out) const;
+
+  void Clear() { m_count = 0; }
+
+ private:
+  std::array<DamageRegion, kMaxFrames> m_frames{};
+  size_t m_head{};
+  size_t m_count{};
+};
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "frame_capture.h"
+
+uint8_t* FrameCapture::BeginFrame(const uint32_t width, const uint32_t height) {
+  const auto latest = m_latest.load(std::memory_order_relaxed);
+  for (int32_t i = 0; i < static_cast<int32_t>(kSlots); i++) {
+    if (i == latest) {
+      continue;
+    }
+    auto& slot = m_slots[static_cast<size_t>(i)];
+    int32_t expected = 0;
+    if (!slot.state.compare_exchange_strong(expected, -1,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+      continue;
+    }
+    m_writing = i;
+    // a reader holding a stale index must not take the old frame from here
+    slot.sequence = 0;
+    slot.width = width;
+    slot.height = height;
+    slot.pixels.resize(size_t{width} * height * kBytesPerPixel);
+    return slot.pixels.data();
+  }
+  m_dropped.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+}
+
+uint64_t FrameCapture::EndFrame(const uint64_t timestamp_ns) {
+  if (m_writing < 0) {
+    return 0;
+  }
+  auto& slot = m_slots[static_cast<size_t>(m_writing)];
+  slot.sequence = ++m_sequence;
+  slot.timestamp_ns = timestamp_ns;
+  slot.state.store(0, std::memory_order_release);
+  m_latest.store(m_writing, std::memory_order_release);
+  m_writing = -1;
+  m_published.fetch_add(1, std::memory_order_relaxed);
+  return m_sequence;
+}
+
+void FrameCapture::CancelFrame() {
+  if (m_writing < 0) {
+    return;
+  }
+  m_slots[static_cast<size_t>(m_writing)].state.store(
+      0, std::memory_order_release);
+  m_writing = -1;
+}
+
+FrameCapture::FrameRef FrameCapture::Acquire(const uint64_t after_sequence) {
+  const auto latest = m_latest.load(std::memory_order_acquire);
+  if (latest < 0) {
+    return {};
+  }
+  auto& slot = m_slots[static_cast<size_t>(latest)];
+  auto state = slot.state.load(std::memory_order_relaxed);
+  do {
+    // being rewritten, so no longer the latest frame either
+    if (state < 0) {
+      return Acquire(after_sequence);
+    }
+  } while (!slot.state.compare_exchange_weak(state, state + 1,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed));
+
+  FrameRef frame(&slot);
+  // the slot may have been republished with a newer frame, never an older one
+  if (slot.sequence == 0 || slot.sequence <= after_sequence) {
+    return {};
+  }
+  return frame;
+}
+
+FrameCapture::Stats FrameCapture::GetStats() const {
+  return {m_published.load(std::memory_order_relaxed),
+          m_dropped.load(std::memory_order_relaxed)};
+}
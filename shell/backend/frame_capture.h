@@ -0,0 +1,170 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "config/common.h"
+
+/**
+ * @brief Ring of completed RGBA frames captured from a backend.
+ *
+ * The raster thread writes each presented frame into a free slot and
+ * publishes it with its sequence number and timestamp, while consumers on any
+ * thread hold on to earlier frames.  A slot is either being written, free, or
+ * pinned by readers, tracked by one atomic per slot, so neither side ever
+ * waits for the other.  With three slots the writer always finds one that is
+ * neither the latest frame nor pinned by a single consumer; when readers pin
+ * every other slot the frame is not captured and counted as dropped.
+ */
+class FrameCapture {
+ public:
+  static constexpr size_t kSlots = 3;
+  static constexpr uint32_t kBytesPerPixel = 4;
+
+  struct Stats {
+    uint64_t published;
+    /// frames not captured because every other slot was pinned
+    uint64_t dropped;
+  };
+
+ private:
+  struct Slot {
+    /// -1 being written, 0 free, > 0 number of readers
+    std::atomic<int32_t> state{};
+    /// 0 while the pixels are not a complete frame
+    uint64_t sequence{};
+    uint64_t timestamp_ns{};
+    uint32_t width{};
+    uint32_t height{};
+    std::vector<uint8_t> pixels;
+  };
+
+ public:
+  /**
+   * @brief Read-only reference to a published frame, pinning its slot
+   */
+  class FrameRef {
+   public:
+    FrameRef() = default;
+
+    FrameRef(FrameRef&& other) noexcept
+        : m_slot(std::exchange(other.m_slot, nullptr)) {}
+
+    FrameRef& operator=(FrameRef&& other) noexcept {
+      std::swap(m_slot, other.m_slot);
+      return *this;
+    }
+
+    FrameRef(const FrameRef&) = delete;
+    FrameRef& operator=(const FrameRef&) = delete;
+
+    ~FrameRef() {
+      if (m_slot) {
+        m_slot->state.fetch_sub(1, std::memory_order_release);
+      }
+    }
+
+    explicit operator bool() const { return m_slot != nullptr; }
+
+    NODISCARD uint64_t sequence() const { return m_slot->sequence; }
+
+    /// CLOCK_MONOTONIC nanoseconds of the present
+    NODISCARD uint64_t timestamp_ns() const { return m_slot->timestamp_ns; }
+
+    NODISCARD uint32_t width() const { return m_slot->width; }
+
+    NODISCARD uint32_t height() const { return m_slot->height; }
+
+    NODISCARD size_t stride() const {
+      return size_t{m_slot->width} * kBytesPerPixel;
+    }
+
+    /// RGBA rows, bottom row first
+    NODISCARD const uint8_t* data() const { return m_slot->pixels.data(); }
+
+    NODISCARD size_t size() const { return stride() * m_slot->height; }
+
+   private:
+    friend class FrameCapture;
+
+    explicit FrameRef(Slot* slot) : m_slot(slot) {}
+
+    Slot* m_slot{};
+  };
+
+  FrameCapture() = default;
+  FrameCapture(const FrameCapture&) = delete;
+  FrameCapture& operator=(const FrameCapture&) = delete;
+
+  /**
+   * @brief Get storage for the next frame, raster thread only
+   * @param[in] width Frame width
+   * @param[in] height Frame height
+   * @return uint8_t*
+   * @retval RGBA storage of width * height pixels
+   * @retval nullptr No free slot, the frame is dropped
+   * @relation
+   * flutter
+   */
+  uint8_t* BeginFrame(uint32_t width, uint32_t height);
+
+  /**
+   * @brief Publish the frame started by BeginFrame()
+   * @param[in] timestamp_ns CLOCK_MONOTONIC nanoseconds of the present
+   * @return uint64_t
+   * @retval Sequence number of the frame
+   * @relation
+   * flutter
+   */
+  uint64_t EndFrame(uint64_t timestamp_ns);
+
+  /**
+   * @brief Give back the slot of a frame that could not be read back
+   * @return void
+   * @relation
+   * flutter
+   */
+  void CancelFrame();
+
+  /**
+   * @brief Pin the latest frame, from any thread
+   * @param[in] after_sequence Only return a frame newer than this
+   * @return FrameRef
+   * @retval Empty when no newer frame has been published
+   * @relation
+   * flutter
+   */
+  FrameRef Acquire(uint64_t after_sequence = 0);
+
+  NODISCARD Stats GetStats() const;
+
+ private:
+  std::array<Slot, kSlots> m_slots{};
+  /// index of the latest published slot, -1 before the first frame
+  std::atomic<int32_t> m_latest{-1};
+  /// slot being written, raster thread only
+  int32_t m_writing{-1};
+  uint64_t m_sequence{};
+  std::atomic<uint64_t> m_published{};
+  std::atomic<uint64_t> m_dropped{};
+};
@@ -0,0 +1,325 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "frame_stream.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+
+namespace {
+
+/// poll interval while the consumer is not reading, bounds stop latency
+constexpr int kWritePollMs = 100;
+
+bool EndsWith(const std::string& str, const char* suffix) {
+  const auto len = std::strlen(suffix);
+  return str.size() >= len && str.compare(str.size() - len, len, suffix) == 0;
+}
+
+uint8_t Clamp(const int32_t value) {
+  return static_cast<uint8_t>(std::min(value, 255));
+}
+
+}  // namespace
+
+FrameStream::FrameStream(FrameCapture& capture, std::string target)
+    : m_capture(capture),
+      m_target(std::move(target)),
+      m_format(EndsWith(m_target, ".y4m") ? Format::kY4m : Format::kRaw) {
+  spdlog::info("Frame stream: {} ({})", m_target,
+               m_format == Format::kY4m ? "y4m" : "raw");
+  // frames published before the stream started are not dropped ones
+  uint64_t last = 0;
+  if (const auto frame = m_capture.Acquire()) {
+    last = frame.sequence();
+  }
+  m_thread = std::thread(&FrameStream::Run, this, last);
+}
+
+FrameStream::~FrameStream() {
+  {
+    std::lock_guard lock(m_mutex);
+    m_stop.store(true, std::memory_order_relaxed);
+  }
+  m_cv.notify_one();
+  m_thread.join();
+  const auto stats = GetStats();
+  spdlog::info("Frame stream: {} frames written, {} dropped", stats.written,
+               stats.dropped);
+}
+
+void FrameStream::Notify() {
+  {
+    std::lock_guard lock(m_mutex);
+    m_pending = true;
+  }
+  m_cv.notify_one();
+}
+
+FrameStream::Stats FrameStream::GetStats() const {
+  return {m_written.load(std::memory_order_relaxed),
+          m_dropped.load(std::memory_order_relaxed)};
+}
+
+size_t FrameStream::I420Size(const uint32_t width, const uint32_t height) {
+  const size_t chroma = size_t{(width + 1) / 2} * ((height + 1) / 2);
+  return size_t{width} * height + 2 * chroma;
+}
+
+void FrameStream::RgbaToI420(const uint8_t* rgba,
+                             const uint32_t width,
+                             const uint32_t height,
+                             uint8_t* i420) {
+  const size_t stride = size_t{width} * 4;
+  const auto row = [&](const uint32_t y) {
+    return rgba + (height - 1 - y) * stride;
+  };
+
+  // BT.601 luma in 8 bit fixed point
+  for (uint32_t y = 0; y < height; y++) {
+    const auto src = row(y);
+    const auto dst = i420 + size_t{y} * width;
+    for (uint32_t x = 0; x < width; x++) {
+      const auto p = src + size_t{x} * 4;
+      dst[x] = static_cast<uint8_t>(
+          (77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+    }
+  }
+
+  const uint32_t chroma_width = (width + 1) / 2;
+  const uint32_t chroma_height = (height + 1) / 2;
+  const auto u_plane = i420 + size_t{width} * height;
+  const auto v_plane = u_plane + size_t{chroma_width} * chroma_height;
+  const auto chroma = [](const uint8_t* a, const uint8_t* b, const uint8_t* c,
+                         const uint8_t* d, uint8_t* u, uint8_t* v) {
+    // sums of the 2x2 block, the offset keeps the products non-negative
+    const int32_t r = a[0] + b[0] + c[0] + d[0];
+    const int32_t g = a[1] + b[1] + c[1] + d[1];
+    const int32_t bl = a[2] + b[2] + c[2] + d[2];
+    *u = Clamp((-43 * r - 85 * g + 128 * bl + 131584) >> 10);
+    *v = Clamp((128 * r - 107 * g - 21 * bl + 131584) >> 10);
+  };
+  for (uint32_t cy = 0; cy < chroma_height; cy++) {
+    const auto top = row(2 * cy);
+    const auto bottom = row(std::min(2 * cy + 1, height - 1));
+    const auto u = u_plane + size_t{cy} * chroma_width;
+    const auto v = v_plane + size_t{cy} * chroma_width;
+    // full blocks, then the odd last column against itself
+    const uint32_t pairs = width / 2;
+    for (uint32_t cx = 0; cx < pairs; cx++) {
+      const auto x = size_t{cx} * 8;
+      chroma(top + x, top + x + 4, bottom + x, bottom + x + 4, u + cx, v + cx);
+    }
+    if (pairs < chroma_width) {
+      const auto x = size_t{pairs} * 8;
+      chroma(top + x, top + x, bottom + x, bottom + x, u + pairs, v + pairs);
+    }
+  }
+}
+
+void FrameStream::Run(uint64_t last) {
+  // a consumer going away must not take the process down
+  sigset_t sigpipe;
+  sigemptyset(&sigpipe);
+  sigaddset(&sigpipe, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &sigpipe, nullptr);
+  pthread_setname_np(pthread_self(), "frame_stream");
+
+  while (true) {
+    {
+      std::unique_lock lock(m_mutex);
+      m_cv.wait(lock, [this] {
+        return m_pending || m_stop.load(std::memory_order_relaxed);
+      });
+      if (m_stop.load(std::memory_order_relaxed)) {
+        break;
+      }
+      m_pending = false;
+    }
+
+    bool staged;
+    {
+      const auto frame = m_capture.Acquire(last);
+      if (!frame) {
+        continue;
+      }
+      m_dropped.fetch_add(frame.sequence() - last - 1,
+                          std::memory_order_relaxed);
+      last = frame.sequence();
+      staged = Connect() && Stage(frame);
+    }
+    // the slot is given back before the consumer is waited on
+    if (staged && WriteAll(m_staging.data(), m_staging.size())) {
+      m_written.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  Disconnect();
+}
+
+bool FrameStream::Connect() {
+  if (m_fd >= 0) {
+    return true;
+  }
+  if (m_failed) {
+    return false;
+  }
+
+  if (m_target.rfind(kUnixPrefix, 0) == 0) {
+    const auto path = m_target.substr(sizeof(kUnixPrefix) - 1);
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+      spdlog::error("Frame stream: socket path too long: {}", path);
+      m_failed = true;
+      return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    m_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_fd < 0 ||
+        connect(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+      // no listener yet
+      Disconnect();
+      return false;
+    }
+    fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+  } else {
+    // a FIFO without a reader fails with ENXIO instead of blocking
+    m_fd = open(m_target.c_str(),
+                O_WRONLY | O_CREAT | O_TRUNC | O_NONBLOCK | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+      if (errno != ENXIO) {
+        spdlog::error("Frame stream: failed to open {}: {}", m_target,
+                      std::strerror(errno));
+        m_failed = true;
+      }
+      return false;
+    }
+    struct stat st {};
+    m_regular_file = fstat(m_fd, &st) == 0 && S_ISREG(st.st_mode);
+  }
+  spdlog::debug("Frame stream: {} connected", m_target);
+  return true;
+}
+
+void FrameStream::Disconnect() {
+  if (m_fd >= 0) {
+    close(m_fd);
+  }
+  m_fd = -1;
+  // the next consumer starts with a new header
+  m_y4m_width = 0;
+  m_y4m_height = 0;
+}
+
+bool FrameStream::Stage(const FrameCapture::FrameRef& frame) {
+  const auto width = frame.width();
+  const auto height = frame.height();
+
+  if (m_format == Format::kRaw) {
+    const RawHeader header{{kRawMagic[0], kRawMagic[1], kRawMagic[2],
+                            kRawMagic[3]},
+                           width,
+                           height,
+                           static_cast<uint32_t>(frame.stride()),
+                           frame.sequence(),
+                           frame.timestamp_ns()};
+    m_staging.resize(sizeof(header) + frame.size());
+    std::memcpy(m_staging.data(), &header, sizeof(header));
+    const auto dst = m_staging.data() + sizeof(header);
+    for (uint32_t y = 0; y < height; y++) {
+      std::memcpy(dst + y * frame.stride(),
+                  frame.data() + (height - 1 - y) * frame.stride(),
+                  frame.stride());
+    }
+    return true;
+  }
+
+  if (m_y4m_width == 0) {
+    m_y4m_width = width;
+    m_y4m_height = height;
+    const auto header =
+        fmt::format("YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C420jpeg\nFRAME\n", width,
+                    height, kY4mFrameRate);
+    m_staging.assign(header.begin(), header.end());
+  } else if (width != m_y4m_width || height != m_y4m_height) {
+    // Y4M cannot change size mid stream
+    spdlog::debug("Frame stream: dropping {}x{} frame in a {}x{} stream",
+                  width, height, m_y4m_width, m_y4m_height);
+    return false;
+  } else {
+    static constexpr char kFrame[] = "FRAME\n";
+    m_staging.assign(kFrame, kFrame + sizeof(kFrame) - 1);
+  }
+  const auto offset = m_staging.size();
+  m_staging.resize(offset + I420Size(width, height));
+  RgbaToI420(frame.data(), width, height, m_staging.data() + offset);
+  return true;
+}
+
+bool FrameStream::WriteAll(const uint8_t* buf, size_t size) {
+  while (size > 0) {
+    const auto written = write(m_fd, buf, size);
+    if (written > 0) {
+      buf += written;
+      size -= static_cast<size_t>(written);
+      continue;
+    }
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      if (m_stop.load(std::memory_order_relaxed)) {
+        return false;
+      }
+      pollfd pfd{m_fd, POLLOUT, 0};
+      poll(&pfd, 1, kWritePollMs);
+      continue;
+    }
+
+    if (errno == EPIPE) {
+      // consume the blocked SIGPIPE so it is not delivered later
+      sigset_t sigpipe;
+      sigemptyset(&sigpipe);
+      sigaddset(&sigpipe, SIGPIPE);
+      const timespec zero{};
+      sigtimedwait(&sigpipe, nullptr, &zero);
+      spdlog::debug("Frame stream: {} disconnected", m_target);
+    } else {
+      spdlog::error("Frame stream: write to {} failed: {}", m_target,
+                    std::strerror(errno));
+    }
+    // a regular file is not restarted, it would be truncated
+    m_failed = m_regular_file;
+    Disconnect();
+    return false;
+  }
+  return true;
+}
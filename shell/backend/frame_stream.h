@@ -0,0 +1,179 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config/common.h"
+
+#include "frame_capture.h"
+
+/**
+ * @brief Streams the frames of a FrameCapture to a file, FIFO or Unix socket.
+ *
+ * A dedicated I/O thread pins the latest frame, converts it into a single
+ * staging buffer, unpins it and writes it out.  The raster thread only
+ * signals that a frame was published, so a slow or absent consumer never
+ * throttles rendering: while the I/O thread is busy the capture ring keeps
+ * only the newest frame and the ones in between are counted as dropped.
+ *
+ * Targets are "unix:<path>" for a listening stream socket, anything else is
+ * opened as a file or FIFO.  FIFOs and sockets are (re)connected when a
+ * consumer is present; a regular file is written once from the start.
+ * Output is Y4M (C420jpeg) when the path ends in ".y4m", otherwise raw
+ * RGBA frames each preceded by a RawHeader.  Rows are top row first in both.
+ */
+class FrameStream {
+ public:
+  enum class Format {
+    kRaw,
+    kY4m,
+  };
+
+  /// precedes every raw frame, host byte order
+  struct RawHeader {
+    char magic[4];
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    uint64_t sequence;
+    /// CLOCK_MONOTONIC nanoseconds of the present
+    uint64_t timestamp_ns;
+  };
+  static_assert(sizeof(RawHeader) == 32);
+
+  static constexpr char kRawMagic[4] = {'H', 'S', 'F', 'R'};
+  static constexpr char kUnixPrefix[] = "unix:";
+  /// nominal rate in the Y4M header, frames carry no timestamps there
+  static constexpr uint32_t kY4mFrameRate = 60;
+
+  struct Stats {
+    uint64_t written;
+    /// frames skipped while the consumer was busy or not connected
+    uint64_t dropped;
+  };
+
+  /**
+   * @brief Start streaming the frames published to capture
+   * @param[in] capture Frame source, must outlive this object
+   * @param[in] target File or FIFO path, or "unix:<path>"
+   * @relation
+   * internal
+   */
+  FrameStream(FrameCapture& capture, std::string target);
+
+  ~FrameStream();
+
+  FrameStream(const FrameStream&) = delete;
+  FrameStream& operator=(const FrameStream&) = delete;
+
+  /**
+   * @brief Wake the I/O thread after FrameCapture::EndFrame()
+   * @return void
+   * @relation
+   * flutter
+   */
+  void Notify();
+
+  NODISCARD Stats GetStats() const;
+
+  NODISCARD Format GetFormat() const { return m_format; }
+
+  /**
+   * @brief Convert RGBA to planar I420, full range BT.601
+   * @param[in] rgba Rows of width RGBA pixels, bottom row first
+   * @param[in] width Frame width
+   * @param[in] height Frame height
+   * @param[out] i420 Y, U and V planes, top row first, of I420Size() bytes
+   * @return void
+   * @relation
+   * internal
+   */
+  static void RgbaToI420(const uint8_t* rgba,
+                         uint32_t width,
+                         uint32_t height,
+                         uint8_t* i420);
+
+  static size_t I420Size(uint32_t width, uint32_t height);
+
+ private:
+  FrameCapture& m_capture;
+  const std::string m_target;
+  const Format m_format;
+
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_pending{};
+  std::atomic<bool> m_stop{};
+
+  // I/O thread only
+  int m_fd{-1};
+  bool m_regular_file{};
+  bool m_failed{};
+  uint32_t m_y4m_width{};
+  uint32_t m_y4m_height{};
+  std::vector<uint8_t> m_staging;
+
+  std::atomic<uint64_t> m_written{};
+  std::atomic<uint64_t> m_dropped{};
+
+  /**
+   * @brief I/O thread
+   * @param[in] last Sequence number of the last frame not to stream
+   * @return void
+   * @relation
+   * internal
+   */
+  void Run(uint64_t last);
+
+  /**
+   * @brief Open the target if not already
+   * @return bool
+   * @retval true The target is open
+   * @retval false No consumer yet, or the target failed for good
+   * @relation
+   * internal
+   */
+  bool Connect();
+
+  void Disconnect();
+
+  /**
+   * @brief Convert the frame into m_staging
+   * @return bool
+   * @retval false The frame cannot be written to this stream
+   * @relation
+   * internal
+   */
+  bool Stage(const FrameCapture::FrameRef& frame);
+
+  /**
+   * @brief Write all of buf, waiting for the consumer unless stopping
+   * @return bool
+   * @retval false Write failed or the stream is stopping
+   * @relation
+   * internal
+   */
+  bool WriteAll(const uint8_t* buf, size_t size);
+};
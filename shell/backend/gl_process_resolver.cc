@@ -23,7 +23,7 @@
 
 #include "logging.h"
 
-#if BUILD_BACKEND_HEADLESS_EGL
+#if BUILD_BACKEND_HEADLESS_EGL && BUILD_HEADLESS_OSMESA
 #include <GL/osmesa.h>
 #endif
 
@@ -82,7 +82,7 @@ void* EglProcessResolver::process_resolver(const char* name) const {
       return address;
     }
   }
-#if BUILD_BACKEND_HEADLESS_EGL
+#if BUILD_BACKEND_HEADLESS_EGL && BUILD_HEADLESS_OSMESA
   SPDLOG_TRACE("** OSMesaGetProcAddress({})", name);
   address = reinterpret_cast<void*>(OSMesaGetProcAddress(name));
 #else
@@ -19,9 +19,11 @@
 #include <memory>
 #include <vector>
 
+#include "config/common.h"
+
 class EglProcessResolver {
  public:
-#if BUILD_BACKEND_HEADLESS_EGL
+#if BUILD_BACKEND_HEADLESS_EGL && BUILD_HEADLESS_OSMESA
   static constexpr char kGlSoNames[3UL][15UL] = {{"libOSMesa.so.8"},
                                                  {"libGLESv2.so.2"},
                                                  {"libEGL.so.1"}};
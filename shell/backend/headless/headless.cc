@@ -15,23 +15,39 @@
  */
 
 #include "headless.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "../gl_process_resolver.h"
 #include "engine.h"
-#include "osmesa.h"
+#include "libflutter_engine.h"
+#include "trace.h"
 #include "shell/platform/homescreen/flutter_desktop_engine_state.h"
+#include "shell/platform/homescreen/pixel_buffer_texture.h"
 
 struct FlutterDesktopEngineState;
 
 HeadlessBackend::HeadlessBackend(uint32_t initial_width,
                                  uint32_t initial_height,
                                  const bool /* debug_backend */,
-                                 const int /* buffer_size */)
-    : OSMesaHeadless(static_cast<int32_t>(initial_width),
-                     static_cast<int32_t>(initial_height)),
+                                 const int /* buffer_size */,
+                                 const bool layer_compositor)
+    : HeadlessContext(static_cast<int32_t>(initial_width),
+                      static_cast<int32_t>(initial_height)),
       Backend(),
       m_width(initial_width),
       m_height(initial_height),
       m_prev_width(initial_width),
-      m_prev_height(initial_height) {}
+      m_prev_height(initial_height),
+      m_layer_compositor(layer_compositor),
+      m_backing_store_pool(kMaxPooledBackingStoreBytes,
+                           kBackingStoreIdleFrames,
+                           [](std::unique_ptr<SoftwareStore>&) {}) {
+  if (m_layer_compositor) {
+    m_compositor.Resize(m_width, m_height);
+  }
+}
 
 void HeadlessBackend::Resize(size_t /* index */,
                              Engine* engine,
@@ -41,10 +57,10 @@ void HeadlessBackend::Resize(size_t /* index */,
   m_prev_height = m_height;
   m_width = static_cast<uint32_t>(width);
   m_height = static_cast<uint32_t>(height);
-  free_buffer();
-  m_buf = create_osmesa_buffer(static_cast<int32_t>(m_width),
-                               static_cast<int32_t>(m_height));
-  MakeCurrent();
+  ResizeBuffer(static_cast<int32_t>(m_width), static_cast<int32_t>(m_height));
+  if (m_layer_compositor) {
+    m_compositor.Resize(m_width, m_height);
+  }
   if (engine) {
     auto result = engine->SetWindowSize(static_cast<size_t>(m_height),
                                         static_cast<size_t>(m_width));
@@ -65,8 +81,10 @@ FlutterRendererConfig HeadlessBackend::GetRenderConfig() {
       .open_gl = {
           .struct_size = sizeof(FlutterOpenGLRendererConfig),
           .make_current = [](void* user_data) -> bool {
+            TRACE_SCOPE("HeadlessBackend::MakeCurrent");
             const auto state =
                 static_cast<FlutterDesktopEngineState*>(user_data);
+            state->view_controller->engine->OnRasterStart();
             return reinterpret_cast<HeadlessBackend*>(
                        state->view_controller->engine->GetBackend())
                 ->MakeCurrent();
@@ -78,9 +96,16 @@ FlutterRendererConfig HeadlessBackend::GetRenderConfig() {
                        state->view_controller->engine->GetBackend())
                 ->ClearCurrent();
           },
-          .present = [](void* /* userdata */) -> bool {
-            HeadlessBackend::Finish();
-            return true;
+          .present = [](void* userdata) -> bool {
+            TRACE_SCOPE("HeadlessBackend::Present");
+            const auto state =
+                static_cast<FlutterDesktopEngineState*>(userdata);
+            const auto b = reinterpret_cast<HeadlessBackend*>(
+                state->view_controller->engine->GetBackend());
+            const auto ret = b->PublishFrame(nullptr);
+            state->view_controller->engine->OnFramePresented(
+                uint64_t{b->m_width} * b->m_height);
+            return ret;
           },
           .fbo_callback = [](void*) -> uint32_t {
             return 0;  // FBO0
@@ -95,7 +120,11 @@ FlutterRendererConfig HeadlessBackend::GetRenderConfig() {
           .fbo_reset_after_present = false,
           .gl_proc_resolver = [](void* /* userdata */,
                                  const char* name) -> void* {
+#if BUILD_HEADLESS_OSMESA
             return reinterpret_cast<void*>(OSMesaGetProcAddress(name));
+#else
+            return GlProcessResolver::GetInstance().process_resolver(name);
+#endif
           },
           .gl_external_texture_frame_callback =
               [](void* userdata, const int64_t texture_id, const size_t width,
@@ -103,14 +132,17 @@ FlutterRendererConfig HeadlessBackend::GetRenderConfig() {
                  FlutterOpenGLTexture* texture_out) -> bool {
             const auto state =
                 static_cast<FlutterDesktopEngineState*>(userdata);
-            auto& texture_registry = state->texture_registrar->texture_registry;
-            auto it = std::find_if(
-                std::begin(texture_registry), std::end(texture_registry),
-                [&texture_id](auto&& p) { return p.first == texture_id; });
+            // wait free, registration never blocks a frame
+            const TextureRegistry::Reader reader(
+                state->texture_registrar->texture_registry);
+            const auto target = reader.Find(texture_id);
             // texture not found in registry
-            if (it == std::end(texture_registry))
+            if (target == nullptr)
               return false;
-            auto& target = texture_registry[texture_id];
+            if (target->pixel_buffer) {
+              return target->pixel_buffer->Populate(width, height,
+                                                    texture_out);
+            }
             *texture_out = {.target = target->target,
                             .name = target->name,
                             .format = target->format,
@@ -118,13 +150,67 @@ FlutterRendererConfig HeadlessBackend::GetRenderConfig() {
                             .destruction_callback = target->release_callback,
                             .width = target->width,
                             .height = target->height};
-            target->visible_width = width;
-            target->visible_width = height;
             return true;
           },
       }};
 }
 
+bool HeadlessBackend::PublishFrame(const uint8_t* composed) {
+  const auto read = [&](uint8_t* pixels) {
+    if (composed != nullptr) {
+      std::memcpy(pixels, composed, m_compositor.GetFrameSize());
+      return true;
+    }
+    return ReadPixels(pixels);
+  };
+
+  if (m_export && !m_stream) {
+    const auto pixels = m_export->BeginFrame(m_width, m_height);
+    if (pixels == nullptr) {
+      return true;
+    }
+    if (!read(pixels)) {
+      m_export->CancelFrame();
+      return false;
+    }
+    m_export->EndFrame(LibFlutterEngine->GetCurrentTime());
+    return true;
+  }
+
+  // readers keep their frames, rendering goes on into a free slot
+  const auto pixels = m_capture.BeginFrame(m_width, m_height);
+  if (pixels == nullptr) {
+    return true;
+  }
+  if (!read(pixels)) {
+    m_capture.CancelFrame();
+    return false;
+  }
+  const auto timestamp = LibFlutterEngine->GetCurrentTime();
+  m_capture.EndFrame(timestamp);
+  if (m_stream) {
+    m_stream->Notify();
+  }
+  if (m_export) {
+    // the stream reads the capture, the export gets a copy of the same frame
+    const auto exported = m_export->BeginFrame(m_width, m_height);
+    if (exported != nullptr) {
+      std::memcpy(exported, pixels,
+                  size_t{m_width} * m_height * FrameCapture::kBytesPerPixel);
+      m_export->EndFrame(timestamp);
+    }
+  }
+  return true;
+}
+
+void HeadlessBackend::StartFrameExport(const std::string& socket_path) {
+  m_export = std::make_unique<ShmFrameExport>(socket_path);
+}
+
+void HeadlessBackend::StartFrameStream(const std::string& target) {
+  m_stream = std::make_unique<FrameStream>(m_capture, target);
+}
+
 bool HeadlessBackend::TextureMakeCurrent() {
   return MakeTextureCurrent();
 }
@@ -134,14 +220,95 @@ bool HeadlessBackend::TextureClearCurrent() {
 }
 
 FlutterCompositor HeadlessBackend::GetCompositorConfig() {
+  if (!m_layer_compositor) {
+    return {.struct_size = sizeof(FlutterCompositor),
+            .user_data = this,
+            .create_backing_store_callback = nullptr,
+            .collect_backing_store_callback = nullptr,
+            .present_layers_callback = nullptr,
+            .avoid_backing_store_cache = true};
+  }
+  // the engine keeps the backing stores of unchanged layers across frames,
+  // and reports whether each was rendered to
   return {.struct_size = sizeof(FlutterCompositor),
           .user_data = this,
-          .create_backing_store_callback = nullptr,
-          .collect_backing_store_callback = nullptr,
-          .present_layers_callback = nullptr,
-          .avoid_backing_store_cache = true};
+          .create_backing_store_callback = CreateBackingStore,
+          .collect_backing_store_callback = CollectBackingStore,
+          .present_layers_callback = PresentLayers,
+          .avoid_backing_store_cache = false};
+}
+
+bool HeadlessBackend::CreateBackingStore(
+    const FlutterBackingStoreConfig* config,
+    FlutterBackingStore* backing_store_out,
+    void* user_data) {
+  TRACE_SCOPE("HeadlessBackend::CreateBackingStore");
+  const auto state = static_cast<FlutterDesktopEngineState*>(user_data);
+  state->view_controller->engine->OnRasterStart();
+  const auto b = reinterpret_cast<HeadlessBackend*>(
+      state->view_controller->engine->GetBackend());
+
+  const BackingStorePool<std::unique_ptr<SoftwareStore>>::Key key{
+      static_cast<uint32_t>(std::ceil(config->size.width)),
+      static_cast<uint32_t>(std::ceil(config->size.height)),
+      kFlutterSoftwarePixelFormatRGBA8888};
+  const size_t row_bytes =
+      size_t{key.width} * SoftwareCompositor::kBytesPerPixel;
+  std::unique_ptr<SoftwareStore> store;
+  if (auto pooled = b->m_backing_store_pool.Acquire(key)) {
+    store = std::move(*pooled);
+  } else {
+    store = std::make_unique<SoftwareStore>();
+    store->backend = b;
+    store->key = key;
+    store->bytes = row_bytes * key.height;
+    store->pixels = std::make_unique<uint8_t[]>(store->bytes);
+    b->m_backing_store_pool.Created(store->bytes);
+    const auto stats = b->m_backing_store_pool.GetStats();
+    spdlog::debug("Software backing store {}x{}: {} KiB live, {} KiB pooled",
+                  key.width, key.height, stats.live_bytes >> 10,
+                  stats.pooled_bytes >> 10);
+  }
+
+  backing_store_out->type = kFlutterBackingStoreTypeSoftware2;
+  backing_store_out->user_data = store.get();
+  backing_store_out->software2 = {
+      .struct_size = sizeof(FlutterSoftwareBackingStore2),
+      .allocation = store->pixels.get(),
+      .row_bytes = row_bytes,
+      .height = key.height,
+      .user_data = store.get(),
+      // returned to the pool by CollectBackingStore
+      .destruction_callback = [](void* /* user_data */) {},
+      .pixel_format = kFlutterSoftwarePixelFormatRGBA8888,
+  };
+  store.release();
+  return true;
+}
+
+bool HeadlessBackend::CollectBackingStore(const FlutterBackingStore* renderer,
+                                          void* /* user_data */) {
+  TRACE_SCOPE("HeadlessBackend::CollectBackingStore");
+  const auto store = static_cast<SoftwareStore*>(renderer->user_data);
+  const auto b = store->backend;
+  const auto key = store->key;
+  const auto bytes = store->bytes;
+  b->m_backing_store_pool.Release(key, std::unique_ptr<SoftwareStore>(store),
+                                  bytes);
+  return true;
 }
 
-GLubyte* HeadlessBackend::getHeadlessBuffer() {
-  return m_buf;
+bool HeadlessBackend::PresentLayers(const FlutterLayer** layers,
+                                    const size_t layers_count,
+                                    void* user_data) {
+  TRACE_SCOPE("HeadlessBackend::PresentLayers");
+  const auto state = static_cast<FlutterDesktopEngineState*>(user_data);
+  const auto b = reinterpret_cast<HeadlessBackend*>(
+      state->view_controller->engine->GetBackend());
+  const auto& damage = b->m_compositor.Composite(layers, layers_count);
+  const auto ret = b->PublishFrame(b->m_compositor.GetFrame());
+  state->view_controller->engine->OnFramePresented(
+      static_cast<uint64_t>(damage.Area()));
+  b->m_backing_store_pool.EndFrame();
+  return ret;
 }
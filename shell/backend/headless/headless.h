@@ -17,24 +17,54 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <string>
 
-#include <GL/osmesa.h>
+#include <GLES2/gl2.h>
 
 #include "config/common.h"
 
 #include "../backend.h"
+#include "../backing_store_pool.h"
+#include "../frame_capture.h"
+#include "../frame_stream.h"
+#include "../shm_frame_export.h"
+#include "software_compositor.h"
+#if BUILD_HEADLESS_OSMESA
 #include "osmesa.h"
+using HeadlessContext = OSMesaHeadless;
+#else
+#include "surfaceless_egl.h"
+using HeadlessContext = SurfacelessEgl;
+#endif
 
 class Backend;
 
 class Engine;
 
-class HeadlessBackend : public OSMesaHeadless, public Backend {
+class HeadlessBackend : public HeadlessContext, public Backend {
  public:
+  /// free backing stores kept for reuse
+  static constexpr size_t kMaxPooledBackingStoreBytes = 64 << 20;
+  /// frames a free backing store survives without being reused
+  static constexpr uint32_t kBackingStoreIdleFrames = 120;
+
+  /**
+   * @brief Create the headless context
+   * @param[in] initial_width Frame width
+   * @param[in] initial_height Frame height
+   * @param[in] debug_backend No use
+   * @param[in] buffer_size No use
+   * @param[in] layer_compositor Render layers into software backing stores
+   * and blend them on the CPU
+   * @relation
+   * wayland
+   */
   HeadlessBackend(uint32_t initial_width,
                   uint32_t initial_height,
                   bool debug_backend,
-                  int buffer_size);
+                  int buffer_size,
+                  bool layer_compositor = false);
 
   /**
    * @brief Resize Flutter engine Window size
@@ -84,15 +114,110 @@ class HeadlessBackend : public OSMesaHeadless, public Backend {
   /**
    * @brief Get FlutterCompositor
    * @return FlutterCompositor
-   * @retval Pointer to FlutterCompositor
+   * @retval Layer compositor if enabled, else no callbacks
    * @relation
    * wayland
    */
   FlutterCompositor GetCompositorConfig() override;
 
-  GLubyte* getHeadlessBuffer();
+  /**
+   * @brief Frames captured at each present
+   * @return FrameCapture&
+   * @relation
+   * internal
+   */
+  FrameCapture& GetFrameCapture() { return m_capture; }
+
+  /**
+   * @brief Stream every captured frame to a file, FIFO or Unix socket
+   * @param[in] target See FrameStream
+   * @return void
+   * @relation
+   * internal
+   */
+  void StartFrameStream(const std::string& target);
+
+  /**
+   * @brief Read frames back into shared memory exported to other processes,
+   * in place of the frame capture unless a frame stream needs it too
+   * @param[in] socket_path Unix socket consumers connect to
+   * @return void
+   * @relation
+   * internal
+   */
+  void StartFrameExport(const std::string& socket_path);
 
  private:
+  /// RGBA memory the engine renders a layer into
+  struct SoftwareStore {
+    HeadlessBackend* backend{};
+    BackingStorePool<std::unique_ptr<SoftwareStore>>::Key key{};
+    std::unique_ptr<uint8_t[]> pixels;
+    size_t bytes{};
+  };
+
   uint32_t m_prev_width, m_width;
   uint32_t m_prev_height, m_height;
+  bool m_layer_compositor;
+  // raster thread only
+  BackingStorePool<std::unique_ptr<SoftwareStore>> m_backing_store_pool;
+  SoftwareCompositor m_compositor;
+  FrameCapture m_capture;
+  /// declared after m_capture, which it reads until destroyed
+  std::unique_ptr<FrameStream> m_stream;
+  std::unique_ptr<ShmFrameExport> m_export;
+
+  /**
+   * @brief Read the presented frame back into the export or the capture
+   * @param[in] composed Frame blended by the layer compositor, nullptr to
+   * read the GL frame back
+   * @return bool
+   * @retval false The read back failed
+   * @relation
+   * flutter
+   */
+  bool PublishFrame(const uint8_t* composed);
+
+  /**
+   * @brief Callback to hand out a pooled or new software backing store
+   * @param[in] config Size of the backing store
+   * @param[out] backing_store_out Backing store
+   * @param[in] user_data Pointer to FlutterDesktopEngineState
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * flutter
+   */
+  static bool CreateBackingStore(const FlutterBackingStoreConfig* config,
+                                 FlutterBackingStore* backing_store_out,
+                                 void* user_data);
+
+  /**
+   * @brief Callback to return a software backing store to the pool
+   * @param[in] renderer Backing store collected by the engine
+   * @param[in] user_data Pointer to FlutterDesktopEngineState
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * flutter
+   */
+  static bool CollectBackingStore(const FlutterBackingStore* renderer,
+                                  void* user_data);
+
+  /**
+   * @brief Callback to blend the layers of a frame and publish it
+   * @param[in] layers Layers, bottom first
+   * @param[in] layers_count Number of layers
+   * @param[in] user_data Pointer to FlutterDesktopEngineState
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * flutter
+   */
+  static bool PresentLayers(const FlutterLayer** layers,
+                            size_t layers_count,
+                            void* user_data);
 };
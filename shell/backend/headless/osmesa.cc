@@ -17,6 +17,7 @@
 #include "osmesa.h"
 
 #include <cassert>
+#include <cstring>
 
 #include <GLES2/gl2.h>
 
@@ -91,6 +92,13 @@ void OSMesaHeadless::Finish() {
   glFinish();
 }
 
+bool OSMesaHeadless::ReadPixels(uint8_t* pixels) const {
+  Finish();
+  memcpy(pixels, m_buf,
+         static_cast<size_t>(m_width) * static_cast<size_t>(m_height) * 4);
+  return true;
+}
+
 GLubyte* OSMesaHeadless::create_osmesa_buffer(int32_t width, int32_t height) {
   return (GLubyte*)malloc(static_cast<unsigned long>(height * width * 4) *
                           sizeof(GLubyte));
@@ -99,3 +107,11 @@ GLubyte* OSMesaHeadless::create_osmesa_buffer(int32_t width, int32_t height) {
 void OSMesaHeadless::free_buffer() {
   free(m_buf);
 }
+
+void OSMesaHeadless::ResizeBuffer(int32_t width, int32_t height) {
+  m_width = width;
+  m_height = height;
+  free_buffer();
+  m_buf = create_osmesa_buffer(m_width, m_height);
+  MakeCurrent();
+}
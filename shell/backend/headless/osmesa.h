@@ -53,6 +53,26 @@ class OSMesaHeadless {
 
   static void Finish();
 
+  /**
+   * @brief Wait for the frame and copy the RGBA buffer out
+   * @param[out] pixels RGBA storage of the buffer size
+   * @return bool
+   * @retval true Normal end
+   * @relation
+   * internal
+   */
+  bool ReadPixels(uint8_t* pixels) const;
+
+  /**
+   * @brief Reallocate the RGBA buffer at a new size and bind it
+   * @param[in] width Buffer width
+   * @param[in] height Buffer height
+   * @return void
+   * @relation
+   * internal
+   */
+  void ResizeBuffer(int32_t width, int32_t height);
+
   /**
    * @brief Create a GLUbyte buffer to bind to an OSMesa Context
    * @param[in] width
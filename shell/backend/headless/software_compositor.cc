@@ -0,0 +1,201 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "software_compositor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+/// every channel of a pixel times a / 255, rounded: two channels per 16 bit
+/// lane pair, so each pixel stays in one 32 bit lane
+inline uint32_t Scale(const uint32_t pixel, const uint32_t a) {
+  auto rb = (pixel & 0x00ff00ffu) * a + 0x00800080u;
+  rb = ((rb + ((rb >> 8) & 0x00ff00ffu)) >> 8) & 0x00ff00ffu;
+  auto ga = ((pixel >> 8) & 0x00ff00ffu) * a + 0x00800080u;
+  ga = (ga + ((ga >> 8) & 0x00ff00ffu)) & 0xff00ff00u;
+  return rb | ga;
+}
+
+}  // namespace
+
+void SoftwareCompositor::Resize(const uint32_t width, const uint32_t height) {
+  m_width = width;
+  m_height = height;
+  m_frame.assign(size_t{width} * height * kBytesPerPixel, 0);
+  m_full_damage = true;
+}
+
+const DamageRegion& SoftwareCompositor::Composite(const FlutterLayer** layers,
+                                                  const size_t layers_count) {
+  m_damage.Clear();
+  size_t count = 0;
+  for (size_t i = 0; i < layers_count; i++) {
+    const auto layer = layers[i];
+    if (layer->type != kFlutterLayerContentTypeBackingStore ||
+        layer->backing_store->type != kFlutterBackingStoreTypeSoftware2) {
+      continue;
+    }
+    const auto& store = layer->backing_store->software2;
+    if (count == m_next_layers.size()) {
+      m_next_layers.emplace_back();
+    }
+    auto& next = m_next_layers[count];
+    next.paint.clear();
+    next.pixels = static_cast<const uint8_t*>(store.allocation);
+    next.row_bytes = store.row_bytes;
+    next.left = static_cast<int32_t>(std::lround(layer->offset.x));
+    next.top = static_cast<int32_t>(std::lround(layer->offset.y));
+    next.right =
+        next.left +
+        static_cast<int32_t>(std::min<double>(
+            static_cast<double>(store.row_bytes / kBytesPerPixel),
+            std::ceil(layer->size.width)));
+    next.bottom = next.top + static_cast<int32_t>(std::min<double>(
+                                 static_cast<double>(store.height),
+                                 std::ceil(layer->size.height)));
+    const FlutterRect bounds{static_cast<double>(next.left),
+                             static_cast<double>(next.top),
+                             static_cast<double>(next.right),
+                             static_cast<double>(next.bottom)};
+    const auto info = layer->backing_store_present_info;
+    if (info != nullptr && info->paint_region != nullptr) {
+      // pixels outside the paint region are transparent
+      for (size_t r = 0; r < info->paint_region->rects_count; r++) {
+        const auto& rect = info->paint_region->rects[r];
+        const FlutterRect clipped{
+            std::max(bounds.left, bounds.left + rect.left),
+            std::max(bounds.top, bounds.top + rect.top),
+            std::min(bounds.right, bounds.left + rect.right),
+            std::min(bounds.bottom, bounds.top + rect.bottom)};
+        if (clipped.left < clipped.right && clipped.top < clipped.bottom) {
+          next.paint.push_back(clipped);
+        }
+      }
+    } else {
+      next.paint.push_back(bounds);
+    }
+
+    // layers are matched with the previous frame by their position in the
+    // stack, a layer moved or inserted below damages the ones above
+    const auto index = count;
+    if (!m_full_damage &&
+        (index >= m_layers.size() || layer->backing_store->did_update ||
+         m_layers[index].left != next.left ||
+         m_layers[index].top != next.top ||
+         m_layers[index].right != next.right ||
+         m_layers[index].bottom != next.bottom)) {
+      if (index < m_layers.size()) {
+        AddDamage(m_layers[index].paint);
+      }
+      AddDamage(next.paint);
+    }
+    count++;
+  }
+  if (!m_full_damage) {
+    for (auto i = count; i < m_layers.size(); i++) {
+      AddDamage(m_layers[i].paint);
+    }
+  }
+  // layers beyond |count| are dropped only when the stack shrinks
+  m_next_layers.resize(count);
+  std::swap(m_layers, m_next_layers);
+
+  if (m_full_damage) {
+    m_damage.Clear();
+    m_damage.Add(FlutterRect{0, 0, static_cast<double>(m_width),
+                             static_cast<double>(m_height)});
+    m_full_damage = false;
+  }
+  for (size_t i = 0; i < m_damage.size(); i++) {
+    ComposeRect(m_damage[i]);
+  }
+  return m_damage;
+}
+
+void SoftwareCompositor::AddDamage(const std::vector<FlutterRect>& paint) {
+  for (const auto& rect : paint) {
+    m_damage.Add(rect);
+  }
+}
+
+void SoftwareCompositor::ComposeRect(const FlutterRect& rect) {
+  const auto left = static_cast<int32_t>(std::max(0.0, std::floor(rect.left)));
+  const auto top = static_cast<int32_t>(std::max(0.0, std::floor(rect.top)));
+  const auto right = static_cast<int32_t>(
+      std::min(static_cast<double>(m_width), std::ceil(rect.right)));
+  const auto bottom = static_cast<int32_t>(
+      std::min(static_cast<double>(m_height), std::ceil(rect.bottom)));
+  if (left >= right) {
+    return;
+  }
+  const size_t stride = size_t{m_width} * kBytesPerPixel;
+
+  for (auto y = top; y < bottom; y++) {
+    const auto row =
+        m_frame.data() + (m_height - 1 - static_cast<uint32_t>(y)) * stride;
+    std::memset(row + static_cast<size_t>(left) * kBytesPerPixel, 0,
+                static_cast<size_t>(right - left) * kBytesPerPixel);
+    for (size_t i = 0; i < m_layers.size(); i++) {
+      const auto& layer = m_layers[i];
+      if (y < layer.top || y >= layer.bottom) {
+        continue;
+      }
+      // paint rectangles never overlap, each pixel is blended once
+      for (const auto& paint : layer.paint) {
+        if (y < paint.top || y >= paint.bottom) {
+          continue;
+        }
+        const auto from =
+            std::max(left, static_cast<int32_t>(std::floor(paint.left)));
+        const auto to =
+            std::min(right, static_cast<int32_t>(std::ceil(paint.right)));
+        if (from >= to) {
+          continue;
+        }
+        const auto src =
+            layer.pixels +
+            static_cast<size_t>(y - layer.top) * layer.row_bytes +
+            static_cast<size_t>(from - layer.left) * kBytesPerPixel;
+        const auto dst = row + static_cast<size_t>(from) * kBytesPerPixel;
+        const auto width = static_cast<uint32_t>(to - from);
+        if (i == 0) {
+          // over a cleared frame the bottom layer is its own blend
+          std::memcpy(dst, src, size_t{width} * kBytesPerPixel);
+        } else {
+          BlendRow(src, dst, width);
+        }
+      }
+    }
+  }
+}
+
+void SoftwareCompositor::BlendRow(const uint8_t* __restrict src,
+                                  uint8_t* __restrict dst,
+                                  const uint32_t width) {
+  // premultiplied source over, a pixel per 32 bit word; the alpha byte is
+  // the top byte on little endian
+  for (size_t x = 0; x < width; x++) {
+    uint32_t s;
+    uint32_t d;
+    std::memcpy(&s, src + x * kBytesPerPixel, sizeof(s));
+    std::memcpy(&d, dst + x * kBytesPerPixel, sizeof(d));
+    d = s + Scale(d, 255u - (s >> 24));
+    std::memcpy(dst + x * kBytesPerPixel, &d, sizeof(d));
+  }
+}
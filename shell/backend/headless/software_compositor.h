@@ -0,0 +1,130 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "config/common.h"
+
+#include "../damage_region.h"
+#include "flutter/shell/platform/embedder/embedder.h"
+
+/**
+ * @brief Blends the software backing stores of a frame's layers into one
+ * RGBA frame on the CPU.
+ *
+ * The frame is kept between presents and only the damage is composed again:
+ * the paint region of every layer the engine updated or moved, and of every
+ * layer that appeared or went away.  Platform views have no content without
+ * a display and are left transparent.
+ *
+ * Backing stores are premultiplied RGBA, top row first.  The frame rows are
+ * bottom row first, as read back from GL, so that it is published like a
+ * rendered frame.
+ */
+class SoftwareCompositor {
+ public:
+  static constexpr size_t kBytesPerPixel = 4;
+
+  /**
+   * @brief Reallocate the frame, the next frame is composed in full
+   * @param[in] width Frame width
+   * @param[in] height Frame height
+   * @return void
+   * @relation
+   * flutter
+   */
+  void Resize(uint32_t width, uint32_t height);
+
+  /**
+   * @brief Bring the frame up to date with the layers of a present
+   * @param[in] layers Layers, bottom first; backing stores must be of type
+   * kFlutterBackingStoreTypeSoftware2 in RGBA8888
+   * @param[in] layers_count Number of layers
+   * @return const DamageRegion&
+   * @retval Part of the frame composed again, valid until the next call
+   * @relation
+   * flutter
+   */
+  const DamageRegion& Composite(const FlutterLayer** layers,
+                                size_t layers_count);
+
+  /// RGBA rows, bottom row first
+  NODISCARD const uint8_t* GetFrame() const { return m_frame.data(); }
+
+  NODISCARD size_t GetFrameSize() const { return m_frame.size(); }
+
+  NODISCARD uint32_t GetWidth() const { return m_width; }
+
+  NODISCARD uint32_t GetHeight() const { return m_height; }
+
+  /**
+   * @brief Blend a row of premultiplied pixels over another
+   * @param[in] src Source pixels
+   * @param[in,out] dst Destination pixels, must not overlap src
+   * @param[in] width Pixels in the row
+   * @return void
+   * @relation
+   * flutter
+   */
+  static void BlendRow(const uint8_t* src, uint8_t* dst, uint32_t width);
+
+ private:
+  struct Layer {
+    const uint8_t* pixels;
+    size_t row_bytes;
+    /// bounds in the frame, whole pixels
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+    /// where the layer has content, in the frame; the engine's paint region
+    /// rectangles as is, which never overlap.  A DamageRegion would merge
+    /// them into overlapping bounds and blend pixels twice.
+    std::vector<FlutterRect> paint;
+  };
+
+  uint32_t m_width{};
+  uint32_t m_height{};
+  std::vector<uint8_t> m_frame;
+  /// backing store layers of the previous frame
+  std::vector<Layer> m_layers;
+  /// storage reused by the next frame, keeps the paint vectors' capacity
+  std::vector<Layer> m_next_layers;
+  DamageRegion m_damage;
+  bool m_full_damage{true};
+
+  /**
+   * @brief Compose one rectangle of the frame from all layers
+   * @param[in] rect Frame rectangle, clipped to the frame
+   * @return void
+   * @relation
+   * flutter
+   */
+  void ComposeRect(const FlutterRect& rect);
+
+  /**
+   * @brief Add the paint rectangles of a layer to the damage
+   * @param[in] paint Paint rectangles
+   * @return void
+   * @relation
+   * flutter
+   */
+  void AddDamage(const std::vector<FlutterRect>& paint);
+};
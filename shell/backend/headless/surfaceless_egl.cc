@@ -0,0 +1,227 @@
+/*
+ * Copyright 2021-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "surfaceless_egl.h"
+
+#include <cassert>
+#include <cstring>
+
+#include <GLES2/gl2.h>
+
+#include "logging.h"
+
+namespace {
+
+bool HasExtension(const char* extensions, const char* name) {
+  if (extensions == nullptr) {
+    return false;
+  }
+  const auto len = strlen(name);
+  for (auto r = strstr(extensions, name); r != nullptr;
+       r = strstr(r + len, name)) {
+    // check the extension name is a whole word
+    if ((r == extensions || r[-1] == ' ') && (r[len] == ' ' || r[len] == 0)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+SurfacelessEgl::SurfacelessEgl(int32_t initial_width, int32_t initial_height)
+    : m_dpy(GetPlatformDisplay()),
+      m_width(initial_width),
+      m_height(initial_height) {
+  if (initial_width == 0) {
+    m_width = kDefaultViewWidth;
+  }
+  if (initial_height == 0) {
+    m_height = kDefaultViewHeight;
+  }
+  assert(m_dpy != EGL_NO_DISPLAY);
+
+  EGLint major, minor;
+  EGLBoolean ret = eglInitialize(m_dpy, &major, &minor);
+  assert(ret == EGL_TRUE);
+  SPDLOG_DEBUG("EGL {}.{}", major, minor);
+
+  ret = eglBindAPI(EGL_OPENGL_ES_API);
+  assert(ret == EGL_TRUE);
+
+  EGLint n;
+  ret = eglChooseConfig(m_dpy, kEglHeadlessConfigAttribs.data(), &m_config, 1,
+                        &n);
+  if (ret != EGL_TRUE || n < 1) {
+    spdlog::critical("No pbuffer EGL config");
+    assert(false);
+  }
+
+  if (!HasExtension(eglQueryString(m_dpy, EGL_EXTENSIONS),
+                    "EGL_KHR_surfaceless_context")) {
+    spdlog::critical("EGL_KHR_surfaceless_context not supported");
+    assert(false);
+  }
+
+  m_context = eglCreateContext(m_dpy, m_config, EGL_NO_CONTEXT,
+                               kEglContextAttribs.data());
+  assert(m_context);
+  spdlog::trace("Context Created");
+
+  m_resource_context =
+      eglCreateContext(m_dpy, m_config, m_context, kEglContextAttribs.data());
+  assert(m_resource_context);
+  spdlog::trace("Resource Context Created");
+
+  m_texture_context =
+      eglCreateContext(m_dpy, m_config, m_context, kEglContextAttribs.data());
+  assert(m_texture_context);
+  spdlog::trace("Texture Context Created");
+
+  ResizeBuffer(m_width, m_height);
+
+#if !defined(NDEBUG)
+  // another view may be current on this thread, put it back afterwards
+  const auto previous_context = eglGetCurrentContext();
+  const auto previous_draw = eglGetCurrentSurface(EGL_DRAW);
+  const auto previous_read = eglGetCurrentSurface(EGL_READ);
+  MakeCurrent();
+  SPDLOG_DEBUG("EGL Vendor: {}", eglQueryString(m_dpy, EGL_VENDOR));
+  SPDLOG_DEBUG("GL Renderer: {}",
+               reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+  eglMakeCurrent(m_dpy, previous_draw, previous_read, previous_context);
+#endif
+
+  (void)ret;
+}
+
+SurfacelessEgl::~SurfacelessEgl() {
+  // the display is shared by every view of the process, and other views may
+  // have contexts current on this thread; release only what this one owns
+  const auto current = eglGetCurrentContext();
+  if (current != EGL_NO_CONTEXT &&
+      (current == m_context || current == m_resource_context ||
+       current == m_texture_context)) {
+    eglMakeCurrent(m_dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  }
+  eglDestroySurface(m_dpy, m_surface);
+  eglDestroyContext(m_dpy, m_texture_context);
+  eglDestroyContext(m_dpy, m_resource_context);
+  eglDestroyContext(m_dpy, m_context);
+}
+
+EGLDisplay SurfacelessEgl::GetPlatformDisplay() {
+  const auto extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  const auto get_platform_display =
+      reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+          eglGetProcAddress("eglGetPlatformDisplayEXT"));
+  if (get_platform_display == nullptr) {
+    spdlog::critical("eglGetPlatformDisplayEXT not supported");
+    return EGL_NO_DISPLAY;
+  }
+
+  if (HasExtension(extensions, "EGL_MESA_platform_surfaceless")) {
+    const auto dpy = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA,
+                                          EGL_DEFAULT_DISPLAY, nullptr);
+    if (dpy != EGL_NO_DISPLAY) {
+      SPDLOG_DEBUG("EGL_MESA_platform_surfaceless");
+      return dpy;
+    }
+  }
+
+  if (HasExtension(extensions, "EGL_EXT_platform_device")) {
+    const auto query_devices = reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(
+        eglGetProcAddress("eglQueryDevicesEXT"));
+    EGLDeviceEXT device;
+    EGLint count = 0;
+    if (query_devices && query_devices(1, &device, &count) && count > 0) {
+      const auto dpy =
+          get_platform_display(EGL_PLATFORM_DEVICE_EXT, device, nullptr);
+      if (dpy != EGL_NO_DISPLAY) {
+        SPDLOG_DEBUG("EGL_EXT_platform_device");
+        return dpy;
+      }
+    }
+  }
+
+  spdlog::critical(
+      "Neither EGL_MESA_platform_surfaceless nor EGL_EXT_platform_device is "
+      "available");
+  return EGL_NO_DISPLAY;
+}
+
+bool SurfacelessEgl::MakeCurrent() {
+  spdlog::trace("+MakeCurrent(), thread_id=0x{:x}", pthread_self());
+  const auto ret = eglMakeCurrent(m_dpy, m_surface, m_surface, m_context);
+  assert(ret == EGL_TRUE);
+  spdlog::trace("-MakeCurrent()");
+  return ret == EGL_TRUE;
+}
+
+bool SurfacelessEgl::ClearCurrent() const {
+  spdlog::trace("+ClearCurrent(), thread_id=0x{:x}", pthread_self());
+  const auto ret =
+      eglMakeCurrent(m_dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  assert(ret == EGL_TRUE);
+  spdlog::trace("-ClearCurrent()");
+  return ret == EGL_TRUE;
+}
+
+bool SurfacelessEgl::MakeResourceCurrent() {
+  spdlog::trace("+MakeResourceCurrent(), thread_id=0x{:x}", pthread_self());
+  const auto ret = eglMakeCurrent(m_dpy, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                                  m_resource_context);
+  assert(ret == EGL_TRUE);
+  spdlog::trace("-MakeResourceCurrent()");
+  return ret == EGL_TRUE;
+}
+
+bool SurfacelessEgl::MakeTextureCurrent() {
+  spdlog::trace("+MakeTextureCurrent(), thread_id=0x{:x}", pthread_self());
+  const auto ret = eglMakeCurrent(m_dpy, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                                  m_texture_context);
+  assert(ret == EGL_TRUE);
+  spdlog::trace("-MakeTextureCurrent()");
+  return ret == EGL_TRUE;
+}
+
+bool SurfacelessEgl::ReadPixels(uint8_t* pixels) const {
+  // pbuffers are single buffered, reading back waits for the frame
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+  return glGetError() == GL_NO_ERROR;
+}
+
+void SurfacelessEgl::ResizeBuffer(int32_t width, int32_t height) {
+  m_width = width;
+  m_height = height;
+
+  if (m_surface != EGL_NO_SURFACE) {
+    if (eglGetCurrentSurface(EGL_DRAW) == m_surface) {
+      ClearCurrent();
+    }
+    eglDestroySurface(m_dpy, m_surface);
+  }
+  const std::array<EGLint, 5> attribs{EGL_WIDTH, m_width, EGL_HEIGHT, m_height,
+                                      EGL_NONE};
+  m_surface = eglCreatePbufferSurface(m_dpy, m_config, attribs.data());
+  if (m_surface == EGL_NO_SURFACE) {
+    spdlog::critical("eglCreatePbufferSurface {}x{} failed: 0x{:x}", m_width,
+                     m_height, eglGetError());
+    assert(false);
+  }
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2021-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "config/common.h"
+
+/**
+ * @brief Offscreen EGL rendering without a window system.
+ *
+ * The display comes from EGL_MESA_platform_surfaceless, or from the first
+ * device of EGL_EXT_platform_device when that is not available, so on a
+ * CPU-only machine Mesa renders with llvmpipe.  Flutter draws into a pbuffer
+ * bound as FBO 0, and ReadPixels() copies it out as RGBA, bottom row first
+ * like OSMesa.
+ */
+class SurfacelessEgl {
+ public:
+  SurfacelessEgl(int32_t initial_width, int32_t initial_height);
+
+  ~SurfacelessEgl();
+
+  /**
+   * @brief Clear an EGL rendering context
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * internal
+   */
+  bool ClearCurrent() const;
+
+  /**
+   * @brief Attach the EGL rendering context to the pbuffer
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * internal
+   */
+  bool MakeCurrent();
+  bool MakeResourceCurrent();
+  bool MakeTextureCurrent();
+
+  /**
+   * @brief Read the rendered frame back, the context must be current
+   * @param[out] pixels RGBA storage of the buffer size
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * internal
+   */
+  bool ReadPixels(uint8_t* pixels) const;
+
+  /**
+   * @brief Recreate the pbuffer at a new size
+   * @param[in] width Buffer width
+   * @param[in] height Buffer height
+   * @return void
+   * @relation
+   * internal
+   */
+  void ResizeBuffer(int32_t width, int32_t height);
+
+ private:
+  /**
+   * @brief Get a display that needs no window system
+   * @return EGLDisplay
+   * @retval EGL_NO_DISPLAY Neither platform is available
+   * @relation
+   * internal
+   */
+  static EGLDisplay GetPlatformDisplay();
+
+  EGLDisplay m_dpy{};
+  EGLConfig m_config{};
+  EGLContext m_context{};
+  EGLContext m_resource_context{};
+  EGLContext m_texture_context{};
+  EGLSurface m_surface{};
+  int32_t m_width{};
+  int32_t m_height{};
+};
@@ -0,0 +1,319 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shm_frame_export.h"
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+
+namespace {
+
+struct Consumer {
+  int fd;
+  /// generation of the pool last handed to the consumer
+  uint64_t pool;
+  uint64_t sequence;
+};
+
+size_t PageAlign(const size_t size) {
+  const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return (size + page - 1) / page * page;
+}
+
+bool Send(const int fd, const shm_frame::Message& message, const int pass_fd) {
+  iovec iov{const_cast<shm_frame::Message*>(&message), sizeof(message)};
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+  if (pass_fd >= 0) {
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    const auto cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &pass_fd, sizeof(int));
+  }
+  return sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL) ==
+         static_cast<ssize_t>(sizeof(message));
+}
+
+}  // namespace
+
+ShmFrameExport::Pool::~Pool() {
+  if (header) {
+    munmap(header, size);
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+}
+
+ShmFrameExport::ShmFrameExport(std::string socket_path)
+    : m_socket_path(std::move(socket_path)) {
+  sockaddr_un addr{};
+  if (m_socket_path.size() >= sizeof(addr.sun_path)) {
+    spdlog::error("Frame export: socket path too long: {}", m_socket_path);
+    return;
+  }
+  addr.sun_family = AF_UNIX;
+  std::memcpy(addr.sun_path, m_socket_path.c_str(), m_socket_path.size());
+
+  // message boundaries keep the fd with its kPool message
+  m_listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK,
+                       0);
+  unlink(m_socket_path.c_str());
+  if (m_listen_fd < 0 ||
+      bind(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) !=
+          0 ||
+      listen(m_listen_fd, 4) != 0) {
+    spdlog::error("Frame export: failed to listen on {}: {}", m_socket_path,
+                  std::strerror(errno));
+    if (m_listen_fd >= 0) {
+      close(m_listen_fd);
+    }
+    m_listen_fd = -1;
+    return;
+  }
+
+  m_event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  spdlog::info("Frame export: {}", m_socket_path);
+  m_thread = std::thread(&ShmFrameExport::Run, this);
+}
+
+ShmFrameExport::~ShmFrameExport() {
+  if (m_thread.joinable()) {
+    m_stop.store(true, std::memory_order_relaxed);
+    Wake();
+    m_thread.join();
+  }
+  if (m_event_fd >= 0) {
+    close(m_event_fd);
+  }
+  if (m_listen_fd >= 0) {
+    close(m_listen_fd);
+    unlink(m_socket_path.c_str());
+  }
+}
+
+std::shared_ptr<ShmFrameExport::Pool> ShmFrameExport::CreatePool(
+    const size_t frame_size) {
+  auto pool = std::make_shared<Pool>();
+  const auto header_size = PageAlign(sizeof(shm_frame::Header));
+  const auto capacity = PageAlign(frame_size);
+  pool->size = header_size + capacity * shm_frame::kBuffers;
+
+#ifdef HAVE_MEMFD_CREATE
+  pool->fd = memfd_create("homescreen-frames", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+  pool->fd = open("/dev/shm", O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+#endif
+  if (pool->fd < 0 || ftruncate(pool->fd, static_cast<off_t>(pool->size))) {
+    spdlog::error("Frame export: failed to allocate {} bytes: {}", pool->size,
+                  std::strerror(errno));
+    return nullptr;
+  }
+#ifdef HAVE_MEMFD_CREATE
+  // consumers may rely on the size; a shrinking pool would fault them
+  fcntl(pool->fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+#endif
+
+  const auto mapped = mmap(nullptr, pool->size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, pool->fd, 0);
+  if (mapped == MAP_FAILED) {
+    spdlog::error("Frame export: mmap failed: {}", std::strerror(errno));
+    return nullptr;
+  }
+  pool->header = new (mapped) shm_frame::Header{};
+  pool->header->magic = shm_frame::kMagic;
+  pool->header->version = shm_frame::kVersion;
+  pool->header->buffer_count = shm_frame::kBuffers;
+  pool->header->buffer_offset = header_size;
+  pool->header->buffer_capacity = capacity;
+  pool->header->latest.store(shm_frame::kNoBuffer, std::memory_order_relaxed);
+  return pool;
+}
+
+uint8_t* ShmFrameExport::BeginFrame(const uint32_t width,
+                                    const uint32_t height) {
+  const size_t frame_size = size_t{width} * height * shm_frame::kBytesPerPixel;
+  // only this thread replaces the pool, reading it needs no lock
+  if (!m_pool || m_pool->header->buffer_capacity < frame_size) {
+    auto pool = CreatePool(frame_size);
+    if (!pool) {
+      return nullptr;
+    }
+    {
+      std::lock_guard lock(m_pool_mutex);
+      if (m_pool) {
+        m_pool->header->retired.store(1, std::memory_order_release);
+      }
+      pool->generation = ++m_pool_generation;
+      m_pool = std::move(pool);
+    }
+    Wake();
+  }
+
+  const auto header = m_pool->header;
+  const auto latest = header->latest.load(std::memory_order_relaxed);
+  m_writing = latest == shm_frame::kNoBuffer ? 0 : (latest + 1) %
+                                                       shm_frame::kBuffers;
+  auto& buffer = header->buffers[m_writing];
+  buffer.seq.store(buffer.seq.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  buffer.width.store(width, std::memory_order_relaxed);
+  buffer.height.store(height, std::memory_order_relaxed);
+  buffer.stride.store(width * shm_frame::kBytesPerPixel,
+                      std::memory_order_relaxed);
+  return shm_frame::BufferPixels(header, m_writing);
+}
+
+uint64_t ShmFrameExport::EndFrame(const uint64_t timestamp_ns) {
+  if (m_writing == shm_frame::kNoBuffer) {
+    return 0;
+  }
+  const auto header = m_pool->header;
+  auto& buffer = header->buffers[m_writing];
+  buffer.sequence.store(++m_sequence, std::memory_order_relaxed);
+  buffer.timestamp_ns.store(timestamp_ns, std::memory_order_relaxed);
+  buffer.seq.store(buffer.seq.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_release);
+  header->latest.store(m_writing, std::memory_order_release);
+  m_writing = shm_frame::kNoBuffer;
+  m_published.fetch_add(1, std::memory_order_relaxed);
+  Wake();
+  return m_sequence;
+}
+
+void ShmFrameExport::CancelFrame() {
+  if (m_writing == shm_frame::kNoBuffer) {
+    return;
+  }
+  auto& buffer = m_pool->header->buffers[m_writing];
+  buffer.sequence.store(0, std::memory_order_relaxed);
+  buffer.seq.store(buffer.seq.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_release);
+  m_writing = shm_frame::kNoBuffer;
+}
+
+ShmFrameExport::Stats ShmFrameExport::GetStats() const {
+  return {m_published.load(std::memory_order_relaxed),
+          m_consumers.load(std::memory_order_relaxed)};
+}
+
+void ShmFrameExport::Wake() const {
+  if (m_event_fd >= 0) {
+    const uint64_t one = 1;
+    // the counter only saturates, which still wakes the thread
+    (void)write(m_event_fd, &one, sizeof(one));
+  }
+}
+
+void ShmFrameExport::Run() {
+  pthread_setname_np(pthread_self(), "frame_export");
+  std::vector<Consumer> consumers;
+  std::vector<pollfd> fds;
+
+  while (!m_stop.load(std::memory_order_relaxed)) {
+    fds.clear();
+    fds.push_back({m_listen_fd, POLLIN, 0});
+    fds.push_back({m_event_fd, POLLIN, 0});
+    for (const auto& consumer : consumers) {
+      // only hang ups are of interest
+      fds.push_back({consumer.fd, 0, 0});
+    }
+    if (poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR) {
+      spdlog::error("Frame export: poll failed: {}", std::strerror(errno));
+      break;
+    }
+
+    if (fds[1].revents & POLLIN) {
+      uint64_t count;
+      (void)read(m_event_fd, &count, sizeof(count));
+    }
+    for (size_t i = consumers.size(); i-- > 0;) {
+      if (fds[i + 2].revents & (POLLHUP | POLLERR)) {
+        close(consumers[i].fd);
+        consumers.erase(consumers.begin() + static_cast<ptrdiff_t>(i));
+      }
+    }
+    if (fds[0].revents & POLLIN) {
+      const auto fd =
+          accept4(m_listen_fd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+      if (fd >= 0) {
+        consumers.push_back({fd, 0, 0});
+      }
+    }
+
+    std::shared_ptr<Pool> pool;
+    {
+      std::lock_guard lock(m_pool_mutex);
+      pool = m_pool;
+    }
+    if (!pool) {
+      m_consumers.store(static_cast<uint32_t>(consumers.size()),
+                        std::memory_order_relaxed);
+      continue;
+    }
+    const auto latest = pool->header->latest.load(std::memory_order_acquire);
+    // a notification only, consumers check the frame with the seqlock
+    const auto sequence =
+        latest == shm_frame::kNoBuffer
+            ? 0
+            : pool->header->buffers[latest].sequence.load(
+                  std::memory_order_relaxed);
+
+    for (size_t i = consumers.size(); i-- > 0;) {
+      auto& consumer = consumers[i];
+      if (consumer.pool != pool->generation) {
+        // one that cannot even take the pool is gone
+        if (!Send(consumer.fd, {shm_frame::kPool, 0, pool->size}, pool->fd)) {
+          spdlog::debug("Frame export: dropping consumer: {}",
+                        std::strerror(errno));
+          close(consumer.fd);
+          consumers.erase(consumers.begin() + static_cast<ptrdiff_t>(i));
+          continue;
+        }
+        consumer.pool = pool->generation;
+      }
+      // a consumer not keeping up misses notifications, not frames
+      if (sequence != 0 && consumer.sequence != sequence &&
+          Send(consumer.fd, {shm_frame::kFrame, latest, sequence}, -1)) {
+        consumer.sequence = sequence;
+      }
+    }
+    m_consumers.store(static_cast<uint32_t>(consumers.size()),
+                      std::memory_order_relaxed);
+  }
+
+  for (const auto& consumer : consumers) {
+    close(consumer.fd);
+  }
+}
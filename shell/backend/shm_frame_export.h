@@ -0,0 +1,142 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config/common.h"
+
+#include "shm_frame_protocol.h"
+
+/**
+ * @brief Exports frames to other processes through a memfd buffer pool.
+ *
+ * The raster thread reads each frame back straight into a pool buffer and
+ * publishes it through the buffer's seqlock, see shm_frame_protocol.h.  An
+ * I/O thread serves the Unix socket: it hands the pool fd to every consumer
+ * that connects and forwards a notification for each frame, never blocking
+ * on a slow consumer.  Consumers map the pool and use the frames in place.
+ */
+class ShmFrameExport {
+ public:
+  struct Stats {
+    uint64_t published;
+    uint32_t consumers;
+  };
+
+  /**
+   * @brief Listen for consumers
+   * @param[in] socket_path Unix socket path, replaced if it exists
+   * @relation
+   * internal
+   */
+  explicit ShmFrameExport(std::string socket_path);
+
+  ~ShmFrameExport();
+
+  ShmFrameExport(const ShmFrameExport&) = delete;
+  ShmFrameExport& operator=(const ShmFrameExport&) = delete;
+
+  /**
+   * @brief Check the socket is listening
+   * @return bool
+   * @retval true Consumers can connect
+   * @relation
+   * internal
+   */
+  NODISCARD bool IsValid() const { return m_listen_fd >= 0; }
+
+  /**
+   * @brief Get the buffer for the next frame, raster thread only
+   * @param[in] width Frame width
+   * @param[in] height Frame height
+   * @return uint8_t*
+   * @retval Shared RGBA buffer of width * height pixels
+   * @retval nullptr No pool could be allocated
+   * @relation
+   * flutter
+   */
+  uint8_t* BeginFrame(uint32_t width, uint32_t height);
+
+  /**
+   * @brief Publish the frame started by BeginFrame()
+   * @param[in] timestamp_ns CLOCK_MONOTONIC nanoseconds of the present
+   * @return uint64_t
+   * @retval Sequence number of the frame
+   * @relation
+   * flutter
+   */
+  uint64_t EndFrame(uint64_t timestamp_ns);
+
+  /**
+   * @brief Give back the buffer of a frame that could not be read back
+   * @return void
+   * @relation
+   * flutter
+   */
+  void CancelFrame();
+
+  NODISCARD Stats GetStats() const;
+
+ private:
+  struct Pool {
+    int fd{-1};
+    size_t size{};
+    uint64_t generation{};
+    shm_frame::Header* header{};
+
+    ~Pool();
+  };
+
+  const std::string m_socket_path;
+  int m_listen_fd{-1};
+  /// wakes the I/O thread for a new frame, pool or stop
+  int m_event_fd{-1};
+  std::thread m_thread;
+  std::atomic<bool> m_stop{};
+
+  /// guards m_pool between the raster and I/O threads
+  std::mutex m_pool_mutex;
+  std::shared_ptr<Pool> m_pool;
+
+  // raster thread only
+  uint32_t m_writing{shm_frame::kNoBuffer};
+  uint64_t m_sequence{};
+  uint64_t m_pool_generation{};
+
+  std::atomic<uint64_t> m_published{};
+  std::atomic<uint32_t> m_consumers{};
+
+  /**
+   * @brief Allocate a pool for frames of frame_size bytes
+   * @return std::shared_ptr<Pool>
+   * @retval nullptr if the memfd could not be created or mapped
+   * @relation
+   * internal
+   */
+  static std::shared_ptr<Pool> CreatePool(size_t frame_size);
+
+  void Run();
+
+  void Wake() const;
+};
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Shared memory frame export protocol, shared with consumers.
+ *
+ * Frames live in a memfd pool: a Header followed by kBuffers RGBA buffers of
+ * buffer_capacity bytes each, starting at buffer_offset.  The pool fd is
+ * passed over a SOCK_SEQPACKET Unix socket in a kPool Message; a kFrame
+ * Message follows every published frame.  A pool is replaced when frames
+ * outgrow it; the old one is marked retired and a new kPool is sent.
+ *
+ * Every buffer is guarded by a seqlock.  To read buffer Header::latest
+ * without copying it:
+ *
+ *   s1 = seq.load(acquire); odd means being written, try again
+ *   use the metadata and pixels in place
+ *   atomic_thread_fence(acquire); s2 = seq.load(relaxed)
+ *   the frame was complete if s1 == s2
+ *
+ * The writer cycles through the buffers, so a buffer stays untouched for at
+ * least one frame after it stopped being the latest.
+ */
+namespace shm_frame {
+
+/// "HSSM"
+constexpr uint32_t kMagic = 0x4d535348;
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kBuffers = 3;
+constexpr uint32_t kBytesPerPixel = 4;
+/// Header::latest before the first frame
+constexpr uint32_t kNoBuffer = UINT32_MAX;
+
+struct BufferHeader {
+  /// seqlock, odd while the buffer is written
+  std::atomic<uint32_t> seq;
+  std::atomic<uint32_t> width;
+  std::atomic<uint32_t> height;
+  /// bytes per row, rows are bottom row first
+  std::atomic<uint32_t> stride;
+  /// frame sequence number, 0 if the buffer holds no frame
+  std::atomic<uint64_t> sequence;
+  /// CLOCK_MONOTONIC nanoseconds of the present
+  std::atomic<uint64_t> timestamp_ns;
+};
+
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t buffer_count;
+  uint32_t reserved;
+  uint64_t buffer_offset;
+  uint64_t buffer_capacity;
+  /// index of the latest published buffer
+  std::atomic<uint32_t> latest;
+  /// non-zero once a newer pool replaced this one
+  std::atomic<uint32_t> retired;
+  BufferHeader buffers[kBuffers];
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free &&
+                  std::atomic<uint64_t>::is_always_lock_free,
+              "shared memory atomics must be address free");
+
+enum MessageType : uint32_t {
+  /// carries the pool fd; value is the pool size in bytes
+  kPool = 1,
+  /// value is the frame sequence number
+  kFrame = 2,
+};
+
+struct Message {
+  uint32_t type;
+  /// kFrame: buffer index of the frame
+  uint32_t buffer;
+  uint64_t value;
+};
+
+/// pixels of buffer index within a mapped pool
+inline uint8_t* BufferPixels(Header* header, const uint32_t index) {
+  return reinterpret_cast<uint8_t*>(header) + header->buffer_offset +
+         header->buffer_capacity * index;
+}
+
+}  // namespace shm_frame
@@ -82,6 +82,10 @@ Egl::Egl(void* native_display, int buffer_size, bool debug)
       eglCreateContext(m_dpy, m_config, m_context, kEglContextAttribs.data());
   SPDLOG_TRACE("Texture Context={}", m_texture_context);
 
+  m_compositor_context =
+      eglCreateContext(m_dpy, m_config, m_context, kEglContextAttribs.data());
+  SPDLOG_TRACE("Compositor Context={}", m_compositor_context);
+
   MakeCurrent();
 
   auto extensions = eglQueryString(m_dpy, EGL_EXTENSIONS);
@@ -113,6 +117,22 @@ Egl::Egl(void* native_display, int buffer_size, bool debug)
     SPDLOG_DEBUG("EGL_EXT_buffer_age found");
   }
 
+  /* setup for ordering the contexts without glFinish */
+  if (HasEGLExtension(extensions, "EGL_KHR_fence_sync")) {
+    SPDLOG_DEBUG("EGL_KHR_fence_sync found");
+    m_pfCreateSync = reinterpret_cast<PFNEGLCREATESYNCKHRPROC>(
+        eglGetProcAddress("eglCreateSyncKHR"));
+    m_pfDestroySync = reinterpret_cast<PFNEGLDESTROYSYNCKHRPROC>(
+        eglGetProcAddress("eglDestroySyncKHR"));
+    m_pfClientWaitSync = reinterpret_cast<PFNEGLCLIENTWAITSYNCKHRPROC>(
+        eglGetProcAddress("eglClientWaitSyncKHR"));
+    if (HasEGLExtension(extensions, "EGL_KHR_wait_sync")) {
+      SPDLOG_DEBUG("EGL_KHR_wait_sync found");
+      m_pfWaitSync = reinterpret_cast<PFNEGLWAITSYNCKHRPROC>(
+          eglGetProcAddress("eglWaitSyncKHR"));
+    }
+  }
+
 #if !defined(NDEBUG)
   SPDLOG_DEBUG("EGL Version: {}", eglQueryString(m_dpy, EGL_VERSION));
   SPDLOG_DEBUG("EGL Vendor: {}", eglQueryString(m_dpy, EGL_VENDOR));
@@ -228,6 +248,48 @@ bool Egl::MakeTextureCurrent() {
   return true;
 }
 
+bool Egl::MakeCompositorCurrent(EGLSurface surface) {
+  SPDLOG_TRACE("+MakeCompositorCurrent(), thread_id=0x{:x}", pthread_self());
+  if (eglGetCurrentContext() != m_compositor_context ||
+      eglGetCurrentSurface(EGL_DRAW) != surface) {
+    if (!eglMakeCurrent(m_dpy, surface, surface, m_compositor_context)) {
+      spdlog::error("Failed to make the compositor context current: 0x{:x}",
+                    eglGetError());
+      return false;
+    }
+  }
+  SPDLOG_TRACE("-MakeCompositorCurrent()");
+  return true;
+}
+
+EGLSyncKHR Egl::CreateFence() {
+  EGLSyncKHR fence = EGL_NO_SYNC_KHR;
+  if (m_pfCreateSync) {
+    fence = m_pfCreateSync(m_dpy, EGL_SYNC_FENCE_KHR, nullptr);
+  }
+  if (fence == EGL_NO_SYNC_KHR) {
+    glFinish();
+    return EGL_NO_SYNC_KHR;
+  }
+  // a fence of another context only signals once its commands are flushed
+  glFlush();
+  return fence;
+}
+
+void Egl::WaitFence(EGLSyncKHR fence) {
+  if (fence == EGL_NO_SYNC_KHR) {
+    return;
+  }
+  if (m_pfWaitSync) {
+    // the GPU waits, this thread goes on
+    m_pfWaitSync(m_dpy, fence, 0);
+  } else {
+    m_pfClientWaitSync(m_dpy, fence, 0, EGL_FOREVER_KHR);
+  }
+  // deleted once no wait refers to it
+  m_pfDestroySync(m_dpy, fence);
+}
+
 bool Egl::HasEGLExtension(const char* extensions, const char* name) {
   const char* r = strstr(extensions, name);
 #if !defined(NDEBUG)
@@ -240,15 +302,19 @@ bool Egl::HasEGLExtension(const char* extensions, const char* name) {
   return r != nullptr && (r[len] == ' ' || r[len] == 0);
 }
 
-std::array<EGLint, 4> Egl::RectToInts(const FlutterRect rect) const {
+void Egl::RectsToInts(const FlutterRect* rects,
+                      const size_t count,
+                      EGLint* out) const {
   EGLint height;
   eglQuerySurface(m_dpy, m_egl_surface, EGL_HEIGHT, &height);
 
-  std::array<EGLint, 4> res{
-      static_cast<int>(rect.left), height - static_cast<int>(rect.bottom),
-      static_cast<int>(rect.right) - static_cast<int>(rect.left),
-      static_cast<int>(rect.bottom) - static_cast<int>(rect.top)};
-  return res;
+  for (size_t i = 0; i < count; i++) {
+    const auto& rect = rects[i];
+    *out++ = static_cast<int>(rect.left);
+    *out++ = height - static_cast<int>(rect.bottom);
+    *out++ = static_cast<int>(rect.right) - static_cast<int>(rect.left);
+    *out++ = static_cast<int>(rect.bottom) - static_cast<int>(rect.top);
+  }
 }
 
 // Print a list of extensions, with word-wrapping.
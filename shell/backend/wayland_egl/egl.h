@@ -80,6 +80,18 @@ class Egl {
    */
   bool MakeTextureCurrent();
 
+  /**
+   * @brief Attach the compositor context, which shares the textures of the
+   * raster context but not its GL state, to a window surface
+   * @param[in] surface Surface to draw to
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * wayland
+   */
+  bool MakeCompositorCurrent(EGLSurface surface);
+
   /**
    * @brief Create a new EGL window surface
    * @param[in] native_window The native window
@@ -126,26 +138,49 @@ class Egl {
   NODISCARD bool HasExtBufferAge() const { return m_has_egl_ext_buffer_age; }
 
   /**
-   * @brief Auxiliary function used to transform a FlutterRect into the format
+   * @brief Auxiliary function used to transform FlutterRects into the format
    * that is expected by the EGL functions
-   * @param[in] rect FlutterRect
-   * @return array of EGLint
-   * @retval if extension is present
+   * @param[in] rects FlutterRect array
+   * @param[in] count Number of rects
+   * @param[out] out Four EGLint per rect, x, y, width, height from the bottom
+   * left of the surface
+   * @return void
    * @relation
    * EGL
    */
-  NODISCARD std::array<EGLint, 4> RectToInts(FlutterRect rect) const;
+  void RectsToInts(const FlutterRect* rects, size_t count, EGLint* out) const;
 
   NODISCARD EGLDisplay GetDisplay() { return m_dpy; }
 
   NODISCARD EGLContext GetTextureContext() { return m_texture_context; }
 
+  /**
+   * @brief Fence the commands issued so far by the current context and
+   * flush them
+   * @return EGLSyncKHR
+   * @retval EGL_NO_SYNC_KHR No fence support, the commands are finished
+   * @relation
+   * EGL
+   */
+  EGLSyncKHR CreateFence();
+
+  /**
+   * @brief Order the commands of the current context after a fence, then
+   * delete the fence
+   * @param[in] fence Fence from CreateFence(), may be EGL_NO_SYNC_KHR
+   * @return void
+   * @relation
+   * EGL
+   */
+  void WaitFence(EGLSyncKHR fence);
+
  protected:
   EGLSurface m_egl_surface{};
 
  private:
   EGLConfig m_config{};
   EGLContext m_texture_context{};
+  EGLContext m_compositor_context{};
 
   int m_buffer_size{};
 
@@ -160,6 +195,12 @@ class Egl {
   PFNEGLSETDAMAGEREGIONKHRPROC m_pfSetDamageRegion{};
   bool m_has_egl_ext_buffer_age{};
 
+  // EGL_KHR_fence_sync, and EGL_KHR_wait_sync for waits on the GPU
+  PFNEGLCREATESYNCKHRPROC m_pfCreateSync{};
+  PFNEGLDESTROYSYNCKHRPROC m_pfDestroySync{};
+  PFNEGLCLIENTWAITSYNCKHRPROC m_pfClientWaitSync{};
+  PFNEGLWAITSYNCKHRPROC m_pfWaitSync{};
+
   /**
    * @brief Auxiliary function used to check if the given list of extensions
    * contains the requested extension name.
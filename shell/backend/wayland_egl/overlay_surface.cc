@@ -0,0 +1,73 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "overlay_surface.h"
+
+#include <wayland-egl.h>
+
+#include "egl.h"
+#include "wayland/display.h"
+
+OverlaySurface::OverlaySurface(const Display& display,
+                               Egl& egl,
+                               wl_surface* parent,
+                               const int32_t width,
+                               const int32_t height)
+    : m_egl_display(egl.GetDisplay()),
+      m_surface(wl_compositor_create_surface(display.GetCompositor())),
+      m_subsurface(wl_subcompositor_get_subsurface(display.GetSubCompositor(),
+                                                   m_surface,
+                                                   parent)),
+      m_egl_window(wl_egl_window_create(m_surface, width, height)),
+      m_egl_surface(egl.create_egl_surface(m_egl_window, nullptr)),
+      m_width(width),
+      m_height(height) {
+  // shown with the next frame of the window surface, never on its own
+  wl_subsurface_set_sync(m_subsurface);
+  // layers only draw, input goes to the window surface below
+  const auto region = wl_compositor_create_region(display.GetCompositor());
+  wl_surface_set_input_region(m_surface, region);
+  wl_region_destroy(region);
+}
+
+OverlaySurface::~OverlaySurface() {
+  if (m_egl_surface != EGL_NO_SURFACE) {
+    eglDestroySurface(m_egl_display, m_egl_surface);
+  }
+  wl_egl_window_destroy(m_egl_window);
+  wl_subsurface_destroy(m_subsurface);
+  wl_surface_destroy(m_surface);
+}
+
+bool OverlaySurface::SetGeometry(const int32_t x,
+                                 const int32_t y,
+                                 const int32_t width,
+                                 const int32_t height) {
+  bool changed = false;
+  if (x != m_x || y != m_y) {
+    wl_subsurface_set_position(m_subsurface, x, y);
+    m_x = x;
+    m_y = y;
+    changed = true;
+  }
+  if (width != m_width || height != m_height) {
+    wl_egl_window_resize(m_egl_window, width, height, 0, 0);
+    m_width = width;
+    m_height = height;
+    changed = true;
+  }
+  return changed;
+}
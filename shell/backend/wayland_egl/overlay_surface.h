@@ -0,0 +1,98 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <EGL/egl.h>
+#include <wayland-client.h>
+
+#include "config/common.h"
+
+class Display;
+
+class Egl;
+
+struct wl_egl_window;
+
+/**
+ * @brief Sub-surface showing one Flutter layer above the window surface.
+ *
+ * The sub-surface is synchronized, so what is drawn to it is shown together
+ * with the next commit of the window surface, and the Wayland compositor
+ * blends it with the layers and platform views below.
+ *
+ * Overlays are stacked above every platform view sub-surface: plugins do not
+ * hand their surfaces to the embedder, so an overlay cannot be placed between
+ * two platform views.  Only one platform view per window is supported.
+ */
+class OverlaySurface {
+ public:
+  /**
+   * @brief Create a sub-surface of parent with its own EGL window surface
+   * @param[in] display Wayland display
+   * @param[in] egl EGL of the backend, creates the window surface
+   * @param[in] parent Window surface
+   * @param[in] width Initial width
+   * @param[in] height Initial height
+   * @relation
+   * wayland
+   */
+  OverlaySurface(const Display& display,
+                 Egl& egl,
+                 wl_surface* parent,
+                 int32_t width,
+                 int32_t height);
+
+  ~OverlaySurface();
+
+  OverlaySurface(const OverlaySurface&) = delete;
+  OverlaySurface& operator=(const OverlaySurface&) = delete;
+
+  /**
+   * @brief Move and resize the sub-surface, only changes are sent
+   * @param[in] x Offset from the window surface
+   * @param[in] y Offset from the window surface
+   * @param[in] width Layer width
+   * @param[in] height Layer height
+   * @return bool
+   * @retval true Anything changed, the window surface needs a commit
+   * @retval false Nothing changed
+   * @relation
+   * wayland
+   */
+  bool SetGeometry(int32_t x, int32_t y, int32_t width, int32_t height);
+
+  NODISCARD wl_surface* GetSurface() const { return m_surface; }
+
+  NODISCARD EGLSurface GetEglSurface() const { return m_egl_surface; }
+
+  NODISCARD int32_t GetWidth() const { return m_width; }
+
+  NODISCARD int32_t GetHeight() const { return m_height; }
+
+ private:
+  EGLDisplay m_egl_display;
+  wl_surface* m_surface;
+  wl_subsurface* m_subsurface;
+  wl_egl_window* m_egl_window;
+  EGLSurface m_egl_surface;
+  int32_t m_x{};
+  int32_t m_y{};
+  int32_t m_width;
+  int32_t m_height;
+};
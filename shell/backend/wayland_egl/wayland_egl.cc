@@ -16,33 +16,99 @@
 
 #include "wayland_egl.h"
 
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+#include <GLES2/gl2ext.h>
 #include <wayland-egl.h>
 
 #include "../gl_process_resolver.h"
 #include "egl.h"
 #include "engine.h"
+#include "trace.h"
 #include "shell/platform/homescreen/flutter_desktop_engine_state.h"
+#include "shell/platform/homescreen/pixel_buffer_texture.h"
+#include "wayland/display.h"
 
 struct FlutterDesktopEngineState;
 
-WaylandEglBackend::WaylandEglBackend(struct wl_display* display,
+namespace {
+
+constexpr char kBlitVertexShader[] = R"(
+attribute vec2 position;
+varying vec2 uv;
+void main() {
+  uv = position * 0.5 + 0.5;
+  gl_Position = vec4(position, 0.0, 1.0);
+})";
+
+constexpr char kBlitFragmentShader[] = R"(
+precision mediump float;
+uniform sampler2D layer;
+varying vec2 uv;
+void main() {
+  gl_FragColor = texture2D(layer, uv);
+})";
+
+constexpr GLfloat kBlitQuad[] = {-1, -1, 1, -1, -1, 1, 1, 1};
+
+GLuint CompileShader(const GLenum type, const char* source) {
+  const auto shader = glCreateShader(type);
+  glShaderSource(shader, 1, &source, nullptr);
+  glCompileShader(shader);
+  GLint compiled = GL_FALSE;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+  if (!compiled) {
+    std::array<GLchar, 512> log{};
+    glGetShaderInfoLog(shader, static_cast<GLsizei>(log.size()), nullptr,
+                       log.data());
+    spdlog::error("Layer compositor shader: {}", log.data());
+    glDeleteShader(shader);
+    return 0;
+  }
+  return shader;
+}
+
+}  // namespace
+
+WaylandEglBackend::WaylandEglBackend(std::shared_ptr<Display> display,
                                      const uint32_t initial_width,
                                      const uint32_t initial_height,
                                      const bool debug_backend,
-                                     const int buffer_size)
-    : Egl(display, buffer_size, debug_backend),
+                                     const int buffer_size,
+                                     const bool layer_compositor)
+    : Egl(display->GetDisplay(), buffer_size, debug_backend),
       Backend(),
+      m_display(std::move(display)),
+      m_layer_compositor(layer_compositor),
+      m_backing_store_pool(kMaxPooledBackingStoreBytes,
+                           kBackingStoreIdleFrames,
+                           [](std::unique_ptr<BackingTexture>& texture) {
+                             // a context sharing the textures is current
+                             glDeleteTextures(1, &texture->name);
+                           }),
       m_initial_width(initial_width),
       m_initial_height(initial_height) {}
 
+WaylandEglBackend::~WaylandEglBackend() {
+  // the engine is shut down, its textures are all collected
+  MakeTextureCurrent();
+  m_backing_store_pool.Clear();
+  ClearCurrent();
+  m_overlays.clear();
+}
+
 FlutterRendererConfig WaylandEglBackend::GetRenderConfig() {
   return {
       .type = kOpenGL,
       .open_gl = {
           .struct_size = sizeof(FlutterOpenGLRendererConfig),
           .make_current = [](void* user_data) -> bool {
+            TRACE_SCOPE("WaylandEglBackend::MakeCurrent");
             const auto state =
                 static_cast<FlutterDesktopEngineState*>(user_data);
+            state->view_controller->engine->OnRasterStart();
             return reinterpret_cast<WaylandEglBackend*>(
                        state->view_controller->engine->GetBackend())
                 ->MakeCurrent();
@@ -75,14 +141,17 @@ FlutterRendererConfig WaylandEglBackend::GetRenderConfig() {
                  FlutterOpenGLTexture* texture_out) -> bool {
             const auto state =
                 static_cast<FlutterDesktopEngineState*>(userdata);
-            auto& texture_registry = state->texture_registrar->texture_registry;
-            auto it = std::find_if(
-                std::begin(texture_registry), std::end(texture_registry),
-                [&texture_id](auto&& p) { return p.first == texture_id; });
+            // wait free, registration never blocks a frame
+            const TextureRegistry::Reader reader(
+                state->texture_registrar->texture_registry);
+            const auto target = reader.Find(texture_id);
             // texture not found in registry
-            if (it == std::end(texture_registry))
+            if (target == nullptr)
               return false;
-            auto& target = texture_registry[texture_id];
+            if (target->pixel_buffer) {
+              return target->pixel_buffer->Populate(width, height,
+                                                    texture_out);
+            }
             *texture_out = {.target = target->target,
                             .name = target->name,
                             .format = target->format,
@@ -90,12 +159,11 @@ FlutterRendererConfig WaylandEglBackend::GetRenderConfig() {
                             .destruction_callback = target->release_callback,
                             .width = target->width,
                             .height = target->height};
-            target->visible_width = width;
-            target->visible_width = height;
             return true;
           },
           .present_with_info = [](void* userdata,
                                   const FlutterPresentInfo* info) -> bool {
+            TRACE_SCOPE("WaylandEglBackend::Present");
             const auto state =
                 static_cast<FlutterDesktopEngineState*>(userdata);
             auto* b = reinterpret_cast<WaylandEglBackend*>(
@@ -103,35 +171,42 @@ FlutterRendererConfig WaylandEglBackend::GetRenderConfig() {
 
             // Full swap if FlutterPresentInfo is invalid
             if (info->struct_size != sizeof(FlutterPresentInfo)) {
+              state->view_controller->engine->OnFramePresented(
+                  uint64_t{b->m_initial_width} * b->m_initial_height);
               return b->SwapBuffers();
             }
 
-            // Free the existing damage that was allocated to this frame.
-            if (b->m_existing_damage_map[info->fbo_id] != nullptr) {
-              free(b->m_existing_damage_map[info->fbo_id]);
-              b->m_existing_damage_map[info->fbo_id] = nullptr;
-            }
+            const DamageRegion frame_damage(info->frame_damage);
+
+            // closes the input latency of the events this frame consumed
+            state->view_controller->engine->OnFramePresented(
+                static_cast<uint64_t>(frame_damage.Area()));
 
             if (b->GetSetDamageRegion()) {
               // Set the buffer damage as the damage region.
-              auto buffer_rects = b->RectToInts(info->buffer_damage.damage[0]);
-              b->GetSetDamageRegion()(b->GetDisplay(), b->m_egl_surface,
-                                      buffer_rects.data(), 1);
+              const DamageRegion buffer_damage(info->buffer_damage);
+              // no rects would damage the whole surface, pass one empty rect
+              b->m_damage_rects.fill(0);
+              b->RectsToInts(buffer_damage.data(), buffer_damage.size(),
+                             b->m_damage_rects.data());
+              b->GetSetDamageRegion()(
+                  b->GetDisplay(), b->m_egl_surface, b->m_damage_rects.data(),
+                  static_cast<EGLint>(
+                      std::max(buffer_damage.size(), size_t{1})));
             }
 
             // Add frame damage to damage history
-            b->m_damage_history.push_back(info->frame_damage.damage[0]);
-            if (b->m_damage_history.size() > kMaxHistorySize) {
-              b->m_damage_history.pop_front();
-            }
+            b->m_damage_history.Push(frame_damage);
 
             if (b->GetSwapBuffersWithDamage()) {
               // Swap buffers with frame damage.
-              const auto frame_rects =
-                  b->RectToInts(info->frame_damage.damage[0]);
+              b->m_damage_rects.fill(0);
+              b->RectsToInts(frame_damage.data(), frame_damage.size(),
+                             b->m_damage_rects.data());
               return b->GetSwapBuffersWithDamage()(
-                  b->GetDisplay(), b->m_egl_surface,
-                  const_cast<int*>(frame_rects.data()), 1);
+                  b->GetDisplay(), b->m_egl_surface, b->m_damage_rects.data(),
+                  static_cast<EGLint>(
+                      std::max(frame_damage.size(), size_t{1})));
             } else {
               // If the required extensions for partial repaint were not
               // provided, do full repaint.
@@ -156,42 +231,317 @@ FlutterRendererConfig WaylandEglBackend::GetRenderConfig() {
                         // length > 4.
             }
 
-            existing_damage->num_rects = 1;
-
-            // Allocate the array of rectangles for the existing damage.
-            b->m_existing_damage_map[fbo_id] = static_cast<FlutterRect*>(
-                malloc(sizeof(FlutterRect) * existing_damage->num_rects));
-            b->m_existing_damage_map[fbo_id][0] =
-                FlutterRect{0, 0, static_cast<double>(b->m_initial_width),
-                            static_cast<double>(b->m_initial_height)};
-            existing_damage->damage = b->m_existing_damage_map[fbo_id];
-
-            if (age > 1) {
-              --age;
-              // join up to (age - 1) last rects from damage history
-              for (auto i = b->m_damage_history.rbegin();
-                   i != b->m_damage_history.rend() && age > 0; ++i, --age) {
-                if (i == b->m_damage_history.rbegin()) {
-                  if (i != b->m_damage_history.rend()) {
-                    existing_damage->damage[0] = {i->left, i->top, i->right,
-                                                  i->bottom};
-                  }
-                } else {
-                  JoinFlutterRect(&(existing_damage->damage[0]), *i);
-                }
-              }
+            auto& region = b->m_existing_damage_map[fbo_id];
+            if (!b->m_damage_history.Accumulate(age, &region)) {
+              region.Add(
+                  FlutterRect{0, 0, static_cast<double>(b->m_initial_width),
+                              static_cast<double>(b->m_initial_height)});
             }
+            region.Export(existing_damage);
           },
       }};
 }
 
 FlutterCompositor WaylandEglBackend::GetCompositorConfig() {
+  if (!m_layer_compositor) {
+    return {.struct_size = sizeof(FlutterCompositor),
+            .user_data = this,
+            .create_backing_store_callback = nullptr,
+            .collect_backing_store_callback = nullptr,
+            .present_layers_callback = nullptr,
+            .avoid_backing_store_cache = true};
+  }
+  // the engine keeps the backing stores of unchanged layers across frames,
+  // and reports whether each was rendered to
   return {.struct_size = sizeof(FlutterCompositor),
           .user_data = this,
-          .create_backing_store_callback = nullptr,
-          .collect_backing_store_callback = nullptr,
-          .present_layers_callback = nullptr,
-          .avoid_backing_store_cache = true};
+          .create_backing_store_callback = CreateBackingStore,
+          .collect_backing_store_callback = CollectBackingStore,
+          .present_layers_callback = PresentLayers,
+          .avoid_backing_store_cache = false};
+}
+
+bool WaylandEglBackend::CreateBackingStore(
+    const FlutterBackingStoreConfig* config,
+    FlutterBackingStore* backing_store_out,
+    void* user_data) {
+  TRACE_SCOPE("WaylandEglBackend::CreateBackingStore");
+  const auto state = static_cast<FlutterDesktopEngineState*>(user_data);
+  state->view_controller->engine->OnRasterStart();
+  const auto b = reinterpret_cast<WaylandEglBackend*>(
+      state->view_controller->engine->GetBackend());
+
+  const BackingStorePool<std::unique_ptr<BackingTexture>>::Key key{
+      static_cast<uint32_t>(std::ceil(config->size.width)),
+      static_cast<uint32_t>(std::ceil(config->size.height)), GL_RGBA8_OES};
+  std::unique_ptr<BackingTexture> texture;
+  if (auto pooled = b->m_backing_store_pool.Acquire(key)) {
+    texture = std::move(*pooled);
+  } else {
+    // the raster context is current
+    texture = std::make_unique<BackingTexture>();
+    texture->backend = b;
+    texture->key = key;
+    texture->bytes = size_t{key.width} * key.height * 4;
+    glGenTextures(1, &texture->name);
+    glBindTexture(GL_TEXTURE_2D, texture->name);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(key.width),
+                 static_cast<GLsizei>(key.height), 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (glGetError() != GL_NO_ERROR) {
+      spdlog::error("Failed to create a {}x{} backing store", key.width,
+                    key.height);
+      glDeleteTextures(1, &texture->name);
+      return false;
+    }
+    b->m_backing_store_pool.Created(texture->bytes);
+    const auto stats = b->m_backing_store_pool.GetStats();
+    spdlog::debug("EGL backing store {}x{}: {} KiB live, {} KiB pooled",
+                  key.width, key.height, stats.live_bytes >> 10,
+                  stats.pooled_bytes >> 10);
+  }
+
+  backing_store_out->type = kFlutterBackingStoreTypeOpenGL;
+  backing_store_out->user_data = texture.get();
+  backing_store_out->open_gl.type = kFlutterOpenGLTargetTypeTexture;
+  backing_store_out->open_gl.texture = {
+      .target = GL_TEXTURE_2D,
+      .name = texture->name,
+      .format = GL_RGBA8_OES,
+      .user_data = texture.get(),
+      // returned to the pool by CollectBackingStore
+      .destruction_callback = [](void* /* user_data */) {},
+      .width = key.width,
+      .height = key.height,
+  };
+  texture.release();
+  return true;
+}
+
+bool WaylandEglBackend::CollectBackingStore(const FlutterBackingStore* renderer,
+                                            void* /* user_data */) {
+  TRACE_SCOPE("WaylandEglBackend::CollectBackingStore");
+  const auto texture = static_cast<BackingTexture*>(renderer->user_data);
+  const auto b = texture->backend;
+  const auto bytes = texture->bytes;
+  b->m_backing_store_pool.Release(
+      texture->key, std::unique_ptr<BackingTexture>(texture), bytes);
+  return true;
+}
+
+bool WaylandEglBackend::PresentLayers(const FlutterLayer** layers,
+                                      const size_t layers_count,
+                                      void* user_data) {
+  TRACE_SCOPE("WaylandEglBackend::PresentLayers");
+  const auto state = static_cast<FlutterDesktopEngineState*>(user_data);
+  const auto b = reinterpret_cast<WaylandEglBackend*>(
+      state->view_controller->engine->GetBackend());
+  uint64_t area = 0;
+  const auto ret = b->Composite(layers, layers_count, &area);
+  // closes the input latency of the events this frame consumed
+  state->view_controller->engine->OnFramePresented(area);
+  b->m_backing_store_pool.EndFrame();
+  return ret;
+}
+
+bool WaylandEglBackend::Composite(const FlutterLayer** layers,
+                                  const size_t layers_count,
+                                  uint64_t* area) {
+  m_overlay_draws.clear();
+  std::optional<Draw> window_draw;
+  bool commit = false;
+
+  // A platform view creates its sub-surface on top of the others; recreate
+  // the overlays so that they are stacked above it again.  The surfaces of
+  // platform views are not known here, so with more than one the overlays
+  // end up above all of them.
+  m_frame_platform_views.clear();
+  for (size_t i = 0; i < layers_count; i++) {
+    if (layers[i]->type == kFlutterLayerContentTypePlatformView) {
+      const auto id = layers[i]->platform_view->identifier;
+      m_frame_platform_views.insert(id);
+      if (m_platform_views.count(id) == 0) {
+        m_overlays.clear();
+      }
+    }
+  }
+  if (m_frame_platform_views.size() > 1 &&
+      m_frame_platform_views.size() > m_platform_views.size()) {
+    spdlog::warn("Composite: {} platform views, layers between them are shown "
+                 "above all of them",
+                 m_frame_platform_views.size());
+  }
+  // both sets keep their buckets from frame to frame
+  m_platform_views.swap(m_frame_platform_views);
+
+  // The bottom Flutter layer is drawn on the window surface, every later one
+  // on a sub-surface of its own.  Platform views draw their own sub-surfaces,
+  // and the Wayland compositor blends them all.
+  size_t overlay_count = 0;
+  for (size_t i = 0; i < layers_count; i++) {
+    const auto layer = layers[i];
+    if (layer->type != kFlutterLayerContentTypeBackingStore) {
+      continue;
+    }
+    const auto texture =
+        static_cast<const BackingTexture*>(layer->backing_store->user_data);
+    const auto x = static_cast<int32_t>(layer->offset.x);
+    const auto y = static_cast<int32_t>(layer->offset.y);
+    const auto width = static_cast<int32_t>(texture->key.width);
+    const auto height = static_cast<int32_t>(texture->key.height);
+
+    if (i == 0) {
+      // unchanged layers stay on screen as they were last committed
+      if (layer->backing_store->did_update || m_window_cleared ||
+          layer->offset.x != m_window_layer_offset.x ||
+          layer->offset.y != m_window_layer_offset.y) {
+        window_draw = Draw{m_egl_surface, texture->name, x, y, width, height,
+                           static_cast<int32_t>(m_initial_height)};
+      }
+      m_window_cleared = false;
+      m_window_layer_offset = layer->offset;
+      continue;
+    }
+
+    if (overlay_count == m_overlays.size()) {
+      // a new sub-surface is stacked on top of its siblings
+      m_overlays.emplace_back(std::make_unique<OverlaySurface>(
+          *m_display, *this, m_surface, width, height));
+      m_overlays.back()->SetGeometry(x, y, width, height);
+      commit = true;
+    } else if (m_overlays[overlay_count]->SetGeometry(x, y, width, height)) {
+      commit = true;
+    } else if (!layer->backing_store->did_update) {
+      overlay_count++;
+      continue;
+    }
+    m_overlay_draws.push_back({m_overlays[overlay_count]->GetEglSurface(),
+                             texture->name, 0, 0, width, height, height});
+    overlay_count++;
+  }
+  if (overlay_count < m_overlays.size()) {
+    m_overlays.resize(overlay_count);
+    commit = true;
+  }
+  if ((layers_count == 0 ||
+       layers[0]->type != kFlutterLayerContentTypeBackingStore) &&
+      !m_window_cleared) {
+    // the bottom layer is a platform view, nothing is drawn below it
+    window_draw = Draw{m_egl_surface,
+                       0,
+                       0,
+                       0,
+                       0,
+                       0,
+                       static_cast<int32_t>(m_initial_height)};
+    m_window_cleared = true;
+  }
+
+  if (m_overlay_draws.empty() && !window_draw) {
+    if (commit) {
+      // sub-surface changes apply with the next commit of the parent
+      wl_surface_commit(m_surface);
+      // eglSwapBuffers flushes, a bare commit waits for the main loop
+      wl_display_flush(m_display->GetDisplay());
+    }
+    return true;
+  }
+
+  // the compositor context reads what the raster context rendered; the
+  // wait is queued on the GPU where supported, neither thread blocks
+  const auto fence = CreateFence();
+  MakeCompositorCurrent(m_overlay_draws.empty()
+                            ? window_draw->surface
+                            : m_overlay_draws.front().surface);
+  WaitFence(fence);
+  bool ret = true;
+  for (const auto& draw : m_overlay_draws) {
+    ret &= DrawLayer(draw.surface, draw.texture, draw.x, draw.y, draw.width,
+                     draw.height, draw.surface_height);
+    *area += uint64_t{static_cast<uint32_t>(draw.width)} *
+             static_cast<uint32_t>(draw.height);
+  }
+  // the window surface last: its commit shows the sub-surfaces too
+  if (window_draw) {
+    ret &= DrawLayer(window_draw->surface, window_draw->texture,
+                     window_draw->x, window_draw->y, window_draw->width,
+                     window_draw->height, window_draw->surface_height);
+    *area += uint64_t{static_cast<uint32_t>(window_draw->width)} *
+             static_cast<uint32_t>(window_draw->height);
+  } else {
+    wl_surface_commit(m_surface);
+    wl_display_flush(m_display->GetDisplay());
+  }
+  MakeCurrent();
+  return ret;
+}
+
+bool WaylandEglBackend::DrawLayer(EGLSurface surface,
+                                  const GLuint texture,
+                                  const int32_t x,
+                                  const int32_t y,
+                                  const int32_t width,
+                                  const int32_t height,
+                                  const int32_t surface_height) {
+  if (!MakeCompositorCurrent(surface)) {
+    return false;
+  }
+  if (!m_blit_program && !CreateBlitProgram()) {
+    return false;
+  }
+  glClearColor(0, 0, 0, 0);
+  glClear(GL_COLOR_BUFFER_BIT);
+  if (texture) {
+    // GL puts the origin at the bottom left
+    glViewport(x, surface_height - y - height, width, height);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  }
+  if (surface != m_egl_surface) {
+    // sub-surfaces are paced by the window surface
+    eglSwapInterval(GetDisplay(), 0);
+  }
+  return eglSwapBuffers(GetDisplay(), surface) == EGL_TRUE;
+}
+
+bool WaylandEglBackend::CreateBlitProgram() {
+  const auto vertex = CompileShader(GL_VERTEX_SHADER, kBlitVertexShader);
+  const auto fragment =
+      CompileShader(GL_FRAGMENT_SHADER, kBlitFragmentShader);
+  if (!vertex || !fragment) {
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    return false;
+  }
+  const auto program = glCreateProgram();
+  glAttachShader(program, vertex);
+  glAttachShader(program, fragment);
+  glLinkProgram(program);
+  glDeleteShader(vertex);
+  glDeleteShader(fragment);
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (!linked) {
+    spdlog::error("Layer compositor program failed to link");
+    glDeleteProgram(program);
+    return false;
+  }
+
+  // the compositor context only ever draws layers, its state is set once
+  m_blit_position = glGetAttribLocation(program, "position");
+  glUseProgram(program);
+  glVertexAttribPointer(static_cast<GLuint>(m_blit_position), 2, GL_FLOAT,
+                        GL_FALSE, 0, kBlitQuad);
+  glEnableVertexAttribArray(static_cast<GLuint>(m_blit_position));
+  glActiveTexture(GL_TEXTURE0);
+  glDisable(GL_BLEND);
+  m_blit_program = program;
+  return true;
 }
 
 void WaylandEglBackend::Resize(size_t /* index */,
@@ -216,6 +566,7 @@ void WaylandEglBackend::CreateSurface(size_t /* index */,
                                       int32_t width,
                                       int32_t height) {
   UpdateSize(width, height);
+  m_surface = surface;
   m_egl_window = wl_egl_window_create(surface, width, height);
   m_egl_surface = create_egl_surface(m_egl_window, nullptr);
 }
@@ -292,11 +643,3 @@ bool WaylandEglBackend::TextureMakeCurrent() {
 bool WaylandEglBackend::TextureClearCurrent() {
   return ClearCurrent();
 }
-
-void WaylandEglBackend::JoinFlutterRect(FlutterRect* rect,
-                                        const FlutterRect& additional_rect) {
-  rect->left = std::min(rect->left, additional_rect.left);
-  rect->top = std::min(rect->top, additional_rect.top);
-  rect->right = std::max(rect->right, additional_rect.right);
-  rect->bottom = std::max(rect->bottom, additional_rect.bottom);
-}
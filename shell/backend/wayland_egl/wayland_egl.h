@@ -16,31 +16,56 @@
 
 #pragma once
 
-#include <list>
+#include <array>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include <GLES2/gl2.h>
 #include <wayland-egl.h>
 
 #include "config/common.h"
 
 #include "backend/backend.h"
+#include "backend/backing_store_pool.h"
+#include "backend/damage_region.h"
 #include "egl.h"
+#include "overlay_surface.h"
 
 class Backend;
 
+class Display;
+
 class Engine;
 
 class WaylandEglBackend : public Egl, public Backend {
  public:
-  // Maximum damage history - for triple buffering we need to store damage for
-  // last two frames.
-  static constexpr int kMaxHistorySize = 10;
+  /// free backing store textures kept for reuse
+  static constexpr size_t kMaxPooledBackingStoreBytes = 64 << 20;
+  /// frames a free backing store texture survives without being reused
+  static constexpr uint32_t kBackingStoreIdleFrames = 120;
 
-  WaylandEglBackend(struct wl_display* display,
+  /**
+   * @brief Create the EGL contexts
+   * @param[in] display Wayland display
+   * @param[in] initial_width Window width
+   * @param[in] initial_height Window height
+   * @param[in] debug_backend Report the EGL configuration
+   * @param[in] buffer_size EGL buffer size
+   * @param[in] layer_compositor Present each Flutter layer above a platform
+   * view on a sub-surface of its own
+   * @relation
+   * wayland
+   */
+  WaylandEglBackend(std::shared_ptr<Display> display,
                     uint32_t initial_width,
                     uint32_t initial_height,
                     bool debug_backend,
-                    int buffer_size = kEglBufferSize);
+                    int buffer_size = kEglBufferSize,
+                    bool layer_compositor = false);
+
+  ~WaylandEglBackend();
 
   /**
    * @brief Resize Flutter engine Window size
@@ -88,7 +113,7 @@ class WaylandEglBackend : public Egl, public Backend {
   /**
    * @brief Get FlutterCompositor
    * @return FlutterCompositor
-   * @retval Pointer to FlutterCompositor
+   * @retval Layer compositor if enabled, else no callbacks
    * @relation
    * wayland
    */
@@ -100,24 +125,148 @@ class WaylandEglBackend : public Egl, public Backend {
   }
 
  private:
+  /// a layer texture drawn to a surface by the compositor context
+  struct Draw {
+    EGLSurface surface;
+    GLuint texture;
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    int32_t surface_height;
+  };
+
+  /// texture the engine renders a layer into, shared with the compositor
+  /// context
+  struct BackingTexture {
+    WaylandEglBackend* backend{};
+    BackingStorePool<std::unique_ptr<BackingTexture>>::Key key{};
+    GLuint name{};
+    size_t bytes{};
+  };
+
+  std::shared_ptr<Display> m_display;
+  bool m_layer_compositor;
+  wl_surface* m_surface{};
   struct wl_egl_window* m_egl_window{};
+
+  // raster thread only
+  BackingStorePool<std::unique_ptr<BackingTexture>> m_backing_store_pool;
+  /// sub-surfaces of the Flutter layers above the first, bottom first
+  std::vector<std::unique_ptr<OverlaySurface>> m_overlays;
+  /// platform views of the previous frame
+  std::unordered_set<FlutterPlatformViewIdentifier> m_platform_views;
+  /// per frame, cleared and refilled by Composite()
+  std::unordered_set<FlutterPlatformViewIdentifier> m_frame_platform_views;
+  std::vector<Draw> m_overlay_draws;
+  /// the window surface shows no layer
+  bool m_window_cleared{};
+  FlutterPoint m_window_layer_offset{};
+  GLuint m_blit_program{};
+  GLint m_blit_position{};
   uint32_t m_initial_width;
   uint32_t m_initial_height;
 
-  // Keeps track of the existing damage associated with each FBO ID
-  std::unordered_map<intptr_t, FlutterRect*> m_existing_damage_map;
+  // Keeps track of the existing damage associated with each FBO ID, the
+  // engine reads it until the frame is presented
+  std::unordered_map<intptr_t, DamageRegion> m_existing_damage_map;
 
   // Keeps track of the most recent frame damages so that existing damage can
   // be easily computed.
-  std::list<FlutterRect> m_damage_history{};
+  DamageHistory m_damage_history{};
+
+  // EGL rects of the frame being presented
+  std::array<EGLint, DamageRegion::kMaxRects * 4> m_damage_rects{};
 
   /**
-   * @brief Auxiliary function to union the damage regions comprised by two
-   * FlutterRect element. It saves the result of this join in the rect variable.
-   * @return void
+   * @brief Hand the layers of a frame to the Wayland compositor
+   * @param[in] layers Layers, bottom first
+   * @param[in] layers_count Number of layers
+   * @param[out] area Pixels drawn
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * wayland
+   */
+  bool Composite(const FlutterLayer** layers,
+                 size_t layers_count,
+                 uint64_t* area);
+
+  /**
+   * @brief Draw a layer texture to a surface with the compositor context
+   * and swap it
+   * @param[in] surface Window or sub-surface
+   * @param[in] texture Layer texture, 0 to clear the surface
+   * @param[in] x Layer offset in the surface
+   * @param[in] y Layer offset in the surface
+   * @param[in] width Texture width
+   * @param[in] height Texture height
+   * @param[in] surface_height Surface height
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
    * @relation
    * wayland
    */
-  static void JoinFlutterRect(FlutterRect* rect,
-                              const FlutterRect& additional_rect);
+  bool DrawLayer(EGLSurface surface,
+                 GLuint texture,
+                 int32_t x,
+                 int32_t y,
+                 int32_t width,
+                 int32_t height,
+                 int32_t surface_height);
+
+  /**
+   * @brief Compile the program drawing layer textures, compositor context
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * wayland
+   */
+  bool CreateBlitProgram();
+
+  /**
+   * @brief Callback to hand out a pooled or new backing store texture
+   * @param[in] config Size of the backing store
+   * @param[out] backing_store_out Backing store
+   * @param[in] user_data Pointer to FlutterDesktopEngineState
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * flutter
+   */
+  static bool CreateBackingStore(const FlutterBackingStoreConfig* config,
+                                 FlutterBackingStore* backing_store_out,
+                                 void* user_data);
+
+  /**
+   * @brief Callback to return a backing store texture to the pool
+   * @param[in] renderer Backing store collected by the engine
+   * @param[in] user_data Pointer to FlutterDesktopEngineState
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * flutter
+   */
+  static bool CollectBackingStore(const FlutterBackingStore* renderer,
+                                  void* user_data);
+
+  /**
+   * @brief Callback to present the layers of a frame
+   * @param[in] layers Layers, bottom first
+   * @param[in] layers_count Number of layers
+   * @param[in] user_data Pointer to FlutterDesktopEngineState
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * flutter
+   */
+  static bool PresentLayers(const FlutterLayer** layers,
+                            size_t layers_count,
+                            void* user_data);
 };
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shm_rows.h"
+
+#include <algorithm>
+#include <cstring>
+
+void ShmRows::Diff(const uint8_t* frame,
+                   uint8_t* shadow,
+                   const size_t stride,
+                   const uint32_t width,
+                   const uint32_t height,
+                   DamageRegion* damage) {
+  damage->Clear();
+  const size_t row_size = size_t{width} * kBytesPerPixel;
+  uint32_t band_top = 0;
+  bool in_band = false;
+  for (uint32_t y = 0; y <= height; y++) {
+    const auto offset = size_t{y} * stride;
+    const bool dirty =
+        y < height &&
+        std::memcmp(frame + offset, shadow + offset, row_size) != 0;
+    if (dirty) {
+      std::memcpy(shadow + offset, frame + offset, row_size);
+      if (!in_band) {
+        band_top = y;
+        in_band = true;
+      }
+    } else if (in_band) {
+      damage->Add(FlutterRect{0, static_cast<double>(band_top),
+                              static_cast<double>(width),
+                              static_cast<double>(y)});
+      in_band = false;
+    }
+  }
+}
+
+void ShmRows::Copy(const uint8_t* src,
+                   const size_t src_stride,
+                   uint8_t* dst,
+                   const size_t dst_stride,
+                   const uint32_t width,
+                   const uint32_t height,
+                   const DamageRegion& damage,
+                   const Conversion conversion) {
+  for (size_t i = 0; i < damage.size(); i++) {
+    const auto top = static_cast<uint32_t>(std::max(0.0, damage[i].top));
+    const auto bottom = static_cast<uint32_t>(
+        std::min(static_cast<double>(height), damage[i].bottom));
+    for (uint32_t y = top; y < bottom; y++) {
+      ConvertRow(src + size_t{y} * src_stride, dst + size_t{y} * dst_stride,
+                 width, conversion);
+    }
+  }
+}
+
+void ShmRows::ConvertRow(const uint8_t* __restrict src,
+                         uint8_t* __restrict dst,
+                         const uint32_t width,
+                         const Conversion conversion) {
+  if (conversion == kCopy) {
+    std::memcpy(dst, src, size_t{width} * kBytesPerPixel);
+    return;
+  }
+  // swap red and blue, one whole pixel per step
+  for (size_t x = 0; x < size_t{width} * kBytesPerPixel; x += kBytesPerPixel) {
+    dst[x] = src[x + 2];
+    dst[x + 1] = src[x + 1];
+    dst[x + 2] = src[x];
+    dst[x + 3] = src[x + 3];
+  }
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../damage_region.h"
+
+/**
+ * @brief Row level damage and pixel copies between software frames and
+ * wl_shm buffers.
+ *
+ * All frames are 32 bits per pixel, top row first.  Damage is made of full
+ * width row bands, so copying it never splits a row.
+ */
+class ShmRows {
+ public:
+  static constexpr size_t kBytesPerPixel = 4;
+
+  enum Conversion {
+    /// source and buffer share the byte order
+    kCopy,
+    /// swap the bytes 0 and 2 of every pixel, RGBA <-> BGRA
+    kSwapRedBlue,
+  };
+
+  /**
+   * @brief Find the rows of frame that differ from shadow and update them
+   * @param[in] frame New frame
+   * @param[in,out] shadow Previous frame, made equal to frame
+   * @param[in] stride Bytes per row of both
+   * @param[in] width Frame width
+   * @param[in] height Frame height
+   * @param[out] damage Bands of changed rows
+   * @return void
+   * @relation
+   * flutter
+   */
+  static void Diff(const uint8_t* frame,
+                   uint8_t* shadow,
+                   size_t stride,
+                   uint32_t width,
+                   uint32_t height,
+                   DamageRegion* damage);
+
+  /**
+   * @brief Copy the rows of damage from src to dst
+   * @param[in] src Source frame
+   * @param[in] src_stride Bytes per source row
+   * @param[out] dst Destination buffer
+   * @param[in] dst_stride Bytes per destination row
+   * @param[in] width Frame width
+   * @param[in] height Frame height, rows past it are ignored
+   * @param[in] damage Row bands to copy
+   * @param[in] conversion Pixel conversion
+   * @return void
+   * @relation
+   * wayland
+   */
+  static void Copy(const uint8_t* src,
+                   size_t src_stride,
+                   uint8_t* dst,
+                   size_t dst_stride,
+                   uint32_t width,
+                   uint32_t height,
+                   const DamageRegion& damage,
+                   Conversion conversion);
+
+  /**
+   * @brief Convert one row of pixels
+   * @param[in] src Source pixels
+   * @param[out] dst Destination pixels, must not overlap src
+   * @param[in] width Pixels in the row
+   * @param[in] conversion Pixel conversion
+   * @return void
+   * @relation
+   * wayland
+   */
+  static void ConvertRow(const uint8_t* src,
+                         uint8_t* dst,
+                         uint32_t width,
+                         Conversion conversion);
+};
@@ -0,0 +1,321 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "wayland_software.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "engine.h"
+#include "libflutter_engine.h"
+#include "logging/logging.h"
+#include "shell/platform/homescreen/flutter_desktop_engine_state.h"
+#include "trace.h"
+#include "wayland/display.h"
+
+namespace {
+
+/// kFlutterSoftwarePixelFormatNative32 is BGRA on little endian CPUs
+constexpr bool kSourceIsBgra = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+}  // namespace
+
+WaylandSoftwareBackend::WaylandSoftwareBackend(std::shared_ptr<Display> display,
+                                               const uint32_t width,
+                                               const uint32_t height,
+                                               const bool /* debug_backend */)
+    : Backend(),
+      m_display(std::move(display)),
+      m_width(width),
+      m_height(height) {}
+
+WaylandSoftwareBackend::~WaylandSoftwareBackend() {
+  DestroyBuffers();
+}
+
+void WaylandSoftwareBackend::Resize(size_t /* index */,
+                                    Engine* engine,
+                                    const int32_t width,
+                                    const int32_t height) {
+  m_width = static_cast<uint32_t>(width);
+  m_height = static_cast<uint32_t>(height);
+  // buffers follow the size of the frames, not of the window
+  if (engine) {
+    if (engine->SetWindowSize(static_cast<size_t>(m_height),
+                              static_cast<size_t>(m_width)) != kSuccess) {
+      spdlog::error("Failed to set Flutter Engine Window Size");
+    }
+  }
+}
+
+void WaylandSoftwareBackend::CreateSurface(size_t /* index */,
+                                           wl_surface* surface,
+                                           int32_t /* width */,
+                                           int32_t /* height */) {
+  m_surface = surface;
+  // wl_shm formats name the bytes of a little endian word: ARGB8888 is BGRA
+  // in memory, ABGR8888 is RGBA
+  if (kSourceIsBgra) {
+    m_format = WL_SHM_FORMAT_ARGB8888;
+    m_conversion = ShmRows::kCopy;
+  } else if (m_display->HasShmFormat(WL_SHM_FORMAT_ABGR8888)) {
+    m_format = WL_SHM_FORMAT_ABGR8888;
+    m_conversion = ShmRows::kCopy;
+  } else {
+    m_format = WL_SHM_FORMAT_ARGB8888;
+    m_conversion = ShmRows::kSwapRedBlue;
+  }
+  spdlog::debug("Software backend: wl_shm format 0x{:08x}{}", m_format,
+                m_conversion == ShmRows::kCopy ? "" : ", converted");
+}
+
+FlutterRendererConfig WaylandSoftwareBackend::GetRenderConfig() {
+  return {.type = kSoftware,
+          .software = {
+              .struct_size = sizeof(FlutterSoftwareRendererConfig),
+              .surface_present_callback = PresentCallback,
+          }};
+}
+
+FlutterCompositor WaylandSoftwareBackend::GetCompositorConfig() {
+  return {.struct_size = sizeof(FlutterCompositor),
+          .user_data = this,
+          .create_backing_store_callback = nullptr,
+          .collect_backing_store_callback = nullptr,
+          .present_layers_callback = nullptr,
+          .avoid_backing_store_cache = true};
+}
+
+bool WaylandSoftwareBackend::PresentCallback(void* user_data,
+                                             const void* allocation,
+                                             const size_t row_bytes,
+                                             const size_t height) {
+  TRACE_SCOPE("WaylandSoftwareBackend::Present");
+  const auto state = static_cast<FlutterDesktopEngineState*>(user_data);
+  // the frame is already rasterized, this times the copy to the compositor
+  state->view_controller->engine->OnRasterStart();
+  const auto b = reinterpret_cast<WaylandSoftwareBackend*>(
+      state->view_controller->engine->GetBackend());
+  b->m_engine.store(state->view_controller->engine,
+                    std::memory_order_relaxed);
+  const auto ret = b->Present(allocation, row_bytes, height);
+  // closes the input latency of the events this frame consumed
+  state->view_controller->engine->OnFramePresented(
+      static_cast<uint64_t>(b->m_frame_damage.Area()));
+  return ret;
+}
+
+bool WaylandSoftwareBackend::Present(const void* allocation,
+                                     const size_t row_bytes,
+                                     const size_t height) {
+  m_frame_damage.Clear();
+  if (!m_surface || !allocation) {
+    return false;
+  }
+  const auto src = static_cast<const uint8_t*>(allocation);
+  const auto width = static_cast<uint32_t>(row_bytes / ShmRows::kBytesPerPixel);
+  if (width != m_buffer_width || height != m_buffer_height) {
+    if (!CreateBuffers(width, static_cast<uint32_t>(height))) {
+      return false;
+    }
+  }
+
+  // set before the scan: either a buffer is found free, or its release sees
+  // the pending present
+  m_present_pending.store(true);
+  // the most recent free buffer is missing the fewest rows
+  Buffer* buffer = nullptr;
+  for (auto& candidate : m_buffers) {
+    if (!candidate.busy.load() &&
+        (!buffer || candidate.frame > buffer->frame)) {
+      buffer = &candidate;
+    }
+  }
+  if (!buffer) {
+    // the shadow keeps the old frame, so the frame scheduled on release
+    // carries this damage
+    if (m_skipped++ % 100 == 0) {
+      spdlog::debug("Software backend: all buffers busy, {} frames skipped",
+                    m_skipped);
+    }
+    return true;
+  }
+  m_present_pending.store(false, std::memory_order_relaxed);
+
+  const auto full = FlutterRect{0, 0, static_cast<double>(m_buffer_width),
+                                static_cast<double>(m_buffer_height)};
+  if (m_shadow_valid) {
+    ShmRows::Diff(src, m_shadow.data(), row_bytes, m_buffer_width,
+                  m_buffer_height, &m_frame_damage);
+    if (m_frame_damage.empty()) {
+      return true;
+    }
+  } else {
+    std::memcpy(m_shadow.data(), src, m_shadow.size());
+    m_shadow_valid = true;
+    m_frame_damage.Add(full);
+  }
+
+  const auto frame = ++m_frame;
+  // older than the history is the same as unknown
+  const auto age =
+      buffer->frame == 0
+          ? 0
+          : static_cast<int>(std::min<uint64_t>(
+                frame - buffer->frame, DamageHistory::kMaxFrames + 2));
+  if (m_damage_history.Accumulate(age, &m_copy_damage)) {
+    m_copy_damage.Add(m_frame_damage);
+  } else {
+    m_copy_damage.Add(full);
+  }
+  m_damage_history.Push(m_frame_damage);
+
+  const size_t stride = size_t{m_buffer_width} * ShmRows::kBytesPerPixel;
+  ShmRows::Copy(src, row_bytes, buffer->pixels, stride, m_buffer_width,
+                m_buffer_height, m_copy_damage, m_conversion);
+  buffer->frame = frame;
+  buffer->busy.store(true, std::memory_order_relaxed);
+
+  wl_surface_attach(m_surface, buffer->handle.load(std::memory_order_relaxed),
+                    0, 0);
+  const bool damage_buffer = wl_proxy_get_version(reinterpret_cast<wl_proxy*>(
+                                 m_surface)) >=
+                             WL_SURFACE_DAMAGE_BUFFER_SINCE_VERSION;
+  for (size_t i = 0; i < m_frame_damage.size(); i++) {
+    const auto& rect = m_frame_damage[i];
+    const auto x = static_cast<int32_t>(rect.left);
+    const auto y = static_cast<int32_t>(rect.top);
+    const auto w = static_cast<int32_t>(rect.right - rect.left);
+    const auto h = static_cast<int32_t>(rect.bottom - rect.top);
+    // the surface has a buffer scale of 1, both coordinates are the same
+    if (damage_buffer) {
+      wl_surface_damage_buffer(m_surface, x, y, w, h);
+    } else {
+      wl_surface_damage(m_surface, x, y, w, h);
+    }
+  }
+  wl_surface_commit(m_surface);
+  // the main loop only flushes when it wakes, do not wait for it
+  wl_display_flush(m_display->GetDisplay());
+  return true;
+}
+
+bool WaylandSoftwareBackend::CreateBuffers(const uint32_t width,
+                                           const uint32_t height) {
+  DestroyBuffers();
+  const int32_t stride = static_cast<int32_t>(width * ShmRows::kBytesPerPixel);
+  const size_t buffer_size = static_cast<size_t>(stride) * height;
+  const size_t pool_size = buffer_size * kBuffers;
+  if (buffer_size == 0 || pool_size > INT32_MAX) {
+    spdlog::error("Software backend: invalid frame size {}x{}", width, height);
+    return false;
+  }
+
+#ifdef HAVE_MEMFD_CREATE
+  const auto fd = memfd_create("homescreen-shm", MFD_CLOEXEC);
+#else
+  const auto fd = open("/dev/shm", O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+#endif
+  if (fd < 0 || ftruncate(fd, static_cast<off_t>(pool_size)) != 0) {
+    spdlog::error("Software backend: failed to allocate {} bytes: {}",
+                  pool_size, std::strerror(errno));
+    if (fd >= 0) {
+      close(fd);
+    }
+    return false;
+  }
+  const auto mapped =
+      mmap(nullptr, pool_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapped == MAP_FAILED) {
+    spdlog::error("Software backend: mmap failed: {}", std::strerror(errno));
+    close(fd);
+    return false;
+  }
+
+  const auto pool = wl_shm_create_pool(m_display->GetShm(), fd,
+                                       static_cast<int32_t>(pool_size));
+  // the compositor holds its own reference to the memory
+  close(fd);
+  m_pool_data = static_cast<uint8_t*>(mapped);
+  m_pool_size = pool_size;
+  for (uint32_t i = 0; i < kBuffers; i++) {
+    auto& buffer = m_buffers[i];
+    const auto handle = wl_shm_pool_create_buffer(
+        pool, static_cast<int32_t>(buffer_size * i),
+        static_cast<int32_t>(width), static_cast<int32_t>(height), stride,
+        m_format);
+    wl_buffer_add_listener(handle, &buffer_listener, &buffer);
+    buffer.pixels = m_pool_data + buffer_size * i;
+    buffer.backend = this;
+    buffer.frame = 0;
+    buffer.busy.store(false, std::memory_order_relaxed);
+    buffer.handle.store(handle, std::memory_order_release);
+  }
+  wl_shm_pool_destroy(pool);
+
+  m_buffer_width = width;
+  m_buffer_height = height;
+  m_shadow.assign(buffer_size, 0);
+  m_shadow_valid = false;
+  m_damage_history.Clear();
+  spdlog::debug("Software backend: {} buffers of {}x{}", kBuffers, width,
+                height);
+  return true;
+}
+
+void WaylandSoftwareBackend::DestroyBuffers() {
+  for (auto& buffer : m_buffers) {
+    if (const auto handle =
+            buffer.handle.exchange(nullptr, std::memory_order_acq_rel)) {
+      // the compositor keeps showing a buffer destroyed while attached
+      wl_buffer_destroy(handle);
+    }
+    buffer.pixels = nullptr;
+    buffer.frame = 0;
+  }
+  if (m_pool_data) {
+    munmap(m_pool_data, m_pool_size);
+    m_pool_data = nullptr;
+  }
+  m_buffer_width = 0;
+  m_buffer_height = 0;
+}
+
+const wl_buffer_listener WaylandSoftwareBackend::buffer_listener = {
+    buffer_release};
+
+void WaylandSoftwareBackend::buffer_release(void* data, wl_buffer* buffer) {
+  const auto b = static_cast<Buffer*>(data);
+  if (b->handle.load(std::memory_order_acquire) != buffer) {
+    return;
+  }
+  b->busy.store(false);
+  if (!b->backend->m_present_pending.exchange(false)) {
+    return;
+  }
+  // the engine rasterizes no new frame by itself while the scene is idle
+  const auto engine = b->backend->m_engine.load(std::memory_order_relaxed);
+  if (engine && LibFlutterEngine->ScheduleFrame &&
+      LibFlutterEngine->ScheduleFrame(engine->GetFlutterEngine()) !=
+          kSuccess) {
+    spdlog::error("Software backend: failed to schedule a frame");
+  }
+}
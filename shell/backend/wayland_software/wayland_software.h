@@ -0,0 +1,211 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <wayland-client.h>
+
+#include "config/common.h"
+
+#include "../backend.h"
+#include "../damage_region.h"
+#include "shm_rows.h"
+
+class Display;
+
+class Engine;
+
+/**
+ * @brief Software rendered frames presented through wl_shm buffers.
+ *
+ * The engine rasterizes with Skia on the CPU and hands over each frame.  The
+ * frame is compared row by row with the previous one; only changed rows are
+ * copied into a free buffer of a small pool and damaged on the surface.  An
+ * unchanged frame is not committed at all.  A frame arriving while the
+ * compositor holds every buffer is dropped, and a new frame is scheduled once
+ * a buffer is released.
+ */
+class WaylandSoftwareBackend final : public Backend {
+ public:
+  static constexpr uint32_t kBuffers = 3;
+
+  WaylandSoftwareBackend(std::shared_ptr<Display> display,
+                         uint32_t width,
+                         uint32_t height,
+                         bool debug_backend);
+
+  ~WaylandSoftwareBackend() override;
+
+  /**
+   * @brief Resize Flutter engine Window size
+   * @param[in] index No use
+   * @param[in] engine Pointer to Flutter engine
+   * @param[in] width Set window width
+   * @param[in] height Set window height
+   * @return void
+   * @relation
+   * wayland
+   */
+  void Resize(size_t index,
+              Engine* engine,
+              int32_t width,
+              int32_t height) override;
+
+  /**
+   * @brief Use the surface and choose the wl_shm format of its buffers
+   * @param[in] index No use
+   * @param[in] surface Pointer to surface
+   * @param[in] width No use
+   * @param[in] height No use
+   * @return void
+   * @relation
+   * wayland
+   */
+  void CreateSurface(size_t index,
+                     wl_surface* surface,
+                     int32_t width,
+                     int32_t height) override;
+
+  /**
+   * @brief Get FlutterRendererConfig
+   * @return FlutterRendererConfig
+   * @retval Software renderer config
+   * @relation
+   * wayland
+   */
+  FlutterRendererConfig GetRenderConfig() override;
+
+  /**
+   * @brief Get FlutterCompositor
+   * @return FlutterCompositor
+   * @retval Pointer to FlutterCompositor
+   * @relation
+   * wayland
+   */
+  FlutterCompositor GetCompositorConfig() override;
+
+  /**
+   * @brief No GL context, textures are not supported
+   * @return bool
+   * @retval false Always
+   * @relation
+   * flutter
+   */
+  bool TextureMakeCurrent() override { return false; }
+
+  bool TextureClearCurrent() override { return false; }
+
+ private:
+  struct Buffer {
+    /// compared on release, a stale release must not free a new buffer
+    std::atomic<wl_buffer*> handle{};
+    /// held by the compositor
+    std::atomic<bool> busy{};
+    /// frame last copied into the buffer, 0 if none
+    uint64_t frame{};
+    uint8_t* pixels{};
+    WaylandSoftwareBackend* backend{};
+  };
+
+  std::shared_ptr<Display> m_display;
+  /// engine of the frames, for the release listener
+  std::atomic<Engine*> m_engine{};
+  /// a frame was dropped, schedule another on the next release
+  std::atomic<bool> m_present_pending{};
+  wl_surface* m_surface{};
+  uint32_t m_format{};
+  ShmRows::Conversion m_conversion{ShmRows::kCopy};
+  uint32_t m_width;
+  uint32_t m_height;
+
+  // raster thread only
+  std::array<Buffer, kBuffers> m_buffers{};
+  uint8_t* m_pool_data{};
+  size_t m_pool_size{};
+  uint32_t m_buffer_width{};
+  uint32_t m_buffer_height{};
+  /// the previous frame, to find the changed rows
+  std::vector<uint8_t> m_shadow;
+  bool m_shadow_valid{};
+  DamageRegion m_frame_damage;
+  DamageRegion m_copy_damage;
+  DamageHistory m_damage_history;
+  uint64_t m_frame{};
+  uint64_t m_skipped{};
+
+  /**
+   * @brief Copy a frame into a free buffer and commit it
+   * @param[in] allocation Frame pixels, native 32 bit format
+   * @param[in] row_bytes Bytes per frame row
+   * @param[in] height Frame height
+   * @return bool
+   * @retval true Presented, unchanged or pending a buffer release
+   * @retval false No buffers could be allocated
+   * @relation
+   * wayland
+   */
+  bool Present(const void* allocation, size_t row_bytes, size_t height);
+
+  /**
+   * @brief Allocate a pool of kBuffers buffers
+   * @param[in] width Buffer width
+   * @param[in] height Buffer height
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * wayland
+   */
+  bool CreateBuffers(uint32_t width, uint32_t height);
+
+  void DestroyBuffers();
+
+  /**
+   * @brief Callback of software frames
+   * @param[in] user_data Pointer to FlutterDesktopEngineState
+   * @param[in] allocation Frame pixels
+   * @param[in] row_bytes Bytes per frame row
+   * @param[in] height Frame height
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * flutter
+   */
+  static bool PresentCallback(void* user_data,
+                              const void* allocation,
+                              size_t row_bytes,
+                              size_t height);
+
+  static const wl_buffer_listener buffer_listener;
+
+  /**
+   * @brief The compositor no longer reads the buffer, a dropped frame is
+   * scheduled again
+   * @param[in] data Pointer to Buffer
+   * @param[in] buffer Released buffer
+   * @return void
+   * @relation
+   * wayland
+   */
+  static void buffer_release(void* data, wl_buffer* buffer);
+};
@@ -16,13 +16,16 @@
 
 #include "wayland_vulkan.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdlib>
 #include <optional>
 #include <queue>
 
 #include "config/common.h"
 #include "engine.h"
+#include "trace.h"
 
 VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
 
@@ -40,10 +43,20 @@ const auto& d = vk::defaultDispatchLoaderDynamic;
 WaylandVulkanBackend::WaylandVulkanBackend(wl_display* display,
                                            const uint32_t width,
                                            const uint32_t height,
-                                           const bool enable_validation_layers)
+                                           const bool enable_validation_layers,
+                                           const uint32_t frames_in_flight,
+                                           const bool layer_compositor)
     : Backend(),
       enable_validation_layers_(enable_validation_layers),
+      layer_compositor_(layer_compositor),
+      frames_in_flight_(
+          std::clamp(frames_in_flight, uint32_t{1}, kMaxFramesInFlight)),
       resize_pending_(false),
+      backing_store_pool_(kMaxPooledBackingStoreBytes,
+                          kBackingStoreIdleFrames,
+                          [this](std::unique_ptr<BackingImage>& image) {
+                            destroyBackingImage(*image);
+                          }),
       wl_display_(display),
       width_(width),
       height_(height) {
@@ -75,24 +88,43 @@ FlutterRendererConfig WaylandVulkanBackend::GetRenderConfig() {
 }
 
 FlutterCompositor WaylandVulkanBackend::GetCompositorConfig() {
+  if (!compositor_supported_) {
+    return {.struct_size = sizeof(FlutterCompositor),
+            .user_data = this,
+            .create_backing_store_callback = nullptr,
+            .collect_backing_store_callback = nullptr,
+            .present_layers_callback = nullptr,
+            .avoid_backing_store_cache = true};
+  }
+  // the pool caches the images, with a budget the engine's cache lacks
   return {.struct_size = sizeof(FlutterCompositor),
           .user_data = this,
-          .create_backing_store_callback = nullptr,   // CreateBackingStore,
-          .collect_backing_store_callback = nullptr,  // CollectBackingStore,
-          .present_layers_callback = nullptr,         // PresentLayers,
+          .create_backing_store_callback = CreateBackingStore,
+          .collect_backing_store_callback = CollectBackingStore,
+          .present_layers_callback = PresentLayers,
           .avoid_backing_store_cache = true};
 }
 
 WaylandVulkanBackend::~WaylandVulkanBackend() {
   if (device_ != nullptr) {
+    // frames may still be in flight
+    d.vkDeviceWaitIdle(device_);
+    const auto stats = backing_store_pool_.GetStats();
+    spdlog::debug("Vulkan backing stores: {} reused, {} allocated, {} evicted",
+                  stats.hits, stats.misses, stats.evictions);
+    backing_store_pool_.Clear();
+    if (swapchain_ != nullptr) {
+      d.vkDestroySwapchainKHR(device_, swapchain_, nullptr);
+    }
     if (swapchain_command_pool_ != nullptr) {
       d.vkDestroyCommandPool(device_, swapchain_command_pool_, nullptr);
     }
-    if (present_transition_semaphore_ != nullptr) {
-      d.vkDestroySemaphore(device_, present_transition_semaphore_, nullptr);
+    for (const auto semaphore : present_semaphores_) {
+      d.vkDestroySemaphore(device_, semaphore, nullptr);
     }
-    if (image_ready_fence_ != nullptr) {
-      d.vkDestroyFence(device_, image_ready_fence_, nullptr);
+    for (const auto& slot : frame_slots_) {
+      d.vkDestroyFence(device_, slot.acquire_fence, nullptr);
+      d.vkDestroyFence(device_, slot.submit_fence, nullptr);
     }
     d.vkDestroyDevice(device_, nullptr);
   }
@@ -452,12 +484,50 @@ void WaylandVulkanBackend::createLogicalDevice() {
   d.vkGetDeviceQueue(device_, queue_family_index_, 0, &queue_);
 }
 
+void WaylandVulkanBackend::createFrameSlots() {
+  VkFenceCreateInfo acquire_info{};
+  acquire_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  // the first wait on a slot returns at once
+  VkFenceCreateInfo submit_info{};
+  submit_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  submit_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+  VkCommandBufferAllocateInfo buffer_info{};
+  buffer_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  buffer_info.commandPool = swapchain_command_pool_;
+  buffer_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  buffer_info.commandBufferCount = 1;
+
+  frame_slots_.resize(frames_in_flight_);
+  for (auto& slot : frame_slots_) {
+    CHECK_VK_RESULT(
+        d.vkCreateFence(device_, &acquire_info, nullptr, &slot.acquire_fence));
+    CHECK_VK_RESULT(
+        d.vkCreateFence(device_, &submit_info, nullptr, &slot.submit_fence));
+    CHECK_VK_RESULT(d.vkAllocateCommandBuffers(device_, &buffer_info,
+                                               &slot.layers_buffer));
+  }
+  spdlog::debug("Vulkan frames in flight: {}", frames_in_flight_);
+}
+
 bool WaylandVulkanBackend::InitializeSwapchain() {
-  if (resize_pending_) {
-    resize_pending_ = false;
+  resize_pending_ = false;
+  if (swapchain_ != nullptr) {
+    // not on the hot path: no frame may use the old images or semaphores
+    CHECK_VK_RESULT(d.vkQueueWaitIdle(queue_));
     d.vkDestroySwapchainKHR(device_, swapchain_, nullptr);
+    swapchain_ = nullptr;
 
-    CHECK_VK_RESULT(d.vkQueueWaitIdle(queue_));
+    if (!present_transition_buffers_.empty()) {
+      d.vkFreeCommandBuffers(
+          device_, swapchain_command_pool_,
+          static_cast<uint32_t>(present_transition_buffers_.size()),
+          present_transition_buffers_.data());
+    }
+    for (const auto semaphore : present_semaphores_) {
+      d.vkDestroySemaphore(device_, semaphore, nullptr);
+    }
+    present_semaphores_.clear();
     CHECK_VK_RESULT(
         d.vkResetCommandPool(device_, swapchain_command_pool_,
                              VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT));
@@ -562,6 +632,18 @@ bool WaylandVulkanBackend::InitializeSwapchain() {
   info.imageExtent = clientSize;
   info.imageArrayLayers = 1;
   info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+  // the compositor copies the layers into the image; without it the engine
+  // renders straight into the swapchain image
+  compositor_supported_ = layer_compositor_ &&
+                          (surface_capabilities.supportedUsageFlags &
+                           VK_IMAGE_USAGE_TRANSFER_DST_BIT) != 0;
+  if (compositor_supported_) {
+    info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+  } else if (layer_compositor_) {
+    spdlog::warn(
+        "Vulkan: swapchain images can not be copied into, layer compositor "
+        "disabled");
+  }
   info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
   info.preTransform = surface_capabilities.currentTransform;
   info.compositeAlpha = (surface_capabilities.supportedCompositeAlpha &
@@ -576,6 +658,7 @@ bool WaylandVulkanBackend::InitializeSwapchain() {
   if (result != VK_SUCCESS) {
     return false;
   }
+  swapchain_extent_ = clientSize;
 
   // --------------------------------------------------------------------------
   // Fetch swapchain images
@@ -588,6 +671,14 @@ bool WaylandVulkanBackend::InitializeSwapchain() {
   CHECK_VK_RESULT(d.vkGetSwapchainImagesKHR(device_, swapchain_, &image_count,
                                             swapchain_images_.data()));
 
+  VkSemaphoreCreateInfo s_info{};
+  s_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+  present_semaphores_.resize(image_count);
+  for (auto& semaphore : present_semaphores_) {
+    CHECK_VK_RESULT(d.vkCreateSemaphore(device_, &s_info, nullptr, &semaphore));
+  }
+  image_fences_.assign(image_count, VK_NULL_HANDLE);
+
   // --------------------------------------------------------------------------
   // Record a command buffer for each of the images to be executed prior to
   // presenting.
@@ -616,7 +707,8 @@ bool WaylandVulkanBackend::InitializeSwapchain() {
     // Filament Engine hands back the image after writing to it
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.srcAccessMask = 0;
+    // the engine's writes are no longer covered by a queue idle wait
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
     barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
     barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
@@ -688,78 +780,132 @@ VKAPI_ATTR VkBool32 VKAPI_CALL WaylandVulkanBackend::debugUtilsCallback(
   return VK_TRUE;
 }
 
-FlutterVulkanImage WaylandVulkanBackend::GetNextImageCallback(
-    void* user_data,
-    const FlutterFrameInfo* frame_info) {
-  if (frame_info->struct_size != sizeof(FlutterFrameInfo)) {
-    SPDLOG_ERROR(
-        "GetNextImageCallback: frame_info->struct_size != "
-        "sizeof(FlutterFrameInfo)");
-  }
+void WaylandVulkanBackend::AcquireImage() {
   // If the framebuffer has been resized, discard the swapchain and create
   // a new one.
-
-  const auto state = reinterpret_cast<FlutterDesktopEngineState*>(user_data);
-  const auto b = reinterpret_cast<WaylandVulkanBackend*>(
-      state->view_controller->view->GetBackend());
-  if (b->resize_pending_) {
-    b->InitializeSwapchain();
+  if (resize_pending_) {
+    InitializeSwapchain();
   }
 
-  CHECK_VK_RESULT(d.vkAcquireNextImageKHR(
-      b->device_, b->swapchain_, 1'000'000'000,  // timeout (ns) 1000ms
-      nullptr, b->image_ready_fence_, &b->last_image_index_));
+  // Keep at most frames_in_flight_ frames queued: the slot is free once the
+  // frame that used it frames_in_flight_ frames ago has executed.
+  const auto& slot = frame_slots_[frame_slot_];
+  CHECK_VK_RESULT(
+      d.vkWaitForFences(device_, 1, &slot.submit_fence, true, UINT64_MAX));
+
+  auto result = d.vkAcquireNextImageKHR(
+      device_, swapchain_, 1'000'000'000,  // timeout (ns) 1000ms
+      nullptr, slot.acquire_fence, &last_image_index_);
+  if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+    InitializeSwapchain();
+    result = d.vkAcquireNextImageKHR(device_, swapchain_, 1'000'000'000,
+                                     nullptr, slot.acquire_fence,
+                                     &last_image_index_);
+  }
+  if (result == VK_SUBOPTIMAL_KHR) {
+    // still presentable, replace it before the next frame
+    resize_pending_ = true;
+  } else {
+    CHECK_VK_RESULT(result);
+  }
 
   // Flutter Engine expects the image to be available for transitioning and
   // attaching immediately, and so we need to force a host sync here before
   // returning.
-  CHECK_VK_RESULT(d.vkWaitForFences(b->device_, 1, &b->image_ready_fence_, true,
-                                    UINT64_MAX));
-  CHECK_VK_RESULT(d.vkResetFences(b->device_, 1, &b->image_ready_fence_));
+  CHECK_VK_RESULT(
+      d.vkWaitForFences(device_, 1, &slot.acquire_fence, true, UINT64_MAX));
+  CHECK_VK_RESULT(d.vkResetFences(device_, 1, &slot.acquire_fence));
 
-  return {
-      .struct_size = sizeof(FlutterVulkanImage),
-      .image = reinterpret_cast<uint64_t>(
-          b->swapchain_images_[b->last_image_index_]),
-      .format = b->surface_format_.format,
-  };
+  // The image's transition buffer may be submitted again only once the frame
+  // that last presented the image has executed; usually long done.
+  auto& image_fence = image_fences_[last_image_index_];
+  if (image_fence != VK_NULL_HANDLE && image_fence != slot.submit_fence) {
+    CHECK_VK_RESULT(
+        d.vkWaitForFences(device_, 1, &image_fence, true, UINT64_MAX));
+  }
+  image_fence = slot.submit_fence;
 }
 
-bool WaylandVulkanBackend::PresentCallback(
-    void* user_data,
-    const FlutterVulkanImage* /* image */) {
-  const auto state = static_cast<FlutterDesktopEngineState*>(user_data);
-  const auto b = reinterpret_cast<WaylandVulkanBackend*>(
-      state->view_controller->view->GetBackend());
+bool WaylandVulkanBackend::SubmitAndPresent(VkCommandBuffer buffer) {
+  const auto& slot = frame_slots_[frame_slot_];
+  frame_slot_ = (frame_slot_ + 1) % frames_in_flight_;
+  // one semaphore per image: it is free again once the image is reacquired
+  const auto present_semaphore = present_semaphores_[last_image_index_];
+
   constexpr VkPipelineStageFlags stage_flags =
       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
   VkSubmitInfo submit_info{};
   submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
   submit_info.pWaitDstStageMask = &stage_flags;
   submit_info.commandBufferCount = 1;
-  submit_info.pCommandBuffers =
-      &b->present_transition_buffers_[b->last_image_index_];
+  submit_info.pCommandBuffers = &buffer;
   submit_info.signalSemaphoreCount = 1;
-  submit_info.pSignalSemaphores = &b->present_transition_semaphore_;
-  d.vkQueueSubmit(b->queue_, 1, &submit_info, nullptr);
+  submit_info.pSignalSemaphores = &present_semaphore;
+  CHECK_VK_RESULT(d.vkResetFences(device_, 1, &slot.submit_fence));
+  auto result = d.vkQueueSubmit(queue_, 1, &submit_info, slot.submit_fence);
+  if (result != VK_SUCCESS) {
+    spdlog::error("Vulkan: frame submit failed: {}",
+                  static_cast<int>(result));
+    // the next wait on the slot must not hang
+    d.vkQueueSubmit(queue_, 0, nullptr, slot.submit_fence);
+    return false;
+  }
 
   VkPresentInfoKHR present_info{};
   present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
   present_info.waitSemaphoreCount = 1;
-  present_info.pWaitSemaphores = &b->present_transition_semaphore_;
+  present_info.pWaitSemaphores = &present_semaphore;
   present_info.swapchainCount = 1;
-  present_info.pSwapchains = &b->swapchain_;
-  present_info.pImageIndices = &b->last_image_index_;
-  const VkResult result = d.vkQueuePresentKHR(b->queue_, &present_info);
+  present_info.pSwapchains = &swapchain_;
+  present_info.pImageIndices = &last_image_index_;
+  result = d.vkQueuePresentKHR(queue_, &present_info);
 
   // If the swapchain is no longer compatible with the surface, discard the
-  // swapchain and create a new one.
+  // swapchain and create a new one before the next acquire.
   if (result == VK_SUBOPTIMAL_KHR || result == VK_ERROR_OUT_OF_DATE_KHR) {
-    b->InitializeSwapchain();
+    resize_pending_ = true;
   }
-  d.vkQueueWaitIdle(b->queue_);
 
-  return result == VK_SUCCESS;
+  return result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR;
+}
+
+FlutterVulkanImage WaylandVulkanBackend::GetNextImageCallback(
+    void* user_data,
+    const FlutterFrameInfo* frame_info) {
+  TRACE_SCOPE("WaylandVulkanBackend::GetNextImage");
+  if (frame_info->struct_size != sizeof(FlutterFrameInfo)) {
+    SPDLOG_ERROR(
+        "GetNextImageCallback: frame_info->struct_size != "
+        "sizeof(FlutterFrameInfo)");
+  }
+
+  const auto state = reinterpret_cast<FlutterDesktopEngineState*>(user_data);
+  state->view_controller->engine->OnRasterStart();
+  const auto b = reinterpret_cast<WaylandVulkanBackend*>(
+      state->view_controller->view->GetBackend());
+  b->AcquireImage();
+
+  return {
+      .struct_size = sizeof(FlutterVulkanImage),
+      .image = reinterpret_cast<uint64_t>(
+          b->swapchain_images_[b->last_image_index_]),
+      .format = b->surface_format_.format,
+  };
+}
+
+bool WaylandVulkanBackend::PresentCallback(
+    void* user_data,
+    const FlutterVulkanImage* /* image */) {
+  TRACE_SCOPE("WaylandVulkanBackend::Present");
+  const auto state = static_cast<FlutterDesktopEngineState*>(user_data);
+  const auto b = reinterpret_cast<WaylandVulkanBackend*>(
+      state->view_controller->view->GetBackend());
+  const auto ret =
+      b->SubmitAndPresent(b->present_transition_buffers_[b->last_image_index_]);
+  // closes the input latency of the events this frame consumed
+  state->view_controller->engine->OnFramePresented(uint64_t{b->width_} *
+                                                   b->height_);
+  return ret;
 }
 
 void* WaylandVulkanBackend::GetInstanceProcAddressCallback(
@@ -817,116 +963,278 @@ void WaylandVulkanBackend::CreateSurface(size_t /* index */,
   // callbacks.
   // --------------------------------------------------------------------------
 
-  VkFenceCreateInfo f_info{};
-  f_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-  d.vkCreateFence(device_, &f_info, nullptr, &image_ready_fence_);
-
-  VkSemaphoreCreateInfo s_info{};
-  s_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-  d.vkCreateSemaphore(device_, &s_info, nullptr,
-                      &present_transition_semaphore_);
-
   VkCommandPoolCreateInfo pool_info{};
   pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  // the compositor rerecords its buffers every frame
+  pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
   pool_info.queueFamilyIndex = queue_family_index_;
   d.vkCreateCommandPool(device_, &pool_info, nullptr, &swapchain_command_pool_);
 
+  createFrameSlots();
+
   if (!InitializeSwapchain()) {
     spdlog::critical("Failed to create swapchain.");
     exit(EXIT_FAILURE);
   }
 }
 
+std::optional<uint32_t> WaylandVulkanBackend::findMemoryType(
+    const uint32_t type_bits,
+    const VkMemoryPropertyFlags properties) {
+  for (uint32_t i = 0; i < physical_device_memory_properties_.memoryTypeCount;
+       i++) {
+    if ((type_bits & (1u << i)) &&
+        (physical_device_memory_properties_.memoryTypes[i].propertyFlags &
+         properties) == properties) {
+      return i;
+    }
+  }
+  return std::nullopt;
+}
+
+std::unique_ptr<WaylandVulkanBackend::BackingImage>
+WaylandVulkanBackend::createBackingImage(
+    const BackingStorePool<std::unique_ptr<BackingImage>>::Key& key) {
+  auto image = std::make_unique<BackingImage>();
+  image->backend = this;
+  image->key = key;
+
+  VkImageCreateInfo info{};
+  info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+  info.imageType = VK_IMAGE_TYPE_2D;
+  info.format = static_cast<VkFormat>(key.format);
+  info.extent = {key.width, key.height, 1};
+  info.mipLevels = 1;
+  info.arrayLayers = 1;
+  info.samples = VK_SAMPLE_COUNT_1_BIT;
+  info.tiling = VK_IMAGE_TILING_OPTIMAL;
+  // the usage the engine wraps backing store images with
+  info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+               VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+               VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+  info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  if (d.vkCreateImage(device_, &info, nullptr, &image->image) != VK_SUCCESS) {
+    spdlog::error("Vulkan: failed to create a {}x{} backing store", key.width,
+                  key.height);
+    return nullptr;
+  }
+
+  VkMemoryRequirements requirements;
+  d.vkGetImageMemoryRequirements(device_, image->image, &requirements);
+  const auto type = findMemoryType(requirements.memoryTypeBits,
+                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  VkMemoryAllocateInfo alloc_info{};
+  alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  alloc_info.allocationSize = requirements.size;
+  alloc_info.memoryTypeIndex = type.value_or(0);
+  if (!type ||
+      d.vkAllocateMemory(device_, &alloc_info, nullptr, &image->memory) !=
+          VK_SUCCESS ||
+      d.vkBindImageMemory(device_, image->image, image->memory, 0) !=
+          VK_SUCCESS) {
+    spdlog::error("Vulkan: failed to allocate {} bytes for a backing store",
+                  requirements.size);
+    destroyBackingImage(*image);
+    return nullptr;
+  }
+  image->bytes = static_cast<size_t>(requirements.size);
+  image->flutter_image = {
+      .struct_size = sizeof(FlutterVulkanImage),
+      .image = reinterpret_cast<uint64_t>(image->image),
+      .format = key.format,
+  };
+  return image;
+}
+
+void WaylandVulkanBackend::destroyBackingImage(BackingImage& image) {
+  if (image.read_fence != VK_NULL_HANDLE) {
+    CHECK_VK_RESULT(
+        d.vkWaitForFences(device_, 1, &image.read_fence, true, UINT64_MAX));
+  }
+  if (image.image != VK_NULL_HANDLE) {
+    d.vkDestroyImage(device_, image.image, nullptr);
+  }
+  if (image.memory != VK_NULL_HANDLE) {
+    d.vkFreeMemory(device_, image.memory, nullptr);
+  }
+}
+
 bool WaylandVulkanBackend::CollectBackingStore(
-    const FlutterBackingStore* /* renderer */,
+    const FlutterBackingStore* renderer,
     void* /* user_data */) {
-  SPDLOG_DEBUG("CollectBackingStore");
-  return false;
+  TRACE_SCOPE("WaylandVulkanBackend::CollectBackingStore");
+  const auto image = static_cast<BackingImage*>(renderer->user_data);
+  const auto b = image->backend;
+  const auto bytes = image->bytes;
+  b->backing_store_pool_.Release(image->key,
+                                 std::unique_ptr<BackingImage>(image), bytes);
+  return true;
 }
 
 bool WaylandVulkanBackend::CreateBackingStore(
-    const FlutterBackingStoreConfig* /* config */,
-    FlutterBackingStore* /* backing_store_out */,
-    void* /* user_data */) {
-  SPDLOG_DEBUG("CreateBackingStore");
-#if 0
-    auto surface_size = SkISize::Make(config->size.width, config->size.height);
-    TestVulkanImage* test_image = new TestVulkanImage(
-        std::move(test_vulkan_context_->CreateImage(surface_size).value()));
-
-    GrVkImageInfo image_info{};
-    image_info.fImage = test_image->GetImage();
-    image_info.fImageTiling = VK_IMAGE_TILING_OPTIMAL;
-    image_info.fImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    image_info.fFormat = VK_FORMAT_R8G8B8A8_UNORM;
-    image_info.fImageUsageFlags = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
-                        VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
-                        VK_IMAGE_USAGE_TRANSFER_DST_BIT |
-                        VK_IMAGE_USAGE_SAMPLED_BIT;
-    image_info.fSampleCount = 1;
-    image_info.fLevelCount = 1;
-
-    GrBackendTexture backend_texture(surface_size.width(), surface_size.height(),
-                                     image_info);
-
-    SkSurfaceProps surface_properties(0, kUnknown_SkPixelGeometry);
-
-    SkSurface::TextureReleaseProc release_vktexture = [](void* user_data) {
-      delete reinterpret_cast<TestVulkanImage*>(user_data);
-    };
+    const FlutterBackingStoreConfig* config,
+    FlutterBackingStore* backing_store_out,
+    void* user_data) {
+  TRACE_SCOPE("WaylandVulkanBackend::CreateBackingStore");
+  const auto state = static_cast<FlutterDesktopEngineState*>(user_data);
+  state->view_controller->engine->OnRasterStart();
+  const auto b = reinterpret_cast<WaylandVulkanBackend*>(
+      state->view_controller->view->GetBackend());
 
-    sk_sp<SkSurface> surface = SkSurface::MakeFromBackendTexture(
-        context_.get(),            // context
-        backend_texture,           // back-end texture
-        kTopLeft_GrSurfaceOrigin,  // surface origin
-        1,                         // sample count
-        kRGBA_8888_SkColorType,    // color type
-        SkColorSpace::MakeSRGB(),  // color space
-        &surface_properties,       // surface properties
-        release_vktexture,         // texture release proc
-        test_image                 // release context
-    );
-
-    if (!surface) {
-      spdlog::error("Could not create Skia surface from Vulkan image.");
-      return false;
+  const BackingStorePool<std::unique_ptr<BackingImage>>::Key key{
+      static_cast<uint32_t>(std::ceil(config->size.width)),
+      static_cast<uint32_t>(std::ceil(config->size.height)),
+      static_cast<uint32_t>(b->surface_format_.format)};
+  std::unique_ptr<BackingImage> image;
+  if (auto pooled = b->backing_store_pool_.Acquire(key)) {
+    image = std::move(*pooled);
+    // a frame still in flight may be copying it
+    if (image->read_fence != VK_NULL_HANDLE) {
+      CHECK_VK_RESULT(d.vkWaitForFences(b->device_, 1, &image->read_fence,
+                                        true, UINT64_MAX));
+      image->read_fence = VK_NULL_HANDLE;
     }
-    backing_store_out->type = kFlutterBackingStoreTypeVulkan;
-
-    auto* image = new FlutterVulkanImage();
-    image->image = reinterpret_cast<uint64_t>(image_info.fImage);
-    image->format = VK_FORMAT_R8G8B8A8_UNORM;
-    backing_store_out->vulkan.image = image;
-
-    // Collect all allocated resources in the destruction_callback.
-    {
-      UserData* user_data = new UserData();
-      user_data->image = image;
-      user_data->surface = surface.get();
-
-      backing_store_out->user_data = user_data;
-      backing_store_out->vulkan.user_data = user_data;
-      backing_store_out->vulkan.destruction_callback = [](void* user_data) {
-        UserData* d = reinterpret_cast<UserData*>(user_data);
-        d->surface->unref();
-        delete d->image;
-        delete d;
-      };
-
-      // The balancing unref is in the destruction callback.
-      surface->ref();
+  } else {
+    image = b->createBackingImage(key);
+    if (!image) {
+      return false;
     }
+    b->backing_store_pool_.Created(image->bytes);
+    const auto stats = b->backing_store_pool_.GetStats();
+    spdlog::debug(
+        "Vulkan backing store {}x{}: {} KiB, {} KiB live, {} KiB pooled",
+        key.width, key.height, image->bytes >> 10, stats.live_bytes >> 10,
+        stats.pooled_bytes >> 10);
+  }
 
-    return true;
-#endif
-  return false;
+  backing_store_out->type = kFlutterBackingStoreTypeVulkan;
+  backing_store_out->user_data = image.get();
+  backing_store_out->vulkan = {
+      .struct_size = sizeof(FlutterVulkanBackingStore),
+      .image = &image->flutter_image,
+      .user_data = image.get(),
+      // returned to the pool by CollectBackingStore
+      .destruction_callback = [](void* /* user_data */) {},
+  };
+  image.release();
+  return true;
 }
 
-bool WaylandVulkanBackend::PresentLayers(const FlutterLayer** /* layers */,
-                                         size_t /* layers_count */,
-                                         void* /* user_data */) {
-  SPDLOG_DEBUG("PresentLayers");
-  return false;
+bool WaylandVulkanBackend::PresentLayers(const FlutterLayer** layers,
+                                         const size_t layers_count,
+                                         void* user_data) {
+  TRACE_SCOPE("WaylandVulkanBackend::PresentLayers");
+  const auto state = static_cast<FlutterDesktopEngineState*>(user_data);
+  state->view_controller->engine->OnRasterStart();
+  const auto b = reinterpret_cast<WaylandVulkanBackend*>(
+      state->view_controller->view->GetBackend());
+  b->AcquireImage();
+
+  const auto& slot = b->frame_slots_[b->frame_slot_];
+  const auto buffer = slot.layers_buffer;
+  const auto target = b->swapchain_images_[b->last_image_index_];
+  const auto extent = b->swapchain_extent_;
+
+  VkCommandBufferBeginInfo begin_info{};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  CHECK_VK_RESULT(d.vkBeginCommandBuffer(buffer, &begin_info));
+
+  constexpr VkImageSubresourceRange range = {
+      .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+      .baseMipLevel = 0,
+      .levelCount = 1,
+      .baseArrayLayer = 0,
+      .layerCount = 1,
+  };
+  VkImageMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.subresourceRange = range;
+
+  // the previous contents of the swapchain image are not needed
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.image = target;
+  d.vkCmdPipelineBarrier(buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                         nullptr, 1, &barrier);
+  constexpr VkClearColorValue transparent{};
+  d.vkCmdClearColorImage(buffer, target, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         &transparent, 1, &range);
+
+  for (size_t i = 0; i < layers_count; i++) {
+    const auto layer = layers[i];
+    if (layer->type != kFlutterLayerContentTypeBackingStore) {
+      // platform views are not supported by this backend
+      continue;
+    }
+    const auto image =
+        static_cast<BackingImage*>(layer->backing_store->user_data);
+    // clip the layer to the swapchain image
+    const auto x = static_cast<int32_t>(layer->offset.x);
+    const auto y = static_cast<int32_t>(layer->offset.y);
+    const auto src_x = static_cast<uint32_t>(std::max(0, -x));
+    const auto src_y = static_cast<uint32_t>(std::max(0, -y));
+    const auto dst_x = static_cast<uint32_t>(std::max(0, x));
+    const auto dst_y = static_cast<uint32_t>(std::max(0, y));
+    const auto layer_width =
+        std::min(static_cast<uint32_t>(layer->size.width), image->key.width);
+    const auto layer_height =
+        std::min(static_cast<uint32_t>(layer->size.height), image->key.height);
+    if (src_x >= layer_width || src_y >= layer_height ||
+        dst_x >= extent.width || dst_y >= extent.height) {
+      continue;
+    }
+
+    // the engine has finished rendering before presenting the layers
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.image = image->image;
+    d.vkCmdPipelineBarrier(buffer,
+                           VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                           nullptr, 1, &barrier);
+
+    // Copied, not blended: without platform views there is a single layer,
+    // and the topmost layer wins where several overlap.
+    VkImageCopy region{};
+    region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.srcOffset = {static_cast<int32_t>(src_x),
+                        static_cast<int32_t>(src_y), 0};
+    region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.dstOffset = {static_cast<int32_t>(dst_x),
+                        static_cast<int32_t>(dst_y), 0};
+    region.extent = {std::min(layer_width - src_x, extent.width - dst_x),
+                     std::min(layer_height - src_y, extent.height - dst_y), 1};
+    d.vkCmdCopyImage(buffer, image->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                     target, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    // the engine wraps a reused image as UNDEFINED, no transition back
+    image->read_fence = slot.submit_fence;
+  }
+
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+  barrier.image = target;
+  d.vkCmdPipelineBarrier(buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr,
+                         0, nullptr, 1, &barrier);
+  CHECK_VK_RESULT(d.vkEndCommandBuffer(buffer));
+
+  const auto ret = b->SubmitAndPresent(buffer);
+  // closes the input latency of the events this frame consumed
+  state->view_controller->engine->OnFramePresented(uint64_t{extent.width} *
+                                                   extent.height);
+  b->backing_store_pool_.EndFrame();
+  return ret;
 }
 
 bool WaylandVulkanBackend::TextureMakeCurrent() {
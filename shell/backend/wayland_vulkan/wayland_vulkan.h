@@ -16,7 +16,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <vector>
 
 // Use vulkan.hpp's convenient proc table and resolver.
@@ -28,14 +31,37 @@
 #include "vulkan/vulkan_wayland.h"
 
 #include "backend/backend.h"
+#include "backend/backing_store_pool.h"
 #include "third_party/flutter/shell/platform/embedder/embedder.h"
 
 class WaylandVulkanBackend final : public Backend {
  public:
+  static constexpr uint32_t kDefaultFramesInFlight = 2;
+  static constexpr uint32_t kMaxFramesInFlight = 4;
+  /// free backing store images kept for reuse
+  static constexpr size_t kMaxPooledBackingStoreBytes = 64 << 20;
+  /// frames a free backing store image survives without being reused
+  static constexpr uint32_t kBackingStoreIdleFrames = 120;
+
+  /**
+   * @brief Create the Vulkan instance
+   * @param[in] display Pointer to wl_display
+   * @param[in] width Window width
+   * @param[in] height Window height
+   * @param[in] enable_validation_layers Load the validation layers
+   * @param[in] frames_in_flight Frames the CPU may submit ahead of the GPU,
+   * 1 to kMaxFramesInFlight
+   * @param[in] layer_compositor Render layers into backing store images and
+   * copy them into the swapchain image, instead of rendering into it
+   * @relation
+   * wayland
+   */
   WaylandVulkanBackend(wl_display* display,
                        uint32_t width,
                        uint32_t height,
-                       bool enable_validation_layers);
+                       bool enable_validation_layers,
+                       uint32_t frames_in_flight = kDefaultFramesInFlight,
+                       bool layer_compositor = false);
 
   ~WaylandVulkanBackend() override;
 
@@ -110,19 +136,53 @@ class WaylandVulkanBackend final : public Backend {
 
   bool debugUtilsSupported_{};
   bool enable_validation_layers_;
+  bool layer_compositor_;
   bool surfaceSupported_{};
   bool waylandSurfaceSupported_{};
 
   VkSurfaceFormatKHR surface_format_{};
   VkSwapchainKHR swapchain_{};
+  VkExtent2D swapchain_extent_{};
+  /// compositor requested and swapchain images can be copied into
+  bool compositor_supported_{};
   VkCommandPool swapchain_command_pool_{};
   std::vector<VkImage> swapchain_images_;
+
+  // per swapchain image
   std::vector<VkCommandBuffer> present_transition_buffers_;
-  VkSemaphore present_transition_semaphore_{};
-  VkFence image_ready_fence_{};
+  /// signaled by the transition, waited on by the present
+  std::vector<VkSemaphore> present_semaphores_;
+  /// submit fence of the frame slot that last used the image, not owned
+  std::vector<VkFence> image_fences_;
   uint32_t last_image_index_{};
 
-  bool resize_pending_;
+  struct FrameSlot {
+    /// the engine needs the acquired image at once, waited on by the host
+    VkFence acquire_fence{};
+    /// signaled when the frame's transition has executed
+    VkFence submit_fence{};
+    /// rerecorded every frame by the compositor
+    VkCommandBuffer layers_buffer{};
+  };
+  uint32_t frames_in_flight_;
+  std::vector<FrameSlot> frame_slots_;
+  uint32_t frame_slot_{};
+
+  /// set by Resize() on the platform thread, read by the raster thread
+  std::atomic<bool> resize_pending_;
+
+  /// image the engine renders a layer into
+  struct BackingImage {
+    WaylandVulkanBackend* backend{};
+    BackingStorePool<std::unique_ptr<BackingImage>>::Key key{};
+    VkImage image{};
+    VkDeviceMemory memory{};
+    size_t bytes{};
+    FlutterVulkanImage flutter_image{};
+    /// submit fence of the last frame that copied the image, not owned
+    VkFence read_fence{};
+  };
+  BackingStorePool<std::unique_ptr<BackingImage>> backing_store_pool_;
 
   wl_display* wl_display_;
   uint32_t width_;
@@ -160,6 +220,68 @@ class WaylandVulkanBackend final : public Backend {
    */
   void createLogicalDevice();
 
+  /**
+   * @brief Create the per frame slot fences
+   * @return void
+   * @relation
+   * wayland
+   */
+  void createFrameSlots();
+
+  /**
+   * @brief Find a memory type of physical_device_
+   * @param[in] type_bits Memory types allowed by the resource
+   * @param[in] properties Required properties
+   * @return std::optional<uint32_t>
+   * @retval Memory type index
+   * @retval std::nullopt None matches
+   * @relation
+   * wayland
+   */
+  std::optional<uint32_t> findMemoryType(uint32_t type_bits,
+                                         VkMemoryPropertyFlags properties);
+
+  /**
+   * @brief Allocate an image for a backing store
+   * @param[in] key Size and format of the image
+   * @return std::unique_ptr<BackingImage>
+   * @retval Image bound to its own device memory
+   * @retval nullptr Allocation failed
+   * @relation
+   * wayland
+   */
+  std::unique_ptr<BackingImage> createBackingImage(
+      const BackingStorePool<std::unique_ptr<BackingImage>>::Key& key);
+
+  /**
+   * @brief Destroy an image once no frame in flight copies it
+   * @param[in] image Image to destroy
+   * @return void
+   * @relation
+   * wayland
+   */
+  void destroyBackingImage(BackingImage& image);
+
+  /**
+   * @brief Acquire the next swapchain image into last_image_index_, waiting
+   * for a free frame slot first
+   * @return void
+   * @relation
+   * wayland
+   */
+  void AcquireImage();
+
+  /**
+   * @brief Submit a frame's commands and present last_image_index_
+   * @param[in] buffer Commands leaving the image in PRESENT_SRC layout
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * wayland
+   */
+  bool SubmitAndPresent(VkCommandBuffer buffer);
+
   /**
    * @brief Initialize Vulkan swapchain
    * @return bool
@@ -260,9 +382,9 @@ class WaylandVulkanBackend final : public Backend {
                           void* pUserData);
 
   /**
-   * @brief Callback to output information "CollectBackingStore"
-   * @param[in] renderer No use
-   * @param[in] user_data No use
+   * @brief Callback to return a backing store image to the pool
+   * @param[in] renderer Backing store collected by the engine
+   * @param[in] user_data Pointer to FlutterDesktopEngineState
    * @return bool
    * @retval true Normal end
    * @retval false Abnormal end
@@ -273,10 +395,10 @@ class WaylandVulkanBackend final : public Backend {
                                   void* user_data);
 
   /**
-   * @brief Callback to output information "CreateBackingStore"
-   * @param[in] config No use
-   * @param[in] backing_store_out No use
-   * @param[in] user_data No use
+   * @brief Callback to hand out a pooled or new backing store image
+   * @param[in] config Size of the backing store
+   * @param[out] backing_store_out Backing store
+   * @param[in] user_data Pointer to FlutterDesktopEngineState
    * @return bool
    * @retval true Normal end
    * @retval false Abnormal end
@@ -288,10 +410,10 @@ class WaylandVulkanBackend final : public Backend {
                                  void* user_data);
 
   /**
-   * @brief Callback to output information "PresentLayers"
-   * @param[in] layers No use
-   * @param[in] layers_count No use
-   * @param[in] user_data No use
+   * @brief Callback to copy the layers into a swapchain image and present it
+   * @param[in] layers Layers, bottom first
+   * @param[in] layers_count Number of layers
+   * @param[in] user_data Pointer to FlutterDesktopEngineState
    * @return bool
    * @retval true Normal end
    * @retval false Abnormal end
@@ -41,6 +41,26 @@ void Configuration::get_parameters(toml::table* tbl, Config& instance) {
     instance.debug_backend =
         tbl->at_path("global.debug_backend").value<bool>().value();
   }
+  if (tbl->at_path("global.trace_file").is_string()) {
+    instance.trace_file =
+        tbl->at_path("global.trace_file").as_string()->value_or("");
+  }
+  if (tbl->at_path("global.frame_stream").is_string()) {
+    instance.frame_stream =
+        tbl->at_path("global.frame_stream").as_string()->value_or("");
+  }
+  if (tbl->at_path("global.frame_export").is_string()) {
+    instance.frame_export =
+        tbl->at_path("global.frame_export").as_string()->value_or("");
+  }
+  if (tbl->at_path("global.frames_in_flight").is_integer()) {
+    instance.frames_in_flight =
+        tbl->at_path("global.frames_in_flight").value<uint32_t>().value();
+  }
+  if (tbl->at_path("global.layer_compositor").is_boolean()) {
+    instance.layer_compositor =
+        tbl->at_path("global.layer_compositor").value<bool>().value();
+  }
 
   if (tbl->at_path("view.window_type").is_string()) {
     instance.view.window_type =
@@ -146,6 +166,21 @@ void Configuration::get_cli_override(const std::string& bundle_path,
   if (cli.debug_backend.has_value()) {
     instance.debug_backend = cli.debug_backend.value();
   }
+  if (!cli.trace_file.empty()) {
+    instance.trace_file = cli.trace_file;
+  }
+  if (!cli.frame_stream.empty()) {
+    instance.frame_stream = cli.frame_stream;
+  }
+  if (!cli.frame_export.empty()) {
+    instance.frame_export = cli.frame_export;
+  }
+  if (cli.frames_in_flight.has_value()) {
+    instance.frames_in_flight = cli.frames_in_flight.value();
+  }
+  if (cli.layer_compositor.has_value()) {
+    instance.layer_compositor = cli.layer_compositor.value();
+  }
   if (!cli.view.vm_args.empty()) {
     for (auto const& arg : cli.view.vm_args) {
       instance.view.vm_args.emplace_back(arg);
@@ -235,6 +270,21 @@ void Configuration::PrintConfig(const Config& config) {
   }
   spdlog::info("Debug Backend: ........... {}",
                (config.debug_backend.value_or(false) ? "true" : "false"));
+  if (!config.trace_file.empty()) {
+    spdlog::info("Trace File: .............. {}", config.trace_file);
+  }
+  if (!config.frame_stream.empty()) {
+    spdlog::info("Frame Stream: ............ {}", config.frame_stream);
+  }
+  if (!config.frame_export.empty()) {
+    spdlog::info("Frame Export: ............ {}", config.frame_export);
+  }
+  if (config.frames_in_flight.has_value()) {
+    spdlog::info("Frames In Flight: ........ {}",
+                 config.frames_in_flight.value());
+  }
+  spdlog::info("Layer Compositor: ........ {}",
+               (config.layer_compositor.value_or(false) ? "true" : "false"));
   spdlog::info("********");
   spdlog::info("* View *");
   spdlog::info("********");
@@ -309,7 +359,23 @@ std::vector<Configuration::Config> Configuration::ParseArgcArgv(
             cxxopts::value<std::string>(config.app_id))(
             "event-mask", "Wayland Events to mask",
             cxxopts::value<std::string>(config.wayland_event_mask))(
-            "ivi-surface-id", "IVI Surface ID", cxxopts::value<uint32_t>());
+            "ivi-surface-id", "IVI Surface ID", cxxopts::value<uint32_t>())(
+            "trace-file",
+            "Trace output, Chrome JSON if *.json, else Perfetto protobuf",
+            cxxopts::value<std::string>(config.trace_file))(
+            "frame-stream",
+            "Headless frame stream, Y4M if *.y4m, else raw RGBA; a file, "
+            "FIFO or unix:<socket path>",
+            cxxopts::value<std::string>(config.frame_stream))(
+            "frame-export",
+            "Headless shared memory frame export, Unix socket path",
+            cxxopts::value<std::string>(config.frame_export))(
+            "frames-in-flight",
+            "Vulkan frames submitted ahead of the GPU, 1 to 4",
+            cxxopts::value<uint32_t>())(
+            "layer-compositor",
+            "Present Flutter layers and platform views as separate surfaces",
+            cxxopts::value<bool>());
 
     const auto result = allocated->parse(argc, argv);
 
@@ -421,6 +487,12 @@ std::vector<Configuration::Config> Configuration::ParseArgcArgv(
     if (result.count("ivi-surface-id")) {
       config.view.ivi_surface_id = result["ivi-surface-id"].as<uint32_t>();
     }
+    if (result.count("frames-in-flight")) {
+      config.frames_in_flight = result["frames-in-flight"].as<uint32_t>();
+    }
+    if (result.count("layer-compositor")) {
+      config.layer_compositor = result["layer-compositor"].as<bool>();
+    }
 
     config.view.vm_args.reserve(result.unmatched().size());
     for (const auto& option : result.unmatched()) {
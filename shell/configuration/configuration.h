@@ -30,6 +30,11 @@ class Configuration {
     std::optional<bool> disable_cursor;
     std::string wayland_event_mask;
     std::optional<bool> debug_backend;
+    std::string trace_file;
+    std::string frame_stream;
+    std::string frame_export;
+    std::optional<uint32_t> frames_in_flight;
+    std::optional<bool> layer_compositor;
     std::vector<std::string> bundle_paths;
 
     struct {
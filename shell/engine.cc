@@ -13,6 +13,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <array>
 #include <filesystem>
 #include <utility>
 #include <vector>
@@ -20,9 +21,12 @@
 #include <dlfcn.h>
 #include <cassert>
 
+#include <asio/post.hpp>
+
 #include "config/common.h"
 #include "engine.h"
 #include "hexdump.h"
+#include "trace.h"
 #include "utils.h"
 
 extern void EngineOnFlutterPlatformMessage(
@@ -62,10 +66,6 @@ Engine::Engine(FlutterView* view,
   m_platform_task_runner =
       std::make_shared<TaskRunner>("Platform", m_flutter_engine);
 
-  // Touch events
-  m_pointer_events.clear();
-  m_pointer_events.reserve(kMaxPointerEvent);
-
   ///
   /// libflutter_engine.so loading
   ///
@@ -159,6 +159,11 @@ Engine::Engine(FlutterView* view,
 
   m_args.custom_task_runners = &m_custom_task_runners;
 
+#if !BUILD_BACKEND_HEADLESS_EGL
+  // pace frames with the compositor instead of the engine's internal timer
+  m_args.vsync_callback = OnVsyncCallback;
+#endif
+
   SPDLOG_TRACE("({}) -Engine::Engine", m_index);
 }
 
@@ -173,6 +178,12 @@ Engine::~Engine() {
   m_platform_task_runner.reset();
 }
 
+void Engine::OnVsyncCallback(void* user_data, const intptr_t baton) {
+  const auto state = static_cast<FlutterDesktopEngineState*>(user_data);
+  const auto engine = state->view_controller->engine;
+  engine->m_egl_window->ScheduleVsync(engine->m_flutter_engine, baton);
+}
+
 FlutterEngineResult Engine::RunTask() {
   if (!m_flutter_engine) {
     return kSuccess;
@@ -195,7 +206,15 @@ bool Engine::IsRunning() const {
 FlutterEngineResult Engine::Run(FlutterDesktopEngineState* state) {
   SPDLOG_TRACE("({}) +Engine::Run", m_index);
 
+  m_texture_registrar = state->texture_registrar.get();
+
   const auto config = m_backend->GetRenderConfig();
+  m_compositor = m_backend->GetCompositorConfig();
+  if (m_compositor.create_backing_store_callback) {
+    // compositor callbacks get the engine state, like the renderer's
+    m_compositor.user_data = state;
+    m_args.compositor = &m_compositor;
+  }
   FlutterEngineResult result = LibFlutterEngine->Initialize(
       FLUTTER_ENGINE_VERSION, &config, &m_args, state, &m_flutter_engine);
   if (result != kSuccess) {
@@ -334,8 +353,9 @@ bool Engine::SendPlatformMessage(
 
   FlutterEngineResult result;
   if (!m_platform_task_runner->IsThreadEqual(pthread_self())) {
-    auto f = m_platform_task_runner->QueuePlatformMessage(channel,
-                                                          std::move(message));
+    // the vector is handed over as is, with the response handle
+    auto f = m_platform_task_runner->QueuePlatformMessage(
+        channel, std::move(message), response_handle);
     f.wait();
     result = f.get();
   } else {
@@ -348,6 +368,27 @@ bool Engine::SendPlatformMessage(
   return (result == kSuccess);
 }
 
+bool Engine::SendPlatformMessage(const char* channel,
+                                 MessageBufferRef message) const {
+  if (!m_running) {
+    return false;
+  }
+
+  FlutterEngineResult result;
+  if (!m_platform_task_runner->IsThreadEqual(pthread_self())) {
+    auto f = m_platform_task_runner->QueuePlatformMessage(channel,
+                                                          std::move(message));
+    f.wait();
+    result = f.get();
+  } else {
+    const FlutterPlatformMessage msg{sizeof(FlutterPlatformMessage), channel,
+                                     message->data(), message->size(),
+                                     nullptr};
+    result = LibFlutterEngine->SendPlatformMessage(m_flutter_engine, &msg);
+  }
+  return (result == kSuccess);
+}
+
 bool Engine::SendPlatformMessage(const char* channel,
                                  const uint8_t* message,
                                  const size_t message_size) const {
@@ -357,10 +398,8 @@ bool Engine::SendPlatformMessage(const char* channel,
 
   FlutterEngineResult result;
   if (!m_platform_task_runner->IsThreadEqual(pthread_self())) {
-    auto msg =
-        std::make_unique<std::vector<uint8_t>>(message, message + message_size);
-    auto f =
-        m_platform_task_runner->QueuePlatformMessage(channel, std::move(msg));
+    auto f = m_platform_task_runner->QueuePlatformMessage(
+        channel, MessageBufferPool::Instance().Copy(message, message_size));
     f.wait();
     result = f.get();
   } else {
@@ -385,10 +424,9 @@ bool Engine::SendPlatformMessage(const char* channel,
 
   FlutterEngineResult result;
   if (!m_platform_task_runner->IsThreadEqual(pthread_self())) {
-    auto msg =
-        std::make_unique<std::vector<uint8_t>>(message, message + message_size);
     auto f = m_platform_task_runner->QueuePlatformMessage(
-        channel, std::move(msg), handle);
+        channel, MessageBufferPool::Instance().Copy(message, message_size),
+        handle);
     f.wait();
     result = f.get();
   } else {
@@ -447,10 +485,10 @@ void Engine::CoalesceMouseEvent(FlutterPointerSignalKind signal,
                                 double y,
                                 double scroll_delta_x,
                                 double scroll_delta_y,
-                                int64_t buttons) {
+                                int64_t buttons,
+                                uint64_t input_ns) {
   auto timestamp = LibFlutterEngine->GetCurrentTime() / 1000;
-  std::scoped_lock lock(m_pointer_mutex);
-  m_pointer_events.emplace_back(
+  m_pointer_events.Push(
       FlutterPointerEvent{.struct_size = sizeof(FlutterPointerEvent),
                           .phase = phase,
 #if ENV64BIT
@@ -470,45 +508,81 @@ void Engine::CoalesceMouseEvent(FlutterPointerSignalKind signal,
                           .pan_x = 0,
                           .pan_y = 0,
                           .scale = 0,
-                          .rotation = 0});
+                          .rotation = 0},
+      input_ns);
 }
 
-void Engine::CoalesceTouchEvent(FlutterPointerPhase phase,
-                                double x,
-                                double y,
-                                int32_t device) {
+void Engine::CoalesceTouchFrame(const TouchFrame& frame) {
   auto timestamp = LibFlutterEngine->GetCurrentTime() / 1000;
-  std::scoped_lock lock(m_pointer_mutex);
-  m_pointer_events.emplace_back(
-      FlutterPointerEvent{.struct_size = sizeof(FlutterPointerEvent),
-                          .phase = phase,
+  std::array<FlutterPointerEvent, TouchFrame::kMaxEvents> events{};
+  std::array<uint64_t, TouchFrame::kMaxEvents> input_ns{};
+  for (size_t i = 0; i < frame.size(); i++) {
+    const auto& touch = frame.events()[i];
+    input_ns[i] = touch.input_ns;
+    events[i] =
+        FlutterPointerEvent{.struct_size = sizeof(FlutterPointerEvent),
+                            .phase = touch.phase,
 #if ENV64BIT
-                          .timestamp = timestamp,
+                            .timestamp = timestamp,
 #elif ENV32BIT
-                          .timestamp =
-                              static_cast<size_t>(timestamp & 0xFFFFFFFFULL),
+                            .timestamp =
+                                static_cast<size_t>(timestamp & 0xFFFFFFFFULL),
 #endif
-                          .x = x,
-                          .y = y,
-                          .device = device,
-                          .signal_kind = kFlutterPointerSignalKindNone,
-                          .scroll_delta_x = 0.0,
-                          .scroll_delta_y = 0.0,
-                          .device_kind = kFlutterPointerDeviceKindTouch,
-                          .buttons = 0,
-                          .pan_x = 0,
-                          .pan_y = 0,
-                          .scale = 0,
-                          .rotation = 0});
+                            .x = touch.x,
+                            .y = touch.y,
+                            .device = touch.device,
+                            .signal_kind = kFlutterPointerSignalKindNone,
+                            .scroll_delta_x = 0.0,
+                            .scroll_delta_y = 0.0,
+                            .device_kind = kFlutterPointerDeviceKindTouch,
+                            .buttons = 0,
+                            .pan_x = 0,
+                            .pan_y = 0,
+                            .scale = 0,
+                            .rotation = 0};
+  }
+  if (!m_pointer_events.Push(events.data(), frame.size(), input_ns.data())) {
+    spdlog::warn("({}) Pointer event queue full, dropped touch frame", m_index);
+  }
 }
 
 void Engine::SendPointerEvents() {
-  if (!m_pointer_events.empty() && m_flutter_engine) {
-    std::scoped_lock lock(m_pointer_mutex);
-    LibFlutterEngine->SendPointerEvent(
-        m_flutter_engine, m_pointer_events.data(), m_pointer_events.size());
-    m_pointer_events.clear();
+  TRACE_SCOPE("Engine::SendPointerEvents");
+  m_pointer_events.Flush(m_flutter_engine);
+}
+
+bool Engine::MarkTextureFrameAvailable(const int64_t texture_id) {
+  if (!m_texture_frames.Mark(texture_id)) {
+    // a flush is pending already
+    return true;
+  }
+  if (!m_args.vsync_callback || !LibFlutterEngine->ScheduleFrame) {
+    // without vsync pacing there is no frame boundary, the platform thread
+    // flushes instead
+    asio::post(*m_platform_task_runner->GetStrandContext(),
+               [this] { SendTextureFrames(); });
+    return true;
   }
+  // an idle engine requests no vsync, the frame brings the flush
+  return kSuccess == LibFlutterEngine->ScheduleFrame(m_flutter_engine);
+}
+
+void Engine::SendTextureFrames() {
+  TRACE_SCOPE("Engine::SendTextureFrames");
+  // pixel buffers are copied here, never on the threads of their plugins
+  m_texture_frames.Flush(m_flutter_engine,
+                         FlutterDesktopTextureRegistrarUploadPixelBuffers,
+                         m_texture_registrar);
+}
+
+void Engine::OnRasterStart() {
+  m_frame_timing.OnRasterStart(LibFlutterEngine->GetCurrentTime());
+}
+
+void Engine::OnFramePresented(const uint64_t damage_area) {
+  const auto now = LibFlutterEngine->GetCurrentTime();
+  m_input_latency.OnPresent(now);
+  m_frame_timing.OnPresent(now, damage_area);
 }
 
 FlutterEngineAOTData Engine::LoadAotData(const std::string& bundle_path) const {
@@ -542,6 +616,7 @@ bool Engine::ActivateSystemCursor(const int32_t device,
 void Engine::OnFlutterPlatformMessage(
     const FlutterPlatformMessage* engine_message,
     void* user_data) {
+  TRACE_SCOPE("Engine::OnFlutterPlatformMessage");
   if (engine_message->struct_size != sizeof(FlutterPlatformMessage)) {
     spdlog::error("Invalid message size received. Expected: {} but received {}",
                   sizeof(FlutterPlatformMessage), engine_message->struct_size);
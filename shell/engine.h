@@ -31,9 +31,13 @@
 #include "backend/backend.h"
 #include "config/common.h"
 #include "flutter_desktop_engine_state.h"
+#include "frame_timing.h"
 #include "logging/logging.h"
+#include "pointer_event_queue.h"
 #include "task_runner.h"
+#include "texture_frame_queue.h"
 #include "view/flutter_view.h"
+#include "wayland/touch_frame.h"
 
 class App;
 class Backend;
@@ -178,6 +182,18 @@ class Engine {
                            const FlutterPlatformMessageResponseHandle*
                                response_handle = nullptr) const;
 
+  /**
+   * @brief Send platform message without copying the payload
+   * @param[in] channel Destination channel
+   * @param[in] message Pooled message buffer, see MessageBufferPool
+   * @return bool
+   * @retval true If successed to send message
+   * @retval false If failed to send message
+   * @relation
+   * flutter
+   */
+  bool SendPlatformMessage(const char* channel, MessageBufferRef message) const;
+
   /**
    * @brief Send platform message
    * @param[in] channel Destination channel
@@ -263,6 +279,7 @@ class Engine {
    * @param[in] scroll_delta_x X offset of the scroll
    * @param[in] scroll_delta_y Y offset of the scroll
    * @param[in] buttons Buttons currently pressed, if any
+   * @param[in] input_ns Wayland input time, 0 if unknown
    * @return void
    * @relation
    * flutter
@@ -273,22 +290,17 @@ class Engine {
                           double y,
                           double scroll_delta_x,
                           double scroll_delta_y,
-                          int64_t buttons);
+                          int64_t buttons,
+                          uint64_t input_ns);
 
   /**
-   * @brief Coalesce touch event
-   * @param[in] phase Phase of the pointer event
-   * @param[in] x X coordinate of the pointer event
-   * @param[in] y Y coordinate of the pointer event
-   * @param[in] device Device identifier
+   * @brief Queue the staged events of a wl_touch frame as one group
+   * @param[in] frame Touch frame to commit
    * @return void
    * @relation
    * flutter
    */
-  void CoalesceTouchEvent(FlutterPointerPhase phase,
-                          double x,
-                          double y,
-                          int32_t device);
+  void CoalesceTouchFrame(const TouchFrame& frame);
 
   /**
    * @brief Send coalesced Pointer events
@@ -298,6 +310,83 @@ class Engine {
    */
   void SendPointerEvents();
 
+  /**
+   * @brief Return and reset the input-to-engine statistics
+   * @return PointerEventQueue::Stats
+   * @relation
+   * flutter
+   */
+  PointerEventQueue::Stats TakePointerEventStats() {
+    return m_pointer_events.TakeStats();
+  }
+
+  /**
+   * @brief A plugin texture has a new frame, called from any thread.  The
+   * engine is told at the next frame boundary, once per texture, after the
+   * pixel buffer of the texture is copied.
+   * @param[in] texture_id Texture id
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * flutter
+   */
+  bool MarkTextureFrameAvailable(int64_t texture_id);
+
+  /**
+   * @brief Upload the pixel buffers of the coalesced texture frames and send
+   * the frames, platform thread
+   * @return void
+   * @relation
+   * flutter
+   */
+  void SendTextureFrames();
+
+  /**
+   * @brief Return and reset the texture frame statistics
+   * @return TextureFrameQueue::Stats
+   * @relation
+   * flutter
+   */
+  TextureFrameQueue::Stats TakeTextureFrameStats() {
+    return m_texture_frames.TakeStats();
+  }
+
+  /**
+   * @brief The raster thread made its context current, called from the
+   * raster thread
+   * @return void
+   * @relation
+   * flutter
+   */
+  void OnRasterStart();
+
+  /**
+   * @brief A frame was handed to the compositor, called from the raster
+   * thread
+   * @param[in] damage_area Damaged pixels of the frame
+   * @return void
+   * @relation
+   * flutter
+   */
+  void OnFramePresented(uint64_t damage_area);
+
+  /**
+   * @brief Get the input latency histograms of this engine
+   * @return InputLatency&
+   * @relation
+   * flutter
+   */
+  InputLatency& GetInputLatency() { return m_input_latency; }
+
+  /**
+   * @brief Get the frame timing ring of this engine
+   * @return FrameTiming&
+   * @relation
+   * flutter
+   */
+  FrameTiming& GetFrameTiming() { return m_frame_timing; }
+
   /**
    * @brief Activate system cursor
    * @param[in] device No use
@@ -329,6 +418,16 @@ class Engine {
       const FlutterPlatformMessage* engine_message,
       void* user_data);
 
+  /**
+   * @brief Vsync request from the engine, answered by the view's window
+   * @param[in] user_data Pointer to FlutterDesktopEngineState
+   * @param[in] baton Baton to return with FlutterEngineOnVsync
+   * @return void
+   * @relation
+   * flutter, wayland
+   */
+  static void OnVsyncCallback(void* user_data, intptr_t baton);
+
   static void onLogMessageCallback(const char* tag,
                                    const char* message,
                                    void* user_data);
@@ -365,6 +464,8 @@ class Engine {
   std::shared_ptr<TaskRunner> m_platform_task_runner;
   FlutterTaskRunnerDescription m_platform_task_runner_description{};
   FlutterCustomTaskRunners m_custom_task_runners{};
+  /// set when the backend composites layers itself
+  FlutterCompositor m_compositor{};
 
   FlutterEngineAOTData m_aot_data;
 
@@ -387,6 +488,10 @@ class Engine {
    */
   void SetUpLocales() const;
 
-  std::vector<FlutterPointerEvent> m_pointer_events;
-  std::mutex m_pointer_mutex;
+  FrameTiming m_frame_timing;
+  InputLatency m_input_latency;
+  PointerEventQueue m_pointer_events{&m_input_latency};
+  TextureFrameQueue m_texture_frames;
+  /// pixel buffer textures uploaded by SendTextureFrames()
+  FlutterDesktopTextureRegistrar* m_texture_registrar{};
 };
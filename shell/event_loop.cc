@@ -0,0 +1,143 @@
+/*
+ * Copyright 2020 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "event_loop.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "logging.h"
+
+EventLoop::EventLoop() : m_epoll_fd(epoll_create1(EPOLL_CLOEXEC)) {
+  if (m_epoll_fd < 0) {
+    spdlog::critical("Failed to create epoll fd. {}", strerror(errno));
+    exit(-1);
+  }
+}
+
+EventLoop::~EventLoop() {
+  close(m_epoll_fd);
+  m_epoll_fd = -1;
+}
+
+bool EventLoop::AddFd(const int fd,
+                      const uint32_t events,
+                      const event_source_cb callback,
+                      void* data) {
+  std::scoped_lock lock(m_sources_mutex);
+  auto& source =
+      m_sources.emplace_back(event_source{fd, callback, data, false});
+
+  epoll_event ep{};
+  ep.events = events;
+  ep.data.ptr = &source;
+  if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ep) < 0) {
+    spdlog::error("EventLoop: failed to watch fd {}: {}", fd, strerror(errno));
+    m_sources.pop_back();
+    return false;
+  }
+  return true;
+}
+
+void EventLoop::RemoveFd(const int fd) {
+  std::scoped_lock lock(m_sources_mutex);
+  for (auto& source : m_sources) {
+    if (source.fd == fd && !source.removed) {
+      epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+      // storage is reclaimed by the owning thread in Wait(), as a pending
+      // ready entry may still reference it
+      source.removed = true;
+      return;
+    }
+  }
+}
+
+int EventLoop::Wait(const int timeout_ms) {
+  {
+    std::scoped_lock lock(m_sources_mutex);
+    m_sources.remove_if([](const event_source& s) { return s.removed; });
+  }
+
+  m_ready_count = 0;
+  const auto ready = epoll_wait(m_epoll_fd, m_ready, kMaxEvents, timeout_ms);
+  if (ready < 0) {
+    if (errno == EINTR) {
+      return 0;
+    }
+    spdlog::error("EventLoop: epoll_wait failed: {}", strerror(errno));
+    return -1;
+  }
+  m_ready_count = ready;
+  return ready;
+}
+
+bool EventLoop::IsReady(const int fd) const {
+  for (auto i = 0; i < m_ready_count; i++) {
+    if (static_cast<const event_source*>(m_ready[i].data.ptr)->fd == fd) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int EventLoop::Dispatch() {
+  int dispatched = 0;
+  for (auto i = 0; i < m_ready_count; i++) {
+    const auto source = static_cast<event_source*>(m_ready[i].data.ptr);
+    event_source_cb callback;
+    void* data;
+    {
+      std::scoped_lock lock(m_sources_mutex);
+      if (source->removed) {
+        continue;
+      }
+      callback = source->callback;
+      data = source->data;
+    }
+    if (callback) {
+      callback(data, source->fd, m_ready[i].events);
+      dispatched++;
+    }
+  }
+  m_ready_count = 0;
+  return dispatched;
+}
+
+int EventLoop::CreateWakeupFd() {
+  const auto fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (fd < 0) {
+    spdlog::critical("Failed to create eventfd. {}", strerror(errno));
+    exit(-1);
+  }
+  return fd;
+}
+
+void EventLoop::Signal(const int fd) {
+  constexpr uint64_t value = 1;
+  if (write(fd, &value, sizeof(value)) != sizeof(value) && errno != EAGAIN) {
+    spdlog::error("EventLoop: failed to signal fd {}: {}", fd,
+                  strerror(errno));
+  }
+}
+
+void EventLoop::Drain(const int fd) {
+  uint64_t value;
+  while (read(fd, &value, sizeof(value)) == sizeof(value)) {
+  }
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2020 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+
+#include <sys/epoll.h>
+
+#include "config/common.h"
+
+typedef void (*event_source_cb)(void* data, int fd, uint32_t events);
+
+/**
+ * @brief epoll based reactor driving the main (Wayland) thread.
+ *
+ * Sources are registered by fd.  Wait() blocks until at least one source is
+ * ready or the timeout expires, and records the ready set.  Dispatch() then
+ * runs the callbacks of the ready sources.  The two steps are split so the
+ * caller can complete a wl_display_prepare_read() cycle before any callback
+ * is allowed to touch Wayland.
+ *
+ * AddFd()/RemoveFd() may be called from any thread.  Wait()/Dispatch() must
+ * only be called from the thread owning the loop.
+ */
+class EventLoop {
+ public:
+  static constexpr int kMaxEvents = 32;
+
+  EventLoop();
+  ~EventLoop();
+  EventLoop(const EventLoop&) = delete;
+  const EventLoop& operator=(const EventLoop&) = delete;
+
+  /**
+   * @brief Register a file descriptor
+   * @param[in] fd file descriptor to watch
+   * @param[in] events epoll events to watch for
+   * @param[in] callback invoked from Dispatch() when ready, may be nullptr
+   * @param[in] data user data passed to callback
+   * @return bool
+   * @retval true if registered
+   * @retval false if registration failed
+   * @relation
+   * internal
+   */
+  bool AddFd(int fd, uint32_t events, event_source_cb callback, void* data);
+
+  /**
+   * @brief Unregister a file descriptor
+   * @param[in] fd file descriptor previously passed to AddFd
+   * @return void
+   * @relation
+   * internal
+   */
+  void RemoveFd(int fd);
+
+  /**
+   * @brief Block until a source is ready or timeout expires
+   * @param[in] timeout_ms timeout in milliseconds, -1 to block indefinitely
+   * @return int
+   * @retval Number of ready sources, 0 on timeout or signal, -1 on error
+   * @relation
+   * internal
+   */
+  int Wait(int timeout_ms);
+
+  /**
+   * @brief Check if fd was reported ready by the last Wait()
+   * @param[in] fd file descriptor
+   * @return bool
+   * @retval true if ready
+   * @retval false if not ready
+   * @relation
+   * internal
+   */
+  NODISCARD bool IsReady(int fd) const;
+
+  /**
+   * @brief Run callbacks of the sources reported ready by the last Wait()
+   * @return int
+   * @retval Number of callbacks run
+   * @relation
+   * internal
+   */
+  int Dispatch();
+
+  /**
+   * @brief Get the epoll fd, so the loop can be nested in another poller
+   * @return int
+   * @retval epoll fd
+   * @relation
+   * internal
+   */
+  NODISCARD int GetFd() const { return m_epoll_fd; }
+
+  /**
+   * @brief Create a non-blocking eventfd usable as a wakeup source
+   * @return int
+   * @retval eventfd, exits on failure
+   * @relation
+   * internal
+   */
+  static int CreateWakeupFd();
+
+  /**
+   * @brief Signal a wakeup fd created by CreateWakeupFd
+   * @param[in] fd wakeup fd
+   * @return void
+   * @relation
+   * internal
+   */
+  static void Signal(int fd);
+
+  /**
+   * @brief Drain a wakeup fd created by CreateWakeupFd
+   * @param[in] fd wakeup fd
+   * @return void
+   * @relation
+   * internal
+   */
+  static void Drain(int fd);
+
+ private:
+  struct event_source {
+    int fd;
+    event_source_cb callback;
+    void* data;
+    bool removed;
+  };
+
+  int m_epoll_fd;
+  std::mutex m_sources_mutex;
+  std::list<event_source> m_sources;
+  epoll_event m_ready[kMaxEvents]{};
+  int m_ready_count{};
+};
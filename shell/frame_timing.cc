@@ -0,0 +1,185 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "frame_timing.h"
+
+#include <algorithm>
+
+namespace {
+/// nearest-rank percentile of sorted |values|
+uint64_t Percentile(const uint64_t* values,
+                    const size_t count,
+                    const unsigned percentile) {
+  const auto rank = (count * percentile + 99) / 100;
+  return values[rank ? rank - 1 : 0];
+}
+}  // namespace
+
+void FrameTiming::OnVsync(const uint64_t start_ns, const uint64_t target_ns) {
+  const auto number = m_vsync_count.load(std::memory_order_relaxed) + 1;
+  auto& slot = m_vsync[number % kVsyncSlots];
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.start_ns.store(start_ns, std::memory_order_relaxed);
+  slot.target_ns.store(target_ns, std::memory_order_relaxed);
+  slot.sequence.store(number, std::memory_order_release);
+  m_vsync_count.store(number, std::memory_order_release);
+}
+
+void FrameTiming::OnRasterStart(const uint64_t now_ns) {
+  if (m_raster_start_ns) {
+    return;
+  }
+  m_raster_start_ns = now_ns;
+  m_vsync_start_ns = 0;
+  m_vsync_target_ns = 0;
+
+  const auto latest = m_vsync_count.load(std::memory_order_acquire);
+  if (latest == m_vsync_consumed) {
+    return;
+  }
+  // the oldest vsync still in the pipeline; older ones produced no frame
+  auto number = m_vsync_consumed + 1;
+  if (latest - number >= kPipelineDepth) {
+    number = latest - kPipelineDepth + 1;
+  }
+  m_vsync_consumed = number;
+
+  const auto& slot = m_vsync[number % kVsyncSlots];
+  if (slot.sequence.load(std::memory_order_acquire) != number) {
+    return;
+  }
+  const auto start_ns = slot.start_ns.load(std::memory_order_relaxed);
+  const auto target_ns = slot.target_ns.load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (slot.sequence.load(std::memory_order_relaxed) != number ||
+      start_ns > now_ns) {
+    return;
+  }
+  m_vsync_start_ns = start_ns;
+  m_vsync_target_ns = target_ns;
+}
+
+void FrameTiming::OnPresent(const uint64_t now_ns,
+                            const uint64_t damage_area) {
+  if (!m_raster_start_ns) {
+    m_raster_start_ns = now_ns;
+  }
+  const Frame frame{
+      .number = m_frames.load(std::memory_order_relaxed) + 1,
+      .vsync_start_ns = m_vsync_start_ns,
+      .vsync_target_ns = m_vsync_target_ns,
+      .raster_start_ns = m_raster_start_ns,
+      .present_ns = now_ns,
+      .damage_area = damage_area,
+  };
+  m_raster_start_ns = 0;
+
+  if (frame.IsJanky()) {
+    const auto period = frame.vsync_target_ns - frame.vsync_start_ns;
+    m_janky.fetch_add(1, std::memory_order_relaxed);
+    m_missed.fetch_add(
+        period ? (frame.present_ns - frame.vsync_target_ns) / period + 1 : 1,
+        std::memory_order_relaxed);
+  }
+  Publish(frame);
+}
+
+void FrameTiming::Publish(const Frame& frame) {
+  auto& slot = m_slots[(frame.number - 1) & kMask];
+  slot.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.vsync_start_ns.store(frame.vsync_start_ns, std::memory_order_relaxed);
+  slot.vsync_target_ns.store(frame.vsync_target_ns, std::memory_order_relaxed);
+  slot.raster_start_ns.store(frame.raster_start_ns, std::memory_order_relaxed);
+  slot.present_ns.store(frame.present_ns, std::memory_order_relaxed);
+  slot.damage_area.store(frame.damage_area, std::memory_order_relaxed);
+  slot.sequence.store(frame.number, std::memory_order_release);
+  m_frames.store(frame.number, std::memory_order_release);
+}
+
+size_t FrameTiming::Snapshot(Frame* frames, const uint64_t after_frame) const {
+  const auto last = m_frames.load(std::memory_order_acquire);
+  const auto first =
+      std::max<uint64_t>(after_frame, last > kFrames ? last - kFrames : 0) + 1;
+
+  size_t count = 0;
+  for (auto number = first; number <= last; number++) {
+    const auto& slot = m_slots[(number - 1) & kMask];
+    if (slot.sequence.load(std::memory_order_acquire) != number) {
+      continue;
+    }
+    const Frame frame{
+        .number = number,
+        .vsync_start_ns = slot.vsync_start_ns.load(std::memory_order_relaxed),
+        .vsync_target_ns =
+            slot.vsync_target_ns.load(std::memory_order_relaxed),
+        .raster_start_ns =
+            slot.raster_start_ns.load(std::memory_order_relaxed),
+        .present_ns = slot.present_ns.load(std::memory_order_relaxed),
+        .damage_area = slot.damage_area.load(std::memory_order_relaxed),
+    };
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // overwritten by a newer frame while copying
+    if (slot.sequence.load(std::memory_order_relaxed) != number) {
+      continue;
+    }
+    frames[count++] = frame;
+  }
+  return count;
+}
+
+FrameTiming::Summary FrameTiming::GetSummary(const uint64_t after_frame) const {
+  Summary summary{};
+  summary.janky_frames = m_janky.load(std::memory_order_relaxed);
+  summary.missed_vsyncs = m_missed.load(std::memory_order_relaxed);
+  summary.total_frames = m_frames.load(std::memory_order_relaxed);
+  summary.last_frame = after_frame;
+
+  std::array<Frame, kFrames> frames{};
+  const auto count = Snapshot(frames.data(), after_frame);
+  if (!count) {
+    return summary;
+  }
+  const auto& first = frames[0];
+  const auto& last = frames[count - 1];
+  summary.frames = count;
+  summary.last_frame = last.number;
+  if (last.present_ns > first.present_ns) {
+    summary.fps = static_cast<double>(count - 1) * 1e9 /
+                  static_cast<double>(last.present_ns - first.present_ns);
+  }
+
+  std::array<uint64_t, kFrames> frame_us{};
+  std::array<uint64_t, kFrames> raster_us{};
+  uint64_t damage = 0;
+  for (size_t i = 0; i < count; i++) {
+    frame_us[i] = frames[i].FrameTime() / 1000;
+    raster_us[i] = frames[i].RasterTime() / 1000;
+    damage += frames[i].damage_area;
+  }
+  std::sort(frame_us.begin(), frame_us.begin() + count);
+  std::sort(raster_us.begin(), raster_us.begin() + count);
+
+  summary.frame_p50_us = Percentile(frame_us.data(), count, 50);
+  summary.frame_p90_us = Percentile(frame_us.data(), count, 90);
+  summary.frame_p99_us = Percentile(frame_us.data(), count, 99);
+  summary.raster_p50_us = Percentile(raster_us.data(), count, 50);
+  summary.raster_p90_us = Percentile(raster_us.data(), count, 90);
+  summary.raster_p99_us = Percentile(raster_us.data(), count, 99);
+  summary.damage_avg = damage / count;
+  return summary;
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "config/common.h"
+
+/**
+ * @brief Timing of the most recent frames of one view.
+ *
+ * The main thread records each vsync it answers, the raster thread records
+ * raster start and present and publishes one record per frame into a ring.
+ * Every slot is a sequence lock, so readers on any thread copy the ring
+ * without ever blocking the raster thread; a slot overwritten while being
+ * read is skipped.
+ *
+ * All times are CLOCK_MONOTONIC nanoseconds.
+ */
+class FrameTiming {
+ public:
+  /// frames kept, power of two
+  static constexpr size_t kFrames = 256;
+  /// answered vsyncs a raster may lag behind, the engine pipeline depth
+  static constexpr uint64_t kPipelineDepth = 2;
+
+  struct Frame {
+    /// 1 based present order
+    uint64_t number;
+    /// vsync the frame was built for, 0 if not paced by vsync
+    uint64_t vsync_start_ns;
+    uint64_t vsync_target_ns;
+    uint64_t raster_start_ns;
+    uint64_t present_ns;
+    /// damaged pixels
+    uint64_t damage_area;
+
+    /// vsync (or raster) start to present
+    NODISCARD uint64_t FrameTime() const {
+      return present_ns - (vsync_start_ns ? vsync_start_ns : raster_start_ns);
+    }
+
+    NODISCARD uint64_t RasterTime() const {
+      return present_ns - raster_start_ns;
+    }
+
+    /// presented after its vsync target
+    NODISCARD bool IsJanky() const {
+      return vsync_target_ns && present_ns > vsync_target_ns;
+    }
+  };
+
+  struct Summary {
+    /// frames summarised
+    uint64_t frames;
+    /// number of the last frame summarised
+    uint64_t last_frame;
+    /// present rate over the summarised frames
+    double fps;
+    uint64_t frame_p50_us;
+    uint64_t frame_p90_us;
+    uint64_t frame_p99_us;
+    uint64_t raster_p50_us;
+    uint64_t raster_p90_us;
+    uint64_t raster_p99_us;
+    uint64_t damage_avg;
+    /// counters since start, not limited to the ring
+    uint64_t total_frames;
+    uint64_t janky_frames;
+    /// vsync intervals skipped by janky frames
+    uint64_t missed_vsyncs;
+  };
+
+  /**
+   * @brief A vsync was answered, called from the main thread
+   * @param[in] start_ns Frame start handed to the engine
+   * @param[in] target_ns Frame target handed to the engine
+   * @return void
+   * @relation
+   * flutter
+   */
+  void OnVsync(uint64_t start_ns, uint64_t target_ns);
+
+  /**
+   * @brief The raster thread made its context current; the first call
+   * after a present starts the next frame
+   * @param[in] now_ns Current time
+   * @return void
+   * @relation
+   * flutter
+   */
+  void OnRasterStart(uint64_t now_ns);
+
+  /**
+   * @brief A frame was presented, called from the raster thread
+   * @param[in] now_ns Current time
+   * @param[in] damage_area Damaged pixels of the frame
+   * @return void
+   * @relation
+   * flutter
+   */
+  void OnPresent(uint64_t now_ns, uint64_t damage_area);
+
+  /**
+   * @brief Copy the recorded frames, oldest first; safe on any thread
+   * @param[out] frames Destination, at least kFrames entries
+   * @param[in] after_frame Skip frames up to and including this number
+   * @return size_t
+   * @retval Number of frames copied
+   * @relation
+   * internal
+   */
+  size_t Snapshot(Frame* frames, uint64_t after_frame = 0) const;
+
+  /**
+   * @brief Summarise the frames in the ring; safe on any thread
+   * @param[in] after_frame Skip frames up to and including this number
+   * @return Summary
+   * @relation
+   * internal
+   */
+  NODISCARD Summary GetSummary(uint64_t after_frame = 0) const;
+
+ private:
+  static constexpr size_t kMask = kFrames - 1;
+  static constexpr size_t kVsyncSlots = 4;
+
+  struct Slot {
+    /// frame number once complete, 0 while being written
+    std::atomic<uint64_t> sequence{};
+    std::atomic<uint64_t> vsync_start_ns{};
+    std::atomic<uint64_t> vsync_target_ns{};
+    std::atomic<uint64_t> raster_start_ns{};
+    std::atomic<uint64_t> present_ns{};
+    std::atomic<uint64_t> damage_area{};
+  };
+
+  struct VsyncSlot {
+    /// vsync number once complete, 0 while being written
+    std::atomic<uint64_t> sequence{};
+    std::atomic<uint64_t> start_ns{};
+    std::atomic<uint64_t> target_ns{};
+  };
+
+  void Publish(const Frame& frame);
+
+  std::array<Slot, kFrames> m_slots{};
+  alignas(64) std::atomic<uint64_t> m_frames{};
+  std::atomic<uint64_t> m_janky{};
+  std::atomic<uint64_t> m_missed{};
+
+  // main thread
+  alignas(64) std::array<VsyncSlot, kVsyncSlots> m_vsync{};
+  std::atomic<uint64_t> m_vsync_count{};
+
+  // raster thread
+  alignas(64) uint64_t m_vsync_consumed{};
+  uint64_t m_raster_start_ns{};
+  uint64_t m_vsync_start_ns{};
+  uint64_t m_vsync_target_ns{};
+};
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Reusable storage for one outstanding asio handler.
+ *
+ * asio allocates its operation object through the handler's associated
+ * allocator.  Binding a handler to this block lets a handler that is posted
+ * over and over (with at most one in flight) reuse the same memory instead of
+ * hitting the heap.  A second concurrent allocation falls back to the heap.
+ */
+class handler_memory {
+ public:
+  static constexpr size_t kSize = 256;
+
+  handler_memory() = default;
+  handler_memory(const handler_memory&) = delete;
+  handler_memory& operator=(const handler_memory&) = delete;
+
+  void* allocate(const size_t size) {
+    bool expected = false;
+    if (size <= kSize &&
+        in_use_.compare_exchange_strong(expected, true,
+                                        std::memory_order_acquire)) {
+      return &storage_;
+    }
+    return ::operator new(size);
+  }
+
+  void deallocate(void* pointer) {
+    if (pointer == &storage_) {
+      in_use_.store(false, std::memory_order_release);
+    } else {
+      ::operator delete(pointer);
+    }
+  }
+
+ private:
+  std::aligned_storage_t<kSize> storage_{};
+  std::atomic<bool> in_use_{false};
+};
+
+/**
+ * @brief Minimal allocator handing out a handler_memory block
+ */
+template <typename T>
+class handler_allocator {
+ public:
+  using value_type = T;
+
+  explicit handler_allocator(handler_memory& mem) : memory_(mem) {}
+
+  template <typename U>
+  explicit handler_allocator(const handler_allocator<U>& other) noexcept
+      : memory_(other.memory_) {}
+
+  bool operator==(const handler_allocator& other) const noexcept {
+    return &memory_ == &other.memory_;
+  }
+
+  bool operator!=(const handler_allocator& other) const noexcept {
+    return &memory_ != &other.memory_;
+  }
+
+  T* allocate(const size_t n) const {
+    return static_cast<T*>(memory_.allocate(sizeof(T) * n));
+  }
+
+  void deallocate(T* const p, size_t /* n */) const { memory_.deallocate(p); }
+
+ private:
+  template <typename>
+  friend class handler_allocator;
+
+  handler_memory& memory_;
+};
+
+/**
+ * @brief Handler wrapper exposing a handler_allocator to asio
+ */
+template <typename Handler>
+class custom_alloc_handler {
+ public:
+  using allocator_type = handler_allocator<Handler>;
+
+  custom_alloc_handler(handler_memory& m, Handler h)
+      : memory_(m), handler_(std::move(h)) {}
+
+  allocator_type get_allocator() const noexcept {
+    return allocator_type(memory_);
+  }
+
+  template <typename... Args>
+  void operator()(Args&&... args) {
+    handler_(std::forward<Args>(args)...);
+  }
+
+ private:
+  handler_memory& memory_;
+  Handler handler_;
+};
+
+template <typename Handler>
+inline custom_alloc_handler<Handler> make_custom_alloc_handler(
+    handler_memory& m,
+    Handler h) {
+  return custom_alloc_handler<Handler>(m, std::move(h));
+}
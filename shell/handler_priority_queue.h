@@ -16,117 +16,170 @@
 
 #pragma once
 
-#include <queue>
-
-#include "asio/bind_executor.hpp"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include "flutter/shell/platform/embedder/embedder.h"
 
+#include "config/common.h"
 #include "libflutter_engine.h"
 #include "logging/logging.h"
+#include "trace.h"
 
-class handler_priority_queue : public asio::execution_context {
+/**
+ * @brief Pooled min-heap of Flutter tasks ordered by target time.
+ *
+ * Task records are fixed size and recycled through a free list, and the heap
+ * stores record pointers in storage reserved for the whole pool, so once the
+ * pool has grown to the working set neither producers nor the consumer touch
+ * the heap allocator.
+ *
+ * add() may be called from any thread.  collect(), execute_all(), empty() and
+ * next_timestamp() belong to the consumer (runner) thread.
+ */
+class handler_priority_queue {
  public:
-  template <typename Function>
-  void add(uint64_t priority, Function function) {
-    std::unique_ptr<queued_handler_base> handler(
-        new queued_handler<Function>(priority, std::move(function)));
-
-    handlers_.push(std::move(handler));
-  }
-
-  void execute_all(FlutterEngine& /* engine */) {
-    while (!handlers_.empty()) {
-      const auto current = LibFlutterEngine->GetCurrentTime();
-      const auto target_time = handlers_.top()->GetTimestamp();
-      if (current >= target_time) {
-        handlers_.top()->execute();
-        handlers_.pop();
-      } else {
-        spdlog::debug("Task Pending Delta: {}", target_time - current);
-        break;
-      }
+  static constexpr size_t kPoolChunkSize = 128;
+
+  handler_priority_queue() { grow(); }
+
+  handler_priority_queue(const handler_priority_queue&) = delete;
+  handler_priority_queue& operator=(const handler_priority_queue&) = delete;
+
+  /**
+   * @brief Submit a task
+   * @param[in] target_time Engine time at which the task is due
+   * @param[in] task Task to run
+   * @return bool
+   * @retval true if the consumer has to be woken to collect()
+   * @retval false if a wakeup is already pending
+   * @relation
+   * flutter
+   */
+  bool add(const uint64_t target_time, const FlutterTask& task) {
+    std::scoped_lock lock(mutex_);
+    if (!free_) {
+      grow();
     }
-  }
-
-  class executor {
-   public:
-    executor(handler_priority_queue& q, uint64_t t)
-        : context_(q), timestamp_(t) {}
-
-    NODISCARD handler_priority_queue& context() const noexcept {
-      return context_;
+    queued_task* record = free_;
+    free_ = record->next;
+
+    record->target_time = target_time;
+    record->sequence = sequence_++;
+    record->task = task;
+    record->next = nullptr;
+
+    if (incoming_tail_) {
+      incoming_tail_->next = record;
+    } else {
+      incoming_head_ = record;
     }
+    incoming_tail_ = record;
 
-    template <typename Function, typename Allocator>
-    void dispatch(Function f, const Allocator&) const {
-      context_.add(timestamp_, std::move(f));
-    }
+    const bool wake = !wake_pending_;
+    wake_pending_ = true;
+    return wake;
+  }
 
-    template <typename Function, typename Allocator>
-    void post(Function f, const Allocator&) const {
-      context_.add(timestamp_, std::move(f));
+  /**
+   * @brief Move submitted tasks into the heap
+   * @return void
+   * @relation
+   * flutter
+   */
+  void collect() {
+    queued_task* record;
+    size_t capacity;
+    {
+      std::scoped_lock lock(mutex_);
+      record = incoming_head_;
+      incoming_head_ = incoming_tail_ = nullptr;
+      wake_pending_ = false;
+      capacity = chunks_.size() * kPoolChunkSize;
     }
-
-    template <typename Function, typename Allocator>
-    void defer(Function f, const Allocator&) const {
-      context_.add(timestamp_, std::move(f));
+    // every record can be in the heap at once; only reallocates after the
+    // pool grew
+    heap_.reserve(capacity);
+    while (record) {
+      queued_task* next = record->next;
+      heap_.push_back(record);
+      std::push_heap(heap_.begin(), heap_.end(), later);
+      record = next;
     }
+  }
 
-    void on_work_started() const noexcept {}
-    void on_work_finished() const noexcept {}
-
-    bool operator==(const executor& other) const noexcept {
-      return &context_ == &other.context_ && timestamp_ == other.timestamp_;
-    }
+  /**
+   * @brief Run all tasks that are due
+   * @param[in] engine Engine to run the tasks on
+   * @return void
+   * @relation
+   * flutter
+   */
+  void execute_all(FlutterEngine& engine) {
+    while (!heap_.empty()) {
+      const auto current = LibFlutterEngine->GetCurrentTime();
+      queued_task* record = heap_.front();
+      if (current < record->target_time) {
+        SPDLOG_DEBUG("Task Pending Delta: {}", record->target_time - current);
+        break;
+      }
+      std::pop_heap(heap_.begin(), heap_.end(), later);
+      heap_.pop_back();
 
-    bool operator!=(const executor& other) const noexcept {
-      return !operator==(other);
+      const FlutterTask task = record->task;
+      release(record);
+      TRACE_SCOPE("FlutterEngineRunTask");
+      LibFlutterEngine->RunTask(engine, &task);
     }
+  }
 
-   private:
-    handler_priority_queue& context_;
-    uint64_t timestamp_;
-  };
+  NODISCARD bool empty() const { return heap_.empty(); }
 
-  template <typename Handler>
-  asio::executor_binder<Handler, executor> wrap(uint64_t timestamp,
-                                                Handler handler) {
-    return asio::bind_executor(executor(*this, timestamp), std::move(handler));
+  /// deadline of the earliest queued task, queue must not be empty
+  NODISCARD uint64_t next_timestamp() const {
+    return heap_.front()->target_time;
   }
 
  private:
-  class queued_handler_base {
-   public:
-    explicit queued_handler_base(uint64_t t) : timestamp_(t) {}
-
-    virtual ~queued_handler_base() = default;
-
-    virtual void execute() = 0;
-
-    NODISCARD uint64_t GetTimestamp() const { return timestamp_; }
+  struct queued_task {
+    uint64_t target_time;
+    uint64_t sequence;
+    FlutterTask task;
+    queued_task* next;
+  };
 
-    friend bool operator<(
-        const std::unique_ptr<queued_handler_base>& a,
-        const std::unique_ptr<queued_handler_base>& b) noexcept {
-      return a->timestamp_ >= b->timestamp_;
+  /// heap comparator; equal deadlines keep submission order
+  static bool later(const queued_task* a, const queued_task* b) {
+    if (a->target_time != b->target_time) {
+      return a->target_time > b->target_time;
     }
+    return a->sequence > b->sequence;
+  }
 
-   private:
-    uint64_t timestamp_;
-  };
-
-  template <typename Function>
-  class queued_handler : public queued_handler_base {
-   public:
-    queued_handler(uint64_t t, Function f)
-        : queued_handler_base(t), function_(std::move(f)) {}
+  void release(queued_task* record) {
+    std::scoped_lock lock(mutex_);
+    record->next = free_;
+    free_ = record;
+  }
 
-    void execute() override { function_(); }
+  /// called with mutex_ held, or from the constructor
+  void grow() {
+    auto& chunk = chunks_.emplace_back(new queued_task[kPoolChunkSize]);
+    for (size_t i = 0; i < kPoolChunkSize; i++) {
+      chunk[i].next = free_;
+      free_ = &chunk[i];
+    }
+  }
 
-   private:
-    Function function_;
-  };
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<queued_task[]>> chunks_;
+  queued_task* free_{};
+  queued_task* incoming_head_{};
+  queued_task* incoming_tail_{};
+  uint64_t sequence_{};
+  bool wake_pending_{};
 
-  std::priority_queue<std::unique_ptr<queued_handler_base>> handlers_;
+  std::vector<queued_task*> heap_;
 };
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "input_latency.h"
+
+#include <sstream>
+
+namespace {
+/// larger differences mean the compositor uses another clock
+constexpr uint64_t kMaxInputAgeMs = 10'000;
+
+constexpr const char* kStageNames[] = {"dispatch", "queue", "present",
+                                       "end-to-end"};
+}  // namespace
+
+size_t LatencyHistogram::BucketIndex(const uint64_t value) {
+  if (value < kSubBuckets) {
+    return static_cast<size_t>(value);
+  }
+  unsigned msb = 63;
+  while (!(value >> msb)) {
+    msb--;
+  }
+  if (msb >= kMaxValueBits) {
+    return kBuckets - 1;
+  }
+  // msb >= kSubBucketBits; keep the kSubBucketBits bits below the top bit
+  const auto shift = msb - kSubBucketBits;
+  const auto sub = static_cast<size_t>(value >> shift) & (kSubBuckets - 1);
+  return (shift + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(const size_t index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+  const auto shift = index / kSubBuckets - 1;
+  const auto sub = index % kSubBuckets;
+  return ((uint64_t{kSubBuckets} + sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(const uint64_t value_us) {
+  m_buckets[BucketIndex(value_us)].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  auto max = m_max.load(std::memory_order_relaxed);
+  while (value_us > max &&
+         !m_max.compare_exchange_weak(max, value_us,
+                                      std::memory_order_relaxed)) {
+  }
+}
+
+uint64_t LatencyHistogram::ValueAtPercentile(const double percentile) const {
+  const auto count = this->count();
+  if (!count) {
+    return 0;
+  }
+  auto rank = static_cast<uint64_t>(percentile / 100.0 *
+                                    static_cast<double>(count) +
+                                    0.5);
+  rank = rank < 1 ? 1 : rank;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBuckets; i++) {
+    seen += m_buckets[i].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      const auto bound = BucketUpperBound(i);
+      return bound < max() ? bound : max();
+    }
+  }
+  return max();
+}
+
+void LatencyHistogram::Reset() {
+  for (auto& bucket : m_buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  m_count.store(0, std::memory_order_relaxed);
+  m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t InputLatency::FromWaylandTime(const uint32_t time_ms,
+                                       const uint64_t now_ns) {
+  const auto now_ms = now_ns / 1'000'000;
+  // the protocol time wraps at 32 bits
+  const auto age_ms = static_cast<uint32_t>(now_ms) - time_ms;
+  if (age_ms > kMaxInputAgeMs || age_ms > now_ms) {
+    return 0;
+  }
+  return (now_ms - age_ms) * 1'000'000;
+}
+
+void InputLatency::StoreOldest(std::atomic<uint64_t>& slot,
+                               const uint64_t value) {
+  auto current = slot.load(std::memory_order_relaxed);
+  while ((!current || value < current) &&
+         !slot.compare_exchange_weak(current, value,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+void InputLatency::RecordSent(const uint64_t input_ns,
+                              const uint64_t handled_ns,
+                              const uint64_t sent_ns) {
+  if (sent_ns >= handled_ns) {
+    m_histograms[kQueue].Record((sent_ns - handled_ns) / 1000);
+  }
+  StoreOldest(m_pending_sent_ns, sent_ns);
+  if (!input_ns) {
+    return;
+  }
+  if (handled_ns >= input_ns) {
+    m_histograms[kDispatch].Record((handled_ns - input_ns) / 1000);
+  }
+  StoreOldest(m_pending_input_ns, input_ns);
+}
+
+void InputLatency::OnPresent(const uint64_t present_ns) {
+  const auto sent_ns = m_pending_sent_ns.exchange(0, std::memory_order_relaxed);
+  if (!sent_ns) {
+    return;
+  }
+  if (present_ns >= sent_ns) {
+    m_histograms[kPresent].Record((present_ns - sent_ns) / 1000);
+  }
+  const auto input_ns =
+      m_pending_input_ns.exchange(0, std::memory_order_relaxed);
+  if (input_ns && present_ns >= input_ns) {
+    m_histograms[kEndToEnd].Record((present_ns - input_ns) / 1000);
+  }
+}
+
+std::string InputLatency::Dump() const {
+  std::ostringstream out;
+  out << "stage        count     p50     p90     p99   p99.9     max (us)";
+  for (size_t i = 0; i < kStageCount; i++) {
+    const auto& h = m_histograms[i];
+    out << "\n";
+    out.width(10);
+    out << std::left << kStageNames[i] << std::right;
+    for (const auto value :
+         {h.count(), h.ValueAtPercentile(50), h.ValueAtPercentile(90),
+          h.ValueAtPercentile(99), h.ValueAtPercentile(99.9), h.max()}) {
+      out << " ";
+      out.width(7);
+      out << value;
+    }
+  }
+  return out.str();
+}
+
+void InputLatency::Reset() {
+  for (auto& h : m_histograms) {
+    h.Reset();
+  }
+  m_pending_input_ns.store(0, std::memory_order_relaxed);
+  m_pending_sent_ns.store(0, std::memory_order_relaxed);
+}
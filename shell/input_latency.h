@@ -0,0 +1,156 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "config/common.h"
+
+/**
+ * @brief Log-linear latency histogram in microseconds.
+ *
+ * Values below 2^kSubBucketBits are recorded exactly; above that each power
+ * of two is split into 2^kSubBucketBits buckets, which bounds the error of
+ * a reported percentile to about 3%, HdrHistogram style.  Record() is
+ * lock-free and may be called from any thread.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr unsigned kSubBucketBits = 5;
+  static constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+  /// values up to 2^32 us, about 71 minutes; larger ones are clamped
+  static constexpr unsigned kMaxValueBits = 32;
+  static constexpr size_t kBuckets =
+      (kMaxValueBits - kSubBucketBits + 1) * kSubBuckets;
+
+  /**
+   * @brief Record one sample
+   * @param[in] value_us Latency in microseconds
+   * @return void
+   * @relation
+   * internal
+   */
+  void Record(uint64_t value_us);
+
+  /**
+   * @brief Get the value at or below which |percentile| of the samples fall
+   * @param[in] percentile Percentile in the range 0..100
+   * @return uint64_t
+   * @retval Upper bound of the bucket holding the percentile, 0 if empty
+   * @relation
+   * internal
+   */
+  NODISCARD uint64_t ValueAtPercentile(double percentile) const;
+
+  NODISCARD uint64_t count() const {
+    return m_count.load(std::memory_order_relaxed);
+  }
+
+  NODISCARD uint64_t max() const {
+    return m_max.load(std::memory_order_relaxed);
+  }
+
+  void Reset();
+
+ private:
+  static size_t BucketIndex(uint64_t value);
+  static uint64_t BucketUpperBound(size_t index);
+
+  std::array<std::atomic<uint64_t>, kBuckets> m_buckets{};
+  std::atomic<uint64_t> m_count{};
+  std::atomic<uint64_t> m_max{};
+};
+
+/**
+ * @brief Input-to-present latency of one view.
+ *
+ * Each pointer event carries the Wayland input time, mapped to
+ * CLOCK_MONOTONIC.  The event is stamped again in the input handler and when
+ * the batch is handed to the engine, and the oldest input of the batches sent
+ * since the last frame is correlated with the next present.
+ */
+class InputLatency {
+ public:
+  enum Stage {
+    /// Wayland input time to the input handler
+    kDispatch,
+    /// input handler to FlutterEngineSendPointerEvent
+    kQueue,
+    /// FlutterEngineSendPointerEvent to the next present
+    kPresent,
+    /// Wayland input time to the next present
+    kEndToEnd,
+    kStageCount,
+  };
+
+  /**
+   * @brief Map a Wayland event time to CLOCK_MONOTONIC
+   * @param[in] time_ms Event time in milliseconds, as sent by the compositor
+   * @param[in] now_ns Current CLOCK_MONOTONIC time in nanoseconds
+   * @return uint64_t
+   * @retval Input time in nanoseconds
+   * @retval 0 The compositor clock is not CLOCK_MONOTONIC
+   * @relation
+   * wayland
+   */
+  static uint64_t FromWaylandTime(uint32_t time_ms, uint64_t now_ns);
+
+  /**
+   * @brief Record an event handed to the engine
+   * @param[in] input_ns Wayland input time, 0 if unknown
+   * @param[in] handled_ns Time the input handler queued the event
+   * @param[in] sent_ns Time the event was sent to the engine
+   * @return void
+   * @relation
+   * flutter
+   */
+  void RecordSent(uint64_t input_ns, uint64_t handled_ns, uint64_t sent_ns);
+
+  /**
+   * @brief A frame was presented; closes the batches sent before it
+   * @param[in] present_ns Present time in nanoseconds
+   * @return void
+   * @relation
+   * flutter
+   */
+  void OnPresent(uint64_t present_ns);
+
+  NODISCARD const LatencyHistogram& histogram(const Stage stage) const {
+    return m_histograms[stage];
+  }
+
+  /**
+   * @brief Format count, p50/p90/p99/p99.9 and max of every stage
+   * @return std::string
+   * @relation
+   * internal
+   */
+  NODISCARD std::string Dump() const;
+
+  void Reset();
+
+ private:
+  static void StoreOldest(std::atomic<uint64_t>& slot, uint64_t value);
+
+  std::array<LatencyHistogram, kStageCount> m_histograms{};
+  /// oldest input and first send since the last present, 0 if none
+  std::atomic<uint64_t> m_pending_input_ns{};
+  std::atomic<uint64_t> m_pending_sent_ns{};
+};
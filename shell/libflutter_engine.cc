@@ -82,7 +82,12 @@ LibFlutterEngineExports::LibFlutterEngineExports(void* lib) {
   }
 }
 
+LibFlutterEngineExports* LibFlutterEngine::overridden_exports_ = nullptr;
+
 LibFlutterEngineExports* LibFlutterEngine::operator->() const {
+  if (overridden_exports_) {
+    return overridden_exports_;
+  }
   return loadExports(nullptr);
 }
 
@@ -70,13 +70,22 @@ struct LibFlutterEngineExports {
 class LibFlutterEngine {
  public:
   static bool IsPresent(const char* library_path = nullptr) {
-    return loadExports(library_path) != nullptr;
+    return overridden_exports_ != nullptr ||
+           loadExports(library_path) != nullptr;
   }
 
   LibFlutterEngineExports* operator->() const;
 
+  // Route all calls to |exports| instead of the loaded library, e.g. stubs
+  // for unit tests and benchmarks. nullptr restores the library exports.
+  static void SetExports(LibFlutterEngineExports* exports) {
+    overridden_exports_ = exports;
+  }
+
  private:
   static LibFlutterEngineExports* loadExports(const char* library_path);
+
+  static LibFlutterEngineExports* overridden_exports_;
 };
 
 extern LibFlutterEngine LibFlutterEngine;
@@ -13,33 +13,79 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <cerrno>
 #include <csignal>
+#include <cstdint>
 #include <cstdlib>
 
+#include <unistd.h>
+
 #include "config/common.h"
 
 #include "app.h"
 #include "configuration/configuration.h"
 #include "logging/logging.h"
+#include "trace.h"
 
 #if BUILD_CRASH_HANDLER
 #include "crash_handler.h"
 #endif
 
-volatile bool running = true;
+volatile std::sig_atomic_t running = 1;
+volatile std::sig_atomic_t dump_input_latency = 0;
+volatile std::sig_atomic_t dump_trace = 0;
+/// main loop wakeup fd, -1 until the app is created
+volatile std::sig_atomic_t signal_fd = -1;
 
 std::unique_ptr<Logging> gLogger;
 
 /**
- * @brief Signal handler
+ * @brief Return the main loop from its blocking wait, async-signal-safe
+ * @return void
+ * @relation
+ * internal
+ */
+void WakeMainLoop() {
+  const int fd = signal_fd;
+  if (fd >= 0) {
+    const auto saved_errno = errno;
+    constexpr uint64_t value = 1;
+    (void)!write(fd, &value, sizeof(value));
+    errno = saved_errno;
+  }
+}
+
+/**
+ * @brief Signal handler, the main loop exits and cleans up
  * @return void
  * @relation
  * internal
  */
 void SignalHandler(int /* signal */) {
-  SPDLOG_INFO("Ctl+C");
-  running = false;
-  exit(0);
+  running = 0;
+  WakeMainLoop();
+}
+
+/**
+ * @brief SIGUSR1 handler, requests an input latency dump
+ * @return void
+ * @relation
+ * internal
+ */
+void DumpSignalHandler(int /* signal */) {
+  dump_input_latency = 1;
+  WakeMainLoop();
+}
+
+/**
+ * @brief SIGUSR2 handler, requests a trace dump
+ * @return void
+ * @relation
+ * internal
+ */
+void TraceSignalHandler(int /* signal */) {
+  dump_trace = 1;
+  WakeMainLoop();
 }
 
 /**
@@ -62,15 +108,49 @@ int main(const int argc, char** argv) {
   const auto configs = Configuration::ParseArgcArgv(argc, argv);
   assert(!configs.empty());
 
+#if ENABLE_TRACING
+  // tracing is process wide, the first view that names a file wins
+  const auto trace = std::find_if(
+      configs.begin(), configs.end(),
+      [](const auto& config) { return !config.trace_file.empty(); });
+  Trace::Instance().Configure(
+      trace == configs.end() ? std::string() : trace->trace_file, true);
+  if (Trace::Instance().IsRecording()) {
+    std::signal(SIGUSR2, TraceSignalHandler);
+  }
+#endif
+
   const App app(configs);
 
+  signal_fd = app.GetSignalFd();
   std::signal(SIGINT, SignalHandler);
+  std::signal(SIGUSR1, DumpSignalHandler);
 
   // run the application
   int ret = 0;
   while (running && ret != -1) {
     ret = app.Loop();
+    // the handlers wake the blocking wait, so the dump is prompt
+    if (dump_input_latency) {
+      dump_input_latency = 0;
+      app.DumpInputLatency();
+    }
+    if (dump_trace) {
+      dump_trace = 0;
+      Trace::Instance().Write();
+    }
+  }
+  if (!running) {
+    SPDLOG_INFO("Ctl+C");
   }
+  signal_fd = -1;
+
+#if ENABLE_TRACING
+  // not from the signal handler, writing the file is not async-signal-safe
+  if (Trace::Instance().IsRecording()) {
+    Trace::Instance().Write();
+  }
+#endif
 
   gLogger.reset();
 
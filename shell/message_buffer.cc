@@ -0,0 +1,233 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "message_buffer.h"
+
+#include <cstring>
+#include <new>
+
+struct MessageBufferPool::ThreadCache {
+  std::array<MessageBuffer*, kSizeClasses.size()> head{};
+  std::array<size_t, kSizeClasses.size()> count{};
+
+  ~ThreadCache() {
+    t_thread_cache = nullptr;
+    auto& pool = Instance();
+    for (size_t i = 0; i < kSizeClasses.size(); i++) {
+      pool.Flush(*this, i, count[i]);
+    }
+  }
+
+  MessageBuffer* Pop(const size_t size_class) {
+    const auto buffer = head[size_class];
+    head[size_class] = buffer->m_next;
+    count[size_class]--;
+    return buffer;
+  }
+
+  void Push(const size_t size_class, MessageBuffer* buffer) {
+    buffer->m_next = head[size_class];
+    head[size_class] = buffer;
+    count[size_class]++;
+  }
+};
+
+thread_local MessageBufferPool::ThreadCache*
+    MessageBufferPool::t_thread_cache;
+
+void MessageBuffer::Release() {
+  if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    m_pool->Recycle(this);
+  }
+}
+
+MessageBufferPool::~MessageBufferPool() {
+  Trim();
+}
+
+MessageBufferPool& MessageBufferPool::Instance() {
+  // never destroyed; buffers may be released by threads still running at exit
+  static auto pool = [] {
+    const auto p = new MessageBufferPool();
+    p->m_thread_cache = true;
+    return p;
+  }();
+  return *pool;
+}
+
+MessageBufferRef MessageBufferPool::Acquire(const size_t capacity) {
+  m_acquires.fetch_add(1, std::memory_order_relaxed);
+
+  size_t size_class = 0;
+  while (size_class < kSizeClasses.size() &&
+         kSizeClasses[size_class] < capacity) {
+    size_class++;
+  }
+
+  MessageBuffer* buffer = nullptr;
+  if (size_class == kOversize) {
+    m_oversize.fetch_add(1, std::memory_order_relaxed);
+  } else if (m_thread_cache) {
+    static thread_local ThreadCache cache;
+    t_thread_cache = &cache;
+    if (cache.count[size_class] ||
+        Refill(cache, size_class, kThreadCacheSize / 2)) {
+      buffer = cache.Pop(size_class);
+    }
+  } else {
+    auto& list = m_free[size_class];
+    std::scoped_lock lock(list.mutex);
+    if ((buffer = list.head)) {
+      list.head = buffer->m_next;
+      list.count--;
+    }
+  }
+
+  if (buffer) {
+    buffer->m_refs.store(1, std::memory_order_relaxed);
+    buffer->m_size = 0;
+    return MessageBufferRef(buffer);
+  }
+
+  const auto bytes =
+      size_class < kSizeClasses.size() ? kSizeClasses[size_class] : capacity;
+  m_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  const auto memory = ::operator new(sizeof(MessageBuffer) + bytes);
+  return MessageBufferRef(new (memory) MessageBuffer(this, size_class, bytes));
+}
+
+MessageBufferRef MessageBufferPool::Copy(const void* data, const size_t size) {
+  auto buffer = Acquire(size);
+  if (size) {
+    std::memcpy(buffer->data(), data, size);
+  }
+  buffer->resize(size);
+  return buffer;
+}
+
+MessageBufferPool::Stats MessageBufferPool::GetStats() const {
+  size_t free = 0;
+  for (const auto& list : m_free) {
+    std::scoped_lock lock(list.mutex);
+    free += list.count;
+  }
+  const auto acquires = m_acquires.load(std::memory_order_relaxed);
+  return {
+      m_heap_allocations.load(std::memory_order_relaxed),
+      m_heap_frees.load(std::memory_order_relaxed),
+      acquires,
+      m_oversize.load(std::memory_order_relaxed),
+      static_cast<size_t>(acquires -
+                          m_releases.load(std::memory_order_relaxed)),
+      free,
+  };
+}
+
+void MessageBufferPool::Trim() {
+  for (auto& list : m_free) {
+    MessageBuffer* buffer;
+    {
+      std::scoped_lock lock(list.mutex);
+      buffer = list.head;
+      list.head = nullptr;
+      list.count = 0;
+    }
+    while (buffer) {
+      const auto next = buffer->m_next;
+      Free(buffer);
+      buffer = next;
+    }
+  }
+}
+
+void MessageBufferPool::Recycle(MessageBuffer* buffer) {
+  m_releases.fetch_add(1, std::memory_order_relaxed);
+  const auto size_class = buffer->m_size_class;
+  if (size_class == kOversize) {
+    Free(buffer);
+    return;
+  }
+
+  // the cache exists once this thread has acquired from the pool
+  if (m_thread_cache && t_thread_cache) {
+    auto& cache = *t_thread_cache;
+    if (cache.count[size_class] == kThreadCacheSize) {
+      Flush(cache, size_class, kThreadCacheSize / 2);
+    }
+    cache.Push(size_class, buffer);
+    return;
+  }
+
+  {
+    auto& list = m_free[size_class];
+    std::scoped_lock lock(list.mutex);
+    if (list.count < kMaxFreePerClass) {
+      buffer->m_next = list.head;
+      list.head = buffer;
+      list.count++;
+      return;
+    }
+  }
+  Free(buffer);
+}
+
+size_t MessageBufferPool::Refill(ThreadCache& cache,
+                                 const size_t size_class,
+                                 const size_t count) {
+  auto& list = m_free[size_class];
+  std::scoped_lock lock(list.mutex);
+  size_t moved = 0;
+  while (moved < count && list.head) {
+    const auto buffer = list.head;
+    list.head = buffer->m_next;
+    list.count--;
+    cache.Push(size_class, buffer);
+    moved++;
+  }
+  return moved;
+}
+
+void MessageBufferPool::Flush(ThreadCache& cache,
+                              const size_t size_class,
+                              size_t count) {
+  MessageBuffer* excess = nullptr;
+  {
+    auto& list = m_free[size_class];
+    std::scoped_lock lock(list.mutex);
+    for (; count && cache.count[size_class]; count--) {
+      const auto buffer = cache.Pop(size_class);
+      if (list.count < kMaxFreePerClass) {
+        buffer->m_next = list.head;
+        list.head = buffer;
+        list.count++;
+      } else {
+        buffer->m_next = excess;
+        excess = buffer;
+      }
+    }
+  }
+  while (excess) {
+    const auto next = excess->m_next;
+    Free(excess);
+    excess = next;
+  }
+}
+
+void MessageBufferPool::Free(MessageBuffer* buffer) {
+  m_heap_frees.fetch_add(1, std::memory_order_relaxed);
+  buffer->~MessageBuffer();
+  ::operator delete(buffer);
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+#include "config/common.h"
+
+class MessageBufferPool;
+
+/**
+ * @brief Reference counted byte buffer for cross-thread platform messages.
+ *
+ * The payload is stored inline after the header, in a single allocation
+ * owned by MessageBufferPool.  Producers encode into data(), set the size and
+ * hand the buffer over; the platform thread passes data() to the engine
+ * without copying.
+ */
+class MessageBuffer {
+ public:
+  MessageBuffer(const MessageBuffer&) = delete;
+  MessageBuffer& operator=(const MessageBuffer&) = delete;
+
+  NODISCARD uint8_t* data() { return reinterpret_cast<uint8_t*>(this + 1); }
+
+  NODISCARD const uint8_t* data() const {
+    return reinterpret_cast<const uint8_t*>(this + 1);
+  }
+
+  NODISCARD size_t size() const { return m_size; }
+
+  NODISCARD size_t capacity() const { return m_capacity; }
+
+  /**
+   * @brief Set the number of valid payload bytes
+   * @param[in] size Payload size, clamped to capacity()
+   * @return void
+   * @relation
+   * flutter
+   */
+  void resize(const size_t size) {
+    m_size = size < m_capacity ? size : m_capacity;
+  }
+
+  void AddRef() { m_refs.fetch_add(1, std::memory_order_relaxed); }
+
+  /**
+   * @brief Drop a reference; the last one returns the buffer to the pool
+   * @return void
+   * @relation
+   * flutter
+   */
+  void Release();
+
+ private:
+  friend class MessageBufferPool;
+
+  MessageBuffer(MessageBufferPool* pool, size_t size_class, size_t capacity)
+      : m_pool(pool), m_size_class(size_class), m_capacity(capacity) {}
+
+  std::atomic<uint32_t> m_refs{1};
+  MessageBufferPool* m_pool;
+  size_t m_size_class;
+  size_t m_capacity;
+  size_t m_size{};
+  MessageBuffer* m_next{};
+};
+
+/**
+ * @brief Owning reference to a MessageBuffer
+ */
+class MessageBufferRef {
+ public:
+  MessageBufferRef() = default;
+
+  /// adopts the reference held by |buffer|
+  explicit MessageBufferRef(MessageBuffer* buffer) : m_buffer(buffer) {}
+
+  MessageBufferRef(const MessageBufferRef& other) : m_buffer(other.m_buffer) {
+    if (m_buffer) {
+      m_buffer->AddRef();
+    }
+  }
+
+  MessageBufferRef(MessageBufferRef&& other) noexcept
+      : m_buffer(other.m_buffer) {
+    other.m_buffer = nullptr;
+  }
+
+  MessageBufferRef& operator=(MessageBufferRef other) noexcept {
+    std::swap(m_buffer, other.m_buffer);
+    return *this;
+  }
+
+  ~MessageBufferRef() {
+    if (m_buffer) {
+      m_buffer->Release();
+    }
+  }
+
+  MessageBuffer* operator->() const { return m_buffer; }
+
+  NODISCARD MessageBuffer* get() const { return m_buffer; }
+
+  explicit operator bool() const { return m_buffer != nullptr; }
+
+  /// gives up ownership without dropping the reference
+  MessageBuffer* release() {
+    const auto buffer = m_buffer;
+    m_buffer = nullptr;
+    return buffer;
+  }
+
+ private:
+  MessageBuffer* m_buffer{};
+};
+
+/**
+ * @brief Size-classed free lists of MessageBuffer.
+ *
+ * Buffers return to the free list of their size class and are reused by the
+ * next Acquire() of that class, so once the working set has been allocated
+ * the pool stops touching the heap.  Requests above the largest class are
+ * served from the heap and counted as oversize.
+ *
+ * The process wide pool keeps a small per-thread cache in front of the shared
+ * lists and moves buffers between the two in batches, so producers and the
+ * platform thread rarely contend on a list lock.
+ */
+class MessageBufferPool {
+ public:
+  static constexpr std::array<size_t, 5> kSizeClasses{256, 1024, 4096, 16384,
+                                                      65536};
+  /// free buffers kept per size class; further releases go to the heap
+  static constexpr size_t kMaxFreePerClass = 64;
+  /// per-thread cache size per size class, process wide pool only
+  static constexpr size_t kThreadCacheSize = 16;
+
+  struct Stats {
+    /// buffers taken from the heap, including oversize
+    uint64_t heap_allocations;
+    /// buffers returned to the heap
+    uint64_t heap_frees;
+    uint64_t acquires;
+    /// acquires above the largest size class
+    uint64_t oversize;
+    size_t in_use;
+    /// free buffers in the shared lists, per-thread caches not included
+    size_t free;
+  };
+
+  MessageBufferPool() = default;
+  ~MessageBufferPool();
+  MessageBufferPool(const MessageBufferPool&) = delete;
+  MessageBufferPool& operator=(const MessageBufferPool&) = delete;
+
+  /**
+   * @brief Process wide pool used for platform messages
+   * @return MessageBufferPool&
+   * @relation
+   * flutter
+   */
+  static MessageBufferPool& Instance();
+
+  /**
+   * @brief Get a buffer with at least |capacity| bytes
+   * @param[in] capacity Required capacity
+   * @return MessageBufferRef
+   * @retval Empty buffer (size 0)
+   * @relation
+   * flutter
+   */
+  MessageBufferRef Acquire(size_t capacity);
+
+  /**
+   * @brief Get a buffer holding a copy of |data|
+   * @param[in] data Bytes to copy
+   * @param[in] size Number of bytes
+   * @return MessageBufferRef
+   * @relation
+   * flutter
+   */
+  MessageBufferRef Copy(const void* data, size_t size);
+
+  NODISCARD Stats GetStats() const;
+
+  /**
+   * @brief Return all free buffers to the heap
+   * @return void
+   * @relation
+   * flutter
+   */
+  void Trim();
+
+ private:
+  friend class MessageBuffer;
+  struct ThreadCache;
+
+  /// set once the calling thread has acquired from the process wide pool
+  static thread_local ThreadCache* t_thread_cache;
+
+  static constexpr size_t kOversize = kSizeClasses.size();
+
+  struct FreeList {
+    mutable std::mutex mutex;
+    MessageBuffer* head{};
+    size_t count{};
+  };
+
+  void Recycle(MessageBuffer* buffer);
+  void Free(MessageBuffer* buffer);
+
+  /// move up to |count| buffers of |size_class| from the shared list
+  size_t Refill(ThreadCache& cache, size_t size_class, size_t count);
+  /// return |count| buffers of |size_class| to the shared list
+  void Flush(ThreadCache& cache, size_t size_class, size_t count);
+
+  std::array<FreeList, kSizeClasses.size()> m_free{};
+
+  std::atomic<uint64_t> m_heap_allocations{};
+  std::atomic<uint64_t> m_heap_frees{};
+  std::atomic<uint64_t> m_acquires{};
+  std::atomic<uint64_t> m_oversize{};
+  std::atomic<uint64_t> m_releases{};
+  bool m_thread_cache{};
+};
@@ -8,8 +8,10 @@
 #include "flutter_homescreen.h"
 
 #include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <string>
+#include <vector>
 
 #include <asio/post.hpp>
 
@@ -20,7 +22,12 @@
 
 #include "view/flutter_view.h"
 
+#include "engine.h"
 #include "libflutter_engine.h"
+#include "message_buffer.h"
+#if BUILD_BACKEND_WAYLAND_EGL || BUILD_BACKEND_HEADLESS_EGL
+#include "pixel_buffer_texture.h"
+#endif
 
 #if !defined(GL_RGBA8)
 #define GL_RGBA8 0x8058
@@ -31,8 +38,6 @@ struct FlutterDesktopView;
 
 static_assert(FLUTTER_ENGINE_VERSION == 1, "Engine version does not match");
 
-std::mutex texture_mutex;
-
 // Attempts to load AOT data from the given path, which must be absolute and
 // non-empty. Logs and returns nullptr on failure.
 std::unique_ptr<_FlutterEngineAOTData, AOTDataDeleter> LoadAotData(
@@ -152,6 +157,44 @@ FlutterDesktopWindowRef FlutterDesktopPluginRegistrarGetWindow(
   return controller->view_wrapper.get();
 }
 
+// Sends a message to the engine; must be called on the platform thread.
+static bool SendOnPlatformThread(FlutterDesktopEngineState* engine,
+                                 const char* channel,
+                                 const uint8_t* message,
+                                 const size_t message_size,
+                                 const FlutterDesktopBinaryReply reply,
+                                 void* user_data) {
+  FlutterPlatformMessageResponseHandle* response_handle = nullptr;
+  if (reply != nullptr && user_data != nullptr) {
+    const FlutterEngineResult result =
+        LibFlutterEngine->PlatformMessageCreateResponseHandle(
+            engine->flutter_engine, reply, user_data, &response_handle);
+    if (result != kSuccess) {
+      spdlog::error("Failed to create response handle");
+      return false;
+    }
+  }
+
+  const FlutterPlatformMessage platform_message = {
+      sizeof(FlutterPlatformMessage),
+      channel,
+      message,
+      message_size,
+      response_handle,
+  };
+
+  const FlutterEngineResult message_result =
+      LibFlutterEngine->SendPlatformMessage(engine->flutter_engine,
+                                            &platform_message);
+
+  if (response_handle != nullptr) {
+    LibFlutterEngine->PlatformMessageReleaseResponseHandle(
+        engine->flutter_engine, response_handle);
+  }
+
+  return message_result == kSuccess;
+}
+
 std::future<bool> PostMessengerSendWithReply(
     FlutterDesktopMessengerRef messenger,
     const char* channel,
@@ -161,39 +204,14 @@ std::future<bool> PostMessengerSendWithReply(
     void* user_data) {
   const auto promise(std::make_shared<std::promise<bool>>());
   auto promise_future(promise->get_future());
-  post(*messenger->GetEngine()->platform_task_runner->GetStrandContext(),
-       [&, promise, channel, message, message_size, reply, user_data]() {
-         FlutterPlatformMessageResponseHandle* response_handle = nullptr;
-         if (reply != nullptr && user_data != nullptr) {
-           const FlutterEngineResult result =
-               LibFlutterEngine->PlatformMessageCreateResponseHandle(
-                   messenger->GetEngine()->flutter_engine, reply, user_data,
-                   &response_handle);
-           if (result != kSuccess) {
-             spdlog::error("Failed to create response handle");
-             promise->set_value(false);
-             return;
-           }
-         }
-
-         auto platform_message = std::make_unique<FlutterPlatformMessage>();
-         platform_message->struct_size = sizeof(FlutterPlatformMessage);
-         platform_message->channel = channel;
-         platform_message->message = message;
-         platform_message->message_size = message_size;
-         platform_message->response_handle = response_handle;
-
-         const FlutterEngineResult message_result =
-             LibFlutterEngine->SendPlatformMessage(
-                 messenger->GetEngine()->flutter_engine,
-                 platform_message.release());
-
-         if (response_handle != nullptr) {
-           LibFlutterEngine->PlatformMessageReleaseResponseHandle(
-               messenger->GetEngine()->flutter_engine, response_handle);
-         }
-
-         promise->set_value(message_result == kSuccess);
+  const auto engine = messenger->GetEngine();
+  engine->message_queue.Queued(1);
+  post(*engine->platform_task_runner->GetStrandContext(),
+       [engine, promise, channel, message, message_size, reply, user_data]() {
+         const auto success = SendOnPlatformThread(
+             engine, channel, message, message_size, reply, user_data);
+         engine->message_queue.Completed(success);
+         promise->set_value(success);
        });
   return promise_future;
 }
@@ -204,38 +222,10 @@ bool FlutterDesktopMessengerSendWithReply(FlutterDesktopMessengerRef messenger,
                                           const size_t message_size,
                                           const FlutterDesktopBinaryReply reply,
                                           void* user_data) {
-  auto task_runner = messenger->GetEngine()->platform_task_runner;
-  if (task_runner->IsThreadEqual(pthread_self())) {
-    FlutterPlatformMessageResponseHandle* response_handle = nullptr;
-    if (reply != nullptr && user_data != nullptr) {
-      const FlutterEngineResult result =
-          LibFlutterEngine->PlatformMessageCreateResponseHandle(
-              messenger->GetEngine()->flutter_engine, reply, user_data,
-              &response_handle);
-      if (result != kSuccess) {
-        spdlog::error("Failed to create response handle");
-        return false;
-      }
-    }
-
-    const FlutterPlatformMessage platform_message = {
-        sizeof(FlutterPlatformMessage),
-        channel,
-        message,
-        message_size,
-        response_handle,
-    };
-
-    const FlutterEngineResult message_result =
-        LibFlutterEngine->SendPlatformMessage(
-            messenger->GetEngine()->flutter_engine, &platform_message);
-
-    if (response_handle != nullptr) {
-      LibFlutterEngine->PlatformMessageReleaseResponseHandle(
-          messenger->GetEngine()->flutter_engine, response_handle);
-    }
-
-    return message_result == kSuccess;
+  const auto engine = messenger->GetEngine();
+  if (engine->platform_task_runner->IsThreadEqual(pthread_self())) {
+    return SendOnPlatformThread(engine, channel, message, message_size, reply,
+                                user_data);
   }
 
   auto f = PostMessengerSendWithReply(messenger, channel, message, message_size,
@@ -252,6 +242,177 @@ bool FlutterDesktopMessengerSend(FlutterDesktopMessengerRef messenger,
                                               message_size, nullptr, nullptr);
 }
 
+namespace {
+
+// Owned copy of a FlutterDesktopMessengerBatchEntry. The payload is handed to
+// the engine straight from the pooled buffer.
+struct QueuedMessage {
+  MessageBufferRef channel;
+  MessageBufferRef message;
+  FlutterDesktopBinaryReply reply;
+  void* reply_user_data;
+};
+
+MessageBuffer* ToMessageBuffer(FlutterDesktopMessageBufferRef buffer) {
+  return reinterpret_cast<MessageBuffer*>(buffer);
+}
+
+MessageBufferRef CopyChannel(const char* channel) {
+  return MessageBufferPool::Instance().Copy(channel, strlen(channel) + 1);
+}
+
+bool PostQueuedMessages(FlutterDesktopMessengerRef messenger,
+                        std::vector<QueuedMessage> messages,
+                        const FlutterDesktopMessengerSendCallback completion,
+                        void* completion_user_data) {
+  const auto engine = messenger->GetEngine();
+  if (engine == nullptr) {
+    return false;
+  }
+
+  engine->message_queue.Queued(messages.size());
+  // the reference keeps |messenger| valid until the batch has been sent
+  post(*engine->platform_task_runner->GetStrandContext(),
+       [messenger = FlutterDesktopMessengerAddRef(messenger),
+        messages = std::move(messages), completion, completion_user_data]() {
+         const auto engine = messenger->GetEngine();
+         bool success = true;
+         for (const auto& m : messages) {
+           const auto sent =
+               engine != nullptr &&
+               SendOnPlatformThread(
+                   engine, reinterpret_cast<const char*>(m.channel->data()),
+                   m.message->data(), m.message->size(), m.reply,
+                   m.reply_user_data);
+           if (engine != nullptr) {
+             engine->message_queue.Completed(sent);
+           }
+           success = success && sent;
+         }
+         if (completion != nullptr) {
+           completion(success, completion_user_data);
+         }
+         FlutterDesktopMessengerRelease(messenger);
+       });
+  return true;
+}
+
+}  // namespace
+
+bool FlutterDesktopMessengerSendBatchAsync(
+    FlutterDesktopMessengerRef messenger,
+    const FlutterDesktopMessengerBatchEntry* entries,
+    const size_t count,
+    const FlutterDesktopMessengerSendCallback completion,
+    void* completion_user_data) {
+  if (messenger->GetEngine() == nullptr) {
+    return false;
+  }
+
+  auto& pool = MessageBufferPool::Instance();
+  std::vector<QueuedMessage> messages;
+  messages.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    const auto& entry = entries[i];
+    messages.push_back(QueuedMessage{
+        CopyChannel(entry.channel),
+        pool.Copy(entry.message, entry.message_size),
+        entry.reply,
+        entry.reply_user_data,
+    });
+  }
+  return PostQueuedMessages(messenger, std::move(messages), completion,
+                            completion_user_data);
+}
+
+bool FlutterDesktopMessengerSendAsync(
+    FlutterDesktopMessengerRef messenger,
+    const char* channel,
+    const uint8_t* message,
+    const size_t message_size,
+    const FlutterDesktopBinaryReply reply,
+    void* reply_user_data,
+    const FlutterDesktopMessengerSendCallback completion,
+    void* completion_user_data) {
+  const FlutterDesktopMessengerBatchEntry entry{
+      channel, message, message_size, reply, reply_user_data,
+  };
+  return FlutterDesktopMessengerSendBatchAsync(messenger, &entry, 1, completion,
+                                               completion_user_data);
+}
+
+FlutterDesktopMessageBufferRef FlutterDesktopMessageBufferAcquire(
+    const size_t capacity) {
+  return reinterpret_cast<FlutterDesktopMessageBufferRef>(
+      MessageBufferPool::Instance().Acquire(capacity).release());
+}
+
+uint8_t* FlutterDesktopMessageBufferGetData(
+    FlutterDesktopMessageBufferRef buffer) {
+  return ToMessageBuffer(buffer)->data();
+}
+
+size_t FlutterDesktopMessageBufferGetCapacity(
+    FlutterDesktopMessageBufferRef buffer) {
+  return ToMessageBuffer(buffer)->capacity();
+}
+
+void FlutterDesktopMessageBufferSetSize(FlutterDesktopMessageBufferRef buffer,
+                                        const size_t size) {
+  ToMessageBuffer(buffer)->resize(size);
+}
+
+void FlutterDesktopMessageBufferRelease(FlutterDesktopMessageBufferRef buffer) {
+  ToMessageBuffer(buffer)->Release();
+}
+
+bool FlutterDesktopMessengerSendBufferAsync(
+    FlutterDesktopMessengerRef messenger,
+    const char* channel,
+    FlutterDesktopMessageBufferRef buffer,
+    const FlutterDesktopBinaryReply reply,
+    void* reply_user_data,
+    const FlutterDesktopMessengerSendCallback completion,
+    void* completion_user_data) {
+  // adopt the caller's reference, it is dropped on every path
+  MessageBufferRef message(ToMessageBuffer(buffer));
+  if (messenger->GetEngine() == nullptr) {
+    return false;
+  }
+
+  std::vector<QueuedMessage> messages;
+  messages.push_back(QueuedMessage{
+      CopyChannel(channel),
+      std::move(message),
+      reply,
+      reply_user_data,
+  });
+  return PostQueuedMessages(messenger, std::move(messages), completion,
+                            completion_user_data);
+}
+
+void FlutterDesktopGetMessageBufferPoolStats(
+    FlutterDesktopMessageBufferPoolStats* stats) {
+  const auto pool = MessageBufferPool::Instance().GetStats();
+  stats->heap_allocations = pool.heap_allocations;
+  stats->heap_frees = pool.heap_frees;
+  stats->acquires = pool.acquires;
+  stats->oversize = pool.oversize;
+  stats->in_use = pool.in_use;
+  stats->free = pool.free;
+}
+
+void FlutterDesktopEngineGetMessageQueueStats(
+    FlutterDesktopEngineRef engine,
+    FlutterDesktopMessageQueueStats* stats) {
+  const auto& counters = engine->message_queue;
+  stats->pending = counters.pending.load(std::memory_order_relaxed);
+  stats->high_water = counters.high_water.load(std::memory_order_relaxed);
+  stats->submitted = counters.submitted.load(std::memory_order_relaxed);
+  stats->sent = counters.sent.load(std::memory_order_relaxed);
+  stats->failed = counters.failed.load(std::memory_order_relaxed);
+}
+
 void FlutterDesktopMessengerSendResponse(
     FlutterDesktopMessengerRef messenger,
     const FlutterDesktopMessageResponseHandle* handle,
@@ -277,13 +438,49 @@ FlutterDesktopTextureRegistrarRef FlutterDesktopRegistrarGetTextureRegistrar(
 int64_t FlutterDesktopTextureRegistrarRegisterExternalTexture(
     FlutterDesktopTextureRegistrarRef texture_registrar,
     const FlutterDesktopTextureInfo* texture_info) {
-  std::scoped_lock lock(texture_mutex);
   int64_t result = -1;
 
   if (texture_info->type == kFlutterDesktopPixelBufferTexture) {
-    spdlog::error("RegisterExternalTexture: Pixel Buffer not implemented.");
+#if BUILD_BACKEND_WAYLAND_EGL || BUILD_BACKEND_HEADLESS_EGL
+    auto texture = std::make_shared<PixelBufferTexture>(
+        texture_info->pixel_buffer_config);
+    const auto backend =
+        texture_registrar->engine->view_controller->view->GetBackend();
+    {
+      std::scoped_lock lock(texture_registrar->upload_mutex);
+      if (!backend->TextureMakeCurrent()) {
+        spdlog::error("RegisterExternalTexture: texture context unavailable");
+        return result;
+      }
+      const bool initialized = texture->Initialize();
+      backend->TextureClearCurrent();
+      if (!initialized) {
+        return result;
+      }
+    }
+
+    std::scoped_lock lock(texture_registrar->texture_mutex);
 
+    // the name of the first texture is unique among GL surface textures
+    const auto id = texture->GetId();
+    auto val = std::make_shared<GL_TEXTURE_2D_DESC>();
+    val->name = static_cast<uint32_t>(id);
+    val->target = GL_TEXTURE_2D;
+    val->format = GL_RGBA8;
+    val->pixel_buffer = std::move(texture);
+    texture_registrar->texture_registry.Insert(id, std::move(val));
+
+    SPDLOG_TRACE("RegisterExternalTexture: {}, pixel buffer {}",
+                 fmt::ptr(texture_registrar->engine->flutter_engine), id);
+    if (kSuccess == LibFlutterEngine->RegisterExternalTexture(
+                        texture_registrar->engine->flutter_engine, id)) {
+      result = id;
+    }
+#else
+    spdlog::error("RegisterExternalTexture: Pixel Buffer requires OpenGL.");
+#endif
   } else if (texture_info->type == kFlutterDesktopGpuSurfaceTexture) {
+    std::scoped_lock lock(texture_registrar->texture_mutex);
     auto [struct_size, type, callback, user_data] =
         texture_info->gpu_surface_config;
     if (type != kFlutterDesktopGpuSurfaceTypeGlTexture2D) {
@@ -313,18 +510,8 @@ int64_t FlutterDesktopTextureRegistrarRegisterExternalTexture(
 
     GLuint id = *static_cast<GLuint*>(descriptor->handle);
 
-    // check for existing entry
-    for (auto& [fst, snd] : texture_registrar->texture_registry) {
-      if (fst == id) {
-        snd.reset();
-        texture_registrar->texture_registry.erase(id);
-        break;
-      }
-    }
-
-    texture_registrar->texture_registry[id] =
-        std::make_unique<GL_TEXTURE_2D_DESC>();
-    const auto& val = texture_registrar->texture_registry[id];
+    // replaces an existing entry
+    auto val = std::make_shared<GL_TEXTURE_2D_DESC>();
     val->name = static_cast<uint32_t>(id);
     val->width = static_cast<uint32_t>(descriptor->width);
     val->height = static_cast<uint32_t>(descriptor->height);
@@ -332,6 +519,7 @@ int64_t FlutterDesktopTextureRegistrarRegisterExternalTexture(
     val->release_context = descriptor->release_context;
     val->target = GL_TEXTURE_2D;
     val->format = GL_RGBA8;
+    texture_registrar->texture_registry.Insert(id, std::move(val));
 
     SPDLOG_TRACE("RegisterExternalTexture: {}, {}",
                  fmt::ptr(texture_registrar->engine->flutter_engine), id);
@@ -351,15 +539,30 @@ void FlutterDesktopTextureRegistrarUnregisterExternalTexture(
     const int64_t texture_id,
     void (*callback)(void* user_data),
     void* user_data) {
-  std::scoped_lock<std::mutex> lock(texture_mutex);
-  LibFlutterEngine->UnregisterExternalTexture(
-      texture_registrar->engine->flutter_engine, texture_id);
-  if (const auto& val = texture_registrar->texture_registry[texture_id];
-      val && val->release_callback != nullptr) {
-    val->release_callback(val->release_context);
+  TextureRegistry::Entry val;
+  {
+    std::scoped_lock<std::mutex> lock(texture_registrar->texture_mutex);
+    LibFlutterEngine->UnregisterExternalTexture(
+        texture_registrar->engine->flutter_engine, texture_id);
+    // the raster thread no longer sees the texture once it is removed
+    val = texture_registrar->texture_registry.Remove(texture_id);
+  }
+  if (val) {
+    if (val->release_callback != nullptr) {
+      val->release_callback(val->release_context);
+    }
+#if BUILD_BACKEND_WAYLAND_EGL || BUILD_BACKEND_HEADLESS_EGL
+    if (val->pixel_buffer) {
+      const auto backend =
+          texture_registrar->engine->view_controller->view->GetBackend();
+      std::scoped_lock lock(texture_registrar->upload_mutex);
+      if (backend->TextureMakeCurrent()) {
+        val->pixel_buffer->Destroy();
+        backend->TextureClearCurrent();
+      }
+    }
+#endif
   }
-  texture_registrar->texture_registry[texture_id].reset();
-  texture_registrar->texture_registry.erase(texture_id);
   if (callback != nullptr) {
     callback(user_data);
   }
@@ -370,9 +573,10 @@ bool FlutterDesktopTextureRegistrarMarkExternalTextureFrameAvailable(
     int64_t texture_id) {
   SPDLOG_TRACE("MarkExternalTextureFrameAvailable: {}, {}",
                fmt::ptr(texture_registrar->engine->flutter_engine), texture_id);
-  const auto result = LibFlutterEngine->MarkExternalTextureFrameAvailable(
-      texture_registrar->engine->flutter_engine, texture_id);
-  return result == kSuccess;
+  // coalesced with other marks of the texture until the next frame, which
+  // copies its pixel buffer
+  return texture_registrar->engine->view_controller->engine
+      ->MarkTextureFrameAvailable(texture_id);
 }
 
 bool FlutterDesktopTextureMakeCurrent(
@@ -391,6 +595,44 @@ bool FlutterDesktopTextureClearCurrent(
   return backend->TextureClearCurrent();
 }
 
+void FlutterDesktopTextureRegistrarUploadPixelBuffers(
+    std::vector<int64_t>& batch,
+    void* user_data) {
+#if BUILD_BACKEND_WAYLAND_EGL || BUILD_BACKEND_HEADLESS_EGL
+  const auto texture_registrar =
+      static_cast<FlutterDesktopTextureRegistrarRef>(user_data);
+  const auto backend =
+      texture_registrar->engine->view_controller->view->GetBackend();
+  std::scoped_lock lock(texture_registrar->upload_mutex);
+  bool current = false;
+  bool failed = false;
+  const auto skip = [&](const int64_t texture_id) {
+    const auto val = texture_registrar->texture_registry.Get(texture_id);
+    if (!val || !val->pixel_buffer) {
+      // GPU surfaces are drawn by their plugin
+      return false;
+    }
+    if (!current && !failed) {
+      current = backend->TextureMakeCurrent();
+      failed = !current;
+    }
+    return !current || !val->pixel_buffer->Upload();
+  };
+  batch.erase(std::remove_if(batch.begin(), batch.end(), skip), batch.end());
+  if (current) {
+    // complete before the raster context samples the uploads
+    glFinish();
+    backend->TextureClearCurrent();
+  }
+  if (failed) {
+    spdlog::error("UploadPixelBuffers: texture context unavailable");
+  }
+#else
+  (void)batch;
+  (void)user_data;
+#endif
+}
+
 // Passes character input events to registered handlers.
 void CharCallback(FlutterDesktopViewControllerState* view_state,
                   const unsigned int code_point) {
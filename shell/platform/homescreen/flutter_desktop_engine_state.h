@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include <asio/io_context_strand.hpp>
 
 #include "flutter/shell/platform/common/client_wrapper/include/flutter/plugin_registrar.h"
@@ -33,6 +35,33 @@ using FlutterDesktopMessengerReferenceOwner =
                     decltype(&FlutterDesktopMessengerRelease)>;
 
 using UniqueAotDataPtr = std::unique_ptr<_FlutterEngineAOTData, AOTDataDeleter>;
+
+// Depth of the platform message queue fed by threads other than the platform
+// thread.
+struct FlutterDesktopMessageQueueCounters {
+  std::atomic<size_t> pending{0};
+  std::atomic<size_t> high_water{0};
+  std::atomic<uint64_t> submitted{0};
+  std::atomic<uint64_t> sent{0};
+  std::atomic<uint64_t> failed{0};
+
+  // Producer side, before posting |count| messages.
+  void Queued(const size_t count) {
+    submitted.fetch_add(count, std::memory_order_relaxed);
+    const auto depth =
+        pending.fetch_add(count, std::memory_order_relaxed) + count;
+    auto high = high_water.load(std::memory_order_relaxed);
+    while (depth > high && !high_water.compare_exchange_weak(
+                               high, depth, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Platform thread, after handing a message to the engine.
+  void Completed(const bool success) {
+    pending.fetch_sub(1, std::memory_order_relaxed);
+    (success ? sent : failed).fetch_add(1, std::memory_order_relaxed);
+  }
+};
 /// Maintains one ref on the FlutterDesktopMessenger's internal reference count.
 
 // Struct for storing state of a Flutter engine instance.
@@ -77,4 +106,7 @@ struct FlutterDesktopEngineState {
 
   // Flutter Asset Folder
   std::string flutter_asset_directory;
+
+  // Off-thread platform message sends queued on |platform_task_runner|.
+  FlutterDesktopMessageQueueCounters message_queue;
 };
@@ -1,11 +1,17 @@
 #pragma once
 
 #include <GLES2/gl2.h>
+#include <cstdint>
+#include <memory>
 #include <mutex>
-#include <unordered_map>
+#include <vector>
+
+#include "texture_registry.h"
 
 struct FlutterDesktopEngineState;
 
+class PixelBufferTexture;
+
 struct GL_TEXTURE_2D_DESC {
   /// Target texture of the active texture unit (example GL_TEXTURE_2D or
   /// GL_TEXTURE_RECTANGLE).
@@ -17,10 +23,11 @@ struct GL_TEXTURE_2D_DESC {
 
   uint32_t width;
   uint32_t height;
-  size_t visible_width;
-  size_t visible_height;
   void (*release_callback)(void* release_context);
   void* release_context;
+  /// Set for kFlutterDesktopPixelBufferTexture, which provides the texture
+  /// of each frame.
+  std::shared_ptr<PixelBufferTexture> pixel_buffer;
 };
 
 // State associated with the texture registrar.
@@ -28,8 +35,26 @@ struct FlutterDesktopTextureRegistrar {
   // The engine that backs this registrar.
   FlutterDesktopEngineState* engine;
 
+  // Serializes registration with the engine.  The raster thread reads the
+  // registry without it.
   std::mutex texture_mutex;
 
-  std::unordered_map<int64_t, std::unique_ptr<GL_TEXTURE_2D_DESC>>
-      texture_registry;
+  // Serializes the pixel buffer work on the texture context: creation,
+  // uploads and deletion.  Internal, plugins never hold it.
+  std::mutex upload_mutex;
+
+  TextureRegistry texture_registry;
 };
+
+/**
+ * @brief Copy the pixel buffers of the marked textures, at the frame boundary
+ * on the platform thread.  Matches TextureFrameQueue::Prepare.
+ * @param[in,out] batch Marked textures, those without a new upload removed
+ * @param[in] user_data Pointer to FlutterDesktopTextureRegistrar
+ * @return void
+ * @relation
+ * flutter
+ */
+void FlutterDesktopTextureRegistrarUploadPixelBuffers(
+    std::vector<int64_t>& batch,
+    void* user_data);
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pixel_buffer_texture.h"
+
+#include <GLES2/gl2ext.h>
+
+#include "logging.h"
+
+PixelBufferTexture::PixelBufferTexture(
+    const FlutterDesktopPixelBufferTextureConfig& config)
+    : m_config(config) {}
+
+bool PixelBufferTexture::Initialize() {
+  glGenTextures(1, &m_buffers[0].name);
+  m_count = 1;
+  return m_buffers[0].name != 0;
+}
+
+int PixelBufferTexture::FindFreeBuffer() {
+  const auto front = m_front.load();
+  for (size_t i = 0; i < m_count; i++) {
+    if (static_cast<int>(i) != front && m_buffers[i].uses.load() == 0) {
+      return static_cast<int>(i);
+    }
+  }
+  if (m_count == kMaxBuffers) {
+    return -1;
+  }
+  glGenTextures(1, &m_buffers[m_count].name);
+  return static_cast<int>(m_count++);
+}
+
+bool PixelBufferTexture::Upload() {
+  if (m_count == 0) {
+    // destroyed while the frame was marked
+    return false;
+  }
+  const auto requested = m_requested_size.load(std::memory_order_relaxed);
+  const auto pixels =
+      m_config.callback(static_cast<size_t>(requested >> 32),
+                        static_cast<size_t>(requested & 0xffffffffu),
+                        m_config.user_data);
+  if (pixels == nullptr || pixels->buffer == nullptr || pixels->width == 0 ||
+      pixels->height == 0) {
+    return false;
+  }
+  const auto release = [pixels] {
+    if (pixels->release_callback != nullptr) {
+      pixels->release_callback(pixels->release_context);
+    }
+  };
+
+  const auto index = FindFreeBuffer();
+  if (index < 0) {
+    // the engine holds two frames, it has not drawn the latest one yet
+    m_dropped++;
+    release();
+    return false;
+  }
+  auto& buffer = m_buffers[static_cast<size_t>(index)];
+  const auto width = static_cast<GLsizei>(pixels->width);
+  const auto height = static_cast<GLsizei>(pixels->height);
+
+  glBindTexture(GL_TEXTURE_2D, buffer.name);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  if (buffer.width == pixels->width && buffer.height == pixels->height) {
+    // same storage, no reallocation in the driver
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA,
+                    GL_UNSIGNED_BYTE, pixels->buffer);
+  } else {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, pixels->buffer);
+    buffer.width = pixels->width;
+    buffer.height = pixels->height;
+    m_reallocations++;
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+  // the pixels are copied once the call returns
+  release();
+  if (const auto error = glGetError(); error != GL_NO_ERROR) {
+    spdlog::error("PixelBufferTexture: upload {}x{} failed: 0x{:x}", width,
+                  height, error);
+    buffer.width = 0;
+    buffer.height = 0;
+    return false;
+  }
+
+  m_front.store(index);
+  m_uploads++;
+  return true;
+}
+
+bool PixelBufferTexture::Populate(const size_t width,
+                                  const size_t height,
+                                  FlutterOpenGLTexture* texture_out) {
+  // one word, an upload never sees the width of one call and the height of
+  // another
+  m_requested_size.store(
+      (static_cast<uint64_t>(width) << 32) | (height & 0xffffffffu),
+      std::memory_order_relaxed);
+
+  // Hold the latest upload.  Should an upload publish another texture in
+  // between, this one may already be picked for the next upload: let go and
+  // take the new one.
+  int front;
+  while (true) {
+    front = m_front.load();
+    if (front < 0) {
+      return false;
+    }
+    m_buffers[static_cast<size_t>(front)].uses++;
+    if (m_front.load() == front) {
+      break;
+    }
+    m_buffers[static_cast<size_t>(front)].uses--;
+  }
+
+  auto& buffer = m_buffers[static_cast<size_t>(front)];
+  *texture_out = {
+      .target = GL_TEXTURE_2D,
+      .name = buffer.name,
+      .format = GL_RGBA8_OES,
+      .user_data = new Lease{shared_from_this(), &buffer},
+      .destruction_callback =
+          [](void* user_data) {
+            const auto lease = static_cast<Lease*>(user_data);
+            lease->buffer->uses--;
+            delete lease;
+          },
+      .width = buffer.width,
+      .height = buffer.height,
+  };
+  return true;
+}
+
+void PixelBufferTexture::Destroy() {
+  // storage still sampled by a frame in flight is kept by the driver until
+  // the frame completes
+  for (size_t i = 0; i < m_count; i++) {
+    glDeleteTextures(1, &m_buffers[i].name);
+    m_buffers[i].name = 0;
+  }
+  m_count = 0;
+  m_front.store(-1);
+}
+
+PixelBufferTexture::Stats PixelBufferTexture::GetStats() const {
+  return {m_uploads.load(std::memory_order_relaxed),
+          m_reallocations.load(std::memory_order_relaxed),
+          m_dropped.load(std::memory_order_relaxed)};
+}
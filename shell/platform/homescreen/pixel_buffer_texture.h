@@ -0,0 +1,144 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <GLES2/gl2.h>
+
+#include "config/common.h"
+
+#include "flutter_texture_registrar.h"
+#include "shell/platform/embedder/embedder.h"
+
+/**
+ * @brief External texture filled from the pixel buffers of a plugin.
+ *
+ * A marked frame is copied into one of a few GL textures on the texture
+ * context at the next frame boundary, on the platform thread, at the size the
+ * engine last populated the texture with.  The raster thread is handed the
+ * latest complete upload and never waits for one in flight: an upload goes
+ * into a texture that is neither the latest nor held by the engine, and a
+ * texture of an unchanged size is rewritten in place.
+ *
+ * Initialize(), Upload() and Destroy() run with the texture context current,
+ * serialized by the caller, who also completes the uploads before the engine
+ * samples them; Populate() runs on the raster thread.
+ */
+class PixelBufferTexture
+    : public std::enable_shared_from_this<PixelBufferTexture> {
+ public:
+  /// latest upload, one held by the engine, one being written
+  static constexpr size_t kMaxBuffers = 3;
+
+  struct Stats {
+    uint64_t uploads;
+    /// uploads that had to allocate texture storage
+    uint64_t reallocations;
+    /// pixel buffers skipped while every texture was busy
+    uint64_t dropped;
+  };
+
+  explicit PixelBufferTexture(
+      const FlutterDesktopPixelBufferTextureConfig& config);
+
+  /**
+   * @brief Create the first texture, its name is the texture id
+   * @return bool
+   * @retval true Normal end
+   * @retval false Abnormal end
+   * @relation
+   * flutter
+   */
+  bool Initialize();
+
+  NODISCARD int64_t GetId() const { return m_buffers[0].name; }
+
+  /**
+   * @brief Copy the plugin's current pixel buffer into a free texture, asking
+   * for the size of the last Populate()
+   * @return bool
+   * @retval true A new frame is ready for the engine
+   * @retval false No pixel buffer, no free texture or the upload failed
+   * @relation
+   * flutter
+   */
+  bool Upload();
+
+  /**
+   * @brief Hand the latest upload to the engine, raster thread
+   * @param[in] width Size the engine draws the texture at
+   * @param[in] height Size the engine draws the texture at
+   * @param[out] texture_out Texture, held until its destruction callback
+   * @return bool
+   * @retval true Normal end
+   * @retval false Nothing uploaded yet
+   * @relation
+   * flutter
+   */
+  bool Populate(size_t width, size_t height, FlutterOpenGLTexture* texture_out);
+
+  /**
+   * @brief Delete the textures, after the texture is unregistered
+   * @return void
+   * @relation
+   * flutter
+   */
+  void Destroy();
+
+  NODISCARD Stats GetStats() const;
+
+ private:
+  struct Buffer {
+    GLuint name{};
+    size_t width{};
+    size_t height{};
+    /// frames the engine holds the texture in
+    std::atomic<uint32_t> uses{};
+  };
+
+  /// keeps the texture alive while the engine holds one of its buffers
+  struct Lease {
+    std::shared_ptr<PixelBufferTexture> texture;
+    Buffer* buffer;
+  };
+
+  FlutterDesktopPixelBufferTextureConfig m_config;
+  std::array<Buffer, kMaxBuffers> m_buffers{};
+  size_t m_count{};
+  /// latest complete upload, -1 before the first
+  std::atomic<int> m_front{-1};
+  /// size of the last Populate(), width in the upper half, 0 before it
+  std::atomic<uint64_t> m_requested_size{};
+  std::atomic<uint64_t> m_uploads{};
+  std::atomic<uint64_t> m_reallocations{};
+  std::atomic<uint64_t> m_dropped{};
+
+  /**
+   * @brief Find a texture neither published nor held by the engine
+   * @return int
+   * @retval Index of the texture
+   * @retval -1 All are busy
+   * @relation
+   * flutter
+   */
+  int FindFreeBuffer();
+};
@@ -59,6 +59,122 @@ FLUTTER_EXPORT FlutterDesktopPluginRegistrarRef
 FlutterDesktopGetPluginRegistrar(FlutterDesktopEngineRef engine,
                                  const char* plugin_name);
 
+// Called on the platform thread once an asynchronous send has been handed to
+// the engine. |success| is false if the engine rejected any of the messages.
+typedef void (*FlutterDesktopMessengerSendCallback)(bool success,
+                                                    void* user_data);
+
+// A message for FlutterDesktopMessengerSendBatchAsync. |reply| is optional, as
+// for FlutterDesktopMessengerSendWithReply.
+typedef struct {
+  const char* channel;
+  const uint8_t* message;
+  size_t message_size;
+  FlutterDesktopBinaryReply reply;
+  void* reply_user_data;
+} FlutterDesktopMessengerBatchEntry;
+
+// Sends a binary message to the Flutter side on the specified channel without
+// waiting for the platform thread.
+//
+// |channel| and |message| are copied before returning. |reply| is as for
+// FlutterDesktopMessengerSendWithReply. |completion| may be null for
+// fire-and-forget sends.
+//
+// Returns false if the messenger is not attached to an engine, in which case
+// nothing is queued and |completion| is not called.
+FLUTTER_EXPORT bool FlutterDesktopMessengerSendAsync(
+    FlutterDesktopMessengerRef messenger,
+    const char* channel,
+    const uint8_t* message,
+    const size_t message_size,
+    const FlutterDesktopBinaryReply reply,
+    void* reply_user_data,
+    const FlutterDesktopMessengerSendCallback completion,
+    void* completion_user_data);
+
+// Sends |count| messages in order with a single post to the platform thread.
+//
+// Entries are copied before returning. |completion|, if not null, is called
+// once after the last message has been sent.
+FLUTTER_EXPORT bool FlutterDesktopMessengerSendBatchAsync(
+    FlutterDesktopMessengerRef messenger,
+    const FlutterDesktopMessengerBatchEntry* entries,
+    const size_t count,
+    const FlutterDesktopMessengerSendCallback completion,
+    void* completion_user_data);
+
+// Opaque reference to a pooled, reference counted message buffer.
+typedef struct FlutterDesktopMessageBuffer* FlutterDesktopMessageBufferRef;
+
+// Returns a buffer of at least |capacity| bytes from the message buffer pool.
+// Encode the message into FlutterDesktopMessageBufferGetData() and set its
+// length with FlutterDesktopMessageBufferSetSize(). The caller owns one
+// reference.
+FLUTTER_EXPORT FlutterDesktopMessageBufferRef
+FlutterDesktopMessageBufferAcquire(const size_t capacity);
+
+FLUTTER_EXPORT uint8_t* FlutterDesktopMessageBufferGetData(
+    FlutterDesktopMessageBufferRef buffer);
+
+FLUTTER_EXPORT size_t
+FlutterDesktopMessageBufferGetCapacity(FlutterDesktopMessageBufferRef buffer);
+
+// Sets the message length; clamped to the capacity.
+FLUTTER_EXPORT void FlutterDesktopMessageBufferSetSize(
+    FlutterDesktopMessageBufferRef buffer,
+    const size_t size);
+
+// Drops the caller's reference; the buffer returns to the pool once unused.
+FLUTTER_EXPORT void FlutterDesktopMessageBufferRelease(
+    FlutterDesktopMessageBufferRef buffer);
+
+// As FlutterDesktopMessengerSendAsync, but sends the contents of |buffer|
+// without copying. Takes over the caller's reference to |buffer|, also when
+// returning false.
+FLUTTER_EXPORT bool FlutterDesktopMessengerSendBufferAsync(
+    FlutterDesktopMessengerRef messenger,
+    const char* channel,
+    FlutterDesktopMessageBufferRef buffer,
+    const FlutterDesktopBinaryReply reply,
+    void* reply_user_data,
+    const FlutterDesktopMessengerSendCallback completion,
+    void* completion_user_data);
+
+// Message buffer pool statistics. Once |heap_allocations| stops growing the
+// message path no longer allocates.
+typedef struct {
+  uint64_t heap_allocations;
+  uint64_t heap_frees;
+  uint64_t acquires;
+  // Requests larger than the largest size class, always heap allocated.
+  uint64_t oversize;
+  size_t in_use;
+  size_t free;
+} FlutterDesktopMessageBufferPoolStats;
+
+// Fills |stats| with the statistics of the process wide message buffer pool.
+FLUTTER_EXPORT void FlutterDesktopGetMessageBufferPoolStats(
+    FlutterDesktopMessageBufferPoolStats* stats);
+
+// Platform message queue metrics of an engine. Covers messages sent from
+// threads other than the platform thread.
+typedef struct {
+  // Messages queued but not yet handed to the engine.
+  size_t pending;
+  // Largest |pending| seen.
+  size_t high_water;
+  // Totals since the engine was created.
+  uint64_t submitted;
+  uint64_t sent;
+  uint64_t failed;
+} FlutterDesktopMessageQueueStats;
+
+// Fills |stats| with the current platform message queue metrics of |engine|.
+FLUTTER_EXPORT void FlutterDesktopEngineGetMessageQueueStats(
+    FlutterDesktopEngineRef engine,
+    FlutterDesktopMessageQueueStats* stats);
+
 #if defined(__cplusplus)
 }  // extern "C"
 #endif
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "texture_registry.h"
+
+#include <thread>
+#include <utility>
+
+TextureRegistry::Reader::Reader(const TextureRegistry& registry)
+    : m_registry(registry), m_epoch(registry.m_epoch.load() & 1u) {
+  // Announce the reader before loading the snapshot: a writer that swapped
+  // the snapshot before this load sees the count and keeps the old one.
+  m_registry.m_readers[m_epoch].fetch_add(1);
+  m_snapshot = m_registry.m_snapshot.load();
+}
+
+TextureRegistry::Reader::~Reader() {
+  m_registry.m_readers[m_epoch].fetch_sub(1, std::memory_order_release);
+}
+
+const GL_TEXTURE_2D_DESC* TextureRegistry::Reader::Find(
+    const int64_t texture_id) const {
+  const auto it = m_snapshot->find(texture_id);
+  return it == m_snapshot->end() ? nullptr : it->second.get();
+}
+
+TextureRegistry::TextureRegistry() : m_snapshot(new Map()) {}
+
+TextureRegistry::~TextureRegistry() {
+  delete m_snapshot.load();
+}
+
+TextureRegistry::Entry TextureRegistry::Insert(const int64_t texture_id,
+                                               Entry entry) {
+  std::scoped_lock lock(m_write_mutex);
+  auto next = std::make_unique<Map>(*m_snapshot.load());
+  Entry replaced;
+  if (const auto it = next->find(texture_id); it != next->end()) {
+    replaced = std::exchange(it->second, std::move(entry));
+  } else {
+    next->emplace(texture_id, std::move(entry));
+  }
+  Publish(std::move(next));
+  return replaced;
+}
+
+TextureRegistry::Entry TextureRegistry::Remove(const int64_t texture_id) {
+  std::scoped_lock lock(m_write_mutex);
+  const auto current = m_snapshot.load();
+  const auto it = current->find(texture_id);
+  if (it == current->end()) {
+    return nullptr;
+  }
+  Entry removed = it->second;
+  auto next = std::make_unique<Map>(*current);
+  next->erase(texture_id);
+  Publish(std::move(next));
+  return removed;
+}
+
+TextureRegistry::Entry TextureRegistry::Get(const int64_t texture_id) const {
+  const Reader reader(*this);
+  const auto it = reader.m_snapshot->find(texture_id);
+  return it == reader.m_snapshot->end() ? nullptr : it->second;
+}
+
+size_t TextureRegistry::size() const {
+  const Reader reader(*this);
+  return reader.m_snapshot->size();
+}
+
+void TextureRegistry::Publish(std::unique_ptr<const Map> next) {
+  const auto previous = m_snapshot.exchange(next.release());
+  // Readers of the previous snapshot announced themselves, in either parity,
+  // before loading it.  Each flip sends new readers to the other parity, so
+  // only the readers that started before it are waited for; a reader counted
+  // in the drained parity after the flip has loaded the new snapshot.
+  for (int i = 0; i < 2; i++) {
+    const auto drained = m_epoch.fetch_add(1) & 1u;
+    while (m_readers[drained].load() != 0) {
+      std::this_thread::yield();
+    }
+  }
+  delete previous;
+}
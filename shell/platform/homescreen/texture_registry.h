@@ -0,0 +1,140 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "config/common.h"
+
+struct GL_TEXTURE_2D_DESC;
+
+/**
+ * @brief External textures of one engine, read by the raster thread without
+ * locks.
+ *
+ * Readers see an immutable snapshot of the registry.  A writer copies the
+ * snapshot, changes the copy and publishes it; the previous snapshot is
+ * deleted once no reader still uses it.  A read is a hash lookup between two
+ * atomic increments, it never waits for a writer.  Writers are serialized and
+ * wait for the readers that started before the snapshot changed, counted per
+ * epoch so that readers arriving meanwhile cannot hold the writer off.
+ * Registration is rare, so copying the map is cheap.
+ *
+ * Entries are immutable once inserted.  A writer must not run inside a Reader
+ * of the same registry on its thread.
+ */
+class TextureRegistry {
+  using Map =
+      std::unordered_map<int64_t, std::shared_ptr<const GL_TEXTURE_2D_DESC>>;
+
+ public:
+  using Entry = std::shared_ptr<const GL_TEXTURE_2D_DESC>;
+
+  /// Read side critical section, entries found are valid for its lifetime
+  class Reader {
+   public:
+    explicit Reader(const TextureRegistry& registry);
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    /**
+     * @brief Look up a texture, wait free
+     * @param[in] texture_id Texture id
+     * @return const GL_TEXTURE_2D_DESC*
+     * @retval Texture, valid until the Reader is destroyed
+     * @retval nullptr Texture is not registered
+     * @relation
+     * flutter
+     */
+    NODISCARD const GL_TEXTURE_2D_DESC* Find(int64_t texture_id) const;
+
+   private:
+    friend class TextureRegistry;
+
+    const TextureRegistry& m_registry;
+    uint32_t m_epoch;
+    const Map* m_snapshot;
+  };
+
+  TextureRegistry();
+  ~TextureRegistry();
+
+  TextureRegistry(const TextureRegistry&) = delete;
+  TextureRegistry& operator=(const TextureRegistry&) = delete;
+
+  /**
+   * @brief Register or replace a texture
+   * @param[in] texture_id Texture id
+   * @param[in] entry Texture
+   * @return Entry
+   * @retval Replaced texture, no longer seen by any reader
+   * @retval nullptr Texture id was not registered
+   * @relation
+   * flutter
+   */
+  Entry Insert(int64_t texture_id, Entry entry);
+
+  /**
+   * @brief Unregister a texture
+   * @param[in] texture_id Texture id
+   * @return Entry
+   * @retval Removed texture, no longer seen by any reader
+   * @retval nullptr Texture id was not registered
+   * @relation
+   * flutter
+   */
+  Entry Remove(int64_t texture_id);
+
+  /**
+   * @brief Texture registered under an id, outside the raster thread
+   * @param[in] texture_id Texture id
+   * @return Entry
+   * @retval Texture
+   * @retval nullptr Texture id is not registered
+   * @relation
+   * flutter
+   */
+  NODISCARD Entry Get(int64_t texture_id) const;
+
+  NODISCARD size_t size() const;
+
+ private:
+  std::mutex m_write_mutex;
+  std::atomic<const Map*> m_snapshot;
+  /// new readers count themselves in the parity of the epoch
+  std::atomic<uint32_t> m_epoch{};
+  /// readers inside a critical section, per epoch parity
+  mutable std::array<std::atomic<uint32_t>, 2> m_readers{};
+
+  /**
+   * @brief Make a snapshot current and delete the previous one once its
+   * readers are done, with the write mutex held
+   * @param[in] next New snapshot
+   * @return void
+   * @relation
+   * flutter
+   */
+  void Publish(std::unique_ptr<const Map> next);
+};
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pointer_event_queue.h"
+
+#include "libflutter_engine.h"
+
+bool PointerEventQueue::Push(const FlutterPointerEvent& event,
+                             const uint64_t input_ns) {
+  const auto tail = m_tail.load(std::memory_order_relaxed);
+  if (tail - m_head.load(std::memory_order_acquire) == kMask + 1) {
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  m_ring[tail & kMask] = event;
+  m_input_ns[tail & kMask] = input_ns;
+  m_tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+bool PointerEventQueue::Push(const FlutterPointerEvent* events,
+                             const size_t count,
+                             const uint64_t* input_ns) {
+  const auto tail = m_tail.load(std::memory_order_relaxed);
+  if (tail + count - m_head.load(std::memory_order_acquire) > kMask + 1) {
+    m_dropped.fetch_add(count, std::memory_order_relaxed);
+    return false;
+  }
+  for (size_t i = 0; i < count; i++) {
+    m_ring[(tail + i) & kMask] = events[i];
+    m_input_ns[(tail + i) & kMask] = input_ns ? input_ns[i] : 0;
+  }
+  // published with a single store, so a flush sees all or none of the group
+  m_tail.store(tail + count, std::memory_order_release);
+  return true;
+}
+
+size_t PointerEventQueue::Flush(FLUTTER_API_SYMBOL(FlutterEngine) engine) {
+  const auto head = m_head.load(std::memory_order_relaxed);
+  const auto tail = m_tail.load(std::memory_order_acquire);
+  if (head == tail || !engine) {
+    return 0;
+  }
+
+  const auto now_ns = LibFlutterEngine->GetCurrentTime();
+  // timestamps are truncated to size_t on 32-bit targets
+  const auto now_us = static_cast<size_t>(now_ns / 1000);
+  size_t count = 0;
+  // first batch index a motion sample may be merged into
+  size_t barrier = 0;
+  for (auto i = head; i != tail; i++) {
+    const auto& event = m_ring[i & kMask];
+
+    const uint64_t latency = now_us - event.timestamp;
+    m_stats.latency_total_us += latency;
+    if (latency > m_stats.latency_max_us) {
+      m_stats.latency_max_us = latency;
+    }
+    if (m_latency) {
+      m_latency->RecordSent(m_input_ns[i & kMask], now_ns - latency * 1000,
+                            now_ns);
+    }
+
+    if (!IsMotion(event)) {
+      m_batch[count++] = event;
+      barrier = count;
+      continue;
+    }
+
+    // only motion follows |barrier|, so each device has at most one entry
+    bool merged = false;
+    for (auto j = count; j > barrier; j--) {
+      auto& previous = m_batch[j - 1];
+      if (SameDevice(previous, event)) {
+        if (previous.phase == event.phase &&
+            previous.buttons == event.buttons) {
+          previous = event;
+          merged = true;
+        }
+        break;
+      }
+    }
+    if (merged) {
+      m_stats.coalesced++;
+    } else {
+      m_batch[count++] = event;
+    }
+  }
+  m_head.store(tail, std::memory_order_release);
+
+  LibFlutterEngine->SendPointerEvent(engine, m_batch.data(), count);
+  m_stats.pushed += tail - head;
+  m_stats.sent += count;
+  m_stats.flushes++;
+  return count;
+}
+
+PointerEventQueue::Stats PointerEventQueue::TakeStats() {
+  auto stats = m_stats;
+  stats.dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+  m_stats = {};
+  return stats;
+}
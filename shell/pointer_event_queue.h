@@ -0,0 +1,137 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "flutter/shell/platform/embedder/embedder.h"
+
+#include "config/common.h"
+#include "input_latency.h"
+
+/**
+ * @brief Pointer events buffered between two engine submissions.
+ *
+ * A single producer (Wayland input dispatch) pushes into a lock-free ring and
+ * a single consumer (the main loop, once per frame) drains it.  Both run on
+ * the main thread today; the ring stays correct if input dispatch moves to a
+ * thread of its own.
+ *
+ * Flush() merges consecutive kMove/kHover samples of the same device into the
+ * latest one.  Any other event is a barrier: samples are never merged across
+ * it, so down/up/cancel ordering relative to motion is preserved.
+ */
+class PointerEventQueue {
+ public:
+  static_assert((kMaxPointerEvent & (kMaxPointerEvent - 1)) == 0,
+                "kMaxPointerEvent must be a power of two");
+
+  /// input-to-engine statistics since the last TakeStats()
+  struct Stats {
+    uint64_t pushed;
+    uint64_t sent;
+    uint64_t coalesced;
+    /// events lost to a full ring
+    uint64_t dropped;
+    uint64_t flushes;
+    /// time from event creation to SendPointerEvent, in microseconds
+    uint64_t latency_total_us;
+    uint64_t latency_max_us;
+  };
+
+  /// |latency| receives every sent event, may be nullptr
+  explicit PointerEventQueue(InputLatency* latency = nullptr)
+      : m_latency(latency) {}
+  PointerEventQueue(const PointerEventQueue&) = delete;
+  PointerEventQueue& operator=(const PointerEventQueue&) = delete;
+
+  /**
+   * @brief Append an event, producer side
+   * @param[in] event Pointer event
+   * @param[in] input_ns Wayland input time, 0 if unknown
+   * @return bool
+   * @retval true Queued
+   * @retval false Ring full, event dropped
+   * @relation
+   * flutter
+   */
+  bool Push(const FlutterPointerEvent& event, uint64_t input_ns = 0);
+
+  /**
+   * @brief Append a group of events that must reach the engine in the same
+   * flush, producer side
+   * @param[in] events Pointer events
+   * @param[in] count Number of events
+   * @param[in] input_ns Wayland input time of each event, may be nullptr
+   * @return bool
+   * @retval true Queued
+   * @retval false Not enough room, the whole group was dropped
+   * @relation
+   * flutter
+   */
+  bool Push(const FlutterPointerEvent* events,
+            size_t count,
+            const uint64_t* input_ns = nullptr);
+
+  /**
+   * @brief Coalesce all queued events and send them to the engine in one
+   * call, consumer side
+   * @param[in] engine Engine to send to
+   * @return size_t
+   * @retval Number of events sent
+   * @relation
+   * flutter
+   */
+  size_t Flush(FLUTTER_API_SYMBOL(FlutterEngine) engine);
+
+  /**
+   * @brief Return and reset the statistics, consumer side
+   * @return Stats
+   * @relation
+   * flutter
+   */
+  Stats TakeStats();
+
+ private:
+  static constexpr size_t kMask = kMaxPointerEvent - 1;
+
+  static bool IsMotion(const FlutterPointerEvent& event) {
+    return (event.phase == kMove || event.phase == kHover) &&
+           event.signal_kind == kFlutterPointerSignalKindNone;
+  }
+
+  static bool SameDevice(const FlutterPointerEvent& a,
+                         const FlutterPointerEvent& b) {
+    return a.device == b.device && a.device_kind == b.device_kind;
+  }
+
+  InputLatency* m_latency;
+
+  std::array<FlutterPointerEvent, kMaxPointerEvent> m_ring{};
+  std::array<uint64_t, kMaxPointerEvent> m_input_ns{};
+  /// next slot to read, written by the consumer
+  alignas(64) std::atomic<size_t> m_head{};
+  /// next slot to write, written by the producer
+  alignas(64) std::atomic<size_t> m_tail{};
+  std::atomic<uint64_t> m_dropped{};
+
+  // consumer only
+  alignas(64) std::array<FlutterPointerEvent, kMaxPointerEvent> m_batch{};
+  Stats m_stats{};
+};
@@ -19,6 +19,7 @@
 #include "asio/post.hpp"
 
 #include "logging/logging.h"
+#include "trace.h"
 
 TaskRunner::TaskRunner(std::string name, FlutterEngine& engine)
     : name_(std::move(name)),
@@ -26,15 +27,15 @@ TaskRunner::TaskRunner(std::string name, FlutterEngine& engine)
       io_context_(std::make_unique<asio::io_context>(ASIO_CONCURRENCY_HINT_1)),
       work_(io_context_->get_executor()),
       strand_(std::make_unique<asio::io_context::strand>(*io_context_)),
-      pri_queue_(std::make_unique<handler_priority_queue>()) {
+      pri_queue_(std::make_unique<handler_priority_queue>()),
+      deadline_timer_(*io_context_) {
   thread_ = std::thread([&]() {
     while (io_context_->run_one()) {
-      // The custom invocation hook adds the handlers to the priority queue
-      // rather than executing them from within the poll_one() call.
       while (io_context_->poll_one())
         ;
 
       pri_queue_->execute_all(engine_);
+      ArmDeadlineTimer();
     }
   });
 
@@ -45,6 +46,11 @@ TaskRunner::TaskRunner(std::string name, FlutterEngine& engine)
 }
 
 TaskRunner::~TaskRunner() {
+  // a pending wait is outstanding work and would keep the thread alive
+  asio::post(*io_context_, [&]() {
+    stopping_ = true;
+    deadline_timer_.cancel();
+  });
   work_.reset();
   thread_.join();
   spdlog::debug("[0x{:x}] {} ~Task Runner", pthread_self(), name_);
@@ -56,25 +62,58 @@ void TaskRunner::QueueFlutterTask(MAYBE_UNUSED size_t index,
                                   void* /* context */) {
   SPDLOG_TRACE("({}) [{}] Task Queue {}", index, name_, task.task);
   (void)index;
-  const auto current = LibFlutterEngine->GetCurrentTime();
-  if (current >= target_time) {
-    post(*strand_, [&, task]() { LibFlutterEngine->RunTask(engine_, &task); });
-  } else {
-    asio::post(*strand_, pri_queue_->wrap(target_time, [&, task]() {
-      LibFlutterEngine->RunTask(engine_, &task);
-    }));
+  // Immediate and delayed tasks share the pooled queue; due tasks run on
+  // the next pass.  Only the first task after a collect() posts a wakeup,
+  // and that post reuses wake_memory_.
+  if (pri_queue_->add(target_time, task)) {
+    asio::post(*strand_, make_custom_alloc_handler(
+                             wake_memory_, [&]() { pri_queue_->collect(); }));
   }
 }
 
-std::future<FlutterEngineResult> TaskRunner::QueuePlatformMessage(
+void TaskRunner::ArmDeadlineTimer() {
+  if (stopping_ || pri_queue_->empty()) {
+    return;
+  }
+
+  const auto deadline = pri_queue_->next_timestamp();
+  if (deadline == armed_deadline_) {
+    return;
+  }
+  armed_deadline_ = deadline;
+
+  // GetCurrentTime is CLOCK_MONOTONIC, as is steady_clock
+  const auto current = LibFlutterEngine->GetCurrentTime();
+  deadline_timer_.expires_after(
+      std::chrono::nanoseconds(deadline > current ? deadline - current : 0));
+  // Completion only has to return from run_one(); re-arming cancels the
+  // previous wait, which must not clear the new deadline.
+  auto& memory = deadline_memory_[deadline_memory_index_];
+  deadline_memory_index_ ^= 1;
+  deadline_timer_.async_wait(
+      make_custom_alloc_handler(memory, [&](const asio::error_code& ec) {
+        if (ec != asio::error::operation_aborted) {
+          armed_deadline_ = 0;
+        }
+      }));
+}
+
+namespace {
+
+/// posts a message whose payload offers data() and size() through ->
+template <typename Message>
+std::future<FlutterEngineResult> PostPlatformMessage(
+    asio::io_context::strand& strand,
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
     const char* channel,
-    std::unique_ptr<std::vector<uint8_t>> message,
-    FlutterPlatformMessageResponseHandle* handle) const {
+    Message message,
+    const FlutterPlatformMessageResponseHandle* handle) {
   auto promise(std::make_unique<std::promise<FlutterEngineResult>>());
   auto future(promise->get_future());
 
-  post(*strand_, [channel, message = std::move(message), handle,
-                  promise = std::move(promise), engine = engine_]() {
+  post(strand, [channel, message = std::move(message), handle,
+                promise = std::move(promise), engine]() {
+    TRACE_SCOPE("FlutterEngineSendPlatformMessage");
     const FlutterPlatformMessage msg{
         sizeof(FlutterPlatformMessage),
         channel,
@@ -89,6 +128,24 @@ std::future<FlutterEngineResult> TaskRunner::QueuePlatformMessage(
   return future;
 }
 
+}  // namespace
+
+std::future<FlutterEngineResult> TaskRunner::QueuePlatformMessage(
+    const char* channel,
+    MessageBufferRef message,
+    const FlutterPlatformMessageResponseHandle* handle) const {
+  return PostPlatformMessage(*strand_, engine_, channel, std::move(message),
+                             handle);
+}
+
+std::future<FlutterEngineResult> TaskRunner::QueuePlatformMessage(
+    const char* channel,
+    std::unique_ptr<std::vector<uint8_t>> message,
+    const FlutterPlatformMessageResponseHandle* handle) const {
+  return PostPlatformMessage(*strand_, engine_, channel, std::move(message),
+                             handle);
+}
+
 std::future<FlutterEngineResult> TaskRunner::QueueUpdateLocales(
     std::vector<const FlutterLocale*> locales) const {
   auto promise(std::make_unique<std::promise<FlutterEngineResult>>());
@@ -18,15 +18,19 @@
 
 #include <future>
 #include <memory>
+#include <vector>
 
 #include "asio/executor_work_guard.hpp"
 #include "asio/io_context.hpp"
 #include "asio/io_context_strand.hpp"
+#include "asio/steady_timer.hpp"
 
 #include "flutter/shell/platform/embedder/embedder.h"
 
 #include "config/common.h"
+#include "handler_memory.h"
 #include "handler_priority_queue.h"
+#include "message_buffer.h"
 
 class TaskRunner {
  public:
@@ -45,10 +49,35 @@ class TaskRunner {
                         FlutterTask task,
                         void* context);
 
+  /**
+   * @brief Send a platform message on the runner thread
+   * @param[in] channel Destination channel, valid until the future is ready
+   * @param[in] message Payload, handed to the engine without copying
+   * @param[in] handle Optional response handle
+   * @return std::future<FlutterEngineResult>
+   * @retval Result of the send
+   * @relation
+   * flutter
+   */
+  std::future<FlutterEngineResult> QueuePlatformMessage(
+      const char* channel,
+      MessageBufferRef message,
+      const FlutterPlatformMessageResponseHandle* handle = nullptr) const;
+
+  /**
+   * @brief Send a platform message on the runner thread
+   * @param[in] channel Destination channel, valid until the future is ready
+   * @param[in] message Payload, adopted and handed to the engine as is
+   * @param[in] handle Optional response handle
+   * @return std::future<FlutterEngineResult>
+   * @retval Result of the send
+   * @relation
+   * flutter
+   */
   std::future<FlutterEngineResult> QueuePlatformMessage(
       const char* channel,
       std::unique_ptr<std::vector<uint8_t>> message,
-      FlutterPlatformMessageResponseHandle* handle = nullptr) const;
+      const FlutterPlatformMessageResponseHandle* handle = nullptr) const;
 
   NODISCARD std::future<FlutterEngineResult> QueueUpdateLocales(
       std::vector<const FlutterLocale*> locales) const;
@@ -68,4 +97,23 @@ class TaskRunner {
   asio::executor_work_guard<decltype(io_context_->get_executor())> work_;
   std::unique_ptr<asio::io_context::strand> strand_;
   std::unique_ptr<handler_priority_queue> pri_queue_;
+  asio::steady_timer deadline_timer_;
+  uint64_t armed_deadline_{};
+  bool stopping_{};
+
+  // Handler storage for the coalesced queue wakeup, and for the deadline
+  // wait plus the cancelled wait it may replace.
+  handler_memory wake_memory_;
+  handler_memory deadline_memory_[2];
+  size_t deadline_memory_index_{};
+
+  /**
+   * @brief Arm the deadline timer for the earliest delayed task, so the
+   * runner thread wakes when it is due instead of on unrelated traffic.
+   * Runner thread only.
+   * @return void
+   * @relation
+   * flutter
+   */
+  void ArmDeadlineTimer();
 };
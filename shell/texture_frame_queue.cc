@@ -0,0 +1,76 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "texture_frame_queue.h"
+
+#include <algorithm>
+
+#include "libflutter_engine.h"
+
+bool TextureFrameQueue::Mark(const int64_t texture_id) {
+  std::scoped_lock lock(m_mutex);
+  m_marks++;
+  if (std::find(m_dirty.begin(), m_dirty.end(), texture_id) != m_dirty.end()) {
+    m_coalesced++;
+    return false;
+  }
+  m_dirty.push_back(texture_id);
+  return m_dirty.size() == 1;
+}
+
+size_t TextureFrameQueue::Flush(FLUTTER_API_SYMBOL(FlutterEngine) engine,
+                                Prepare prepare,
+                                void* user_data) {
+  {
+    // both vectors keep their capacity, a steady state flush allocates none
+    std::scoped_lock lock(m_mutex);
+    if (m_dirty.empty() || !engine) {
+      return 0;
+    }
+    m_batch.swap(m_dirty);
+    m_stats.marks += m_marks;
+    m_stats.coalesced += m_coalesced;
+    m_marks = 0;
+    m_coalesced = 0;
+  }
+
+  // outside the lock, producers mark the next frame meanwhile
+  if (prepare != nullptr) {
+    prepare(m_batch, user_data);
+  }
+  for (const auto texture_id : m_batch) {
+    LibFlutterEngine->MarkExternalTextureFrameAvailable(engine, texture_id);
+  }
+  const auto count = m_batch.size();
+  m_batch.clear();
+  m_stats.sent += count;
+  m_stats.flushes++;
+  return count;
+}
+
+TextureFrameQueue::Stats TextureFrameQueue::TakeStats() {
+  auto stats = m_stats;
+  {
+    // marks of the frame not flushed yet
+    std::scoped_lock lock(m_mutex);
+    stats.marks += m_marks;
+    stats.coalesced += m_coalesced;
+    m_marks = 0;
+    m_coalesced = 0;
+  }
+  m_stats = {};
+  return stats;
+}
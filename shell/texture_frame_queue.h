@@ -0,0 +1,101 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "flutter/shell/platform/embedder/embedder.h"
+
+#include "config/common.h"
+
+/**
+ * @brief External textures marked available since the last frame.
+ *
+ * Plugins mark frames from their own threads, often faster than the display
+ * refreshes.  Marks only add the texture to a dirty set; the main loop flushes
+ * the set once per frame, right before answering the vsync, with one engine
+ * call per texture.  Marks of a texture already in the set are coalesced.
+ *
+ * The set holds the handful of textures that change per frame, so a scan is
+ * all a lookup needs.
+ *
+ * A prepare step may run on the batch first, on the consumer thread, e.g. to
+ * copy pixel buffers; it removes the textures that have no frame after all.
+ */
+class TextureFrameQueue {
+ public:
+  /// statistics since the last TakeStats()
+  struct Stats {
+    uint64_t marks;
+    uint64_t sent;
+    /// marks of a texture already pending
+    uint64_t coalesced;
+    uint64_t flushes;
+  };
+
+  /// prepares the batch of a flush, removing the textures not to mark
+  using Prepare = void (*)(std::vector<int64_t>& batch, void* user_data);
+
+  TextureFrameQueue() = default;
+  TextureFrameQueue(const TextureFrameQueue&) = delete;
+  TextureFrameQueue& operator=(const TextureFrameQueue&) = delete;
+
+  /**
+   * @brief Add a texture to the dirty set, any thread
+   * @param[in] texture_id Texture id
+   * @return bool
+   * @retval true The set was empty, a frame must be scheduled for the flush
+   * @retval false A flush is pending already
+   * @relation
+   * flutter
+   */
+  bool Mark(int64_t texture_id);
+
+  /**
+   * @brief Mark each dirty texture available to the engine, consumer side
+   * @param[in] engine Engine to mark the textures in
+   * @param[in] prepare Optional step run on the batch before it is marked
+   * @param[in] user_data Passed to prepare
+   * @return size_t
+   * @retval Number of textures marked
+   * @relation
+   * flutter
+   */
+  size_t Flush(FLUTTER_API_SYMBOL(FlutterEngine) engine,
+               Prepare prepare = nullptr,
+               void* user_data = nullptr);
+
+  /**
+   * @brief Return and reset the statistics, consumer side
+   * @return Stats
+   * @relation
+   * flutter
+   */
+  Stats TakeStats();
+
+ private:
+  std::mutex m_mutex;
+  std::vector<int64_t> m_dirty;
+  uint64_t m_marks{};
+  uint64_t m_coalesced{};
+
+  // consumer only
+  std::vector<int64_t> m_batch;
+  Stats m_stats{};
+};
@@ -0,0 +1,401 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "libflutter_engine.h"
+#include "logging/logging.h"
+
+namespace {
+
+uint64_t Now() {
+  // steady_clock is CLOCK_MONOTONIC, as is FlutterEngineGetCurrentTime
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+void AppendJsonString(std::string& out, const char* value) {
+  out += '"';
+  for (; *value; value++) {
+    const auto c = *value;
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      out += ' ';
+    } else {
+      out += c;
+    }
+  }
+  out += '"';
+}
+
+// Perfetto protobuf, see protos/perfetto/trace/trace_packet.proto
+namespace proto {
+
+enum WireType : uint32_t {
+  kVarint = 0,
+  kLengthDelimited = 2,
+};
+
+void AppendVarint(std::string& out, uint64_t value) {
+  while (value >= 0x80) {
+    out += static_cast<char>((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  out += static_cast<char>(value);
+}
+
+void AppendTag(std::string& out, const uint32_t field, const WireType type) {
+  AppendVarint(out, (uint64_t{field} << 3) | type);
+}
+
+void AppendVarintField(std::string& out,
+                       const uint32_t field,
+                       const uint64_t value) {
+  AppendTag(out, field, kVarint);
+  AppendVarint(out, value);
+}
+
+void AppendBytesField(std::string& out,
+                      const uint32_t field,
+                      const std::string& value) {
+  AppendTag(out, field, kLengthDelimited);
+  AppendVarint(out, value.size());
+  out += value;
+}
+
+// Trace
+constexpr uint32_t kTracePacket = 1;
+// TracePacket
+constexpr uint32_t kClockSnapshot = 6;
+constexpr uint32_t kTimestamp = 8;
+constexpr uint32_t kTrustedPacketSequenceId = 10;
+constexpr uint32_t kTrackEvent = 11;
+constexpr uint32_t kSequenceFlags = 13;
+constexpr uint32_t kTimestampClockId = 58;
+constexpr uint32_t kTrackDescriptor = 60;
+constexpr uint64_t kSeqIncrementalStateCleared = 1;
+constexpr uint64_t kBuiltinClockMonotonic = 3;
+constexpr uint64_t kBuiltinClockBoottime = 6;
+// ClockSnapshot, Clock
+constexpr uint32_t kClocks = 1;
+constexpr uint32_t kPrimaryTraceClock = 2;
+constexpr uint32_t kClockId = 1;
+constexpr uint32_t kClockTimestamp = 2;
+// TrackDescriptor
+constexpr uint32_t kUuid = 1;
+constexpr uint32_t kProcess = 3;
+constexpr uint32_t kThread = 4;
+constexpr uint32_t kParentUuid = 5;
+// ProcessDescriptor, ThreadDescriptor
+constexpr uint32_t kPid = 1;
+constexpr uint32_t kTid = 2;
+constexpr uint32_t kProcessName = 6;
+constexpr uint32_t kThreadName = 5;
+// TrackEvent
+constexpr uint32_t kType = 9;
+constexpr uint32_t kTrackUuid = 11;
+constexpr uint32_t kName = 23;
+constexpr uint64_t kTypeSliceBegin = 1;
+constexpr uint64_t kTypeSliceEnd = 2;
+constexpr uint64_t kTypeInstant = 3;
+
+}  // namespace proto
+
+}  // namespace
+
+thread_local Trace::ThreadBuffer* Trace::t_buffer = nullptr;
+
+Trace& Trace::Instance() {
+  static Trace instance;
+  return instance;
+}
+
+void Trace::Configure(const std::string& output_path,
+                      const bool forward_to_engine) {
+  {
+    std::scoped_lock lock(m_threads_mutex);
+    m_output_path = output_path;
+  }
+  if (forward_to_engine && LibFlutterEngine::IsPresent()) {
+    m_engine_begin = LibFlutterEngine->TraceEventDurationBegin;
+    m_engine_end = LibFlutterEngine->TraceEventDurationEnd;
+    m_engine_instant = LibFlutterEngine->TraceEventInstant;
+  }
+  m_forward.store(forward_to_engine && m_engine_begin && m_engine_end &&
+                      m_engine_instant,
+                  std::memory_order_relaxed);
+  m_recording.store(!output_path.empty(), std::memory_order_relaxed);
+  m_active.store(IsRecording() || m_forward.load(std::memory_order_relaxed),
+                 std::memory_order_relaxed);
+}
+
+void Trace::Record(const Phase phase, const char* name) {
+  if (m_forward.load(std::memory_order_relaxed)) {
+    Forward(phase, name);
+  }
+  if (!m_recording.load(std::memory_order_relaxed)) {
+    return;
+  }
+  auto* buffer = t_buffer;
+  if (!buffer) {
+    buffer = RegisterThread();
+  }
+
+  const auto now = Now();
+  const auto index = buffer->head.load(std::memory_order_relaxed);
+  // readers drop the slot this claim may be overwriting
+  buffer->claimed.store(index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  auto& slot = buffer->slots[index & kMask];
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.stamp.store(now << 2 | phase, std::memory_order_relaxed);
+  buffer->head.store(index + 1, std::memory_order_release);
+}
+
+void Trace::Forward(const Phase phase, const char* name) const {
+  switch (phase) {
+    case kBegin:
+      m_engine_begin(name);
+      break;
+    case kEnd:
+      m_engine_end(name);
+      break;
+    case kInstant:
+      m_engine_instant(name);
+      break;
+  }
+}
+
+Trace::ThreadBuffer* Trace::RegisterThread() {
+  auto buffer = std::make_unique<ThreadBuffer>();
+  buffer->tid = static_cast<int32_t>(syscall(SYS_gettid));
+  char name[16]{};
+  if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0) {
+    buffer->name = name;
+  }
+
+  std::scoped_lock lock(m_threads_mutex);
+  t_buffer = buffer.get();
+  m_threads.emplace_back(std::move(buffer));
+  return t_buffer;
+}
+
+std::vector<Trace::Thread> Trace::Snapshot() const {
+  std::scoped_lock lock(m_threads_mutex);
+  std::vector<Thread> threads;
+  threads.reserve(m_threads.size());
+
+  for (auto const& buffer : m_threads) {
+    Thread thread{buffer->tid, buffer->name, {}};
+    const auto head = buffer->head.load(std::memory_order_acquire);
+    const auto first = head > kEventsPerThread ? head - kEventsPerThread : 0;
+    thread.events.reserve(head - first);
+    for (auto index = first; index < head; index++) {
+      const auto& slot = buffer->slots[index & kMask];
+      const auto stamp = slot.stamp.load(std::memory_order_relaxed);
+      thread.events.push_back({slot.name.load(std::memory_order_relaxed),
+                               stamp >> 2, static_cast<Phase>(stamp & 3)});
+    }
+
+    // drop the events the thread overwrote while they were copied
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto claimed = buffer->claimed.load(std::memory_order_relaxed);
+    const auto valid =
+        claimed > kEventsPerThread ? claimed - kEventsPerThread : 0;
+    if (valid > first) {
+      thread.events.erase(
+          thread.events.begin(),
+          thread.events.begin() +
+              static_cast<std::ptrdiff_t>(std::min(valid, head) - first));
+    }
+    threads.emplace_back(std::move(thread));
+  }
+  return threads;
+}
+
+void Trace::Clear() {
+  std::scoped_lock lock(m_threads_mutex);
+  for (auto const& buffer : m_threads) {
+    // only safe while the thread is not recording
+    buffer->head.store(0, std::memory_order_relaxed);
+    buffer->claimed.store(0, std::memory_order_relaxed);
+  }
+}
+
+bool Trace::Write() const {
+  std::string path;
+  {
+    std::scoped_lock lock(m_threads_mutex);
+    path = m_output_path;
+  }
+  if (path.empty()) {
+    return false;
+  }
+
+  const auto threads = Snapshot();
+  const auto pid = static_cast<int32_t>(getpid());
+  const auto json = path.size() >= 5 && path.rfind(".json") == path.size() - 5;
+  const auto data = json ? ToChromeJson(threads, pid) : ToPerfetto(threads, pid);
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file || !file.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+    spdlog::error("Failed to write trace: {}", path);
+    return false;
+  }
+  size_t events = 0;
+  for (auto const& thread : threads) {
+    events += thread.events.size();
+  }
+  spdlog::info("Trace: {} events of {} threads written to {}", events,
+               threads.size(), path);
+  return true;
+}
+
+std::string Trace::ToChromeJson(const std::vector<Thread>& threads,
+                                const int32_t pid) {
+  static constexpr char kPhases[] = {'B', 'E', 'i'};
+  const auto pid_str = std::to_string(pid);
+
+  std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  for (auto const& thread : threads) {
+    const auto tid_str = std::to_string(thread.tid);
+    if (!first) {
+      out += ',';
+    }
+    first = false;
+    out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid_str +
+           ",\"tid\":" + tid_str + ",\"args\":{\"name\":";
+    AppendJsonString(out, thread.name.c_str());
+    out += "}}";
+
+    for (auto const& event : thread.events) {
+      out += ",{\"name\":";
+      AppendJsonString(out, event.name);
+      out += ",\"ph\":\"";
+      out += kPhases[event.phase];
+      // microseconds with nanosecond precision
+      out += "\",\"ts\":" + std::to_string(event.timestamp_ns / 1000) + '.';
+      const auto ns = std::to_string(event.timestamp_ns % 1000);
+      out.append(3 - ns.size(), '0') += ns;
+      out += ",\"pid\":" + pid_str + ",\"tid\":" + tid_str;
+      if (event.phase == kInstant) {
+        out += ",\"s\":\"t\"";
+      }
+      out += '}';
+    }
+  }
+  out += "]}\n";
+  return out;
+}
+
+std::string Trace::ToPerfetto(const std::vector<Thread>& threads,
+                              const int32_t pid) {
+  using namespace proto;
+  const uint64_t process_uuid = static_cast<uint64_t>(pid) << 32;
+
+  std::string out;
+  std::string packet;
+  std::string message;
+  std::string descriptor;
+
+  const auto append_packet = [&out, &packet]() {
+    AppendBytesField(out, kTracePacket, packet);
+    packet.clear();
+  };
+
+  // monotonic is the trace clock, so the timeline matches the engine's
+  for (const auto clock_id : {kBuiltinClockMonotonic, kBuiltinClockBoottime}) {
+    timespec now{};
+    clock_gettime(clock_id == kBuiltinClockMonotonic ? CLOCK_MONOTONIC
+                                                     : CLOCK_BOOTTIME,
+                  &now);
+    descriptor.clear();
+    AppendVarintField(descriptor, kClockId, clock_id);
+    AppendVarintField(descriptor, kClockTimestamp,
+                      static_cast<uint64_t>(now.tv_sec) * 1'000'000'000 +
+                          static_cast<uint64_t>(now.tv_nsec));
+    AppendBytesField(message, kClocks, descriptor);
+  }
+  AppendVarintField(message, kPrimaryTraceClock, kBuiltinClockMonotonic);
+  AppendBytesField(packet, kClockSnapshot, message);
+  append_packet();
+
+  // process track
+  descriptor.clear();
+  message.clear();
+  AppendVarintField(descriptor, kPid, static_cast<uint32_t>(pid));
+  AppendBytesField(descriptor, kProcessName, kApplicationName);
+  message.clear();
+  AppendVarintField(message, kUuid, process_uuid);
+  AppendBytesField(message, kProcess, descriptor);
+  AppendBytesField(packet, kTrackDescriptor, message);
+  append_packet();
+
+  uint32_t sequence = 1;
+  for (auto const& thread : threads) {
+    const auto track_uuid = process_uuid | static_cast<uint32_t>(thread.tid);
+
+    descriptor.clear();
+    AppendVarintField(descriptor, kPid, static_cast<uint32_t>(pid));
+    AppendVarintField(descriptor, kTid, static_cast<uint32_t>(thread.tid));
+    AppendBytesField(descriptor, kThreadName, thread.name);
+    message.clear();
+    AppendVarintField(message, kUuid, track_uuid);
+    AppendVarintField(message, kParentUuid, process_uuid);
+    AppendBytesField(message, kThread, descriptor);
+    AppendBytesField(packet, kTrackDescriptor, message);
+    append_packet();
+
+    bool first = true;
+    for (auto const& event : thread.events) {
+      message.clear();
+      AppendVarintField(message, kType,
+                        event.phase == kBegin ? kTypeSliceBegin
+                        : event.phase == kEnd ? kTypeSliceEnd
+                                              : kTypeInstant);
+      AppendVarintField(message, kTrackUuid, track_uuid);
+      if (event.phase != kEnd) {
+        AppendBytesField(message, kName, event.name);
+      }
+
+      AppendVarintField(packet, kTimestamp, event.timestamp_ns);
+      AppendVarintField(packet, kTimestampClockId, kBuiltinClockMonotonic);
+      AppendVarintField(packet, kTrustedPacketSequenceId, sequence);
+      if (first) {
+        AppendVarintField(packet, kSequenceFlags, kSeqIncrementalStateCleared);
+        first = false;
+      }
+      AppendBytesField(packet, kTrackEvent, message);
+      append_packet();
+    }
+    sequence++;
+  }
+  return out;
+}
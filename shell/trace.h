@@ -0,0 +1,220 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "config/common.h"
+
+/**
+ * @brief Embedder trace events.
+ *
+ * Every thread records into its own ring of the most recent kEventsPerThread
+ * events without locking; the rings are written out as Chrome JSON or
+ * Perfetto protobuf on request.  Timestamps are CLOCK_MONOTONIC, the clock
+ * of FlutterEngineGetCurrentTime(), so the spans line up with the engine's
+ * timeline.  Events may also be forwarded to the engine's own timeline.
+ *
+ * Event names must be string literals; only the pointer is stored.
+ */
+class Trace {
+ public:
+  /// events kept per thread, power of two
+  static constexpr size_t kEventsPerThread = 8192;
+
+  enum Phase : uint8_t {
+    kBegin,
+    kEnd,
+    kInstant,
+  };
+
+  struct Event {
+    const char* name;
+    uint64_t timestamp_ns;
+    Phase phase;
+  };
+
+  struct Thread {
+    int32_t tid;
+    std::string name;
+    std::vector<Event> events;
+  };
+
+  static Trace& Instance();
+
+  /**
+   * @brief Start or stop recording; call before other threads emit events
+   * @param[in] output_path Trace file written by Write(), empty to stop
+   * recording
+   * @param[in] forward_to_engine Also emit the events on the engine timeline
+   * @return void
+   * @relation
+   * internal
+   */
+  void Configure(const std::string& output_path, bool forward_to_engine);
+
+  NODISCARD bool IsRecording() const {
+    return m_recording.load(std::memory_order_relaxed);
+  }
+
+  void Begin(const char* name) {
+    if (m_active.load(std::memory_order_relaxed)) {
+      Record(kBegin, name);
+    }
+  }
+
+  void End(const char* name) {
+    if (m_active.load(std::memory_order_relaxed)) {
+      Record(kEnd, name);
+    }
+  }
+
+  void Instant(const char* name) {
+    if (m_active.load(std::memory_order_relaxed)) {
+      Record(kInstant, name);
+    }
+  }
+
+  /**
+   * @brief Copy the events recorded by every thread, oldest first
+   * @return std::vector<Thread>
+   * @relation
+   * internal
+   */
+  NODISCARD std::vector<Thread> Snapshot() const;
+
+  /**
+   * @brief Drop all recorded events
+   * @return void
+   * @relation
+   * internal
+   */
+  void Clear();
+
+  /**
+   * @brief Write the recorded events to the configured output path.  A
+   * ".json" path gets Chrome JSON, anything else Perfetto protobuf.
+   * @return bool
+   * @retval true Written
+   * @retval false Not recording or the file could not be written
+   * @relation
+   * internal
+   */
+  bool Write() const;
+
+  /**
+   * @brief Write |threads| as Chrome trace event JSON
+   * @param[in] threads Recorded events
+   * @param[in] pid Process id
+   * @return std::string
+   * @relation
+   * internal
+   */
+  static std::string ToChromeJson(const std::vector<Thread>& threads,
+                                  int32_t pid);
+
+  /**
+   * @brief Write |threads| as a Perfetto Trace protobuf of track events
+   * @param[in] threads Recorded events
+   * @param[in] pid Process id
+   * @return std::string
+   * @relation
+   * internal
+   */
+  static std::string ToPerfetto(const std::vector<Thread>& threads,
+                                int32_t pid);
+
+ private:
+  static constexpr size_t kMask = kEventsPerThread - 1;
+
+  struct Slot {
+    std::atomic<const char*> name{};
+    /// timestamp_ns << 2 | phase
+    std::atomic<uint64_t> stamp{};
+  };
+
+  struct ThreadBuffer {
+    int32_t tid{};
+    std::string name;
+    std::array<Slot, kEventsPerThread> slots{};
+    /// events published
+    std::atomic<uint64_t> head{};
+    /// events published or being written
+    std::atomic<uint64_t> claimed{};
+  };
+
+  using EngineTraceFn = void (*)(const char* name);
+
+  /// the calling thread's ring, owned by Instance()
+  static thread_local ThreadBuffer* t_buffer;
+
+  Trace() = default;
+
+  void Record(Phase phase, const char* name);
+  ThreadBuffer* RegisterThread();
+  void Forward(Phase phase, const char* name) const;
+
+  /// recording or forwarding
+  std::atomic<bool> m_active{};
+  std::atomic<bool> m_recording{};
+  std::atomic<bool> m_forward{};
+  EngineTraceFn m_engine_begin{};
+  EngineTraceFn m_engine_end{};
+  EngineTraceFn m_engine_instant{};
+  std::string m_output_path;
+
+  mutable std::mutex m_threads_mutex;
+  /// never shrinks, so events of exited threads are kept
+  std::vector<std::unique_ptr<ThreadBuffer>> m_threads;
+};
+
+/**
+ * @brief Begin/End pair for the enclosing scope
+ */
+class TraceScope {
+ public:
+  explicit TraceScope(const char* name) : m_name(name) {
+    Trace::Instance().Begin(name);
+  }
+
+  ~TraceScope() { Trace::Instance().End(m_name); }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  const char* m_name;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#if ENABLE_TRACING
+// "" rejects anything but a string literal
+#define TRACE_SCOPE(name) \
+  const TraceScope TRACE_CONCAT(trace_scope_, __LINE__)("" name)
+#define TRACE_INSTANT(name) Trace::Instance().Instant("" name)
+#else
+#define TRACE_SCOPE(name) static_cast<void>(0)
+#define TRACE_INSTANT(name) static_cast<void>(0)
+#endif
@@ -9,6 +9,8 @@
 #include <wayland-egl.h>
 #include <utility>
 
+#include "../event_loop.h"
+#include "../trace.h"
 #include "../utils.h"
 #include "../view/flutter_view.h"
 #include "../wayland/display.h"
@@ -40,6 +42,7 @@ CompositorSurface::CompositorSurface(
       m_origin_x(x),
       m_origin_y(y),
       m_context(nullptr),
+      m_event_loop(display->GetEventLoop()),
       m_callback(nullptr) {
   // API
   init_api(this);
@@ -87,6 +90,11 @@ CompositorSurface::CompositorSurface(
 void CompositorSurface::Dispose(void* userdata) {
   auto* obj = static_cast<CompositorSurface*>(userdata);
 
+  if (obj->m_event_fd >= 0) {
+    obj->m_event_loop->RemoveFd(obj->m_event_fd);
+    obj->m_event_fd = -1;
+  }
+
   obj->m_api.de_initialize(obj->m_context);
   obj->m_context = nullptr;
 
@@ -154,6 +162,9 @@ void CompositorSurface::init_api(CompositorSurface* obj) {
   if (!obj->m_api.resize) {
     goto invalid;
   }
+  // optional
+  obj->m_api.get_event_fd = reinterpret_cast<COMP_SURF_API_GET_EVENT_FD_T*>(
+      dlsym(obj->m_h_module, "comp_surf_get_event_fd"));
   return;
 
 invalid:
@@ -180,9 +191,23 @@ void CompositorSurface::InitializePlugin() {
   m_context =
       m_api.initialize("", width_, height_, &m_wl, m_assets_path.c_str(),
                        m_cache_path.c_str(), m_misc_path.c_str());
+
+  if (m_context && m_api.get_event_fd) {
+    const auto fd = m_api.get_event_fd(m_context);
+    if (fd >= 0 && m_event_loop->AddFd(fd, EPOLLIN, on_event, this)) {
+      m_event_fd = fd;
+    }
+  }
+
   StartFrames();
 }
 
+void CompositorSurface::on_event(void* data,
+                                 int /* fd */,
+                                 uint32_t /* events */) {
+  static_cast<CompositorSurface*>(data)->RunTask();
+}
+
 void CompositorSurface::StartFrames() {
   if (m_callback)
     wl_callback_destroy(m_callback);
@@ -206,7 +231,10 @@ void CompositorSurface::on_frame(void* data,
   if (callback)
     wl_callback_destroy(callback);
 
-  obj->m_api.draw_frame(obj->m_context, time);
+  {
+    TRACE_SCOPE("CompositorSurface::draw_frame");
+    obj->m_api.draw_frame(obj->m_context, time);
+  }
 
   obj->m_callback = wl_surface_frame(obj->m_wl.surface);
   wl_callback_add_listener(obj->m_callback, &CompositorSurface::frame_listener,
@@ -13,6 +13,8 @@
 
 class Display;
 
+class EventLoop;
+
 class FlutterView;
 
 class WaylandWindow;
@@ -80,6 +82,16 @@ class CompositorSurface {
     }
   }
 
+  /**
+   * @brief check if run_task is driven by a plugin event fd
+   * @return bool
+   * @retval true if the plugin provided an event fd
+   * @retval false if run_task has to be polled
+   * @relation
+   * internal
+   */
+  NODISCARD bool HasEventFd() const { return m_event_fd >= 0; }
+
   /**
    * @brief dispose a surface context
    * @param[in] userdata
@@ -147,10 +159,14 @@ class CompositorSurface {
     COMP_SURF_API_RUN_TASK_T* run_task{};
     COMP_SURF_API_DRAW_FRAME_T* draw_frame{};
     COMP_SURF_API_RESIZE_T* resize{};
+    COMP_SURF_API_GET_EVENT_FD_T* get_event_fd{};
   } m_api;
 
   COMP_SURF_API_CONTEXT_T* m_context{};
 
+  EventLoop* m_event_loop;
+  int m_event_fd{-1};
+
   struct wl_callback* m_callback;
 
   /**
@@ -171,5 +187,16 @@ class CompositorSurface {
    * plugin, wayland
    */
   static void on_frame(void* data, struct wl_callback* callback, uint32_t time);
+
+  /**
+   * @brief run a plugin task when its event fd is ready
+   * @param[in] data user data
+   * @param[in] fd the plugin event fd
+   * @param[in] events ready events
+   * @return void
+   * @relation
+   * plugin
+   */
+  static void on_event(void* data, int fd, uint32_t events);
   static const struct wl_callback_listener frame_listener;
 };
@@ -34,3 +34,8 @@ typedef void COMP_SURF_API_RUN_TASK_T(COMP_SURF_API_CONTEXT_T* ctx);
 typedef void COMP_SURF_API_RESIZE_T(COMP_SURF_API_CONTEXT_T* ctx,
                                     int width,
                                     int height);
+
+// Optional.  Returns an fd that becomes readable when the plugin has work for
+// run_task, or -1.  When provided, run_task is driven by the homescreen event
+// loop instead of being polled every main loop iteration.
+typedef int COMP_SURF_API_GET_EVENT_FD_T(COMP_SURF_API_CONTEXT_T* ctx);
@@ -21,6 +21,8 @@
 #include "backend/headless/headless.h"
 #elif BUILD_BACKEND_WAYLAND_DRM
 #include "backend/wayland_drm/wayland_drm.h"
+#elif BUILD_BACKEND_WAYLAND_SOFTWARE
+#include "backend/wayland_software/wayland_software.h"
 #elif BUILD_BACKEND_WAYLAND_EGL
 #include "backend/wayland_egl/wayland_egl.h"
 #elif BUILD_BACKEND_WAYLAND_VULKAN
@@ -57,6 +59,10 @@
 #include <plugins/webview_flutter_view/include/webview_flutter_view/webview_flutter_view_plugin_c_api.h>
 #endif
 
+#include <unistd.h>
+
+#include "event_loop.h"
+#include "trace.h"
 #include "wayland/display.h"
 #include "wayland/window.h"
 
@@ -71,22 +77,38 @@ FlutterView::FlutterView(Configuration::Config config,
   m_backend = std::make_shared<HeadlessBackend>(
       m_config.view.width.value_or(kDefaultViewWidth),
       m_config.view.height.value_or(kDefaultViewHeight),
-      m_config.debug_backend.value_or(false), kEglBufferSize);
+      m_config.debug_backend.value_or(false), kEglBufferSize,
+      m_config.layer_compositor.value_or(false));
+  if (!m_config.frame_stream.empty()) {
+    m_backend->StartFrameStream(m_config.frame_stream);
+  }
+  if (!m_config.frame_export.empty()) {
+    m_backend->StartFrameExport(m_config.frame_export);
+  }
 #elif BUILD_BACKEND_WAYLAND_DRM
   m_backend = std::make_shared<WaylandDrmBackend>(
       display->GetDisplay(), m_config.view.width.value_or(kDefaultViewWidth),
       m_config.view.height.value_or(kDefaultViewHeight),
       m_config.debug_backend.value_or(false), kEglBufferSize);
+#elif BUILD_BACKEND_WAYLAND_SOFTWARE
+  m_backend = std::make_shared<WaylandSoftwareBackend>(
+      display, m_config.view.width.value_or(kDefaultViewWidth),
+      m_config.view.height.value_or(kDefaultViewHeight),
+      m_config.debug_backend.value_or(false));
 #elif BUILD_BACKEND_WAYLAND_EGL
   m_backend = std::make_shared<WaylandEglBackend>(
-      display->GetDisplay(), m_config.view.width.value_or(kDefaultViewWidth),
+      display, m_config.view.width.value_or(kDefaultViewWidth),
       m_config.view.height.value_or(kDefaultViewHeight),
-      m_config.debug_backend.value_or(false), kEglBufferSize);
+      m_config.debug_backend.value_or(false), kEglBufferSize,
+      m_config.layer_compositor.value_or(false));
 #elif BUILD_BACKEND_WAYLAND_VULKAN
   m_backend = std::make_shared<WaylandVulkanBackend>(
       display->GetDisplay(), m_config.view.width.value_or(kDefaultViewWidth),
       m_config.view.height.value_or(kDefaultViewHeight),
-      m_config.debug_backend.value_or(false));
+      m_config.debug_backend.value_or(false),
+      m_config.frames_in_flight.value_or(
+          WaylandVulkanBackend::kDefaultFramesInFlight),
+      m_config.layer_compositor.value_or(false));
 #endif
 
   SPDLOG_DEBUG("Width: {}, Height: {}",
@@ -131,9 +153,30 @@ FlutterView::FlutterView(Configuration::Config config,
       m_state->engine_state->view_controller);
 
   RegisterPlugins(m_state->engine_state.get());
+
+  m_wakeup_fd = EventLoop::CreateWakeupFd();
+  m_wayland_display->GetEventLoop()->AddFd(m_wakeup_fd, EPOLLIN, on_wakeup,
+                                           this);
 }
 
-FlutterView::~FlutterView() = default;
+FlutterView::~FlutterView() {
+  if (m_wakeup_fd >= 0) {
+    m_wayland_display->GetEventLoop()->RemoveFd(m_wakeup_fd);
+    close(m_wakeup_fd);
+    m_wakeup_fd = -1;
+  }
+}
+
+void FlutterView::Wakeup() const {
+  EventLoop::Signal(m_wakeup_fd);
+}
+
+void FlutterView::on_wakeup(void* /* data */,
+                            const int fd,
+                            uint32_t /* events */) {
+  // RunTasks() follows every main loop iteration; only clear the signal
+  EventLoop::Drain(fd);
+}
 
 void FlutterView::Initialize() {
   std::vector<const char*> m_command_line_args_c;
@@ -161,8 +204,10 @@ void FlutterView::Initialize() {
   display.struct_size = sizeof(FlutterEngineDisplay);
   display.display_id = 1;
   display.single_display = true;
+  // wl_output reports mHz, the engine expects Hz
   display.refresh_rate =
-      m_wayland_display->GetRefreshRate(static_cast<uint32_t>(m_index));
+      m_wayland_display->GetRefreshRate(static_cast<uint32_t>(m_index)) /
+      1000.0;
   auto [width, height] = m_wayland_window->GetSize();
   display.width = static_cast<size_t>(width);
   display.height = static_cast<size_t>(height);
@@ -189,7 +234,7 @@ void FlutterView::Initialize() {
   // init the fps output option.
   m_fps.output = 0;
   m_fps.period = 1;
-  m_fps.counter = 0;
+  m_fps.last_frame = 0;
 
   if (m_config.view.fps_output_console) {
     m_fps.output |= 0x01;
@@ -206,7 +251,9 @@ void FlutterView::Initialize() {
       m_fps.period = 1;
     }
 
-    m_fps.period *= (1000 / 16);
+    // the main loop no longer runs at a fixed rate, so the output period is
+    // measured in milliseconds instead of loop iterations
+    m_fps.period *= 1000;
     m_fps.pre_time = std::chrono::duration_cast<std::chrono::milliseconds>(
                          std::chrono::steady_clock::now().time_since_epoch())
                          .count();
@@ -214,36 +261,78 @@ void FlutterView::Initialize() {
 }
 
 void FlutterView::RunTasks() {
+  TRACE_SCOPE("FlutterView::RunTasks");
   m_flutter_engine->RunTask();
 
 #ifdef ENABLE_PLUGIN_COMP_SURF
   for (auto const& surface : m_comp_surf) {
-    surface.second->RunTask();
+    // surfaces exposing an event fd are run from the event loop
+    if (!surface.second->HasEventFd()) {
+      surface.second->RunTask();
+    }
   }
 #endif
 
-  m_pointer_events++;
-  if (m_pointer_events % kPointerEventModulus == 0) {
+  // with a frame pending, input is flushed once when its vsync is answered;
+  // an idle engine gets it right away so it can schedule a frame
+  if (!m_wayland_window->IsVsyncPending()) {
     m_flutter_engine->SendPointerEvents();
   }
 }
 
-// calc and output the FPS
+bool FlutterView::NeedsPolling() const {
+#ifdef ENABLE_PLUGIN_COMP_SURF
+  for (auto const& surface : m_comp_surf) {
+    if (!surface.second->HasEventFd()) {
+      return true;
+    }
+  }
+#endif
+  return false;
+}
+
+void FlutterView::DumpInputLatency() const {
+  spdlog::info("({}) Input latency\n{}", m_index,
+               m_flutter_engine->GetInputLatency().Dump());
+}
+
+// summarise the frames presented since the last output
 void FlutterView::DrawFps(long long end_time) {
   if (0 < m_fps.output) {
-    m_fps.counter++;
+    if (m_fps.period <= end_time - m_fps.pre_time) {
+      // reads the frame timing ring without touching the raster thread
+      const auto frames =
+          m_flutter_engine->GetFrameTiming().GetSummary(m_fps.last_frame);
 
-    if (m_fps.period <= m_fps.counter) {
-      auto fps_loop = (m_fps.counter * 1000) / (end_time - m_fps.pre_time);
-      auto fps_redraw = (m_wayland_window->GetFpsCounter() * 1000) /
-                        (end_time - m_fps.pre_time);
-
-      m_fps.counter = 0;
+      m_fps.last_frame = frames.last_frame;
       m_fps.pre_time = end_time;
 
       if (0 < (m_fps.output & 0x01)) {
-        if (0 < (m_fps.output & 0x01)) {
-          spdlog::info("({}) FPS = {} {}", m_index, fps_loop, fps_redraw);
+        spdlog::info(
+            "({}) FPS = {:.1f}, frame p50/p90/p99 = {}/{}/{} us, raster "
+            "p50/p90/p99 = {}/{}/{} us, damage avg {} px",
+            m_index, frames.fps, frames.frame_p50_us, frames.frame_p90_us,
+            frames.frame_p99_us, frames.raster_p50_us, frames.raster_p90_us,
+            frames.raster_p99_us, frames.damage_avg);
+        spdlog::info("({}) Jank = {} of {} frames, {} vsyncs missed", m_index,
+                     frames.janky_frames, frames.total_frames,
+                     frames.missed_vsyncs);
+        const auto input = m_flutter_engine->TakePointerEventStats();
+        if (input.pushed || input.dropped) {
+          spdlog::info(
+              "({}) Input = {} events, {} sent in {} flushes, {} dropped, "
+              "latency avg {} us max {} us",
+              m_index, input.pushed, input.sent, input.flushes, input.dropped,
+              input.pushed ? input.latency_total_us / input.pushed : 0,
+              input.latency_max_us);
+        }
+        const auto textures = m_flutter_engine->TakeTextureFrameStats();
+        if (textures.marks) {
+          spdlog::info(
+              "({}) Texture frames = {} marked, {} sent in {} flushes, {} "
+              "coalesced",
+              m_index, textures.marks, textures.sent, textures.flushes,
+              textures.coalesced);
         }
       }
     }
@@ -271,6 +360,9 @@ size_t FlutterView::CreateSurface(void* h_module,
 
   m_comp_surf[index]->InitializePlugin();
 
+  // called from the platform thread; let the main loop flush the new surface
+  Wakeup();
+
   const auto tEnd = std::chrono::steady_clock::now();
   const auto tDiff =
       std::chrono::duration<double, std::milli>(tEnd - tStart).count();
@@ -43,6 +43,8 @@ class WaylandWindow;
 class HeadlessBackend;
 #elif BUILD_BACKEND_WAYLAND_DRM
 class WaylandDrmBackend;
+#elif BUILD_BACKEND_WAYLAND_SOFTWARE
+class WaylandSoftwareBackend;
 #elif BUILD_BACKEND_WAYLAND_EGL
 class WaylandEglBackend;
 #elif BUILD_BACKEND_WAYLAND_VULKAN
@@ -67,6 +69,24 @@ class FlutterView {
    */
   void RunTasks();
 
+  /**
+   * @brief Check if the view has work that can not be signalled by an fd
+   * @return bool
+   * @retval true if the main loop has to poll RunTasks periodically
+   * @retval false if the main loop may block until an event source is ready
+   * @relation
+   * internal
+   */
+  NODISCARD bool NeedsPolling() const;
+
+  /**
+   * @brief Wake the main loop so RunTasks runs promptly. Thread safe.
+   * @return void
+   * @relation
+   * internal
+   */
+  void Wakeup() const;
+
   /**
    * @brief Initialize
    * @return void
@@ -113,7 +133,15 @@ class FlutterView {
   NODISCARD Display* GetDisplay() const { return m_wayland_display.get(); }
 
   /**
-   * @brief Draw FPS to calc and output
+   * @brief Log the input latency histograms of this view
+   * @return void
+   * @relation
+   * flutter
+   */
+  void DumpInputLatency() const;
+
+  /**
+   * @brief Output the frame timing summary once per output period
    * @param[in] end_time End time
    * @return void
    * @relation
@@ -205,6 +233,8 @@ class FlutterView {
   std::shared_ptr<HeadlessBackend> m_backend;
 #elif BUILD_BACKEND_WAYLAND_DRM
   std::shared_ptr<WaylandDrmBackend> m_backend;
+#elif BUILD_BACKEND_WAYLAND_SOFTWARE
+  std::shared_ptr<WaylandSoftwareBackend> m_backend;
 #elif BUILD_BACKEND_WAYLAND_EGL
   std::shared_ptr<WaylandEglBackend> m_backend;
 #elif BUILD_BACKEND_WAYLAND_VULKAN
@@ -222,11 +252,23 @@ class FlutterView {
   struct {
     uint8_t output;
     uint32_t period;
-    uint32_t counter;
+    /// last frame included in the previous output
+    uint64_t last_frame;
     long long pre_time;
   } m_fps{};
 
-  uint64_t m_pointer_events{};
+  int m_wakeup_fd{-1};
+
+  /**
+   * @brief Clear the wakeup eventfd
+   * @param[in] data Pointer to FlutterView
+   * @param[in] fd Wakeup eventfd
+   * @param[in] events Ready events
+   * @return void
+   * @relation
+   * internal
+   */
+  static void on_wakeup(void* data, int fd, uint32_t events);
 
   static void RegisterPlugins(FlutterDesktopEngineRef engine);
 };
@@ -27,7 +27,9 @@
 #include "config/common.h"
 
 #include "engine.h"
+#include "libflutter_engine.h"
 #include "timer.h"
+#include "trace.h"
 
 extern void KeyCallback(FlutterDesktopViewControllerState* view_state,
                         bool released,
@@ -62,6 +64,8 @@ Display::Display(bool enable_cursor,
     exit(-1);
   }
 
+  m_event_loop->AddFd(wl_display_get_fd(m_display), EPOLLIN, nullptr, nullptr);
+
   m_registry = wl_display_get_registry(m_display);
   wl_registry_add_listener(m_registry, &registry_listener, this);
   wl_display_dispatch(m_display);
@@ -90,6 +94,11 @@ Display::Display(bool enable_cursor,
 Display::~Display() {
   SPDLOG_TRACE("+ ~Display()");
 
+#if defined(WP_PRESENTATION_FEEDBACK_SINCE_VERSION)
+  if (m_presentation)
+    wp_presentation_destroy(m_presentation);
+#endif
+
   if (m_shm)
     wl_shm_destroy(m_shm);
 
@@ -231,7 +240,17 @@ void Display::registry_handle_global(void* data,
     d->m_repeat_timer =
         std::make_shared<EventTimer>(CLOCK_MONOTONIC, keyboard_repeat_func, d);
     d->m_repeat_timer->set_timerspec(40, 400);
+
+    d->WatchEventTimers();
+  }
+#if defined(WP_PRESENTATION_FEEDBACK_SINCE_VERSION)
+  else if (strcmp(interface, wp_presentation_interface.name) == 0) {
+    d->m_presentation = static_cast<struct wp_presentation*>(
+        wl_registry_bind(registry, name, &wp_presentation_interface,
+                         std::min(static_cast<uint32_t>(1), version)));
+    wp_presentation_add_listener(d->m_presentation, &presentation_listener, d);
   }
+#endif
 #if ENABLE_AGL_SHELL_CLIENT
   else if (strcmp(interface, agl_shell_interface.name) == 0 &&
            d->m_agl.bind_to_agl_shell) {
@@ -352,9 +371,20 @@ const struct wl_output_listener Display::output_listener = {
 #endif
 };
 
-void Display::shm_format(void* /* data */,
+void Display::shm_format(void* data,
                          struct wl_shm* /* wl_shm */,
-                         uint32_t /* format */) {}
+                         const uint32_t format) {
+  const auto d = static_cast<Display*>(data);
+  d->m_shm_formats.push_back(format);
+}
+
+bool Display::HasShmFormat(const uint32_t format) const {
+  if (format == WL_SHM_FORMAT_ARGB8888 || format == WL_SHM_FORMAT_XRGB8888) {
+    return true;
+  }
+  return std::find(m_shm_formats.begin(), m_shm_formats.end(), format) !=
+         m_shm_formats.end();
+}
 
 const struct wl_shm_listener Display::shm_listener = {shm_format};
 
@@ -433,7 +463,7 @@ void Display::pointer_handle_enter(void* data,
     d->m_active_engine->CoalesceMouseEvent(
         kFlutterPointerSignalKindNone, FlutterPointerPhase::kAdd,
         d->m_pointer.event.surface_x, d->m_pointer.event.surface_y, 0.0, 0.0,
-        d->m_pointer.buttons);
+        d->m_pointer.buttons, 0);
   }
 }
 
@@ -448,13 +478,14 @@ void Display::pointer_handle_leave(void* data,
   if (d->m_active_engine) {
     d->m_active_engine->CoalesceMouseEvent(kFlutterPointerSignalKindNone,
                                            FlutterPointerPhase::kRemove, 0.0,
-                                           0.0, 0.0, 0.0, d->m_pointer.buttons);
+                                           0.0, 0.0, 0.0, d->m_pointer.buttons,
+                                           0);
   }
 }
 
 void Display::pointer_handle_motion(void* data,
                                     struct wl_pointer* /* pointer */,
-                                    uint32_t /* time */,
+                                    uint32_t time,
                                     wl_fixed_t sx,
                                     wl_fixed_t sy) {
   auto* d = static_cast<Display*>(data);
@@ -468,7 +499,8 @@ void Display::pointer_handle_motion(void* data,
           pointerButtonStatePressed(&d->m_pointer) ? kMove : kHover;
       d->m_active_engine->CoalesceMouseEvent(
           kFlutterPointerSignalKindNone, phase, d->m_pointer.event.surface_x,
-          d->m_pointer.event.surface_y, 0.0, 0.0, d->m_pointer.buttons);
+          d->m_pointer.event.surface_y, 0.0, 0.0, d->m_pointer.buttons,
+          InputTime(time));
     }
   }
 }
@@ -476,7 +508,7 @@ void Display::pointer_handle_motion(void* data,
 void Display::pointer_handle_button(void* data,
                                     struct wl_pointer* /* wl_pointer */,
                                     uint32_t serial,
-                                    uint32_t /* time */,
+                                    uint32_t time,
                                     uint32_t button,
                                     uint32_t state) {
   auto* d = static_cast<Display*>(data);
@@ -502,7 +534,8 @@ void Display::pointer_handle_button(void* data,
     if (d->m_active_engine) {
       d->m_active_engine->CoalesceMouseEvent(
           kFlutterPointerSignalKindNone, phase, d->m_pointer.event.surface_x,
-          d->m_pointer.event.surface_y, 0.0, 0.0, d->m_pointer.buttons);
+          d->m_pointer.event.surface_y, 0.0, 0.0, d->m_pointer.buttons,
+          InputTime(time));
     }
   }
 }
@@ -522,7 +555,7 @@ void Display::pointer_handle_axis(void* data,
           kFlutterPointerSignalKindScroll, FlutterPointerPhase::kMove,
           d->m_pointer.event.surface_x, d->m_pointer.event.surface_y,
           d->m_pointer.event.axes[1].value, d->m_pointer.event.axes[0].value,
-          d->m_pointer.buttons);
+          d->m_pointer.buttons, InputTime(time));
     }
   }
 }
@@ -695,72 +728,80 @@ void Display::keyboard_repeat_func(void* data) {
   }
 }
 
+uint64_t Display::InputTime(const uint32_t time) {
+  return InputLatency::FromWaylandTime(time,
+                                       LibFlutterEngine->GetCurrentTime());
+}
+
+void Display::CommitTouchFrame() {
+  auto& frame = m_touch.frame;
+  if (m_touch_engine && frame.size()) {
+    m_touch_engine->CoalesceTouchFrame(frame);
+  }
+  frame.Clear();
+}
+
 void Display::touch_handle_down(void* data,
                                 struct wl_touch* /* wl_touch */,
                                 uint32_t /* serial */,
-                                uint32_t /* time */,
+                                uint32_t time,
                                 struct wl_surface* surface,
                                 int32_t id,
                                 wl_fixed_t x_w,
                                 wl_fixed_t y_w) {
   auto* d = static_cast<Display*>(data);
 
-  d->m_touch.surface_x[id] = x_w;
-  d->m_touch.surface_y[id] = y_w;
-
   d->m_active_surface = surface;
-  d->m_touch_engine = d->m_surface_engine_map[surface];
-  if (d->m_touch_engine) {
-    d->m_touch_engine->CoalesceTouchEvent(FlutterPointerPhase::kDown,
-                                          wl_fixed_to_double(x_w),
-                                          wl_fixed_to_double(y_w), id);
+  const auto engine = d->m_surface_engine_map[surface];
+  if (engine != d->m_touch_engine || d->m_touch.frame.Full()) {
+    // staged events belong to the previous surface
+    d->CommitTouchFrame();
+    d->m_touch_engine = engine;
   }
+  d->m_touch.frame.Down(id, wl_fixed_to_double(x_w), wl_fixed_to_double(y_w),
+                        InputTime(time));
 }
 
 void Display::touch_handle_up(void* data,
                               struct wl_touch* /* wl_touch */,
                               uint32_t /* serial */,
-                              uint32_t /* time */,
+                              uint32_t time,
                               int32_t id) {
-  const auto* d = static_cast<Display*>(data);
+  auto* d = static_cast<Display*>(data);
 
-  if (d->m_touch_engine) {
-    d->m_touch_engine->CoalesceTouchEvent(
-        FlutterPointerPhase::kUp, wl_fixed_to_double(d->m_touch.surface_x[id]),
-        wl_fixed_to_double(d->m_touch.surface_y[id]), id);
+  if (d->m_touch.frame.Full()) {
+    d->CommitTouchFrame();
   }
+  d->m_touch.frame.Up(id, InputTime(time));
 }
 
 void Display::touch_handle_motion(void* data,
                                   struct wl_touch* /* wl_touch */,
-                                  uint32_t /* time */,
+                                  uint32_t time,
                                   int32_t id,
                                   wl_fixed_t x_w,
                                   wl_fixed_t y_w) {
   auto* d = static_cast<Display*>(data);
 
-  d->m_touch.surface_x[id] = x_w;
-  d->m_touch.surface_y[id] = y_w;
-
-  if (d->m_touch_engine) {
-    d->m_touch_engine->CoalesceTouchEvent(FlutterPointerPhase::kMove,
-                                          wl_fixed_to_double(x_w),
-                                          wl_fixed_to_double(y_w), id);
+  if (d->m_touch.frame.Full()) {
+    d->CommitTouchFrame();
   }
+  d->m_touch.frame.Motion(id, wl_fixed_to_double(x_w),
+                          wl_fixed_to_double(y_w), InputTime(time));
 }
 
 void Display::touch_handle_cancel(void* data, struct wl_touch* /* wl_touch */) {
-  const auto* d = static_cast<Display*>(data);
-  if (d->m_touch_engine) {
-    SPDLOG_DEBUG("touch_handle_cancel");
-    d->m_touch_engine->CoalesceTouchEvent(FlutterPointerPhase::kCancel,
-                                          d->m_pointer.event.surface_x,
-                                          d->m_pointer.event.surface_y, 0);
-  }
+  auto* d = static_cast<Display*>(data);
+  SPDLOG_DEBUG("touch_handle_cancel");
+  // no frame follows a cancel
+  d->CommitTouchFrame();
+  d->m_touch.frame.Cancel();
+  d->CommitTouchFrame();
 }
 
-void Display::touch_handle_frame(void* /* data */,
-                                 struct wl_touch* /* wl_touch */) {}
+void Display::touch_handle_frame(void* data, struct wl_touch* /* wl_touch */) {
+  static_cast<Display*>(data)->CommitTouchFrame();
+}
 
 const struct wl_touch_listener Display::touch_listener = {
     .down = touch_handle_down,
@@ -770,14 +811,54 @@ const struct wl_touch_listener Display::touch_listener = {
     .cancel = touch_handle_cancel,
 };
 
-int Display::PollEvents() const {
+void Display::WatchEventTimers() {
+  // all EventTimers share one epoll fd; nest it in the main loop
+  if (EventTimer::evfd >= 0 && m_watched_timer_fd != EventTimer::evfd &&
+      m_event_loop->AddFd(EventTimer::evfd, EPOLLIN, on_timer_ready, this)) {
+    m_watched_timer_fd = EventTimer::evfd;
+  }
+}
+
+void Display::on_timer_ready(void* /* data */,
+                             int /* fd */,
+                             uint32_t /* events */) {
+  EventTimer::wait_event();
+}
+
+int Display::PollEvents(int timeout_ms) const {
+  int pending = 0;
   while (wl_display_prepare_read(m_display) != 0) {
-    wl_display_dispatch_pending(m_display);
+    pending += wl_display_dispatch_pending(m_display);
   }
   wl_display_flush(m_display);
 
-  wl_display_read_events(m_display);
-  return wl_display_dispatch_pending(m_display);
+  // events already dispatched may have queued work for the caller, so do not
+  // block on top of them
+  if (pending > 0) {
+    timeout_ms = 0;
+  }
+
+  const auto ready = m_event_loop->Wait(timeout_ms);
+  if (ready > 0 && m_event_loop->IsReady(wl_display_get_fd(m_display))) {
+    wl_display_read_events(m_display);
+  } else {
+    wl_display_cancel_read(m_display);
+  }
+  if (ready < 0) {
+    return -1;
+  }
+
+  TRACE_SCOPE("Display::DispatchEvents");
+  const auto ret = wl_display_dispatch_pending(m_display);
+  if (ret < 0) {
+    return ret;
+  }
+
+  // other sources run outside of the prepare_read/read_events window so they
+  // are free to use Wayland themselves
+  m_event_loop->Dispatch();
+
+  return pending + ret;
 }
 
 #if ENABLE_AGL_SHELL_CLIENT
@@ -836,6 +917,8 @@ bool Display::ActivateSystemCursor(const int32_t device,
                           m_cursor_surface, 0, 0);
     wl_surface_damage(m_cursor_surface, 0, 0, 0, 0);
     wl_surface_commit(m_cursor_surface);
+    // called on the platform thread, the main loop may be asleep
+    wl_display_flush(m_display);
     return true;
   }
 
@@ -870,6 +953,7 @@ bool Display::ActivateSystemCursor(const int32_t device,
                         static_cast<int32_t>(cursor->images[0]->width),
                         static_cast<int32_t>(cursor->images[0]->height));
       wl_surface_commit(m_cursor_surface);
+      wl_display_flush(m_display);
     } else {
       SPDLOG_DEBUG("Failed to set cursor: Invalid Cursor Buffer");
       return false;
@@ -901,6 +985,21 @@ std::pair<int32_t, int32_t> Display::GetVideoModeSize(uint32_t index) const {
   return {0, 0};
 }
 
+#if defined(WP_PRESENTATION_FEEDBACK_SINCE_VERSION)
+void Display::presentation_handle_clock_id(
+    void* data,
+    struct wp_presentation* /* wp_presentation */,
+    const uint32_t clk_id) {
+  auto* d = static_cast<Display*>(data);
+  d->m_presentation_clock_id = static_cast<clockid_t>(clk_id);
+  SPDLOG_DEBUG("Wayland: wp_presentation clock id: {}", clk_id);
+}
+
+const struct wp_presentation_listener Display::presentation_listener = {
+    .clock_id = presentation_handle_clock_id,
+};
+#endif
+
 int Display::GetRefreshRate(uint32_t index) const {
   if (index < m_all_outputs.size()) {
     return m_all_outputs[index]->refresh_rate;
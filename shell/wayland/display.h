@@ -18,6 +18,7 @@
 #pragma once
 
 #include <chrono>
+#include <ctime>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -32,11 +33,13 @@
 
 #include "config/common.h"
 #include "configuration/configuration.h"
+#include "event_loop.h"
 #include "platform/homescreen/flutter_desktop_view_controller_state.h"
 #include "platform/homescreen/key_event_handler.h"
 #include "platform/homescreen/keyboard_hook_handler.h"
 #include "platform/homescreen/text_input_plugin.h"
 #include "timer.h"
+#include "wayland/touch_frame.h"
 
 class Engine;
 
@@ -132,14 +135,36 @@ class Display {
     return m_shm;
   }
 
+  /**
+   * @brief Check the compositor advertised a wl_shm format
+   * @param[in] format wl_shm format
+   * @return bool
+   * @retval true The format can be used for wl_shm buffers
+   * @relation
+   * wayland
+   * @note ARGB8888 and XRGB8888 are always supported
+   */
+  NODISCARD bool HasShmFormat(uint32_t format) const;
+
   /**
    * @brief Wait for events
+   * @param[in] timeout_ms Maximum time to block in milliseconds, -1 to block
+   * until an event source is ready
    * @return int
    * @retval Number of dispatched events
    * @relation
    * wayland
    */
-  NODISCARD int PollEvents() const;
+  NODISCARD int PollEvents(int timeout_ms = -1) const;
+
+  /**
+   * @brief Get the event loop of the main thread
+   * @return EventLoop*
+   * @retval Pointer to event loop
+   * @relation
+   * internal
+   */
+  NODISCARD EventLoop* GetEventLoop() const { return m_event_loop.get(); }
 
 #if ENABLE_AGL_SHELL_CLIENT
   /**
@@ -282,6 +307,27 @@ class Display {
    */
   NODISCARD int GetRefreshRate(uint32_t index) const;
 
+  /**
+   * @brief Get presentation-time interface
+   * @return wp_presentation*
+   * @retval Pointer to wp_presentation, nullptr if the compositor does not
+   * support it or its clock is not CLOCK_MONOTONIC
+   * @relation
+   * wayland
+   */
+  NODISCARD struct wp_presentation* GetPresentation() const {
+    return m_presentation_clock_id == CLOCK_MONOTONIC ? m_presentation
+                                                      : nullptr;
+  }
+
+  /**
+   * @brief Nest the EventTimer epoll fd in the event loop, if not already
+   * @return void
+   * @relation
+   * internal
+   */
+  void WatchEventTimers();
+
   /**
    * @brief deactivate/hide the application pointed by app_id
    * @param[in] app_id the app_id
@@ -324,12 +370,18 @@ class Display {
  private:
   std::shared_ptr<Engine> m_flutter_engine;
 
+  std::unique_ptr<EventLoop> m_event_loop{std::make_unique<EventLoop>()};
+  int m_watched_timer_fd{-1};
+
   struct wl_display* m_display{};
   struct wl_registry* m_registry{};
   struct wl_compositor* m_compositor{};
   struct wl_subcompositor* m_subcompositor{};
   struct wl_shm* m_shm{};
+  std::vector<uint32_t> m_shm_formats;
   struct wl_surface* m_base_surface{};
+  struct wp_presentation* m_presentation{};
+  clockid_t m_presentation_clock_id{-1};
 
   std::map<wl_surface*, Engine*> m_surface_engine_map;
   wl_surface* m_active_surface{};
@@ -431,8 +483,8 @@ class Display {
   struct touch_ {
     struct wl_touch* touch;
     struct touch_event event;
-    wl_fixed_t surface_x[kMaxTouchFinger];
-    wl_fixed_t surface_y[kMaxTouchFinger];
+    /// contacts and events of the current wl_touch frame
+    TouchFrame frame;
     uint32_t state;
     FlutterPointerPhase phase;
   } m_touch{};
@@ -474,6 +526,35 @@ class Display {
 
   static const struct wl_registry_listener registry_listener;
 
+  /**
+   * @brief Dispatch expired keyboard repeat timers
+   * @param[in] data Pointer to Display
+   * @param[in] fd EventTimer epoll fd
+   * @param[in] events Ready events
+   * @return void
+   * @relation
+   * internal
+   */
+  static void on_timer_ready(void* data, int fd, uint32_t events);
+
+#if defined(WP_PRESENTATION_FEEDBACK_SINCE_VERSION)
+  static const struct wp_presentation_listener presentation_listener;
+
+  /**
+   * @brief Clock used by presentation feedback timestamps
+   * @param[in,out] data Data of type Display
+   * @param[in] wp_presentation No use
+   * @param[in] clk_id clockid_t of presentation timestamps
+   * @return void
+   * @relation
+   * wayland
+   */
+  static void presentation_handle_clock_id(
+      void* data,
+      struct wp_presentation* wp_presentation,
+      uint32_t clk_id);
+#endif
+
   /**
    * @brief Receive wl_registry events from Wayland server
    * @param[in,out] data Pointer to scatter Display type data
@@ -605,14 +686,13 @@ class Display {
   static const struct wl_shm_listener shm_listener;
 
   /**
-   * @brief Do nothing
-   * @param[in] data No use
+   * @brief Record a wl_shm format supported by the compositor
+   * @param[in] data Pointer to Display
    * @param[in] wl_shm No use
-   * @param[in] format No use
+   * @param[in] format wl_shm format
    * @return void
    * @relation
    * wayland
-   * @note Do nothing
    */
   static void shm_format(void* data, struct wl_shm* wl_shm, uint32_t format);
 
@@ -986,16 +1066,33 @@ class Display {
   static void touch_handle_cancel(void* data, struct wl_touch* wl_touch);
 
   /**
-   * @brief Touch event frame
-   * @param[in,out] data No use
+   * @brief Touch event frame, commits the staged events as one group
+   * @param[in,out] data Data of type Display
    * @param[in] wl_touch No use
    * @return void
    * @relation
    * wayland
-   * @note Do nothing
    */
   static void touch_handle_frame(void* data, struct wl_touch* wl_touch);
 
+  /**
+   * @brief Map a Wayland event time to CLOCK_MONOTONIC
+   * @param[in] time Event time in milliseconds
+   * @return uint64_t
+   * @retval Input time in nanoseconds, 0 if the compositor clock differs
+   * @relation
+   * wayland
+   */
+  static uint64_t InputTime(uint32_t time);
+
+  /**
+   * @brief Hand the staged touch events to the touch engine
+   * @return void
+   * @relation
+   * wayland, flutter
+   */
+  void CommitTouchFrame();
+
   static const struct wl_touch_listener touch_listener;
 
   /**
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "touch_frame.h"
+
+#include "logging/logging.h"
+
+TouchFrame::Slot* TouchFrame::Find(const int32_t id) {
+  for (auto& slot : m_slots) {
+    if (slot.active && slot.id == id) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+void TouchFrame::Stage(const FlutterPointerPhase phase,
+                       const size_t slot,
+                       const uint64_t input_ns) {
+  if (m_count == kMaxEvents) {
+    spdlog::warn("[touch] frame overflow, dropping event");
+    return;
+  }
+  const auto& s = m_slots[slot];
+  m_events[m_count++] = {phase, static_cast<int32_t>(slot), s.x, s.y,
+                        input_ns};
+}
+
+bool TouchFrame::Down(const int32_t id,
+                      const double x,
+                      const double y,
+                      const uint64_t input_ns) {
+  if (Find(id)) {
+    spdlog::warn("[touch] down for active id {}", id);
+    return false;
+  }
+  for (size_t i = 0; i < m_slots.size(); i++) {
+    auto& slot = m_slots[i];
+    if (!slot.active) {
+      slot = {true, id, x, y, kNoEvent};
+      Stage(kDown, i, input_ns);
+      return true;
+    }
+  }
+  spdlog::warn("[touch] more than {} contacts, ignoring id {}",
+               kMaxTouchFinger, id);
+  return false;
+}
+
+bool TouchFrame::Motion(const int32_t id,
+                        const double x,
+                        const double y,
+                        const uint64_t input_ns) {
+  const auto slot = Find(id);
+  if (!slot) {
+    return false;
+  }
+  slot->x = x;
+  slot->y = y;
+  if (slot->motion != kNoEvent) {
+    auto& event = m_events[slot->motion];
+    event.x = x;
+    event.y = y;
+    if (!event.input_ns) {
+      event.input_ns = input_ns;
+    }
+    return true;
+  }
+  const auto index = static_cast<size_t>(slot - m_slots.data());
+  slot->motion = m_count;
+  Stage(kMove, index, input_ns);
+  return true;
+}
+
+bool TouchFrame::Up(const int32_t id, const uint64_t input_ns) {
+  const auto slot = Find(id);
+  if (!slot) {
+    return false;
+  }
+  Stage(kUp, static_cast<size_t>(slot - m_slots.data()), input_ns);
+  slot->active = false;
+  return true;
+}
+
+void TouchFrame::Cancel() {
+  for (size_t i = 0; i < m_slots.size(); i++) {
+    if (m_slots[i].active) {
+      Stage(kCancel, i, 0);
+      m_slots[i].active = false;
+    }
+  }
+}
+
+void TouchFrame::Clear() {
+  m_count = 0;
+  for (auto& slot : m_slots) {
+    slot.motion = kNoEvent;
+  }
+}
+
+size_t TouchFrame::ActiveContacts() const {
+  size_t count = 0;
+  for (const auto& slot : m_slots) {
+    count += slot.active ? 1 : 0;
+  }
+  return count;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "flutter/shell/platform/embedder/embedder.h"
+
+#include "config/common.h"
+
+/**
+ * @brief Touch contacts of a wl_seat and the events of the current
+ * wl_touch frame.
+ *
+ * Wayland touch ids are chosen by the compositor and may be any int32.  Each
+ * contact is assigned a slot in a fixed table of kMaxTouchFinger entries and
+ * the slot index is used as the Flutter device id.  A down that finds no free
+ * slot is dropped together with the rest of that contact.
+ *
+ * down/motion/up are staged until wl_touch.frame and then handed to the
+ * engine as one group.  Repeated motion of a contact within a frame keeps
+ * only the latest position.
+ */
+class TouchFrame {
+ public:
+  /// staged events per frame; a down, motion and up per slot
+  static constexpr size_t kMaxEvents = kMaxTouchFinger * 3;
+
+  struct Event {
+    FlutterPointerPhase phase;
+    int32_t device;
+    double x;
+    double y;
+    /// Wayland input time, 0 if unknown; the oldest of merged motion
+    uint64_t input_ns;
+  };
+
+  /**
+   * @brief Stage a new contact
+   * @param[in] id Wayland touch id
+   * @param[in] x X coordinate in surface space
+   * @param[in] y Y coordinate in surface space
+   * @param[in] input_ns Wayland input time, 0 if unknown
+   * @return bool
+   * @retval true Staged
+   * @retval false No free slot, or id already down
+   * @relation
+   * wayland, flutter
+   */
+  bool Down(int32_t id, double x, double y, uint64_t input_ns = 0);
+
+  /**
+   * @brief Stage motion of a contact
+   * @param[in] id Wayland touch id
+   * @param[in] x X coordinate in surface space
+   * @param[in] y Y coordinate in surface space
+   * @param[in] input_ns Wayland input time, 0 if unknown
+   * @return bool
+   * @retval true Staged
+   * @retval false Unknown id
+   * @relation
+   * wayland, flutter
+   */
+  bool Motion(int32_t id, double x, double y, uint64_t input_ns = 0);
+
+  /**
+   * @brief Stage the release of a contact at its last position
+   * @param[in] id Wayland touch id
+   * @param[in] input_ns Wayland input time, 0 if unknown
+   * @return bool
+   * @retval true Staged
+   * @retval false Unknown id
+   * @relation
+   * wayland, flutter
+   */
+  bool Up(int32_t id, uint64_t input_ns = 0);
+
+  /**
+   * @brief Stage a cancel for every active contact and clear the table
+   * @return void
+   * @relation
+   * wayland, flutter
+   */
+  void Cancel();
+
+  /// no room for another event; commit before staging more
+  NODISCARD bool Full() const { return m_count == kMaxEvents; }
+
+  NODISCARD const Event* events() const { return m_events.data(); }
+
+  NODISCARD size_t size() const { return m_count; }
+
+  /**
+   * @brief Drop the staged events once they were committed
+   * @return void
+   * @relation
+   * wayland, flutter
+   */
+  void Clear();
+
+  NODISCARD size_t ActiveContacts() const;
+
+ private:
+  struct Slot {
+    bool active;
+    int32_t id;
+    double x;
+    double y;
+    /// staged motion of this frame, or kNoEvent
+    size_t motion;
+  };
+
+  static constexpr size_t kNoEvent = kMaxEvents;
+
+  NODISCARD Slot* Find(int32_t id);
+  void Stage(FlutterPointerPhase phase, size_t slot, uint64_t input_ns);
+
+  std::array<Slot, kMaxTouchFinger> m_slots{};
+  std::array<Event, kMaxEvents> m_events{};
+  size_t m_count{};
+};
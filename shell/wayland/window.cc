@@ -18,6 +18,12 @@
 
 #include "display.h"
 #include "engine.h"
+#include "trace.h"
+
+// frame callbacks stop while the surface is occluded; answer vsync from a
+// timer then so the engine is throttled instead of stalled
+static constexpr long kVsyncFallbackTimeoutNs = 64'000'000;
+static constexpr uint64_t kDefaultRefreshPeriodNs = 16'666'667;
 
 WaylandWindow::WaylandWindow(size_t index,
                              std::shared_ptr<Display> display,
@@ -49,10 +55,9 @@ WaylandWindow::WaylandWindow(size_t index,
                          activation_area_width, activation_area_height}),
       m_window_size({width, height}),
       m_type(get_window_type(type)),
-      m_app_id(std::move(app_id)) {  // disable vsync
+      m_app_id(std::move(app_id)) {
   SPDLOG_TRACE("({}) + WaylandWindow()", m_index);
 
-  m_fps_counter = 0;
   m_base_surface = wl_compositor_create_surface(m_display->GetCompositor());
   wl_surface_add_listener(m_base_surface, &m_base_surface_listener, this);
 
@@ -60,6 +65,11 @@ WaylandWindow::WaylandWindow(size_t index,
   wl_callback_add_listener(m_base_frame_callback,
                            &m_base_surface_frame_listener, this);
 
+  m_vsync_timer =
+      std::make_unique<EventTimer>(CLOCK_MONOTONIC, on_vsync_timeout, this);
+  m_vsync_timer->m_timerspec.it_value.tv_nsec = kVsyncFallbackTimeoutNs;
+  m_display->WatchEventTimers();
+
 #if ENABLE_IVI_SHELL_CLIENT
   auto ivi_application = m_display->GetIviApplication();
   if (ivi_application) {
@@ -153,6 +163,13 @@ WaylandWindow::~WaylandWindow() {
   if (m_base_frame_callback)
     wl_callback_destroy(m_base_frame_callback);
 
+#if defined(WP_PRESENTATION_FEEDBACK_SINCE_VERSION)
+  if (m_presentation_feedback)
+    wp_presentation_feedback_destroy(m_presentation_feedback);
+#endif
+
+  m_vsync_timer.reset();
+
 #if ENABLE_IVI_SHELL_CLIENT
   if (m_ivi_surface)
     ivi_surface_destroy(m_ivi_surface);
@@ -320,19 +337,117 @@ void WaylandWindow::on_frame_base_surface(void* data,
   wl_callback_add_listener(window->m_base_frame_callback,
                            &m_base_surface_frame_listener, window);
 
-  window->m_fps_counter++;
-  window->m_fps_counter++;
+#if defined(WP_PRESENTATION_FEEDBACK_SINCE_VERSION)
+  const auto presentation = window->m_display->GetPresentation();
+  if (presentation && !window->m_presentation_feedback) {
+    window->m_presentation_feedback =
+        wp_presentation_feedback(presentation, window->m_base_surface);
+    wp_presentation_feedback_add_listener(window->m_presentation_feedback,
+                                          &m_presentation_feedback_listener,
+                                          window);
+  }
+#endif
 
   wl_surface_commit(window->m_base_surface);
+
+  window->AnswerVsync(LibFlutterEngine->GetCurrentTime());
+}
+
+void WaylandWindow::ScheduleVsync(FLUTTER_API_SYMBOL(FlutterEngine) engine,
+                                  const intptr_t baton) {
+  m_vsync_engine = engine;
+  m_vsync_baton = baton;
+  m_vsync_timer->arm();
+}
+
+uint64_t WaylandWindow::GetRefreshPeriod() const {
+  if (m_presentation.refresh_ns) {
+    return m_presentation.refresh_ns;
+  }
+  // wl_output reports mHz
+  const auto refresh_rate = m_display->GetRefreshRate(m_output_index);
+  if (refresh_rate > 0) {
+    return 1'000'000'000'000ull / static_cast<uint64_t>(refresh_rate);
+  }
+  return kDefaultRefreshPeriodNs;
+}
+
+void WaylandWindow::AnswerVsync(const uint64_t now_ns) {
+  const auto baton = m_vsync_baton.exchange(0);
+  if (!baton) {
+    return;
+  }
+  TRACE_SCOPE("WaylandWindow::AnswerVsync");
+
+  const auto period = GetRefreshPeriod();
+  auto frame_start = now_ns;
+  // snap to the compositor's vblank grid when presentation feedback is known
+  const auto last_present = m_presentation.last_present_ns;
+  if (last_present && last_present <= now_ns) {
+    frame_start = last_present + ((now_ns - last_present) / period) * period;
+  }
+
+  // input and texture frames of this frame reach the engine right before it
+  // begins the frame
+  if (m_flutter_engine) {
+    m_flutter_engine->SendPointerEvents();
+    m_flutter_engine->SendTextureFrames();
+    m_flutter_engine->GetFrameTiming().OnVsync(frame_start,
+                                               frame_start + period);
+  }
+
+  LibFlutterEngine->OnVsync(m_vsync_engine, baton, frame_start,
+                            frame_start + period);
 }
 
-uint32_t WaylandWindow::GetFpsCounter() {
-  const uint32_t fps_counter = m_fps_counter;
-  m_fps_counter = 0;
+void WaylandWindow::on_vsync_timeout(void* data) {
+  auto* window = static_cast<WaylandWindow*>(data);
+  window->AnswerVsync(LibFlutterEngine->GetCurrentTime());
+}
+
+#if defined(WP_PRESENTATION_FEEDBACK_SINCE_VERSION)
+void WaylandWindow::presentation_feedback_sync_output(
+    void* /* data */,
+    struct wp_presentation_feedback* /* feedback */,
+    struct wl_output* /* output */) {}
+
+void WaylandWindow::presentation_feedback_presented(
+    void* data,
+    struct wp_presentation_feedback* feedback,
+    const uint32_t tv_sec_hi,
+    const uint32_t tv_sec_lo,
+    const uint32_t tv_nsec,
+    const uint32_t refresh,
+    uint32_t /* seq_hi */,
+    uint32_t /* seq_lo */,
+    uint32_t /* flags */) {
+  auto* window = static_cast<WaylandWindow*>(data);
+
+  const auto tv_sec = (static_cast<uint64_t>(tv_sec_hi) << 32) |
+                      static_cast<uint64_t>(tv_sec_lo);
+  window->m_presentation.last_present_ns = tv_sec * 1'000'000'000ull + tv_nsec;
+  window->m_presentation.refresh_ns = refresh;
 
-  return fps_counter;
+  wp_presentation_feedback_destroy(feedback);
+  window->m_presentation_feedback = nullptr;
 }
 
+void WaylandWindow::presentation_feedback_discarded(
+    void* data,
+    struct wp_presentation_feedback* feedback) {
+  auto* window = static_cast<WaylandWindow*>(data);
+  wp_presentation_feedback_destroy(feedback);
+  window->m_presentation_feedback = nullptr;
+}
+
+const struct wp_presentation_feedback_listener
+    WaylandWindow::m_presentation_feedback_listener = {
+        .sync_output = presentation_feedback_sync_output,
+        .presented = presentation_feedback_presented,
+        .discarded = presentation_feedback_discarded,
+};
+#endif
+
 bool WaylandWindow::ActivateSystemCursor(int32_t device,
                                          const std::string& kind) const {
   return m_display->ActivateSystemCursor(device, kind);
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -23,6 +24,7 @@
 #include <cassert>
 
 #include "backend/backend.h"
+#include "timer.h"
 
 // workaround for Wayland macro not compiling in C++
 #define WL_ARRAY_FOR_EACH(pos, array, type)                             \
@@ -82,15 +84,6 @@ class WaylandWindow {
    */
   void SetEngine(const std::shared_ptr<Engine>& engine);
 
-  /**
-   * @brief Get Fps Counter
-   * @return uint32_t
-   * @retval Frames Per Second counter.
-   * @relation
-   * wayland
-   */
-  uint32_t GetFpsCounter();
-
   /**
    * @brief activate a system cursor
    * @param[in] device Device
@@ -113,7 +106,26 @@ class WaylandWindow {
    */
   wl_surface* GetBaseSurface() { return m_base_surface; }
 
-  uint32_t m_fps_counter{};
+  /**
+   * @brief Answer an engine vsync request on the next frame callback of the
+   * base surface. Thread safe, called from the Flutter UI thread.
+   * @param[in] engine Engine handle to answer
+   * @param[in] baton Vsync baton handed out by the engine
+   * @return void
+   * @relation
+   * wayland, flutter
+   */
+  void ScheduleVsync(FLUTTER_API_SYMBOL(FlutterEngine) engine, intptr_t baton);
+
+  /**
+   * @brief Check if an engine vsync request is waiting for a frame callback
+   * @return bool
+   * @retval true Pointer events are flushed when it is answered
+   * @retval false No frame is pending
+   * @relation
+   * wayland, flutter
+   */
+  NODISCARD bool IsVsyncPending() const { return m_vsync_baton != 0; }
 
   /**
    * @brief Get window_type
@@ -184,6 +196,85 @@ class WaylandWindow {
 
   struct wl_callback* m_base_frame_callback{};
 
+  /// vsync baton awaiting the next frame callback, 0 if none
+  std::atomic<intptr_t> m_vsync_baton{};
+  std::atomic<FLUTTER_API_SYMBOL(FlutterEngine)> m_vsync_engine{};
+  /// answers the baton if frame callbacks are throttled by the compositor
+  std::unique_ptr<EventTimer> m_vsync_timer;
+  struct wp_presentation_feedback* m_presentation_feedback{};
+  /// last presentation feedback of the base surface, CLOCK_MONOTONIC
+  struct {
+    uint64_t last_present_ns;
+    uint64_t refresh_ns;
+  } m_presentation{};
+
+  /**
+   * @brief Get the refresh period of the output
+   * @return uint64_t
+   * @retval refresh period in nanoseconds
+   * @relation
+   * wayland
+   */
+  NODISCARD uint64_t GetRefreshPeriod() const;
+
+  /**
+   * @brief Answer a pending vsync baton, aligned to the presentation clock
+   * @param[in] now_ns Current time in nanoseconds, CLOCK_MONOTONIC
+   * @return void
+   * @relation
+   * wayland, flutter
+   */
+  void AnswerVsync(uint64_t now_ns);
+
+  /**
+   * @brief Vsync fallback timer expired
+   * @param[in] data Pointer to WaylandWindow type
+   * @return void
+   * @relation
+   * wayland, flutter
+   */
+  static void on_vsync_timeout(void* data);
+
+#if defined(WP_PRESENTATION_FEEDBACK_SINCE_VERSION)
+  static const struct wp_presentation_feedback_listener
+      m_presentation_feedback_listener;
+
+  static void presentation_feedback_sync_output(
+      void* data,
+      struct wp_presentation_feedback* feedback,
+      struct wl_output* output);
+
+  /**
+   * @brief Record the time the base surface was presented
+   * @param[in] data Pointer to WaylandWindow type
+   * @param[in] feedback Feedback object, destroyed here
+   * @param[in] tv_sec_hi High 32 bits of seconds
+   * @param[in] tv_sec_lo Low 32 bits of seconds
+   * @param[in] tv_nsec Nanoseconds
+   * @param[in] refresh Refresh period in nanoseconds, 0 if unknown
+   * @param[in] seq_hi No use
+   * @param[in] seq_lo No use
+   * @param[in] flags No use
+   * @return void
+   * @relation
+   * wayland
+   */
+  static void presentation_feedback_presented(
+      void* data,
+      struct wp_presentation_feedback* feedback,
+      uint32_t tv_sec_hi,
+      uint32_t tv_sec_lo,
+      uint32_t tv_nsec,
+      uint32_t refresh,
+      uint32_t seq_hi,
+      uint32_t seq_lo,
+      uint32_t flags);
+
+  static void presentation_feedback_discarded(
+      void* data,
+      struct wp_presentation_feedback* feedback);
+#endif
+
   static const struct wl_surface_listener m_base_surface_listener;
 
   /**
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include "event_loop.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// frame of the previous main loop, which polled and slept the rest of it
+constexpr auto kLegacyFrame = std::chrono::milliseconds(16);
+
+struct Wakeup {
+  std::atomic<Clock::rep> sent{};
+  Clock::time_point received;
+  bool seen{};
+};
+
+void OnWakeup(void* data, const int fd, uint32_t /* events */) {
+  EventLoop::Drain(fd);
+  const auto wakeup = static_cast<Wakeup*>(data);
+  wakeup->received = Clock::now();
+  wakeup->seen = true;
+}
+
+double Percentile(std::vector<double> samples, const double p) {
+  std::sort(samples.begin(), samples.end());
+  return samples[static_cast<size_t>(p * static_cast<double>(samples.size() -
+                                                              1))];
+}
+
+// Main loop wakeup latency for a signal from another thread, as input or a
+// plugin sends one at an arbitrary point of the frame.  Arg 0 blocks in the
+// event loop; arg 1 is the previous loop, a non-blocking poll followed by
+// sleeping out the 16 ms frame.
+void BM_EventLoopWakeup(benchmark::State& state) {
+  const bool legacy = state.range(0) != 0;
+  EventLoop loop;
+  const int fd = EventLoop::CreateWakeupFd();
+  Wakeup wakeup;
+  loop.AddFd(fd, EPOLLIN, OnWakeup, &wakeup);
+  std::vector<double> latency_us;
+  latency_us.reserve(static_cast<size_t>(state.max_iterations));
+
+  int i = 0;
+  for (auto _ : state) {
+    wakeup.seen = false;
+    std::thread producer([&wakeup, fd, i] {
+      std::this_thread::sleep_for(
+          std::chrono::microseconds(1000 + (i * 7919) % 19000));
+      wakeup.sent = Clock::now().time_since_epoch().count();
+      EventLoop::Signal(fd);
+    });
+    while (!wakeup.seen) {
+      if (legacy) {
+        const auto start = Clock::now();
+        if (loop.Wait(0) > 0) {
+          loop.Dispatch();
+        }
+        std::this_thread::sleep_until(start + kLegacyFrame);
+      } else if (loop.Wait(100) > 0) {
+        loop.Dispatch();
+      }
+    }
+    producer.join();
+
+    const auto latency =
+        std::chrono::duration<double>(wakeup.received.time_since_epoch() -
+                                      Clock::duration(wakeup.sent.load()));
+    state.SetIterationTime(latency.count());
+    latency_us.push_back(latency.count() * 1e6);
+    i++;
+  }
+
+  loop.RemoveFd(fd);
+  close(fd);
+  state.counters["p50_us"] = Percentile(latency_us, 0.50);
+  state.counters["p99_us"] = Percentile(latency_us, 0.99);
+}
+BENCHMARK(BM_EventLoopWakeup)
+    ->Arg(0)
+    ->Arg(1)
+    ->Iterations(64)
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
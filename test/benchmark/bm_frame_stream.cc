@@ -0,0 +1,43 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "backend/frame_stream.h"
+
+// RGBA to I420 of one frame on the stream's I/O thread; bytes/s is RGBA in.
+static void BM_RgbaToI420(benchmark::State& state) {
+  constexpr uint32_t kWidth = 1920;
+  constexpr uint32_t kHeight = 720;
+  std::vector<uint8_t> rgba(size_t{kWidth} * kHeight * 4);
+  for (size_t i = 0; i < rgba.size(); i++) {
+    rgba[i] = static_cast<uint8_t>(i * 7);
+  }
+  std::vector<uint8_t> i420(FrameStream::I420Size(kWidth, kHeight));
+
+  for (auto _ : state) {
+    FrameStream::RgbaToI420(rgba.data(), kWidth, kHeight, i420.data());
+    benchmark::DoNotOptimize(i420.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(rgba.size()));
+}
+
+BENCHMARK(BM_RgbaToI420)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+
+#include <benchmark/benchmark.h>
+
+#include "frame_timing.h"
+
+namespace {
+
+constexpr uint64_t kPeriod = 16'666'667;
+
+FrameTiming* shared_timing;
+
+// What the main and raster threads record per frame.
+void RecordFrame(FrameTiming& timing, const uint64_t frame) {
+  const auto start = (frame + 1) * kPeriod;
+  timing.OnVsync(start, start + kPeriod);
+  timing.OnRasterStart(start + 4'000'000);
+  timing.OnPresent(start + (frame % 7) * 3'000'000, 1920 * 1080);
+}
+
+void BM_FrameTimingRecord(benchmark::State& state) {
+  FrameTiming timing;
+  uint64_t frame = 0;
+
+  for (auto _ : state) {
+    RecordFrame(timing, frame++);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FrameTimingRecord);
+
+// Summary of a full ring, as DrawFps() computes it.
+void BM_FrameTimingSummary(benchmark::State& state) {
+  FrameTiming timing;
+  for (uint64_t frame = 0; frame < FrameTiming::kFrames; frame++) {
+    RecordFrame(timing, frame);
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(timing.GetSummary());
+  }
+}
+BENCHMARK(BM_FrameTimingSummary);
+
+// Thread 0 records frames while thread 1 keeps copying the ring; the record
+// cost must not depend on the reader.
+void BM_FrameTimingRecordWithReader(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    shared_timing = new FrameTiming();
+  }
+  // the loops start and stop together, so thread 0 owns the ring
+  std::array<FrameTiming::Frame, FrameTiming::kFrames> frames{};
+  uint64_t frame = 0;
+
+  for (auto _ : state) {
+    if (state.thread_index() == 0) {
+      RecordFrame(*shared_timing, frame++);
+    } else {
+      benchmark::DoNotOptimize(shared_timing->Snapshot(frames.data()));
+    }
+  }
+
+  if (state.thread_index() == 0) {
+    state.SetItemsProcessed(state.iterations());
+    delete shared_timing;
+    shared_timing = nullptr;
+  }
+}
+BENCHMARK(BM_FrameTimingRecordWithReader)->Threads(2)->UseRealTime();
+
+}  // namespace
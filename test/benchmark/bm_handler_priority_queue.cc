@@ -0,0 +1,78 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "handler_priority_queue.h"
+#include "stub_flutter_engine.h"
+
+namespace {
+
+constexpr int kMaxThreads = StubFlutterEngine::kMaxProducerThreads;
+
+// Deadlines scattered below the current time, so every task is due.
+uint64_t Deadline(const uint64_t i) {
+  return (i * 2654435761u) % 1'000'000u;
+}
+
+// Insert a batch of range(0) tasks, then pop all of them.
+void BM_HandlerPriorityQueueAddPop(benchmark::State& state) {
+  StubFlutterEngine::Install();
+  handler_priority_queue queue;
+  const auto batch = static_cast<uint64_t>(state.range(0));
+  auto engine = StubFlutterEngine::engine;
+
+  for (auto _ : state) {
+    for (uint64_t i = 0; i < batch; i++) {
+      queue.add(Deadline(i), FlutterTask{nullptr, 0});
+    }
+    queue.collect();
+    queue.execute_all(engine);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HandlerPriorityQueueAddPop)->RangeMultiplier(8)->Range(1, 4096);
+
+handler_priority_queue* shared_queue;
+
+// add() from 1..N producers while the first thread also consumes.
+void BM_HandlerPriorityQueueContention(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    StubFlutterEngine::Install();
+    shared_queue = new handler_priority_queue();
+  }
+  auto engine = StubFlutterEngine::engine;
+  uint64_t i = 0;
+
+  for (auto _ : state) {
+    shared_queue->add(Deadline(i++), FlutterTask{nullptr, 0});
+    if (state.thread_index() == 0 && i % 64 == 0) {
+      shared_queue->collect();
+      shared_queue->execute_all(engine);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    delete shared_queue;
+    shared_queue = nullptr;
+  }
+}
+BENCHMARK(BM_HandlerPriorityQueueContention)
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+#include <GLES2/gl2.h>
+
+#include "backend/frame_capture.h"
+#include "backend/headless/surfaceless_egl.h"
+#if BENCHMARK_HEADLESS_OSMESA
+#include "backend/headless/osmesa.h"
+#endif
+
+namespace {
+
+constexpr int32_t kWidth = 1920;
+constexpr int32_t kHeight = 720;
+/// blended quads per frame, a busy cluster frame
+constexpr int kQuads = 200;
+
+constexpr char kVertexShader[] =
+    "#version 100\n"
+    "attribute vec2 position;\n"
+    "uniform vec4 rect;\n"
+    "void main() {\n"
+    "  gl_Position = vec4(rect.xy + position * rect.zw, 0.0, 1.0);\n"
+    "}\n";
+
+constexpr char kFragmentShader[] =
+    "#version 100\n"
+    "precision mediump float;\n"
+    "uniform vec4 color;\n"
+    "void main() {\n"
+    "  gl_FragColor = color;\n"
+    "}\n";
+
+void* Resolve(const SurfacelessEgl* /* context */, const char* name) {
+  return reinterpret_cast<void*>(eglGetProcAddress(name));
+}
+
+#if BENCHMARK_HEADLESS_OSMESA
+void* Resolve(const OSMesaHeadless* /* context */, const char* name) {
+  return reinterpret_cast<void*>(OSMesaGetProcAddress(name));
+}
+#endif
+
+/// GL entry points are resolved through the context, as the engine does
+struct Scene {
+  PFNGLCLEARCOLORPROC ClearColor;
+  PFNGLCLEARPROC Clear;
+  PFNGLVIEWPORTPROC Viewport;
+  PFNGLENABLEPROC Enable;
+  PFNGLBLENDFUNCPROC BlendFunc;
+  PFNGLCREATESHADERPROC CreateShader;
+  PFNGLSHADERSOURCEPROC ShaderSource;
+  PFNGLCOMPILESHADERPROC CompileShader;
+  PFNGLCREATEPROGRAMPROC CreateProgram;
+  PFNGLATTACHSHADERPROC AttachShader;
+  PFNGLBINDATTRIBLOCATIONPROC BindAttribLocation;
+  PFNGLLINKPROGRAMPROC LinkProgram;
+  PFNGLUSEPROGRAMPROC UseProgram;
+  PFNGLDELETEPROGRAMPROC DeleteProgram;
+  PFNGLDELETESHADERPROC DeleteShader;
+  PFNGLGETUNIFORMLOCATIONPROC GetUniformLocation;
+  PFNGLUNIFORM4FPROC Uniform4f;
+  PFNGLGENBUFFERSPROC GenBuffers;
+  PFNGLDELETEBUFFERSPROC DeleteBuffers;
+  PFNGLBINDBUFFERPROC BindBuffer;
+  PFNGLBUFFERDATAPROC BufferData;
+  PFNGLENABLEVERTEXATTRIBARRAYPROC EnableVertexAttribArray;
+  PFNGLVERTEXATTRIBPOINTERPROC VertexAttribPointer;
+  PFNGLDRAWARRAYSPROC DrawArrays;
+
+  GLuint program{};
+  GLuint vertex_shader{};
+  GLuint fragment_shader{};
+  GLuint buffer{};
+  GLint rect{};
+  GLint color{};
+
+  template <class Context>
+  explicit Scene(const Context* context) {
+    const auto load = [context](auto& fn, const char* name) {
+      fn = reinterpret_cast<std::remove_reference_t<decltype(fn)>>(
+          Resolve(context, name));
+    };
+    load(ClearColor, "glClearColor");
+    load(Clear, "glClear");
+    load(Viewport, "glViewport");
+    load(Enable, "glEnable");
+    load(BlendFunc, "glBlendFunc");
+    load(CreateShader, "glCreateShader");
+    load(ShaderSource, "glShaderSource");
+    load(CompileShader, "glCompileShader");
+    load(CreateProgram, "glCreateProgram");
+    load(AttachShader, "glAttachShader");
+    load(BindAttribLocation, "glBindAttribLocation");
+    load(LinkProgram, "glLinkProgram");
+    load(UseProgram, "glUseProgram");
+    load(DeleteProgram, "glDeleteProgram");
+    load(DeleteShader, "glDeleteShader");
+    load(GetUniformLocation, "glGetUniformLocation");
+    load(Uniform4f, "glUniform4f");
+    load(GenBuffers, "glGenBuffers");
+    load(DeleteBuffers, "glDeleteBuffers");
+    load(BindBuffer, "glBindBuffer");
+    load(BufferData, "glBufferData");
+    load(EnableVertexAttribArray, "glEnableVertexAttribArray");
+    load(VertexAttribPointer, "glVertexAttribPointer");
+    load(DrawArrays, "glDrawArrays");
+
+    vertex_shader = Compile(GL_VERTEX_SHADER, kVertexShader);
+    fragment_shader = Compile(GL_FRAGMENT_SHADER, kFragmentShader);
+    program = CreateProgram();
+    AttachShader(program, vertex_shader);
+    AttachShader(program, fragment_shader);
+    BindAttribLocation(program, 0, "position");
+    LinkProgram(program);
+    UseProgram(program);
+    rect = GetUniformLocation(program, "rect");
+    color = GetUniformLocation(program, "color");
+
+    constexpr std::array<GLfloat, 8> kQuad{0, 0, 1, 0, 0, 1, 1, 1};
+    GenBuffers(1, &buffer);
+    BindBuffer(GL_ARRAY_BUFFER, buffer);
+    BufferData(GL_ARRAY_BUFFER, sizeof(kQuad), kQuad.data(), GL_STATIC_DRAW);
+    EnableVertexAttribArray(0);
+    VertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+    Viewport(0, 0, kWidth, kHeight);
+    Enable(GL_BLEND);
+    BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  }
+
+  ~Scene() {
+    DeleteBuffers(1, &buffer);
+    DeleteProgram(program);
+    DeleteShader(vertex_shader);
+    DeleteShader(fragment_shader);
+  }
+
+  GLuint Compile(const GLenum type, const char* source) const {
+    const auto shader = CreateShader(type);
+    ShaderSource(shader, 1, &source, nullptr);
+    CompileShader(shader);
+    return shader;
+  }
+
+  void Draw(const int64_t frame) const {
+    ClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    Clear(GL_COLOR_BUFFER_BIT);
+    for (int i = 0; i < kQuads; i++) {
+      // quads drift a little every frame, covering about three screens
+      const auto x = static_cast<GLfloat>((i * 37 + frame) % 180) / 100 - 1;
+      const auto y = static_cast<GLfloat>((i * 53) % 180) / 100 - 1;
+      Uniform4f(rect, x, y, 0.2f, 0.33f);
+      Uniform4f(color, static_cast<GLfloat>(i % 7) / 7, 0.5f,
+                static_cast<GLfloat>(i % 3) / 3, 0.5f);
+      DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+  }
+};
+
+}  // namespace
+
+// One frame of blended quads rendered offscreen and read back into the
+// frame capture ring, as the headless present does; fps is the headless
+// frame rate.
+template <class Context>
+static void BM_HeadlessFrame(benchmark::State& state) {
+  Context context(kWidth, kHeight);
+  context.MakeCurrent();
+  FrameCapture capture;
+  {
+    const Scene scene(&context);
+    int64_t frame = 0;
+    for (auto _ : state) {
+      scene.Draw(frame);
+      context.ReadPixels(capture.BeginFrame(kWidth, kHeight));
+      capture.EndFrame(static_cast<uint64_t>(frame++));
+    }
+  }
+  state.counters["fps"] =
+      benchmark::Counter(static_cast<double>(state.iterations()),
+                         benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_TEMPLATE(BM_HeadlessFrame, SurfacelessEgl)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+#if BENCHMARK_HEADLESS_OSMESA
+BENCHMARK_TEMPLATE(BM_HeadlessFrame, OSMesaHeadless)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+#endif
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "input_latency.h"
+#include "stub_flutter_engine.h"
+
+namespace {
+
+constexpr int kMaxThreads = StubFlutterEngine::kMaxProducerThreads;
+
+LatencyHistogram shared_histogram;
+
+// Recording from the input handler, the main loop and the raster thread.
+void BM_LatencyHistogramRecord(benchmark::State& state) {
+  uint64_t value = static_cast<uint64_t>(state.thread_index()) * 97;
+
+  for (auto _ : state) {
+    shared_histogram.Record(value);
+    value = (value * 7 + 13) % 50'000;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LatencyHistogramRecord)
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime();
+
+// p50/p90/p99/p99.9 and max of all stages, as dumped on SIGUSR1.
+void BM_InputLatencyDump(benchmark::State& state) {
+  InputLatency latency;
+  for (uint64_t i = 0; i < 10'000; i++) {
+    latency.RecordSent(1'000'000, 1'000'000 + i * 1000, 2'000'000 + i * 1000);
+    latency.OnPresent(20'000'000 + i * 1000);
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(latency.Dump());
+  }
+}
+BENCHMARK(BM_InputLatencyDump);
+
+}  // namespace
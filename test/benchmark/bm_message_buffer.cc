@@ -0,0 +1,67 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "message_buffer.h"
+#include "stub_flutter_engine.h"
+
+namespace {
+
+constexpr int kMaxThreads = StubFlutterEngine::kMaxProducerThreads;
+
+// Acquire, fill and release a pooled buffer of range(0) bytes.
+void BM_MessageBufferPool(benchmark::State& state) {
+  auto& pool = MessageBufferPool::Instance();
+  const auto size = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    auto buffer = pool.Acquire(size);
+    std::memset(buffer->data(), 0, size);
+    buffer->resize(size);
+    benchmark::DoNotOptimize(buffer->data());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MessageBufferPool)
+    ->Arg(64)
+    ->Arg(4096)
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime();
+
+// The previous per-message allocation, for comparison.
+void BM_MessageBufferVector(benchmark::State& state) {
+  const auto size = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    auto buffer = std::make_unique<std::vector<uint8_t>>(size);
+    benchmark::DoNotOptimize(buffer->data());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MessageBufferVector)
+    ->Arg(64)
+    ->Arg(4096)
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime();
+
+}  // namespace
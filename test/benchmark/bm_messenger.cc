@@ -0,0 +1,103 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "flutter_desktop_engine_state.h"
+#include "flutter_desktop_messenger.h"
+#include "flutter_homescreen.h"
+#include "flutter_messenger.h"
+#include "stub_flutter_engine.h"
+
+namespace {
+
+constexpr int kMaxThreads = StubFlutterEngine::kMaxProducerThreads;
+constexpr std::array<uint8_t, 64> kMessage{};
+
+FlutterDesktopEngineState* engine_state;
+FlutterDesktopMessengerRef messenger;
+
+// FlutterDesktopMessengerSend() from threads other than the platform thread,
+// i.e. a post to the platform runner and a wait for the send to complete.
+void BM_FlutterDesktopMessengerSend(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    engine_state = new FlutterDesktopEngineState();
+    engine_state->flutter_engine = StubFlutterEngine::engine;
+    engine_state->platform_task_runner =
+        &StubFlutterEngine::PlatformTaskRunner();
+    messenger = FlutterDesktopMessengerAddRef(new FlutterDesktopMessenger());
+    messenger->SetEngine(engine_state);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(FlutterDesktopMessengerSend(
+        messenger, "benchmark", kMessage.data(), kMessage.size()));
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    FlutterDesktopMessengerRelease(messenger);
+    delete engine_state;
+  }
+}
+BENCHMARK(BM_FlutterDesktopMessengerSend)
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime();
+
+// Fire-and-forget FlutterDesktopMessengerSendAsync() from foreign threads,
+// in batches of range(0) messages.  The queue is drained outside the timed
+// region.
+void BM_FlutterDesktopMessengerSendAsync(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    engine_state = new FlutterDesktopEngineState();
+    engine_state->flutter_engine = StubFlutterEngine::engine;
+    engine_state->platform_task_runner =
+        &StubFlutterEngine::PlatformTaskRunner();
+    messenger = FlutterDesktopMessengerAddRef(new FlutterDesktopMessenger());
+    messenger->SetEngine(engine_state);
+  }
+  const auto batch = static_cast<size_t>(state.range(0));
+  const std::vector<FlutterDesktopMessengerBatchEntry> entries(
+      batch, {"benchmark", kMessage.data(), kMessage.size(), nullptr, nullptr});
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(FlutterDesktopMessengerSendBatchAsync(
+        messenger, entries.data(), entries.size(), nullptr, nullptr));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+
+  if (state.thread_index() == 0) {
+    // all producers have left the loop
+    while (engine_state->message_queue.pending.load() != 0) {
+      std::this_thread::yield();
+    }
+    FlutterDesktopMessageQueueStats stats{};
+    FlutterDesktopEngineGetMessageQueueStats(engine_state, &stats);
+    state.counters["high_water"] = static_cast<double>(stats.high_water);
+    FlutterDesktopMessengerRelease(messenger);
+    delete engine_state;
+  }
+}
+BENCHMARK(BM_FlutterDesktopMessengerSendAsync)
+    ->Arg(1)
+    ->Arg(16)
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "backend/headless/surfaceless_egl.h"
+#include "platform/homescreen/pixel_buffer_texture.h"
+
+namespace {
+
+constexpr size_t kWidth = 1920;
+constexpr size_t kHeight = 1080;
+
+}  // namespace
+
+// A 1080p RGBA video frame uploaded at each frame boundary while the raster
+// thread draws the texture; arg 0 is the raster frame rate.  The time is
+// spent on the uploading thread only, the raster thread never waits.
+static void BM_PixelBufferTextureUpload(benchmark::State& state) {
+  const auto fps = state.range(0);
+  SurfacelessEgl context(16, 16);
+  if (!context.MakeTextureCurrent()) {
+    state.SkipWithError("no surfaceless EGL");
+    return;
+  }
+  std::vector<uint8_t> pixels(kWidth * kHeight * 4, 0x80);
+  FlutterDesktopPixelBuffer buffer{pixels.data(), kWidth, kHeight, nullptr,
+                                   nullptr};
+  auto texture = std::make_shared<PixelBufferTexture>(
+      FlutterDesktopPixelBufferTextureConfig{
+          [](size_t /* width */, size_t /* height */,
+             void* user_data) -> const FlutterDesktopPixelBuffer* {
+            return static_cast<const FlutterDesktopPixelBuffer*>(user_data);
+          },
+          &buffer});
+  if (!texture->Initialize()) {
+    state.SkipWithError("no texture");
+    return;
+  }
+
+  // the raster thread holds each texture for one frame
+  std::atomic<bool> running{true};
+  std::thread raster([&] {
+    const auto period = std::chrono::microseconds(1000000 / fps);
+    auto next = std::chrono::steady_clock::now();
+    while (running.load()) {
+      FlutterOpenGLTexture out{};
+      const auto drawn = texture->Populate(kWidth, kHeight, &out);
+      next += period;
+      std::this_thread::sleep_until(next);
+      if (drawn) {
+        out.destruction_callback(out.user_data);
+      }
+    }
+  });
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(texture->Upload());
+    // as the frame boundary does before marking the frame
+    glFinish();
+  }
+  running.store(false);
+  raster.join();
+
+  const auto iterations = static_cast<double>(state.iterations());
+  state.counters["fps"] =
+      benchmark::Counter(iterations, benchmark::Counter::kIsRate);
+  state.counters["dropped"] =
+      static_cast<double>(texture->GetStats().dropped);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(pixels.size()));
+  texture->Destroy();
+  context.ClearCurrent();
+}
+
+BENCHMARK(BM_PixelBufferTextureUpload)
+    ->Arg(30)
+    ->Arg(60)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
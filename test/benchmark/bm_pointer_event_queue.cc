@@ -0,0 +1,117 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "config/common.h"
+#include "libflutter_engine.h"
+#include "pointer_event_queue.h"
+#include "stub_flutter_engine.h"
+
+namespace {
+
+PointerEventQueue* shared_queue;
+
+// Same event Engine::CoalesceTouchFrame() builds.
+FlutterPointerEvent TouchEvent(const FlutterPointerPhase phase,
+                               const double x,
+                               const double y,
+                               const int32_t device) {
+  const auto timestamp = LibFlutterEngine->GetCurrentTime() / 1000;
+  return FlutterPointerEvent{.struct_size = sizeof(FlutterPointerEvent),
+                             .phase = phase,
+#if ENV64BIT
+                             .timestamp = timestamp,
+#elif ENV32BIT
+                             .timestamp = static_cast<size_t>(
+                                 timestamp & 0xFFFFFFFFULL),
+#endif
+                             .x = x,
+                             .y = y,
+                             .device = device,
+                             .signal_kind = kFlutterPointerSignalKindNone,
+                             .scroll_delta_x = 0.0,
+                             .scroll_delta_y = 0.0,
+                             .device_kind = kFlutterPointerDeviceKindTouch,
+                             .buttons = 0,
+                             .pan_x = 0,
+                             .pan_y = 0,
+                             .scale = 0,
+                             .rotation = 0};
+}
+
+// One frame of input: range(0) touch moves spread over kMaxTouchFinger
+// fingers, coalesced and flushed as the main loop does right before vsync.
+void BM_PointerEventQueueFrame(benchmark::State& state) {
+  StubFlutterEngine::Install();
+  PointerEventQueue queue;
+  const auto events = static_cast<int>(state.range(0));
+  double x = 0;
+
+  for (auto _ : state) {
+    for (int i = 0; i < events; i++) {
+      queue.Push(TouchEvent(kMove, x, x, i % kMaxTouchFinger));
+      x += 1.0;
+    }
+    benchmark::DoNotOptimize(queue.Flush(StubFlutterEngine::engine));
+  }
+
+  const auto stats = queue.TakeStats();
+  state.SetItemsProcessed(static_cast<int64_t>(stats.pushed));
+  state.counters["sent_per_frame"] = benchmark::Counter(
+      static_cast<double>(stats.sent) / static_cast<double>(stats.flushes));
+}
+BENCHMARK(BM_PointerEventQueueFrame)->Arg(kMaxTouchFinger)->Arg(64)->Arg(240);
+
+// Input dispatch on one thread, flushes on another; reports the time from
+// event creation to SendPointerEvent.
+void BM_PointerEventQueueLatency(benchmark::State& state) {
+  if (state.thread_index() == 0) {
+    StubFlutterEngine::Install();
+    shared_queue = new PointerEventQueue();
+  }
+  double x = 0;
+
+  for (auto _ : state) {
+    if (state.thread_index() == 0) {
+      shared_queue->Push(TouchEvent(kMove, x, x, 0));
+      x += 1.0;
+    } else {
+      benchmark::DoNotOptimize(shared_queue->Flush(StubFlutterEngine::engine));
+    }
+  }
+
+  if (state.thread_index() == 1) {
+    shared_queue->Flush(StubFlutterEngine::engine);
+    const auto stats = shared_queue->TakeStats();
+    state.counters["latency_avg_us"] =
+        benchmark::Counter(static_cast<double>(stats.latency_total_us) /
+                           static_cast<double>(stats.pushed ? stats.pushed : 1));
+    state.counters["latency_max_us"] =
+        benchmark::Counter(static_cast<double>(stats.latency_max_us));
+    state.counters["dropped"] =
+        benchmark::Counter(static_cast<double>(stats.dropped));
+    // the consumer tears down; the producer is done after the loop
+    delete shared_queue;
+    shared_queue = nullptr;
+  }
+  if (state.thread_index() == 0) {
+    state.SetItemsProcessed(state.iterations());
+  }
+}
+BENCHMARK(BM_PointerEventQueueLatency)->Threads(2)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "backend/wayland_software/shm_rows.h"
+
+// Row diff and copy of one software frame into a wl_shm buffer; arg 0 is the
+// number of changed rows, arg 1 the ShmRows::Conversion.
+static void BM_ShmRowsPresent(benchmark::State& state) {
+  constexpr uint32_t kWidth = 1920;
+  constexpr uint32_t kHeight = 720;
+  constexpr size_t kStride = kWidth * ShmRows::kBytesPerPixel;
+  const auto rows = static_cast<uint32_t>(state.range(0));
+  const auto conversion = static_cast<ShmRows::Conversion>(state.range(1));
+  std::vector<uint8_t> frame(kStride * kHeight);
+  std::vector<uint8_t> shadow(frame.size());
+  std::vector<uint8_t> buffer(frame.size());
+  DamageRegion damage;
+  uint8_t value = 0;
+
+  for (auto _ : state) {
+    // a band of rows changes every frame, like a scrolling list item
+    value++;
+    for (uint32_t y = 0; y < rows; y++) {
+      frame[y * kStride + (y % kWidth) * ShmRows::kBytesPerPixel] = value;
+    }
+    ShmRows::Diff(frame.data(), shadow.data(), kStride, kWidth, kHeight,
+                  &damage);
+    ShmRows::Copy(frame.data(), kStride, buffer.data(), kStride, kWidth,
+                  kHeight, damage, conversion);
+    benchmark::DoNotOptimize(buffer.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(frame.size()));
+}
+
+BENCHMARK(BM_ShmRowsPresent)
+    ->ArgsProduct({{0, 72, 720}, {ShmRows::kCopy, ShmRows::kSwapRedBlue}})
+    ->Unit(benchmark::kMicrosecond);
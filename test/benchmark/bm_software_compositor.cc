@@ -0,0 +1,120 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "backend/headless/software_compositor.h"
+
+namespace {
+
+constexpr uint32_t kWidth = 1920;
+constexpr uint32_t kHeight = 720;
+
+/// full frame software backing store, translucent where it paints
+struct Layer {
+  std::vector<uint8_t> pixels;
+  FlutterBackingStore store{};
+  FlutterRect paint_rect{};
+  FlutterRegion paint_region{};
+  FlutterBackingStorePresentInfo info{};
+  FlutterLayer layer{};
+
+  explicit Layer(const uint8_t alpha)
+      : pixels(size_t{kWidth} * kHeight * SoftwareCompositor::kBytesPerPixel,
+               alpha / 2) {
+    for (size_t i = 3; i < pixels.size(); i += 4) {
+      pixels[i] = alpha;
+    }
+    store.struct_size = sizeof(FlutterBackingStore);
+    store.type = kFlutterBackingStoreTypeSoftware2;
+    store.software2.struct_size = sizeof(FlutterSoftwareBackingStore2);
+    store.software2.allocation = pixels.data();
+    store.software2.row_bytes =
+        size_t{kWidth} * SoftwareCompositor::kBytesPerPixel;
+    store.software2.height = kHeight;
+    store.software2.pixel_format = kFlutterSoftwarePixelFormatRGBA8888;
+    paint_region = {sizeof(FlutterRegion), 1, &paint_rect};
+    info = {sizeof(FlutterBackingStorePresentInfo), &paint_region};
+    layer.struct_size = sizeof(FlutterLayer);
+    layer.type = kFlutterLayerContentTypeBackingStore;
+    layer.backing_store = &store;
+    layer.size = {kWidth, kHeight};
+    layer.backing_store_present_info = &info;
+  }
+};
+
+}  // namespace
+
+// One headless frame of an app with platform views: an opaque bottom layer
+// and translucent layers above; arg 0 is the number of backing store layers,
+// arg 1 the percentage of rows the top layer repaints each frame.
+static void BM_SoftwareCompositor(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  const auto rows = static_cast<double>(kHeight * state.range(1) / 100);
+  std::vector<std::unique_ptr<Layer>> layers;
+  std::vector<const FlutterLayer*> stack;
+  for (size_t i = 0; i < count; i++) {
+    layers.push_back(std::make_unique<Layer>(i == 0 ? 255 : 160));
+    // layers above the bottom one cover a band, like a video overlay
+    layers.back()->paint_rect =
+        i == 0 ? FlutterRect{0, 0, kWidth, kHeight}
+               : FlutterRect{0, 0, kWidth, static_cast<double>(kHeight) / 2};
+    stack.push_back(&layers.back()->layer);
+  }
+  SoftwareCompositor compositor;
+  compositor.Resize(kWidth, kHeight);
+  compositor.Composite(stack.data(), stack.size());
+  for (const auto& layer : layers) {
+    layer->store.did_update = false;
+  }
+  auto& top = *layers.back();
+  top.store.did_update = true;
+  top.paint_rect = {0, 0, kWidth, rows};
+
+  double area = 0;
+  for (auto _ : state) {
+    area += compositor.Composite(stack.data(), stack.size()).Area();
+    benchmark::DoNotOptimize(compositor.GetFrame());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(
+      static_cast<int64_t>(area) *
+      static_cast<int64_t>(SoftwareCompositor::kBytesPerPixel));
+}
+
+BENCHMARK(BM_SoftwareCompositor)
+    ->ArgsProduct({{1, 2, 4}, {10, 100}})
+    ->Unit(benchmark::kMicrosecond);
+
+// Blending of one translucent 1920 pixel row.
+static void BM_SoftwareCompositorBlendRow(benchmark::State& state) {
+  const size_t size = size_t{kWidth} * SoftwareCompositor::kBytesPerPixel;
+  std::vector<uint8_t> src(size, 0x40);
+  std::vector<uint8_t> dst(size, 0xff);
+  for (auto _ : state) {
+    SoftwareCompositor::BlendRow(src.data(), dst.data(), kWidth);
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(size));
+}
+
+BENCHMARK(BM_SoftwareCompositorBlendRow);
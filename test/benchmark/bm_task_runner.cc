@@ -0,0 +1,86 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "message_buffer.h"
+#include "stub_flutter_engine.h"
+#include "task_runner.h"
+
+namespace {
+
+constexpr int kMaxThreads = StubFlutterEngine::kMaxProducerThreads;
+
+// Submission cost of immediate tasks from 1..N producer threads.  Each
+// producer waits for its own tasks to drain outside the timed region.
+void BM_QueueFlutterTask(benchmark::State& state) {
+  auto& runner = StubFlutterEngine::PlatformTaskRunner();
+  const auto slot = state.thread_index();
+  const auto base = StubFlutterEngine::TasksRun(slot);
+  const FlutterTask task{nullptr, static_cast<uint64_t>(slot)};
+
+  for (auto _ : state) {
+    runner.QueueFlutterTask(0, 0, task, nullptr);
+  }
+
+  StubFlutterEngine::WaitForTasks(
+      slot, base + static_cast<uint64_t>(state.iterations()));
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_QueueFlutterTask)->ThreadRange(1, kMaxThreads)->UseRealTime();
+
+// Time from QueueFlutterTask() until RunTask() is observed by the producer.
+void BM_QueueFlutterTaskLatency(benchmark::State& state) {
+  auto& runner = StubFlutterEngine::PlatformTaskRunner();
+  const auto slot = state.thread_index();
+  auto expected = StubFlutterEngine::TasksRun(slot);
+  const FlutterTask task{nullptr, static_cast<uint64_t>(slot)};
+
+  for (auto _ : state) {
+    runner.QueueFlutterTask(0, 0, task, nullptr);
+    StubFlutterEngine::WaitForTasks(slot, ++expected);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_QueueFlutterTaskLatency)
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime();
+
+// QueuePlatformMessage() round trip: post, send on the runner, wait on the
+// future.
+void BM_QueuePlatformMessage(benchmark::State& state) {
+  auto& runner = StubFlutterEngine::PlatformTaskRunner();
+  const std::vector<uint8_t> payload(static_cast<size_t>(state.range(0)));
+  auto& pool = MessageBufferPool::Instance();
+
+  for (auto _ : state) {
+    auto f = runner.QueuePlatformMessage(
+        "benchmark", pool.Copy(payload.data(), payload.size()));
+    f.wait();
+    benchmark::DoNotOptimize(f.get());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QueuePlatformMessage)
+    ->Arg(64)
+    ->Arg(4096)
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "stub_flutter_engine.h"
+#include "texture_frame_queue.h"
+
+namespace {
+
+// One frame of texture producers: range(0) marks spread over range(1)
+// textures, flushed as the main loop does right before vsync.
+void BM_TextureFrameQueueFrame(benchmark::State& state) {
+  StubFlutterEngine::Install();
+  TextureFrameQueue queue;
+  const auto marks = state.range(0);
+  const auto textures = state.range(1);
+
+  for (auto _ : state) {
+    for (int64_t i = 0; i < marks; i++) {
+      queue.Mark(i % textures);
+    }
+    benchmark::DoNotOptimize(queue.Flush(StubFlutterEngine::engine));
+  }
+
+  const auto stats = queue.TakeStats();
+  state.SetItemsProcessed(static_cast<int64_t>(stats.marks));
+  state.counters["sent_per_frame"] = benchmark::Counter(
+      static_cast<double>(stats.sent) / static_cast<double>(stats.flushes));
+  state.counters["coalesced_per_frame"] = benchmark::Counter(
+      static_cast<double>(stats.coalesced) /
+      static_cast<double>(stats.flushes));
+}
+BENCHMARK(BM_TextureFrameQueueFrame)
+    ->Args({1, 1})
+    ->Args({3, 2})
+    ->Args({16, 4});
+
+}  // namespace
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "platform/homescreen/flutter_desktop_texture_registrar.h"
+#include "platform/homescreen/texture_registry.h"
+
+namespace {
+
+void Fill(TextureRegistry& registry, const int64_t count) {
+  for (int64_t id = 0; id < count; id++) {
+    auto desc = std::make_shared<GL_TEXTURE_2D_DESC>();
+    desc->name = static_cast<uint32_t>(id);
+    registry.Insert(id, std::move(desc));
+  }
+}
+
+}  // namespace
+
+// Raster thread lookup of one external texture, per registered textures.
+static void BM_TextureRegistryFind(benchmark::State& state) {
+  const auto count = state.range(0);
+  TextureRegistry registry;
+  Fill(registry, count);
+  int64_t id = 0;
+  for (auto _ : state) {
+    const TextureRegistry::Reader reader(registry);
+    benchmark::DoNotOptimize(reader.Find(id));
+    id = (id + 1) % count;
+  }
+}
+
+BENCHMARK(BM_TextureRegistryFind)->Arg(1)->Arg(16)->Arg(256);
+
+// The same lookup while another thread registers and unregisters a texture
+// every 100 us, as video plugins starting and stopping do.
+static void BM_TextureRegistryFindWithWriter(benchmark::State& state) {
+  constexpr int64_t kCount = 16;
+  TextureRegistry registry;
+  Fill(registry, kCount);
+  std::atomic<bool> running{true};
+  std::thread writer([&] {
+    while (running.load()) {
+      registry.Insert(kCount, std::make_shared<GL_TEXTURE_2D_DESC>());
+      registry.Remove(kCount);
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  });
+  int64_t id = 0;
+  for (auto _ : state) {
+    const TextureRegistry::Reader reader(registry);
+    benchmark::DoNotOptimize(reader.Find(id));
+    id = (id + 1) % kCount;
+  }
+  running.store(false);
+  writer.join();
+}
+
+BENCHMARK(BM_TextureRegistryFindWithWriter)->UseRealTime();
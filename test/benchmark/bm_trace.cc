@@ -0,0 +1,42 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "trace.h"
+
+namespace {
+
+// A begin/end pair as TRACE_SCOPE() records it, against the runtime check
+// alone when no trace file is configured.
+void BM_TraceScope(benchmark::State& state) {
+  const auto recording = state.range(0) != 0;
+  if (state.thread_index() == 0) {
+    Trace::Instance().Configure(recording ? "bm_trace.json" : "", false);
+  }
+
+  for (auto _ : state) {
+    const TraceScope scope("BM_TraceScope");
+  }
+
+  if (state.thread_index() == 0) {
+    Trace::Instance().Configure("", false);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TraceScope)->Arg(0)->Arg(1)->ThreadRange(1, 4)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stub_flutter_engine.h"
+
+#include <thread>
+
+#include <ctime>
+
+#include "libflutter_engine.h"
+#include "task_runner.h"
+
+namespace {
+
+int stub_engine_instance;
+
+FlutterEngineResult StubSendPlatformMessage(
+    FLUTTER_API_SYMBOL(FlutterEngine) /* engine */,
+    const FlutterPlatformMessage* /* message */) {
+  return kSuccess;
+}
+
+FlutterEngineResult StubSendPointerEvent(
+    FLUTTER_API_SYMBOL(FlutterEngine) /* engine */,
+    const FlutterPointerEvent* /* events */,
+    size_t /* events_count */) {
+  return kSuccess;
+}
+
+FlutterEngineResult StubMarkExternalTextureFrameAvailable(
+    FLUTTER_API_SYMBOL(FlutterEngine) /* engine */,
+    int64_t /* texture_identifier */) {
+  return kSuccess;
+}
+
+}  // namespace
+
+FLUTTER_API_SYMBOL(FlutterEngine)
+StubFlutterEngine::engine =
+    reinterpret_cast<FLUTTER_API_SYMBOL(FlutterEngine)>(&stub_engine_instance);
+
+StubFlutterEngine::Counter
+    StubFlutterEngine::tasks_run_[StubFlutterEngine::kMaxProducerThreads];
+
+void StubFlutterEngine::Install() {
+  static LibFlutterEngineExports exports = [] {
+    LibFlutterEngineExports e{};
+    e.GetCurrentTime = Now;
+    e.RunTask = RunTask;
+    e.SendPlatformMessage = StubSendPlatformMessage;
+    e.SendPointerEvent = StubSendPointerEvent;
+    e.MarkExternalTextureFrameAvailable =
+        StubMarkExternalTextureFrameAvailable;
+    return e;
+  }();
+  LibFlutterEngine::SetExports(&exports);
+}
+
+uint64_t StubFlutterEngine::Now() {
+  timespec ts{};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ull +
+         static_cast<uint64_t>(ts.tv_nsec);
+}
+
+TaskRunner& StubFlutterEngine::PlatformTaskRunner() {
+  // never destroyed; benchmark threads may still post to it during exit
+  static TaskRunner* runner = [] {
+    Install();
+    return new TaskRunner("Benchmark", engine);
+  }();
+  return *runner;
+}
+
+uint64_t StubFlutterEngine::TasksRun(const int slot) {
+  return tasks_run_[slot].value.load(std::memory_order_acquire);
+}
+
+void StubFlutterEngine::WaitForTasks(const int slot, const uint64_t count) {
+  while (TasksRun(slot) < count) {
+    std::this_thread::yield();
+  }
+}
+
+FlutterEngineResult StubFlutterEngine::RunTask(
+    FLUTTER_API_SYMBOL(FlutterEngine) /* engine */,
+    const FlutterTask* task) {
+  tasks_run_[task->task].value.fetch_add(1, std::memory_order_release);
+  return kSuccess;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2023 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "flutter/shell/platform/embedder/embedder.h"
+
+class TaskRunner;
+
+/**
+ * @brief Stub engine exports shared by the benchmarks.
+ *
+ * RunTask() counts completions per producer, using FlutterTask::task as the
+ * producer slot, so a producer can wait for its own tasks.
+ */
+class StubFlutterEngine {
+ public:
+  /// upper bound of ThreadRange() in all benchmarks
+  static constexpr int kMaxProducerThreads = 8;
+
+  /**
+   * @brief Route LibFlutterEngine calls to the stubs.  Idempotent.
+   * @return void
+   */
+  static void Install();
+
+  /**
+   * @brief Engine time, CLOCK_MONOTONIC in nanoseconds
+   * @return uint64_t
+   */
+  static uint64_t Now();
+
+  /**
+   * @brief Platform task runner shared by the benchmarks, created on first use
+   * @return TaskRunner&
+   */
+  static TaskRunner& PlatformTaskRunner();
+
+  /**
+   * @brief Tasks run so far for a producer slot
+   * @param[in] slot Producer slot
+   * @return uint64_t
+   */
+  static uint64_t TasksRun(int slot);
+
+  /**
+   * @brief Spin until a producer slot has run |count| tasks
+   * @param[in] slot Producer slot
+   * @param[in] count Number of tasks
+   * @return void
+   */
+  static void WaitForTasks(int slot, uint64_t count);
+
+  /// engine handle passed to the stubs; never dereferenced
+  static FLUTTER_API_SYMBOL(FlutterEngine) engine;
+
+ private:
+  struct alignas(64) Counter {
+    std::atomic<uint64_t> value{0};
+  };
+
+  static Counter tasks_run_[kMaxProducerThreads];
+
+  static FlutterEngineResult RunTask(FLUTTER_API_SYMBOL(FlutterEngine) engine,
+                                     const FlutterTask* task);
+};
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "shm_frame_protocol.h"
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+uint64_t Now() {
+  // steady_clock is CLOCK_MONOTONIC, the clock of the frame timestamps
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+int Connect(const char* path) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  while (!g_stop) {
+    const auto fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+      return fd;
+    }
+    close(fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  return -1;
+}
+
+struct Pool {
+  shm_frame::Header* header{};
+  size_t size{};
+
+  void Map(const int fd, const size_t pool_size) {
+    Unmap();
+    const auto mapped =
+        mmap(nullptr, pool_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+      std::perror("mmap");
+      return;
+    }
+    header = static_cast<shm_frame::Header*>(mapped);
+    size = pool_size;
+    if (header->magic != shm_frame::kMagic ||
+        header->version != shm_frame::kVersion) {
+      std::fprintf(stderr, "unknown pool format\n");
+      Unmap();
+    }
+  }
+
+  void Unmap() {
+    if (header) {
+      munmap(header, size);
+    }
+    header = nullptr;
+  }
+};
+
+struct Results {
+  std::vector<uint64_t> latency_ns;
+  uint64_t missed{};
+  uint64_t torn{};
+  /// keeps the pixel reads from being optimized away
+  uint32_t checksum{};
+};
+
+/**
+ * @brief Read the frame of buffer index in place
+ * @return bool
+ * @retval false The writer overwrote the frame while it was read
+ */
+bool ReadFrame(const Pool& pool,
+               const uint32_t index,
+               uint64_t* sequence,
+               uint64_t* timestamp_ns,
+               Results* results) {
+  auto& buffer = pool.header->buffers[index];
+  const auto s1 = buffer.seq.load(std::memory_order_acquire);
+  if (s1 & 1) {
+    return false;
+  }
+  *sequence = buffer.sequence.load(std::memory_order_relaxed);
+  *timestamp_ns = buffer.timestamp_ns.load(std::memory_order_relaxed);
+  const auto stride = buffer.stride.load(std::memory_order_relaxed);
+  const auto height = buffer.height.load(std::memory_order_relaxed);
+
+  // stands in for a texture upload: one word of every row, no copy
+  const auto pixels = shm_frame::BufferPixels(pool.header, index);
+  uint32_t checksum = 0;
+  for (uint32_t y = 0; y < height; y++) {
+    uint32_t word;
+    std::memcpy(&word, pixels + size_t{y} * stride, sizeof(word));
+    checksum ^= word;
+  }
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (buffer.seq.load(std::memory_order_relaxed) != s1) {
+    return false;
+  }
+  results->checksum ^= checksum;
+  return true;
+}
+
+uint64_t Percentile(const std::vector<uint64_t>& sorted, const double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  const auto i = static_cast<size_t>(p * static_cast<double>(sorted.size()));
+  return sorted[std::min(i, sorted.size() - 1)];
+}
+
+void Report(Results& results) {
+  auto& latency = results.latency_ns;
+  std::sort(latency.begin(), latency.end());
+  std::printf(
+      "frames %zu, missed %llu, torn %llu\n"
+      "present to read latency (us): p50 %.1f, p90 %.1f, p99 %.1f, max %.1f\n",
+      latency.size(), static_cast<unsigned long long>(results.missed),
+      static_cast<unsigned long long>(results.torn),
+      static_cast<double>(Percentile(latency, 0.5)) / 1000,
+      static_cast<double>(Percentile(latency, 0.9)) / 1000,
+      static_cast<double>(Percentile(latency, 0.99)) / 1000,
+      latency.empty() ? 0.0 : static_cast<double>(latency.back()) / 1000);
+}
+
+}  // namespace
+
+int main(const int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s <socket path> [frames]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  const uint64_t frames = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0;
+  std::signal(SIGINT, [](int) { g_stop = 1; });
+
+  const auto fd = Connect(argv[1]);
+  if (fd < 0) {
+    return EXIT_FAILURE;
+  }
+
+  Pool pool;
+  Results results;
+  uint64_t last_sequence = 0;
+  while (!g_stop && (frames == 0 || results.latency_ns.size() < frames)) {
+    shm_frame::Message message{};
+    iovec iov{&message, sizeof(message)};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(fd, &msg, MSG_CMSG_CLOEXEC) != sizeof(message)) {
+      break;
+    }
+
+    if (message.type == shm_frame::kPool) {
+      const auto cmsg = CMSG_FIRSTHDR(&msg);
+      if (cmsg && cmsg->cmsg_type == SCM_RIGHTS) {
+        int pool_fd;
+        std::memcpy(&pool_fd, CMSG_DATA(cmsg), sizeof(int));
+        pool.Map(pool_fd, message.value);
+        close(pool_fd);
+      }
+      continue;
+    }
+    if (message.type != shm_frame::kFrame || !pool.header) {
+      continue;
+    }
+
+    // the newest frame, which may be newer than the notification
+    const auto index = pool.header->latest.load(std::memory_order_acquire);
+    uint64_t sequence;
+    uint64_t timestamp_ns;
+    if (index >= shm_frame::kBuffers ||
+        !ReadFrame(pool, index, &sequence, &timestamp_ns, &results)) {
+      results.torn++;
+      continue;
+    }
+    if (sequence <= last_sequence) {
+      continue;
+    }
+    const auto now = Now();
+    results.latency_ns.push_back(now - std::min(now, timestamp_ns));
+    if (last_sequence != 0) {
+      results.missed += sequence - last_sequence - 1;
+    }
+    last_sequence = sequence;
+  }
+
+  Report(results);
+  pool.Unmap();
+  close(fd);
+  return EXIT_SUCCESS;
+}
@@ -42,16 +42,19 @@ TEST(HomescreenAppHeadless, Lv1Normal001) {
     ret = app.Loop();
   } while (ret > 0);
 
+  const auto frame = app.AcquireViewFrame(0);
+  ASSERT_TRUE(frame);
+
   auto test_filename = utils_get_image_filename(TEST, "1");
   auto golden_filename = utils_get_image_filename(GOLDEN, "1");
 
 #ifdef SAVE_IMAGE_FOR_COMPARISON
-  utils_write_targa(app.getViewRenderBuf(0), golden_filename.c_str(), configs[0].view.width.value_or(1920), configs[0].view.height.value_or(1080));
+  utils_write_targa(frame.data(), golden_filename.c_str(), configs[0].view.width.value_or(1920), configs[0].view.height.value_or(1080));
 
   EXPECT_TRUE(0) << "Intentionally failed: Image saved for future comps"
                  << std::endl;
 #else
-  utils_write_targa(app.getViewRenderBuf(0), test_filename.c_str(), configs[0].view.width.value_or(1920), configs[0].view.height.value_or(1080));
+  utils_write_targa(frame.data(), test_filename.c_str(), configs[0].view.width.value_or(1920), configs[0].view.height.value_or(1080));
   int images_are_equal =
     utils_images_are_equal(test_filename.c_str(), golden_filename.c_str(), configs[0].view.width.value_or(1920), configs[0].view.height.value_or(1080));
 
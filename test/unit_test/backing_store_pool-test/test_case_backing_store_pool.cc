@@ -0,0 +1,113 @@
+#include <memory>
+#include <vector>
+
+#include "backend/backing_store_pool.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+using Pool = BackingStorePool<std::unique_ptr<int>>;
+
+constexpr Pool::Key kSmall{64, 64, 1};
+constexpr Pool::Key kLarge{128, 64, 1};
+constexpr size_t kSmallBytes = 64 * 64 * 4;
+constexpr size_t kLargeBytes = 128 * 64 * 4;
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenBackingStorePool_Lv1Normal001
+Use Case Name: Compositor backing store reuse
+Test Summary：Test a released store is handed out again for the same key
+              only, and live and pooled bytes are accounted for
+***************************************************************/
+
+TEST(HomescreenBackingStorePool, Lv1Normal001) {
+  std::vector<int> destroyed;
+  Pool pool(kSmallBytes * 4, 60,
+            [&](std::unique_ptr<int>& r) { destroyed.push_back(*r); });
+
+  // call target API
+  EXPECT_FALSE(pool.Acquire(kSmall).has_value());
+  pool.Created(kSmallBytes);
+  EXPECT_EQ(kSmallBytes, pool.GetStats().live_bytes);
+  pool.Release(kSmall, std::make_unique<int>(1), kSmallBytes);
+
+  EXPECT_FALSE(pool.Acquire(kLarge).has_value());
+  EXPECT_FALSE(pool.Acquire(Pool::Key{64, 64, 2}).has_value());
+  auto store = pool.Acquire(kSmall);
+  ASSERT_TRUE(store.has_value());
+  EXPECT_EQ(1, **store);
+
+  const auto stats = pool.GetStats();
+  EXPECT_EQ(kSmallBytes, stats.live_bytes);
+  EXPECT_EQ(0u, stats.pooled_bytes);
+  EXPECT_EQ(0u, stats.pooled);
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(3u, stats.misses);
+  EXPECT_TRUE(destroyed.empty());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenBackingStorePool_Lv1Normal002
+Use Case Name: Compositor backing store reuse
+Test Summary：Test the least recently released stores are destroyed first
+              over the budget, and idle stores after max_idle_frames
+***************************************************************/
+
+TEST(HomescreenBackingStorePool, Lv1Normal002) {
+  std::vector<int> destroyed;
+  Pool pool(kSmallBytes * 2, 2,
+            [&](std::unique_ptr<int>& r) { destroyed.push_back(*r); });
+  for (int i = 0; i < 3; i++) {
+    pool.Created(kSmallBytes);
+  }
+
+  // call target API
+  pool.Release(kSmall, std::make_unique<int>(1), kSmallBytes);
+  pool.Release(kSmall, std::make_unique<int>(2), kSmallBytes);
+  pool.Release(kSmall, std::make_unique<int>(3), kSmallBytes);
+  EXPECT_EQ(std::vector<int>{1}, destroyed);
+
+  pool.EndFrame();
+  pool.Release(kSmall, std::move(*pool.Acquire(kSmall)), kSmallBytes);
+  pool.EndFrame();
+  // released two frames ago, kept
+  EXPECT_EQ(std::vector<int>{1}, destroyed);
+  pool.EndFrame();
+  EXPECT_EQ((std::vector<int>{1, 2}), destroyed);
+  pool.EndFrame();
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), destroyed);
+
+  const auto stats = pool.GetStats();
+  EXPECT_EQ(0u, stats.live_bytes);
+  EXPECT_EQ(0u, stats.pooled_bytes);
+  EXPECT_EQ(3u, stats.evictions);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenBackingStorePool_Lv1Abnormal001
+Use Case Name: Compositor backing store reuse
+Test Summary：Test a store larger than the budget is not kept, and the free
+              stores are destroyed with the pool
+***************************************************************/
+
+TEST(HomescreenBackingStorePool, Lv1Abnormal001) {
+  std::vector<int> destroyed;
+  {
+    Pool pool(kSmallBytes, 60,
+              [&](std::unique_ptr<int>& r) { destroyed.push_back(*r); });
+    pool.Created(kLargeBytes);
+    pool.Created(kSmallBytes);
+    pool.Created(kSmallBytes);
+
+    // call target API
+    pool.Release(kLarge, std::make_unique<int>(1), kLargeBytes);
+    EXPECT_EQ(std::vector<int>{1}, destroyed);
+    pool.Dropped(kSmallBytes);
+    pool.Release(kSmall, std::make_unique<int>(2), kSmallBytes);
+    EXPECT_EQ(0u, pool.GetStats().live_bytes);
+    EXPECT_EQ(1u, pool.GetStats().pooled);
+  }
+  EXPECT_EQ((std::vector<int>{1, 2}), destroyed);
+}
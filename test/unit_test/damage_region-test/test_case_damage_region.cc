@@ -0,0 +1,134 @@
+#include "backend/damage_region.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+bool operator==(const FlutterRect& a, const FlutterRect& b) {
+  return a.left == b.left && a.top == b.top && a.right == b.right &&
+         a.bottom == b.bottom;
+}
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenDamageRegion_Lv1Normal001
+Use Case Name: Multi-rectangle damage
+Test Summary：Test updates at opposite corners stay separate rects while
+              overlapping and contained rects are merged
+***************************************************************/
+
+TEST(HomescreenDamageRegion, Lv1Normal001) {
+  DamageRegion region;
+
+  // call target API
+  region.Add(FlutterRect{0, 0, 100, 100});
+  region.Add(FlutterRect{1820, 620, 1920, 720});
+  ASSERT_EQ(2u, region.size());
+  EXPECT_EQ(20000, region.Area());
+
+  // inside an existing rect
+  region.Add(FlutterRect{10, 10, 20, 20});
+  EXPECT_EQ(2u, region.size());
+
+  // mostly overlapping, the bounds waste little area
+  region.Add(FlutterRect{0, 10, 100, 110});
+  ASSERT_EQ(2u, region.size());
+  bool merged = false;
+  for (size_t i = 0; i < region.size(); i++) {
+    merged |= region[i] == FlutterRect{0, 0, 100, 110};
+  }
+  EXPECT_TRUE(merged);
+
+  // empty rects are ignored
+  region.Add(FlutterRect{50, 50, 50, 80});
+  EXPECT_EQ(2u, region.size());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenDamageRegion_Lv1Normal002
+Use Case Name: Multi-rectangle damage
+Test Summary：Test more rects than slots are merged into bounds still
+              covering every added rect
+***************************************************************/
+
+TEST(HomescreenDamageRegion, Lv1Normal002) {
+  DamageRegion region;
+  constexpr size_t kAdded = DamageRegion::kMaxRects * 3;
+
+  // call target API
+  for (size_t i = 0; i < kAdded; i++) {
+    const auto x = static_cast<double>(i * 80);
+    region.Add(FlutterRect{x, 0, x + 10, 10});
+  }
+
+  EXPECT_EQ(DamageRegion::kMaxRects, region.size());
+  for (size_t i = 0; i < kAdded; i++) {
+    const auto x = static_cast<double>(i * 80);
+    bool covered = false;
+    for (size_t r = 0; r < region.size(); r++) {
+      covered |= region[r].left <= x && region[r].right >= x + 10;
+    }
+    EXPECT_TRUE(covered) << "rect " << i;
+  }
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenDamageRegion_Lv1Normal003
+Use Case Name: Multi-rectangle damage
+Test Summary：Test the existing damage of a buffer joins the frames rendered
+              since it was last used, handed over as their bounds
+***************************************************************/
+
+TEST(HomescreenDamageRegion, Lv1Normal003) {
+  DamageHistory history;
+  for (int i = 0; i < 3; i++) {
+    DamageRegion frame;
+    const auto x = static_cast<double>(i * 500);
+    frame.Add(FlutterRect{x, 0, x + 10, 10});
+    history.Push(frame);
+  }
+
+  // call target API
+  DamageRegion region;
+  ASSERT_TRUE(history.Accumulate(3, &region));
+  ASSERT_EQ(2u, region.size());
+  EXPECT_EQ(200, region.Area());
+  FlutterDamage damage{};
+  region.Export(&damage);
+  ASSERT_EQ(1u, damage.num_rects);
+  EXPECT_TRUE(damage.damage[0] == (FlutterRect{500, 0, 1010, 10}));
+
+  // the previous frame is already in the buffer
+  ASSERT_TRUE(history.Accumulate(1, &region));
+  EXPECT_TRUE(region.empty());
+
+  region.Export(&damage);
+  ASSERT_EQ(1u, damage.num_rects);
+  EXPECT_TRUE(damage.damage[0] == FlutterRect{});
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenDamageRegion_Lv1Abnormal001
+Use Case Name: Multi-rectangle damage
+Test Summary：Test an unknown buffer age or one older than the history asks
+              for a full repaint
+***************************************************************/
+
+TEST(HomescreenDamageRegion, Lv1Abnormal001) {
+  DamageHistory history;
+  DamageRegion frame;
+  frame.Add(FlutterRect{0, 0, 10, 10});
+  history.Push(frame);
+
+  DamageRegion region;
+
+  // call target API
+  EXPECT_FALSE(history.Accumulate(0, &region));
+  EXPECT_FALSE(history.Accumulate(3, &region));
+  EXPECT_TRUE(history.Accumulate(2, &region));
+
+  for (size_t i = 0; i < DamageHistory::kMaxFrames; i++) {
+    history.Push(frame);
+  }
+  EXPECT_FALSE(history.Accumulate(DamageHistory::kMaxFrames + 2, &region));
+}
@@ -0,0 +1,118 @@
+#include <thread>
+
+#include <unistd.h>
+
+#include "event_loop.h"
+#include "gtest/gtest.h"
+
+static int dispatch_count = 0;
+static int dispatch_fd = -1;
+
+static void event_loop_callback(void* data, int fd, uint32_t /* events */) {
+  EXPECT_EQ(&dispatch_count, data);
+  EventLoop::Drain(fd);
+  dispatch_fd = fd;
+  dispatch_count++;
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenEventLoopDispatch_Lv1Normal001
+Use Case Name: Dispatch
+Test Summary：Test a signalled wakeup fd is reported and dispatched
+***************************************************************/
+
+TEST(HomescreenEventLoopDispatch, Lv1Normal001) {
+  EventLoop loop;
+  const int fd = EventLoop::CreateWakeupFd();
+  dispatch_count = 0;
+  dispatch_fd = -1;
+  EXPECT_TRUE(loop.AddFd(fd, EPOLLIN, event_loop_callback, &dispatch_count));
+
+  // nothing signalled yet
+  EXPECT_EQ(0, loop.Wait(0));
+  EXPECT_FALSE(loop.IsReady(fd));
+
+  // call target API
+  EventLoop::Signal(fd);
+  EXPECT_EQ(1, loop.Wait(1000));
+  EXPECT_TRUE(loop.IsReady(fd));
+  EXPECT_EQ(1, loop.Dispatch());
+
+  EXPECT_EQ(1, dispatch_count);
+  EXPECT_EQ(fd, dispatch_fd);
+
+  // drained by the callback
+  EXPECT_EQ(0, loop.Wait(0));
+
+  close(fd);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenEventLoopDispatch_Lv1Normal002
+Use Case Name: Dispatch
+Test Summary：Test a source removed after Wait is not dispatched
+***************************************************************/
+
+TEST(HomescreenEventLoopDispatch, Lv1Normal002) {
+  EventLoop loop;
+  const int fd = EventLoop::CreateWakeupFd();
+  dispatch_count = 0;
+  EXPECT_TRUE(loop.AddFd(fd, EPOLLIN, event_loop_callback, &dispatch_count));
+
+  EventLoop::Signal(fd);
+  EXPECT_EQ(1, loop.Wait(1000));
+
+  // call target API
+  loop.RemoveFd(fd);
+  EXPECT_EQ(0, loop.Dispatch());
+  EXPECT_EQ(0, dispatch_count);
+
+  // no longer watched
+  EXPECT_EQ(0, loop.Wait(0));
+
+  close(fd);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenEventLoopDispatch_Lv1Abnormal001
+Use Case Name: Dispatch
+Test Summary：Test registering an invalid fd fails
+***************************************************************/
+
+TEST(HomescreenEventLoopDispatch, Lv1Abnormal001) {
+  EventLoop loop;
+
+  // call target API
+  EXPECT_FALSE(loop.AddFd(-1, EPOLLIN, event_loop_callback, &dispatch_count));
+
+  EXPECT_EQ(0, loop.Wait(0));
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenEventLoopWakeup_Lv1Normal001
+Use Case Name: Wakeup
+Test Summary：Test a signal from another thread ends a blocking Wait, and
+              signals sent before the dispatch are dispatched once
+***************************************************************/
+
+TEST(HomescreenEventLoopWakeup, Lv1Normal001) {
+  EventLoop loop;
+  const int fd = EventLoop::CreateWakeupFd();
+  dispatch_count = 0;
+  EXPECT_TRUE(loop.AddFd(fd, EPOLLIN, event_loop_callback, &dispatch_count));
+
+  // call target API
+  std::thread producer([fd] {
+    EventLoop::Signal(fd);
+    EventLoop::Signal(fd);
+  });
+  // blocks until the producer signals, the timeout is only a safety net
+  EXPECT_EQ(1, loop.Wait(10000));
+  producer.join();
+  EXPECT_EQ(1, loop.Dispatch());
+
+  EXPECT_EQ(1, dispatch_count);
+  EXPECT_EQ(0, loop.Wait(0));
+
+  close(fd);
+}
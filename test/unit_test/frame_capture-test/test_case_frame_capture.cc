@@ -0,0 +1,171 @@
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "backend/frame_capture.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+uint64_t Publish(FrameCapture& capture,
+                 const uint8_t value,
+                 const uint32_t width = 4,
+                 const uint32_t height = 2) {
+  const auto pixels = capture.BeginFrame(width, height);
+  if (pixels == nullptr) {
+    return 0;
+  }
+  std::memset(pixels, value, size_t{width} * height * 4);
+  return capture.EndFrame(1000u * value);
+}
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenFrameCapture_Lv1Normal001
+Use Case Name: Headless frame capture
+Test Summary：Test a published frame is acquired with its sequence number,
+              timestamp, size and pixels
+***************************************************************/
+
+TEST(HomescreenFrameCapture, Lv1Normal001) {
+  FrameCapture capture;
+
+  // call target API
+  const auto sequence = Publish(capture, 7, 8, 3);
+  ASSERT_EQ(1u, sequence);
+
+  const auto frame = capture.Acquire();
+  ASSERT_TRUE(frame);
+  EXPECT_EQ(1u, frame.sequence());
+  EXPECT_EQ(7000u, frame.timestamp_ns());
+  EXPECT_EQ(8u, frame.width());
+  EXPECT_EQ(3u, frame.height());
+  EXPECT_EQ(32u, frame.stride());
+  ASSERT_EQ(96u, frame.size());
+  EXPECT_EQ(7, frame.data()[95]);
+
+  // nothing newer yet
+  EXPECT_FALSE(capture.Acquire(sequence));
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenFrameCapture_Lv1Normal002
+Use Case Name: Headless frame capture
+Test Summary：Test a pinned frame is never overwritten and a frame is dropped
+              only when readers pin every other slot
+***************************************************************/
+
+TEST(HomescreenFrameCapture, Lv1Normal002) {
+  FrameCapture capture;
+  Publish(capture, 1);
+  const auto first = capture.Acquire();
+  ASSERT_TRUE(first);
+
+  // call target API
+  EXPECT_EQ(2u, Publish(capture, 2));
+  EXPECT_EQ(3u, Publish(capture, 3));
+  EXPECT_EQ(4u, Publish(capture, 4));
+
+  EXPECT_EQ(1u, first.sequence());
+  EXPECT_EQ(1, first.data()[0]);
+
+  const auto latest = capture.Acquire();
+  ASSERT_TRUE(latest);
+  EXPECT_EQ(4u, latest.sequence());
+  EXPECT_EQ(0u, capture.GetStats().dropped);
+
+  // the slots of 1 and 4 are pinned and 5 is kept for the next reader
+  EXPECT_EQ(5u, Publish(capture, 5));
+  EXPECT_EQ(0u, Publish(capture, 6));
+  EXPECT_EQ(1u, capture.GetStats().dropped);
+  EXPECT_EQ(5u, capture.Acquire().sequence());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenFrameCapture_Lv1Normal003
+Use Case Name: Headless frame capture
+Test Summary：Test readers on other threads only ever see complete frames in
+              publishing order while the writer keeps publishing
+***************************************************************/
+
+TEST(HomescreenFrameCapture, Lv1Normal003) {
+  constexpr int kFrames = 2000;
+  constexpr int kReaders = 3;
+  FrameCapture capture;
+  std::atomic<bool> done{};
+  std::atomic<int> torn{};
+  std::atomic<int> reordered{};
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < kReaders; r++) {
+    readers.emplace_back([&]() {
+      uint64_t last = 0;
+      while (!done.load(std::memory_order_acquire)) {
+        const auto frame = capture.Acquire(last);
+        if (!frame) {
+          continue;
+        }
+        if (frame.sequence() <= last) {
+          reordered++;
+        }
+        last = frame.sequence();
+        const auto value = static_cast<uint8_t>(frame.sequence());
+        for (size_t i = 0; i < frame.size(); i++) {
+          if (frame.data()[i] != value) {
+            torn++;
+            break;
+          }
+        }
+      }
+    });
+  }
+
+  // call target API
+  for (int i = 1; i <= kFrames; i++) {
+    const auto width = static_cast<uint32_t>(16 + i % 5);
+    const auto pixels = capture.BeginFrame(width, 16);
+    if (pixels == nullptr) {
+      continue;
+    }
+    // the frame takes the next sequence number
+    const auto value = static_cast<uint8_t>(capture.GetStats().published + 1);
+    std::memset(pixels, value, size_t{width} * 16 * 4);
+    capture.EndFrame(static_cast<uint64_t>(i));
+  }
+  done.store(true, std::memory_order_release);
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  const auto stats = capture.GetStats();
+  EXPECT_EQ(static_cast<uint64_t>(kFrames), stats.published + stats.dropped);
+  EXPECT_EQ(0, torn.load());
+  EXPECT_EQ(0, reordered.load());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenFrameCapture_Lv1Abnormal001
+Use Case Name: Headless frame capture
+Test Summary：Test nothing is acquired before the first frame and a canceled
+              frame leaves the previous one published
+***************************************************************/
+
+TEST(HomescreenFrameCapture, Lv1Abnormal001) {
+  FrameCapture capture;
+
+  // call target API
+  EXPECT_FALSE(capture.Acquire());
+  EXPECT_EQ(0u, capture.EndFrame(1));
+
+  Publish(capture, 9);
+  ASSERT_NE(nullptr, capture.BeginFrame(4, 2));
+  capture.CancelFrame();
+
+  const auto frame = capture.Acquire();
+  ASSERT_TRUE(frame);
+  EXPECT_EQ(1u, frame.sequence());
+  EXPECT_EQ(9, frame.data()[0]);
+  EXPECT_EQ(1u, capture.GetStats().published);
+}
@@ -0,0 +1,238 @@
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "backend/frame_capture.h"
+#include "backend/frame_stream.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr uint32_t kWidth = 4;
+constexpr uint32_t kHeight = 2;
+
+/// publishes a frame whose bottom row is bottom and the rest top
+void Publish(FrameCapture& capture,
+             FrameStream& stream,
+             const uint8_t bottom,
+             const uint8_t top) {
+  const auto pixels = capture.BeginFrame(kWidth, kHeight);
+  ASSERT_NE(nullptr, pixels);
+  std::memset(pixels, top, size_t{kWidth} * kHeight * 4);
+  std::memset(pixels, bottom, size_t{kWidth} * 4);
+  capture.EndFrame(1000u * bottom);
+  stream.Notify();
+}
+
+bool WaitFor(const std::function<bool()>& done) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!done()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+/// reads exactly size bytes from a non-blocking fd
+std::string ReadExactly(const int fd, const size_t size) {
+  std::string data;
+  WaitFor([&]() {
+    char buf[256];
+    pollfd pfd{fd, POLLIN, 0};
+    poll(&pfd, 1, 10);
+    const auto n = read(fd, buf, std::min(sizeof(buf), size - data.size()));
+    if (n > 0) {
+      data.append(buf, static_cast<size_t>(n));
+    }
+    return data.size() == size;
+  });
+  return data;
+}
+
+std::string TempPath(const char* name) {
+  return ::testing::TempDir() + name + std::to_string(getpid());
+}
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenFrameStream_Lv1Normal001
+Use Case Name: Headless frame streaming
+Test Summary：Test RGBA is converted to full range I420 with the top row
+              first
+***************************************************************/
+
+TEST(HomescreenFrameStream, Lv1Normal001) {
+  // 2x4, red bottom half, blue top half
+  std::vector<uint8_t> rgba(2 * 4 * 4, 0);
+  for (size_t i = 0; i < rgba.size(); i += 4) {
+    rgba[i + (i < rgba.size() / 2 ? 0 : 2)] = 255;
+    rgba[i + 3] = 255;
+  }
+  ASSERT_EQ(12u, FrameStream::I420Size(2, 4));
+  std::vector<uint8_t> i420(12);
+
+  // call target API
+  FrameStream::RgbaToI420(rgba.data(), 2, 4, i420.data());
+
+  // Y rows, blue then red
+  EXPECT_EQ(29, i420[0]);
+  EXPECT_EQ(29, i420[3]);
+  EXPECT_EQ(77, i420[4]);
+  EXPECT_EQ(77, i420[7]);
+  // U then V, blue then red
+  EXPECT_EQ(255, i420[8]);
+  EXPECT_EQ(85, i420[9]);
+  EXPECT_EQ(107, i420[10]);
+  EXPECT_EQ(255, i420[11]);
+
+  // odd sizes round the chroma planes up
+  EXPECT_EQ(17u, FrameStream::I420Size(3, 3));
+  std::vector<uint8_t> white(3 * 3 * 4, 255);
+  std::vector<uint8_t> odd(17);
+  FrameStream::RgbaToI420(white.data(), 3, 3, odd.data());
+  EXPECT_EQ(255, odd[8]);
+  EXPECT_EQ(128, odd[9]);
+  EXPECT_EQ(128, odd[16]);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenFrameStream_Lv1Normal002
+Use Case Name: Headless frame streaming
+Test Summary：Test raw frames are written to a file with their headers and
+              the top row first
+***************************************************************/
+
+TEST(HomescreenFrameStream, Lv1Normal002) {
+  const auto path = TempPath("frame_stream.rgba");
+  FrameCapture capture;
+  {
+    FrameStream stream(capture, path);
+    ASSERT_EQ(FrameStream::Format::kRaw, stream.GetFormat());
+
+    // call target API
+    for (uint8_t i = 1; i <= 3; i++) {
+      Publish(capture, stream, i, 0xf0);
+      ASSERT_TRUE(WaitFor([&]() { return stream.GetStats().written == i; }));
+    }
+    EXPECT_EQ(0u, stream.GetStats().dropped);
+  }
+
+  std::ifstream file(path, std::ios::binary);
+  const std::string data((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+  unlink(path.c_str());
+  constexpr size_t kFrameSize =
+      sizeof(FrameStream::RawHeader) + kWidth * kHeight * 4;
+  ASSERT_EQ(3 * kFrameSize, data.size());
+  for (size_t i = 0; i < 3; i++) {
+    FrameStream::RawHeader header{};
+    std::memcpy(&header, data.data() + i * kFrameSize, sizeof(header));
+    EXPECT_EQ(0, std::memcmp(header.magic, "HSFR", 4));
+    EXPECT_EQ(kWidth, header.width);
+    EXPECT_EQ(kHeight, header.height);
+    EXPECT_EQ(kWidth * 4, header.stride);
+    EXPECT_EQ(i + 1, header.sequence);
+    EXPECT_EQ(1000 * (i + 1), header.timestamp_ns);
+    const auto pixels = data.data() + i * kFrameSize + sizeof(header);
+    EXPECT_EQ('\xf0', pixels[0]);
+    EXPECT_EQ(static_cast<char>(i + 1), pixels[kWidth * 4]);
+  }
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenFrameStream_Lv1Normal003
+Use Case Name: Headless frame streaming
+Test Summary：Test a Unix socket consumer connecting late receives a Y4M
+              header followed by I420 frames
+***************************************************************/
+
+TEST(HomescreenFrameStream, Lv1Normal003) {
+  const auto path = TempPath("frame_stream.sock") + ".y4m";
+  unlink(path.c_str());
+  FrameCapture capture;
+  FrameStream stream(capture, "unix:" + path);
+  ASSERT_EQ(FrameStream::Format::kY4m, stream.GetFormat());
+
+  // no listener yet, dropped
+  Publish(capture, stream, 1, 0);
+  ASSERT_TRUE(WaitFor([&]() { return stream.GetStats().dropped == 1; }));
+
+  const auto listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  ASSERT_EQ(0, bind(listener, reinterpret_cast<sockaddr*>(&addr),
+                    sizeof(addr)));
+  ASSERT_EQ(0, listen(listener, 1));
+
+  // call target API
+  Publish(capture, stream, 2, 0);
+  const auto consumer = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK);
+  ASSERT_GE(consumer, 0);
+
+  const std::string header = "YUV4MPEG2 W4 H2 F60:1 Ip A1:1 C420jpeg\nFRAME\n";
+  const auto frame_size = FrameStream::I420Size(kWidth, kHeight);
+  const auto first = ReadExactly(consumer, header.size() + frame_size);
+  EXPECT_EQ(0, first.compare(0, header.size(), header));
+
+  Publish(capture, stream, 3, 0);
+  const auto second = ReadExactly(consumer, 6 + frame_size);
+  EXPECT_EQ(0, second.compare(0, 6, "FRAME\n"));
+  EXPECT_TRUE(WaitFor([&]() { return stream.GetStats().written == 2; }));
+
+  close(consumer);
+  close(listener);
+  unlink(path.c_str());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenFrameStream_Lv1Abnormal001
+Use Case Name: Headless frame streaming
+Test Summary：Test publishing never waits for a FIFO without a reader, and a
+              reader attaching later gets the frames from then on
+***************************************************************/
+
+TEST(HomescreenFrameStream, Lv1Abnormal001) {
+  const auto path = TempPath("frame_stream.fifo");
+  unlink(path.c_str());
+  ASSERT_EQ(0, mkfifo(path.c_str(), 0600));
+  FrameCapture capture;
+  FrameStream stream(capture, path);
+
+  // call target API
+  for (uint8_t i = 1; i <= 50; i++) {
+    Publish(capture, stream, i, 0);
+  }
+  EXPECT_TRUE(WaitFor([&]() { return stream.GetStats().dropped == 50; }));
+  EXPECT_EQ(0u, stream.GetStats().written);
+
+  const auto reader = open(path.c_str(), O_RDONLY | O_NONBLOCK);
+  ASSERT_GE(reader, 0);
+  Publish(capture, stream, 51, 0);
+  constexpr size_t kFrameSize =
+      sizeof(FrameStream::RawHeader) + kWidth * kHeight * 4;
+  const auto frame = ReadExactly(reader, kFrameSize);
+  ASSERT_EQ(kFrameSize, frame.size());
+  FrameStream::RawHeader header{};
+  std::memcpy(&header, frame.data(), sizeof(header));
+  EXPECT_EQ(51u, header.sequence);
+
+  close(reader);
+  unlink(path.c_str());
+}
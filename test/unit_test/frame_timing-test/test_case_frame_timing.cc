@@ -0,0 +1,181 @@
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "frame_timing.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr uint64_t kPeriod = 16'666'667;
+constexpr uint64_t kUs = 1000;
+
+/// one paced frame: vsync at |start|, raster after 4 ms, present after 10 ms
+void RunFrame(FrameTiming& timing,
+              const uint64_t start,
+              const uint64_t present_offset = 10'000 * kUs) {
+  timing.OnVsync(start, start + kPeriod);
+  timing.OnRasterStart(start + 4'000 * kUs);
+  timing.OnRasterStart(start + 5'000 * kUs);
+  timing.OnPresent(start + present_offset, 100);
+}
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenFrameTiming_Lv1Normal001
+Use Case Name: Per-view frame timing
+Test Summary：Test a frame is recorded with its vsync, first raster start,
+              present and damage
+***************************************************************/
+
+TEST(HomescreenFrameTiming, Lv1Normal001) {
+  FrameTiming timing;
+  const uint64_t start = 1'000 * kPeriod;
+
+  // call target API
+  RunFrame(timing, start);
+
+  std::array<FrameTiming::Frame, FrameTiming::kFrames> frames{};
+  ASSERT_EQ(1u, timing.Snapshot(frames.data()));
+  const auto& frame = frames[0];
+  EXPECT_EQ(1u, frame.number);
+  EXPECT_EQ(start, frame.vsync_start_ns);
+  EXPECT_EQ(start + kPeriod, frame.vsync_target_ns);
+  EXPECT_EQ(start + 4'000 * kUs, frame.raster_start_ns);
+  EXPECT_EQ(10'000 * kUs, frame.FrameTime());
+  EXPECT_EQ(6'000 * kUs, frame.RasterTime());
+  EXPECT_EQ(100u, frame.damage_area);
+  EXPECT_FALSE(frame.IsJanky());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenFrameTiming_Lv1Normal002
+Use Case Name: Per-view frame timing
+Test Summary：Test a frame presented after its vsync target is counted as
+              janky with the vsync intervals it skipped
+***************************************************************/
+
+TEST(HomescreenFrameTiming, Lv1Normal002) {
+  FrameTiming timing;
+  const uint64_t start = 1'000 * kPeriod;
+
+  // call target API
+  RunFrame(timing, start);
+  RunFrame(timing, start + kPeriod, kPeriod * 5 / 2);
+
+  const auto summary = timing.GetSummary();
+  EXPECT_EQ(2u, summary.total_frames);
+  EXPECT_EQ(1u, summary.janky_frames);
+  EXPECT_EQ(2u, summary.missed_vsyncs);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenFrameTiming_Lv1Normal003
+Use Case Name: Per-view frame timing
+Test Summary：Test the summary covers the last kFrames frames, or only the
+              frames after a given one
+***************************************************************/
+
+TEST(HomescreenFrameTiming, Lv1Normal003) {
+  FrameTiming timing;
+  constexpr uint64_t kCount = FrameTiming::kFrames + 100;
+
+  // frame i takes i us more than 1 ms
+  for (uint64_t i = 0; i < kCount; i++) {
+    RunFrame(timing, (1'000 + i) * kPeriod, (1'000 + i) * kUs);
+  }
+
+  // call target API
+  const auto summary = timing.GetSummary();
+  EXPECT_EQ(FrameTiming::kFrames, summary.frames);
+  EXPECT_EQ(kCount, summary.last_frame);
+  EXPECT_NEAR(60.0, summary.fps, 0.01);
+  // the ring holds frames 100..355
+  EXPECT_EQ(1'000 + 100 + 127u, summary.frame_p50_us);
+  EXPECT_EQ(1'000 + 100 + 253u, summary.frame_p99_us);
+  EXPECT_EQ(100u, summary.damage_avg);
+
+  const auto recent = timing.GetSummary(kCount - 10);
+  EXPECT_EQ(10u, recent.frames);
+  EXPECT_EQ(kCount, recent.last_frame);
+
+  const auto none = timing.GetSummary(kCount);
+  EXPECT_EQ(0u, none.frames);
+  EXPECT_EQ(kCount, none.last_frame);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenFrameTiming_Lv1Normal004
+Use Case Name: Per-view frame timing
+Test Summary：Test readers on another thread only ever see complete frames
+              while the raster thread keeps publishing
+***************************************************************/
+
+TEST(HomescreenFrameTiming, Lv1Normal004) {
+  FrameTiming timing;
+  std::atomic<bool> done{false};
+
+  std::thread raster([&timing, &done]() {
+    for (uint64_t i = 0; i < 20'000; i++) {
+      // every field is derived from the frame number
+      const auto start = (i + 1) * kPeriod;
+      timing.OnVsync(start, start + kPeriod);
+      timing.OnRasterStart(start + i);
+      timing.OnPresent(start + 2 * i, i + 1);
+    }
+    done = true;
+  });
+
+  // call target API
+  std::array<FrameTiming::Frame, FrameTiming::kFrames> frames{};
+  while (!done) {
+    const auto count = timing.Snapshot(frames.data());
+    for (size_t i = 0; i < count; i++) {
+      const auto& frame = frames[i];
+      ASSERT_EQ(frame.number, frame.damage_area);
+      ASSERT_EQ(frame.number * kPeriod, frame.vsync_start_ns);
+      ASSERT_EQ(frame.number - 1, frame.RasterTime());
+      if (i) {
+        ASSERT_LT(frames[i - 1].number, frame.number);
+      }
+    }
+  }
+  raster.join();
+  EXPECT_EQ(20'000u, timing.GetSummary().total_frames);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenFrameTiming_Lv1Abnormal001
+Use Case Name: Per-view frame timing
+Test Summary：Test a raster without a new vsync is recorded unpaced, and a
+              raster lagging the vsyncs is matched within the pipeline depth
+***************************************************************/
+
+TEST(HomescreenFrameTiming, Lv1Abnormal001) {
+  FrameTiming timing;
+  const uint64_t start = 1'000 * kPeriod;
+
+  // call target API
+  timing.OnRasterStart(start);
+  timing.OnPresent(start + 3'000 * kUs, 0);
+
+  // three vsyncs answered before the next raster starts
+  for (uint64_t i = 0; i < 3; i++) {
+    timing.OnVsync(start + i * kPeriod, start + (i + 1) * kPeriod);
+  }
+  timing.OnRasterStart(start + 3 * kPeriod);
+  timing.OnPresent(start + 3 * kPeriod + 1'000 * kUs, 0);
+  timing.OnRasterStart(start + 4 * kPeriod);
+  timing.OnPresent(start + 4 * kPeriod + 1'000 * kUs, 0);
+
+  std::array<FrameTiming::Frame, FrameTiming::kFrames> frames{};
+  ASSERT_EQ(3u, timing.Snapshot(frames.data()));
+  EXPECT_EQ(0u, frames[0].vsync_start_ns);
+  EXPECT_EQ(3'000 * kUs, frames[0].FrameTime());
+  EXPECT_FALSE(frames[0].IsJanky());
+  // the oldest vsync produced no frame
+  EXPECT_EQ(start + kPeriod, frames[1].vsync_start_ns);
+  EXPECT_EQ(start + 2 * kPeriod, frames[2].vsync_start_ns);
+}
@@ -0,0 +1,138 @@
+#include <cmath>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "input_latency.h"
+
+namespace {
+
+constexpr uint64_t kNsPerMs = 1'000'000;
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenLatencyHistogram_Lv1Normal001
+Use Case Name: Input latency histogram
+Test Summary：Test percentiles of a uniform distribution are within the
+              histogram's bucket precision
+***************************************************************/
+
+TEST(HomescreenLatencyHistogram, Lv1Normal001) {
+  LatencyHistogram histogram;
+
+  // call target API
+  for (uint64_t value = 1; value <= 100'000; value++) {
+    histogram.Record(value);
+  }
+
+  EXPECT_EQ(100'000u, histogram.count());
+  EXPECT_EQ(100'000u, histogram.max());
+  for (const double percentile : {50.0, 90.0, 99.0, 99.9}) {
+    const auto expected = percentile * 1000.0;
+    const auto value = static_cast<double>(histogram.ValueAtPercentile(percentile));
+    EXPECT_GE(value, expected) << percentile;
+    EXPECT_LE(std::abs(value - expected) / expected, 1.0 / 32) << percentile;
+  }
+  EXPECT_EQ(100'000u, histogram.ValueAtPercentile(100));
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenLatencyHistogram_Lv1Normal002
+Use Case Name: Input latency histogram
+Test Summary：Test small values are exact and an empty histogram reports 0
+***************************************************************/
+
+TEST(HomescreenLatencyHistogram, Lv1Normal002) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(0u, histogram.ValueAtPercentile(50));
+
+  // call target API
+  histogram.Record(3);
+  histogram.Record(3);
+  histogram.Record(17);
+
+  EXPECT_EQ(3u, histogram.ValueAtPercentile(50));
+  EXPECT_EQ(17u, histogram.ValueAtPercentile(99));
+
+  histogram.Reset();
+  EXPECT_EQ(0u, histogram.count());
+  EXPECT_EQ(0u, histogram.max());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenInputLatency_Lv1Normal001
+Use Case Name: Input latency histogram
+Test Summary：Test the oldest input sent before a present is correlated with
+              that present, per stage
+***************************************************************/
+
+TEST(HomescreenInputLatency, Lv1Normal001) {
+  InputLatency latency;
+  const uint64_t input = 100 * kNsPerMs;
+
+  // call target API
+  latency.RecordSent(input, input + 1 * kNsPerMs, input + 5 * kNsPerMs);
+  latency.RecordSent(input + 2 * kNsPerMs, input + 3 * kNsPerMs,
+                     input + 5 * kNsPerMs);
+  latency.OnPresent(input + 12 * kNsPerMs);
+  // no input since the last frame
+  latency.OnPresent(input + 29 * kNsPerMs);
+
+  const auto& dispatch = latency.histogram(InputLatency::kDispatch);
+  EXPECT_EQ(2u, dispatch.count());
+  EXPECT_EQ(1000u, dispatch.max());
+  EXPECT_EQ(4000u,
+            latency.histogram(InputLatency::kQueue).ValueAtPercentile(100));
+
+  const auto& present = latency.histogram(InputLatency::kPresent);
+  EXPECT_EQ(1u, present.count());
+  EXPECT_EQ(7000u, present.max());
+
+  const auto& end_to_end = latency.histogram(InputLatency::kEndToEnd);
+  EXPECT_EQ(1u, end_to_end.count());
+  EXPECT_EQ(12000u, end_to_end.max());
+
+  EXPECT_NE(std::string::npos, latency.Dump().find("end-to-end"));
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenInputLatency_Lv1Normal002
+Use Case Name: Input latency histogram
+Test Summary：Test Wayland millisecond times are mapped to CLOCK_MONOTONIC,
+              including across the 32 bit wrap
+***************************************************************/
+
+TEST(HomescreenInputLatency, Lv1Normal002) {
+  const uint64_t now = 5'000'000 * kNsPerMs + 123'456;
+
+  // call target API
+  EXPECT_EQ(4'999'996 * kNsPerMs,
+            InputLatency::FromWaylandTime(4'999'996, now));
+
+  const uint64_t wrapped_ms = (uint64_t{1} << 32) + 2;
+  EXPECT_EQ((wrapped_ms - 5) * kNsPerMs,
+            InputLatency::FromWaylandTime(UINT32_MAX - 2,
+                                          wrapped_ms * kNsPerMs));
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenInputLatency_Lv1Abnormal001
+Use Case Name: Input latency histogram
+Test Summary：Test a compositor clock other than CLOCK_MONOTONIC is detected
+              and such input is left out of the dispatch and end-to-end stages
+***************************************************************/
+
+TEST(HomescreenInputLatency, Lv1Abnormal001) {
+  const uint64_t now = 5'000'000 * kNsPerMs;
+
+  // call target API
+  EXPECT_EQ(0u, InputLatency::FromWaylandTime(4'000'000, now));
+  EXPECT_EQ(0u, InputLatency::FromWaylandTime(5'000'100, now));
+
+  InputLatency latency;
+  latency.RecordSent(0, now, now + kNsPerMs);
+  latency.OnPresent(now + 10 * kNsPerMs);
+  EXPECT_EQ(0u, latency.histogram(InputLatency::kDispatch).count());
+  EXPECT_EQ(0u, latency.histogram(InputLatency::kEndToEnd).count());
+  EXPECT_EQ(1u, latency.histogram(InputLatency::kPresent).count());
+}
@@ -0,0 +1,147 @@
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "message_buffer.h"
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenMessageBuffer_Lv1Normal001
+Use Case Name: Pooled message buffers
+Test Summary：Test a released buffer is reused by the next acquire of the
+              same size class
+***************************************************************/
+
+TEST(HomescreenMessageBuffer, Lv1Normal001) {
+  MessageBufferPool pool;
+
+  // call target API
+  auto first = pool.Acquire(100);
+  ASSERT_TRUE(first);
+  EXPECT_EQ(MessageBufferPool::kSizeClasses[0], first->capacity());
+  EXPECT_EQ(0u, first->size());
+  const auto address = first.get();
+  first = MessageBufferRef();
+
+  const auto second = pool.Acquire(200);
+  EXPECT_EQ(address, second.get());
+
+  const auto stats = pool.GetStats();
+  EXPECT_EQ(1u, stats.heap_allocations);
+  EXPECT_EQ(2u, stats.acquires);
+  EXPECT_EQ(1u, stats.in_use);
+  EXPECT_EQ(0u, stats.free);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenMessageBuffer_Lv1Normal002
+Use Case Name: Pooled message buffers
+Test Summary：Test copies share the payload and the buffer is recycled only
+              after the last reference is dropped
+***************************************************************/
+
+TEST(HomescreenMessageBuffer, Lv1Normal002) {
+  MessageBufferPool pool;
+  const char payload[] = "flutter/platform";
+
+  // call target API
+  auto buffer = pool.Copy(payload, sizeof(payload));
+  ASSERT_EQ(sizeof(payload), buffer->size());
+  EXPECT_EQ(0, std::memcmp(payload, buffer->data(), sizeof(payload)));
+
+  auto copy = buffer;
+  EXPECT_EQ(buffer.get(), copy.get());
+  buffer = MessageBufferRef();
+  EXPECT_EQ(1u, pool.GetStats().in_use);
+  EXPECT_EQ(0u, pool.GetStats().free);
+
+  copy = MessageBufferRef();
+  EXPECT_EQ(0u, pool.GetStats().in_use);
+  EXPECT_EQ(1u, pool.GetStats().free);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenMessageBuffer_Lv1Normal003
+Use Case Name: Pooled message buffers
+Test Summary：Test buffers acquired on producer threads and released on the
+              test thread are reused without heap allocations once the
+              working set has been allocated
+***************************************************************/
+
+TEST(HomescreenMessageBuffer, Lv1Normal003) {
+  constexpr int kThreads = 4;
+  constexpr int kRounds = 30;
+  constexpr size_t kClasses = 4;
+  // one refill of a thread cache per size class, the working set is exact
+  constexpr size_t kPerClass = MessageBufferPool::kThreadCacheSize / 2;
+  static_assert(kThreads * kPerClass <= MessageBufferPool::kMaxFreePerClass,
+                "the shared lists keep the whole working set");
+  auto& pool = MessageBufferPool::Instance();
+
+  // producers acquire, the test thread releases, as with the platform thread
+  const auto run = [&pool]() {
+    std::vector<std::vector<MessageBufferRef>> sent(kThreads);
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kThreads; t++) {
+      producers.emplace_back([&pool, &sent, t]() {
+        for (size_t i = 0; i < kPerClass * kClasses; i++) {
+          const auto size = MessageBufferPool::kSizeClasses[i % kClasses] - 1;
+          auto buffer = pool.Acquire(size);
+          std::memset(buffer->data(), static_cast<int>(i), size);
+          buffer->resize(size);
+          sent[static_cast<size_t>(t)].push_back(std::move(buffer));
+        }
+      });
+    }
+    for (auto& producer : producers) {
+      producer.join();
+    }
+    // this thread never acquires from the process wide pool, so it has no
+    // cache and every release goes back to the shared lists
+    for (auto& buffers : sent) {
+      buffers.clear();
+    }
+  };
+
+  // warm up
+  run();
+  const auto warm = pool.GetStats();
+
+  // call target API
+  for (int round = 0; round < kRounds; round++) {
+    run();
+  }
+  const auto stats = pool.GetStats();
+
+  EXPECT_EQ(0u, stats.in_use);
+  EXPECT_EQ(warm.acquires + kRounds * kThreads * kPerClass * kClasses,
+            stats.acquires);
+  EXPECT_EQ(warm.heap_allocations, stats.heap_allocations);
+  EXPECT_EQ(warm.heap_frees, stats.heap_frees);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenMessageBuffer_Lv1Abnormal001
+Use Case Name: Pooled message buffers
+Test Summary：Test requests above the largest size class are served from the
+              heap, counted as oversize and never kept in the pool
+***************************************************************/
+
+TEST(HomescreenMessageBuffer, Lv1Abnormal001) {
+  MessageBufferPool pool;
+  const auto size = MessageBufferPool::kSizeClasses.back() + 1;
+
+  // call target API
+  {
+    auto buffer = pool.Acquire(size);
+    EXPECT_EQ(size, buffer->capacity());
+    buffer->resize(size * 2);
+    EXPECT_EQ(size, buffer->size());
+  }
+
+  const auto stats = pool.GetStats();
+  EXPECT_EQ(1u, stats.oversize);
+  EXPECT_EQ(1u, stats.heap_allocations);
+  EXPECT_EQ(1u, stats.heap_frees);
+  EXPECT_EQ(0u, stats.free);
+}
@@ -0,0 +1,235 @@
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "asio/post.hpp"
+#include "flutter_desktop_engine_state.h"
+#include "flutter_desktop_messenger.h"
+#include "flutter_homescreen.h"
+#include "gtest/gtest.h"
+#include "libflutter_engine.h"
+#include "task_runner.h"
+
+namespace {
+
+std::mutex sent_mutex;
+std::vector<std::string> sent_channels;
+const uint8_t* sent_message = nullptr;
+FlutterEngineResult send_result = kSuccess;
+
+FlutterEngineResult StubSendPlatformMessage(
+    FLUTTER_API_SYMBOL(FlutterEngine) /* engine */,
+    const FlutterPlatformMessage* message) {
+  std::scoped_lock lock(sent_mutex);
+  sent_channels.emplace_back(message->channel);
+  sent_message = message->message;
+  return send_result;
+}
+
+struct Completion {
+  std::promise<bool> promise;
+
+  static void Callback(const bool success, void* user_data) {
+    static_cast<Completion*>(user_data)->promise.set_value(success);
+  }
+};
+
+class HomescreenMessengerSendAsync : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    exports_.SendPlatformMessage = StubSendPlatformMessage;
+    LibFlutterEngine::SetExports(&exports_);
+    sent_channels.clear();
+    send_result = kSuccess;
+
+    runner_ = std::make_unique<TaskRunner>("Test", flutter_engine_);
+    state_.flutter_engine = flutter_engine_;
+    state_.platform_task_runner = runner_.get();
+    messenger_ = FlutterDesktopMessengerAddRef(new FlutterDesktopMessenger());
+    messenger_->SetEngine(&state_);
+  }
+
+  void TearDown() override {
+    runner_.reset();
+    FlutterDesktopMessengerRelease(messenger_);
+    LibFlutterEngine::SetExports(nullptr);
+  }
+
+  // Occupy the platform thread until the returned promise is fulfilled.
+  std::shared_ptr<std::promise<void>> BlockPlatformThread() const {
+    auto release = std::make_shared<std::promise<void>>();
+    asio::post(*runner_->GetStrandContext(),
+               [future = release->get_future().share()]() { future.wait(); });
+    return release;
+  }
+
+  FlutterDesktopMessageQueueStats Stats() {
+    FlutterDesktopMessageQueueStats stats{};
+    FlutterDesktopEngineGetMessageQueueStats(&state_, &stats);
+    return stats;
+  }
+
+  LibFlutterEngineExports exports_{};
+  FlutterEngine flutter_engine_{};
+  std::unique_ptr<TaskRunner> runner_;
+  FlutterDesktopEngineState state_;
+  FlutterDesktopMessengerRef messenger_{};
+};
+
+constexpr uint8_t kMessage[] = {1, 2, 3, 4};
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenMessengerSendAsync_Lv1Normal001
+Use Case Name: Asynchronous platform message send
+Test Summary：Test an asynchronous send returns while the platform thread is
+              busy and completes once it is free
+***************************************************************/
+
+TEST_F(HomescreenMessengerSendAsync, Lv1Normal001) {
+  const auto release = BlockPlatformThread();
+  Completion completion;
+  auto done = completion.promise.get_future();
+
+  // call target API
+  EXPECT_TRUE(FlutterDesktopMessengerSendAsync(
+      messenger_, "test/channel", kMessage, sizeof(kMessage), nullptr, nullptr,
+      Completion::Callback, &completion));
+
+  // queued behind the blocked platform thread
+  EXPECT_EQ(std::future_status::timeout,
+            done.wait_for(std::chrono::milliseconds(20)));
+  EXPECT_EQ(1u, Stats().pending);
+
+  release->set_value();
+  ASSERT_EQ(std::future_status::ready,
+            done.wait_for(std::chrono::seconds(5)));
+  EXPECT_TRUE(done.get());
+
+  const auto stats = Stats();
+  EXPECT_EQ(0u, stats.pending);
+  EXPECT_EQ(1u, stats.submitted);
+  EXPECT_EQ(1u, stats.sent);
+  EXPECT_EQ(0u, stats.failed);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenMessengerSendAsync_Lv1Normal002
+Use Case Name: Asynchronous platform message send
+Test Summary：Test a batch is sent in order and counted in the queue depth
+***************************************************************/
+
+TEST_F(HomescreenMessengerSendAsync, Lv1Normal002) {
+  const auto release = BlockPlatformThread();
+  Completion completion;
+  auto done = completion.promise.get_future();
+
+  const FlutterDesktopMessengerBatchEntry entries[] = {
+      {"test/a", kMessage, sizeof(kMessage), nullptr, nullptr},
+      {"test/b", kMessage, sizeof(kMessage), nullptr, nullptr},
+      {"test/c", nullptr, 0, nullptr, nullptr},
+  };
+
+  // call target API
+  EXPECT_TRUE(FlutterDesktopMessengerSendBatchAsync(
+      messenger_, entries, 3, Completion::Callback, &completion));
+  EXPECT_TRUE(FlutterDesktopMessengerSendAsync(messenger_, "test/d", kMessage,
+                                               sizeof(kMessage), nullptr,
+                                               nullptr, nullptr, nullptr));
+  EXPECT_EQ(4u, Stats().pending);
+
+  release->set_value();
+  ASSERT_EQ(std::future_status::ready,
+            done.wait_for(std::chrono::seconds(5)));
+  EXPECT_TRUE(done.get());
+  runner_.reset();
+
+  const std::vector<std::string> expected{"test/a", "test/b", "test/c",
+                                          "test/d"};
+  EXPECT_EQ(expected, sent_channels);
+
+  const auto stats = Stats();
+  EXPECT_EQ(0u, stats.pending);
+  EXPECT_EQ(4u, stats.high_water);
+  EXPECT_EQ(4u, stats.sent);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenMessengerSendAsync_Lv1Normal003
+Use Case Name: Asynchronous platform message send
+Test Summary：Test a pooled buffer is handed to the engine without a copy and
+              returned to the pool once sent
+***************************************************************/
+
+TEST_F(HomescreenMessengerSendAsync, Lv1Normal003) {
+  Completion completion;
+  auto done = completion.promise.get_future();
+
+  const auto buffer = FlutterDesktopMessageBufferAcquire(sizeof(kMessage));
+  ASSERT_GE(FlutterDesktopMessageBufferGetCapacity(buffer), sizeof(kMessage));
+  const auto data = FlutterDesktopMessageBufferGetData(buffer);
+  std::memcpy(data, kMessage, sizeof(kMessage));
+  FlutterDesktopMessageBufferSetSize(buffer, sizeof(kMessage));
+
+  FlutterDesktopMessageBufferPoolStats before{};
+  FlutterDesktopGetMessageBufferPoolStats(&before);
+
+  // call target API
+  EXPECT_TRUE(FlutterDesktopMessengerSendBufferAsync(
+      messenger_, "test/channel", buffer, nullptr, nullptr,
+      Completion::Callback, &completion));
+
+  ASSERT_EQ(std::future_status::ready,
+            done.wait_for(std::chrono::seconds(5)));
+  EXPECT_TRUE(done.get());
+  runner_.reset();
+
+  EXPECT_EQ(data, sent_message);
+  FlutterDesktopMessageBufferPoolStats after{};
+  FlutterDesktopGetMessageBufferPoolStats(&after);
+  // the payload and the channel copy are both back in the pool
+  EXPECT_EQ(before.in_use - 1, after.in_use);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenMessengerSendAsync_Lv1Abnormal001
+Use Case Name: Asynchronous platform message send
+Test Summary：Test a message rejected by the engine is reported as failed
+***************************************************************/
+
+TEST_F(HomescreenMessengerSendAsync, Lv1Abnormal001) {
+  send_result = kInvalidArguments;
+  Completion completion;
+  auto done = completion.promise.get_future();
+
+  // call target API
+  EXPECT_TRUE(FlutterDesktopMessengerSendAsync(
+      messenger_, "test/channel", kMessage, sizeof(kMessage), nullptr, nullptr,
+      Completion::Callback, &completion));
+
+  ASSERT_EQ(std::future_status::ready,
+            done.wait_for(std::chrono::seconds(5)));
+  EXPECT_FALSE(done.get());
+  EXPECT_EQ(1u, Stats().failed);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenMessengerSendAsync_Lv1Abnormal002
+Use Case Name: Asynchronous platform message send
+Test Summary：Test nothing is queued for a messenger without an engine
+***************************************************************/
+
+TEST_F(HomescreenMessengerSendAsync, Lv1Abnormal002) {
+  messenger_->SetEngine(nullptr);
+
+  // call target API
+  EXPECT_FALSE(FlutterDesktopMessengerSendAsync(
+      messenger_, "test/channel", kMessage, sizeof(kMessage), nullptr, nullptr,
+      nullptr, nullptr));
+
+  EXPECT_EQ(0u, Stats().submitted);
+}
@@ -0,0 +1,183 @@
+#include <memory>
+#include <vector>
+
+#include <GLES2/gl2.h>
+
+#include "backend/headless/surfaceless_egl.h"
+#include "gtest/gtest.h"
+#include "platform/homescreen/pixel_buffer_texture.h"
+
+namespace {
+
+/// plugin side of a pixel buffer texture
+struct Producer {
+  std::vector<uint8_t> pixels;
+  FlutterDesktopPixelBuffer buffer{};
+  int released{};
+  bool empty{};
+  /// size the last copy was asked for
+  size_t requested_width{};
+  size_t requested_height{};
+
+  void Fill(const size_t width, const size_t height, const uint8_t value) {
+    pixels.assign(width * height * 4, value);
+    buffer = {pixels.data(), width, height,
+              [](void* context) {
+                static_cast<Producer*>(context)->released++;
+              },
+              this};
+  }
+
+  FlutterDesktopPixelBufferTextureConfig Config() {
+    return {[](const size_t width, const size_t height,
+               void* user_data) -> const FlutterDesktopPixelBuffer* {
+              const auto producer = static_cast<Producer*>(user_data);
+              producer->requested_width = width;
+              producer->requested_height = height;
+              return producer->empty ? nullptr : &producer->buffer;
+            },
+            this};
+  }
+};
+
+/// first pixel of a texture, read back through a framebuffer
+std::vector<uint8_t> ReadTexel(const GLuint texture) {
+  GLuint fbo;
+  glGenFramebuffers(1, &fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         texture, 0);
+  std::vector<uint8_t> texel(4);
+  glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, texel.data());
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDeleteFramebuffers(1, &fbo);
+  return texel;
+}
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenPixelBufferTexture_Lv1Normal001
+Use Case Name: Pixel buffer external texture
+Test Summary：Test a marked frame is uploaded at the size the engine asked
+              for and handed to the engine, and the pixel buffer is released
+              after the copy
+***************************************************************/
+
+TEST(HomescreenPixelBufferTexture, Lv1Normal001) {
+  SurfacelessEgl context(16, 16);
+  ASSERT_TRUE(context.MakeTextureCurrent());
+  Producer producer;
+  producer.Fill(32, 8, 0x7f);
+  auto texture = std::make_shared<PixelBufferTexture>(producer.Config());
+  ASSERT_TRUE(texture->Initialize());
+  FlutterOpenGLTexture out{};
+  EXPECT_FALSE(texture->Populate(32, 8, &out));
+
+  // call target API
+  ASSERT_TRUE(texture->Upload());
+  EXPECT_EQ(1, producer.released);
+  EXPECT_EQ(32u, producer.requested_width);
+  EXPECT_EQ(8u, producer.requested_height);
+  ASSERT_TRUE(texture->Populate(32, 8, &out));
+
+  EXPECT_EQ(static_cast<uint32_t>(GL_TEXTURE_2D), out.target);
+  EXPECT_EQ(static_cast<int64_t>(out.name), texture->GetId());
+  EXPECT_EQ(32u, out.width);
+  EXPECT_EQ(8u, out.height);
+  EXPECT_EQ((std::vector<uint8_t>{0x7f, 0x7f, 0x7f, 0x7f}),
+            ReadTexel(out.name));
+  out.destruction_callback(out.user_data);
+  texture->Destroy();
+  EXPECT_TRUE(context.ClearCurrent());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenPixelBufferTexture_Lv1Normal002
+Use Case Name: Pixel buffer external texture
+Test Summary：Test uploads never write a texture the engine holds or is
+              handed, and unchanged sizes reuse the texture storage
+***************************************************************/
+
+TEST(HomescreenPixelBufferTexture, Lv1Normal002) {
+  SurfacelessEgl context(16, 16);
+  ASSERT_TRUE(context.MakeTextureCurrent());
+  Producer producer;
+  auto texture = std::make_shared<PixelBufferTexture>(producer.Config());
+  ASSERT_TRUE(texture->Initialize());
+
+  // call target API
+  producer.Fill(4, 4, 1);
+  ASSERT_TRUE(texture->Upload());
+  FlutterOpenGLTexture held{};
+  ASSERT_TRUE(texture->Populate(4, 4, &held));
+
+  producer.Fill(4, 4, 2);
+  ASSERT_TRUE(texture->Upload());
+  FlutterOpenGLTexture next{};
+  ASSERT_TRUE(texture->Populate(4, 4, &next));
+  producer.Fill(4, 4, 3);
+  ASSERT_TRUE(texture->Upload());
+  EXPECT_NE(held.name, next.name);
+  EXPECT_EQ(1, ReadTexel(held.name)[0]);
+  EXPECT_EQ(2, ReadTexel(next.name)[0]);
+
+  // the latest upload and both held textures are busy
+  producer.Fill(4, 4, 4);
+  EXPECT_FALSE(texture->Upload());
+  EXPECT_EQ(1u, texture->GetStats().dropped);
+  held.destruction_callback(held.user_data);
+  ASSERT_TRUE(texture->Upload());
+  EXPECT_EQ(4, ReadTexel(held.name)[0]);
+  EXPECT_EQ(2, ReadTexel(next.name)[0]);
+  next.destruction_callback(next.user_data);
+
+  const auto stats = texture->GetStats();
+  EXPECT_EQ(4u, stats.uploads);
+  EXPECT_EQ(PixelBufferTexture::kMaxBuffers, stats.reallocations);
+  EXPECT_EQ(5, producer.released);
+  texture->Destroy();
+  EXPECT_TRUE(context.ClearCurrent());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenPixelBufferTexture_Lv1Abnormal001
+Use Case Name: Pixel buffer external texture
+Test Summary：Test no pixel buffer is no frame, and a resized buffer
+              reallocates the texture storage
+***************************************************************/
+
+TEST(HomescreenPixelBufferTexture, Lv1Abnormal001) {
+  SurfacelessEgl context(16, 16);
+  ASSERT_TRUE(context.MakeTextureCurrent());
+  Producer producer;
+  auto texture = std::make_shared<PixelBufferTexture>(producer.Config());
+  ASSERT_TRUE(texture->Initialize());
+
+  // call target API
+  producer.empty = true;
+  EXPECT_FALSE(texture->Upload());
+  producer.empty = false;
+  producer.Fill(0, 0, 0);
+  EXPECT_FALSE(texture->Upload());
+  EXPECT_EQ(0, producer.released);
+
+  producer.Fill(8, 8, 5);
+  ASSERT_TRUE(texture->Upload());
+  producer.Fill(16, 4, 6);
+  ASSERT_TRUE(texture->Upload());
+  producer.Fill(16, 4, 7);
+  ASSERT_TRUE(texture->Upload());
+  producer.Fill(16, 4, 8);
+  ASSERT_TRUE(texture->Upload());
+  FlutterOpenGLTexture out{};
+  ASSERT_TRUE(texture->Populate(16, 4, &out));
+  EXPECT_EQ(16u, out.width);
+  EXPECT_EQ(4u, out.height);
+  EXPECT_EQ(8, ReadTexel(out.name)[0]);
+  // the first texture is reallocated at the new size, the second is reused
+  EXPECT_EQ(3u, texture->GetStats().reallocations);
+  out.destruction_callback(out.user_data);
+  texture->Destroy();
+  EXPECT_TRUE(context.ClearCurrent());
+}
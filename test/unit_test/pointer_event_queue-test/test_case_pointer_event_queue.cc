@@ -0,0 +1,207 @@
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "libflutter_engine.h"
+#include "pointer_event_queue.h"
+
+namespace {
+
+std::vector<FlutterPointerEvent> sent_events;
+uint64_t current_time_ns = 0;
+
+uint64_t StubGetCurrentTime() {
+  return current_time_ns;
+}
+
+FlutterEngineResult StubSendPointerEvent(
+    FLUTTER_API_SYMBOL(FlutterEngine) /* engine */,
+    const FlutterPointerEvent* events,
+    const size_t events_count) {
+  sent_events.insert(sent_events.end(), events, events + events_count);
+  return kSuccess;
+}
+
+class HomescreenPointerEventQueue : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    exports_.GetCurrentTime = StubGetCurrentTime;
+    exports_.SendPointerEvent = StubSendPointerEvent;
+    LibFlutterEngine::SetExports(&exports_);
+    sent_events.clear();
+    current_time_ns = 1'000'000;
+  }
+
+  void TearDown() override { LibFlutterEngine::SetExports(nullptr); }
+
+  static FlutterPointerEvent Touch(const FlutterPointerPhase phase,
+                                   const double x,
+                                   const int32_t device) {
+    FlutterPointerEvent event{};
+    event.struct_size = sizeof(FlutterPointerEvent);
+    event.phase = phase;
+    event.timestamp = static_cast<size_t>(current_time_ns / 1000);
+    event.x = x;
+    event.device = device;
+    event.device_kind = kFlutterPointerDeviceKindTouch;
+    return event;
+  }
+
+  static FlutterPointerEvent Mouse(const FlutterPointerPhase phase,
+                                   const double x,
+                                   const int64_t buttons) {
+    FlutterPointerEvent event = Touch(phase, x, 0);
+    event.device_kind = kFlutterPointerDeviceKindMouse;
+    event.buttons = buttons;
+    return event;
+  }
+
+  LibFlutterEngineExports exports_{};
+  FLUTTER_API_SYMBOL(FlutterEngine)
+  engine_ = reinterpret_cast<FLUTTER_API_SYMBOL(FlutterEngine)>(1);
+};
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenPointerEventQueue_Lv1Normal001
+Use Case Name: Pointer event coalescing
+Test Summary：Test moves of several fingers collapse to the latest sample of
+              each finger
+***************************************************************/
+
+TEST_F(HomescreenPointerEventQueue, Lv1Normal001) {
+  PointerEventQueue queue;
+  for (int i = 0; i < 5; i++) {
+    queue.Push(Touch(kMove, i, 0));
+    queue.Push(Touch(kMove, 100 + i, 1));
+  }
+
+  // call target API
+  EXPECT_EQ(2u, queue.Flush(engine_));
+
+  ASSERT_EQ(2u, sent_events.size());
+  EXPECT_EQ(0, sent_events[0].device);
+  EXPECT_EQ(4, sent_events[0].x);
+  EXPECT_EQ(1, sent_events[1].device);
+  EXPECT_EQ(104, sent_events[1].x);
+
+  const auto stats = queue.TakeStats();
+  EXPECT_EQ(10u, stats.pushed);
+  EXPECT_EQ(2u, stats.sent);
+  EXPECT_EQ(8u, stats.coalesced);
+  EXPECT_EQ(1u, stats.flushes);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenPointerEventQueue_Lv1Normal002
+Use Case Name: Pointer event coalescing
+Test Summary：Test moves are not merged across down/up, so the order of
+              contacts is preserved
+***************************************************************/
+
+TEST_F(HomescreenPointerEventQueue, Lv1Normal002) {
+  PointerEventQueue queue;
+  queue.Push(Touch(kDown, 0, 0));
+  queue.Push(Touch(kMove, 1, 0));
+  queue.Push(Touch(kMove, 2, 0));
+  queue.Push(Touch(kUp, 2, 0));
+  queue.Push(Touch(kDown, 10, 0));
+  queue.Push(Touch(kMove, 11, 0));
+  queue.Push(Touch(kDown, 20, 1));
+  queue.Push(Touch(kMove, 12, 0));
+
+  // call target API
+  queue.Flush(engine_);
+
+  const std::vector<std::pair<FlutterPointerPhase, double>> expected{
+      {kDown, 0}, {kMove, 2},  {kUp, 2},   {kDown, 10},
+      {kMove, 11}, {kDown, 20}, {kMove, 12},
+  };
+  ASSERT_EQ(expected.size(), sent_events.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(expected[i].first, sent_events[i].phase) << i;
+    EXPECT_EQ(expected[i].second, sent_events[i].x) << i;
+  }
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenPointerEventQueue_Lv1Normal003
+Use Case Name: Pointer event coalescing
+Test Summary：Test hover, drag with a different button and scroll samples of
+              one mouse are kept apart, and latency is measured to the flush
+***************************************************************/
+
+TEST_F(HomescreenPointerEventQueue, Lv1Normal003) {
+  PointerEventQueue queue;
+  queue.Push(Mouse(kHover, 0, 0));
+  queue.Push(Mouse(kHover, 1, 0));
+  queue.Push(Mouse(kMove, 2, kFlutterPointerButtonMousePrimary));
+  queue.Push(Mouse(kMove, 3, kFlutterPointerButtonMouseSecondary));
+  auto scroll = Mouse(kHover, 3, 0);
+  scroll.signal_kind = kFlutterPointerSignalKindScroll;
+  queue.Push(scroll);
+  queue.Push(scroll);
+
+  // call target API
+  current_time_ns += 4'000'000;
+  queue.Flush(engine_);
+
+  ASSERT_EQ(5u, sent_events.size());
+  EXPECT_EQ(1, sent_events[0].x);
+  EXPECT_EQ(kFlutterPointerButtonMousePrimary, sent_events[1].buttons);
+  EXPECT_EQ(kFlutterPointerButtonMouseSecondary, sent_events[2].buttons);
+  EXPECT_EQ(kFlutterPointerSignalKindScroll, sent_events[3].signal_kind);
+  EXPECT_EQ(kFlutterPointerSignalKindScroll, sent_events[4].signal_kind);
+
+  const auto stats = queue.TakeStats();
+  EXPECT_EQ(4000u, stats.latency_max_us);
+  EXPECT_EQ(6u * 4000u, stats.latency_total_us);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenPointerEventQueue_Lv1Normal004
+Use Case Name: Pointer event coalescing
+Test Summary：Test a touch frame pushed as a group is sent in one flush, or
+              dropped as a whole when it does not fit
+***************************************************************/
+
+TEST_F(HomescreenPointerEventQueue, Lv1Normal004) {
+  PointerEventQueue queue;
+  std::vector<FlutterPointerEvent> group;
+  for (int32_t device = 0; device < 5; device++) {
+    group.push_back(Touch(kMove, device, device));
+  }
+
+  // call target API
+  EXPECT_TRUE(queue.Push(group.data(), group.size()));
+  EXPECT_EQ(5u, queue.Flush(engine_));
+
+  for (int i = 0; i < kMaxPointerEvent - 2; i++) {
+    queue.Push(Touch(kDown, i, i));
+  }
+  EXPECT_FALSE(queue.Push(group.data(), group.size()));
+  EXPECT_EQ(5u, queue.TakeStats().dropped);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenPointerEventQueue_Lv1Abnormal001
+Use Case Name: Pointer event coalescing
+Test Summary：Test a full ring drops and counts new events, and events are kept
+              until an engine is available
+***************************************************************/
+
+TEST_F(HomescreenPointerEventQueue, Lv1Abnormal001) {
+  PointerEventQueue queue;
+  for (int i = 0; i < kMaxPointerEvent; i++) {
+    ASSERT_TRUE(queue.Push(Touch(kDown, i, i)));
+  }
+
+  // call target API
+  EXPECT_FALSE(queue.Push(Touch(kUp, 0, 0)));
+  EXPECT_EQ(0u, queue.Flush(nullptr));
+  EXPECT_TRUE(sent_events.empty());
+
+  EXPECT_EQ(static_cast<size_t>(kMaxPointerEvent), queue.Flush(engine_));
+  EXPECT_TRUE(queue.Push(Touch(kUp, 0, 0)));
+  EXPECT_EQ(1u, queue.TakeStats().dropped);
+}
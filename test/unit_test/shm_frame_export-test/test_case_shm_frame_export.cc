@@ -0,0 +1,194 @@
+#include <cstring>
+#include <string>
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "backend/shm_frame_export.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string SocketPath() {
+  return ::testing::TempDir() + "shm_frame_export" + std::to_string(getpid());
+}
+
+int Connect(const std::string& path) {
+  const auto fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/// receives one message and the fd passed with it, if any
+bool Receive(const int fd, shm_frame::Message* message, int* pass_fd) {
+  pollfd pfd{fd, POLLIN, 0};
+  if (poll(&pfd, 1, 5000) != 1) {
+    return false;
+  }
+  iovec iov{message, sizeof(*message)};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  if (recvmsg(fd, &msg, MSG_CMSG_CLOEXEC) != sizeof(*message)) {
+    return false;
+  }
+  const auto cmsg = CMSG_FIRSTHDR(&msg);
+  if (pass_fd && cmsg && cmsg->cmsg_type == SCM_RIGHTS) {
+    std::memcpy(pass_fd, CMSG_DATA(cmsg), sizeof(int));
+  }
+  return true;
+}
+
+/// receives a kPool message and maps the pool
+shm_frame::Header* MapPool(const int fd, size_t* size) {
+  shm_frame::Message message{};
+  int pool_fd = -1;
+  if (!Receive(fd, &message, &pool_fd) || message.type != shm_frame::kPool ||
+      pool_fd < 0) {
+    return nullptr;
+  }
+  *size = message.value;
+  const auto mapped =
+      mmap(nullptr, *size, PROT_READ | PROT_WRITE, MAP_SHARED, pool_fd, 0);
+  close(pool_fd);
+  return mapped == MAP_FAILED ? nullptr
+                              : static_cast<shm_frame::Header*>(mapped);
+}
+
+void Publish(ShmFrameExport& frame_export,
+             const uint8_t value,
+             const uint32_t width = 4,
+             const uint32_t height = 2) {
+  const auto pixels = frame_export.BeginFrame(width, height);
+  ASSERT_NE(nullptr, pixels);
+  std::memset(pixels, value, size_t{width} * height * 4);
+  frame_export.EndFrame(1000u * value);
+}
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenShmFrameExport_Lv1Normal001
+Use Case Name: Headless shared memory frame export
+Test Summary：Test a consumer receives the pool fd and a notification, and
+              reads the frame in place under the seqlock
+***************************************************************/
+
+TEST(HomescreenShmFrameExport, Lv1Normal001) {
+  const auto path = SocketPath();
+  ShmFrameExport frame_export(path);
+  ASSERT_TRUE(frame_export.IsValid());
+  Publish(frame_export, 1);
+
+  // call target API
+  const auto consumer = Connect(path);
+  ASSERT_GE(consumer, 0);
+  size_t size;
+  const auto header = MapPool(consumer, &size);
+  ASSERT_NE(nullptr, header);
+  EXPECT_EQ(shm_frame::kMagic, header->magic);
+  EXPECT_EQ(shm_frame::kBuffers, header->buffer_count);
+
+  shm_frame::Message message{};
+  ASSERT_TRUE(Receive(consumer, &message, nullptr));
+  EXPECT_EQ(shm_frame::kFrame, message.type);
+  EXPECT_EQ(1u, message.value);
+
+  Publish(frame_export, 2);
+  ASSERT_TRUE(Receive(consumer, &message, nullptr));
+  EXPECT_EQ(2u, message.value);
+  ASSERT_EQ(message.buffer, header->latest.load());
+
+  auto& buffer = header->buffers[message.buffer];
+  const auto s1 = buffer.seq.load(std::memory_order_acquire);
+  EXPECT_EQ(0u, s1 % 2);
+  EXPECT_EQ(4u, buffer.width.load());
+  EXPECT_EQ(2u, buffer.height.load());
+  EXPECT_EQ(16u, buffer.stride.load());
+  EXPECT_EQ(2000u, buffer.timestamp_ns.load());
+  EXPECT_EQ(2, shm_frame::BufferPixels(header, message.buffer)[31]);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  EXPECT_EQ(s1, buffer.seq.load(std::memory_order_relaxed));
+
+  munmap(header, size);
+  close(consumer);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenShmFrameExport_Lv1Normal002
+Use Case Name: Headless shared memory frame export
+Test Summary：Test frames outgrowing the pool move to a new pool, retiring
+              the old one
+***************************************************************/
+
+TEST(HomescreenShmFrameExport, Lv1Normal002) {
+  const auto path = SocketPath();
+  ShmFrameExport frame_export(path);
+  Publish(frame_export, 1);
+  const auto consumer = Connect(path);
+  size_t size;
+  const auto first = MapPool(consumer, &size);
+  ASSERT_NE(nullptr, first);
+  shm_frame::Message message{};
+  ASSERT_TRUE(Receive(consumer, &message, nullptr));
+
+  // call target API
+  Publish(frame_export, 2, 1920, 720);
+
+  size_t second_size;
+  const auto second = MapPool(consumer, &second_size);
+  ASSERT_NE(nullptr, second);
+  EXPECT_EQ(1u, first->retired.load());
+  EXPECT_EQ(0u, second->retired.load());
+  EXPECT_GE(second->buffer_capacity, 1920u * 720 * 4);
+  ASSERT_TRUE(Receive(consumer, &message, nullptr));
+  EXPECT_EQ(2u, message.value);
+  EXPECT_EQ(1920u, second->buffers[message.buffer].width.load());
+
+  munmap(first, size);
+  munmap(second, second_size);
+  close(consumer);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenShmFrameExport_Lv1Abnormal001
+Use Case Name: Headless shared memory frame export
+Test Summary：Test a consumer that never reads does not hold up publishing
+              and still finds the latest frame in the pool
+***************************************************************/
+
+TEST(HomescreenShmFrameExport, Lv1Abnormal001) {
+  const auto path = SocketPath();
+  ShmFrameExport frame_export(path);
+  Publish(frame_export, 1);
+  const auto consumer = Connect(path);
+  size_t size;
+  const auto header = MapPool(consumer, &size);
+  ASSERT_NE(nullptr, header);
+
+  // call target API
+  for (int i = 0; i < 20000; i++) {
+    Publish(frame_export, static_cast<uint8_t>(i));
+  }
+  EXPECT_EQ(20001u, frame_export.GetStats().published);
+
+  const auto& buffer = header->buffers[header->latest.load()];
+  EXPECT_EQ(20001u, buffer.sequence.load());
+  EXPECT_EQ(static_cast<uint8_t>(19999),
+            shm_frame::BufferPixels(header, header->latest.load())[0]);
+
+  munmap(header, size);
+  close(consumer);
+}
@@ -0,0 +1,126 @@
+#include <cstring>
+#include <vector>
+
+#include "backend/wayland_software/shm_rows.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr uint32_t kWidth = 7;
+constexpr uint32_t kHeight = 10;
+constexpr size_t kStride = kWidth * ShmRows::kBytesPerPixel;
+
+std::vector<uint8_t> Frame(const uint8_t value) {
+  return std::vector<uint8_t>(kStride * kHeight, value);
+}
+
+void SetPixel(std::vector<uint8_t>& frame,
+              const uint32_t x,
+              const uint32_t y,
+              const uint8_t b,
+              const uint8_t g,
+              const uint8_t r,
+              const uint8_t a) {
+  const auto p = &frame[y * kStride + x * ShmRows::kBytesPerPixel];
+  p[0] = b;
+  p[1] = g;
+  p[2] = r;
+  p[3] = a;
+}
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenShmRows_Lv1Normal001
+Use Case Name: Software backend row damage
+Test Summary：Test changed rows are found as bands and the shadow is brought
+              up to date
+***************************************************************/
+
+TEST(HomescreenShmRows, Lv1Normal001) {
+  auto frame = Frame(0);
+  auto shadow = Frame(0);
+  SetPixel(frame, 0, 1, 1, 1, 1, 1);
+  SetPixel(frame, 6, 2, 1, 1, 1, 1);
+  SetPixel(frame, 3, 9, 1, 1, 1, 1);
+
+  // call target API
+  DamageRegion damage;
+  ShmRows::Diff(frame.data(), shadow.data(), kStride, kWidth, kHeight,
+                &damage);
+
+  ASSERT_EQ(2u, damage.size());
+  EXPECT_EQ(kWidth * 3.0, damage.Area());
+  for (size_t i = 0; i < damage.size(); i++) {
+    EXPECT_EQ(0, damage[i].left);
+    EXPECT_EQ(kWidth, damage[i].right);
+    EXPECT_TRUE((damage[i].top == 1 && damage[i].bottom == 3) ||
+                (damage[i].top == 9 && damage[i].bottom == 10));
+  }
+  EXPECT_EQ(frame, shadow);
+
+  ShmRows::Diff(frame.data(), shadow.data(), kStride, kWidth, kHeight,
+                &damage);
+  EXPECT_TRUE(damage.empty());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenShmRows_Lv1Normal002
+Use Case Name: Software backend row damage
+Test Summary：Test only the damaged rows are copied, with and without the red
+              and blue swap
+***************************************************************/
+
+TEST(HomescreenShmRows, Lv1Normal002) {
+  auto frame = Frame(0);
+  for (uint32_t y = 0; y < kHeight; y++) {
+    for (uint32_t x = 0; x < kWidth; x++) {
+      SetPixel(frame, x, y, 10, 20, 30, 40);
+    }
+  }
+  DamageRegion damage;
+  damage.Add(FlutterRect{0, 2, kWidth, 4});
+
+  // call target API
+  auto copy = Frame(0xee);
+  ShmRows::Copy(frame.data(), kStride, copy.data(), kStride, kWidth, kHeight,
+                damage, ShmRows::kCopy);
+  auto swapped = Frame(0xee);
+  ShmRows::Copy(frame.data(), kStride, swapped.data(), kStride, kWidth,
+                kHeight, damage, ShmRows::kSwapRedBlue);
+
+  for (uint32_t y = 0; y < kHeight; y++) {
+    const bool damaged = y == 2 || y == 3;
+    const auto row = y * kStride;
+    EXPECT_EQ(damaged,
+              std::memcmp(&copy[row], &frame[row], kStride) == 0);
+    // the last pixel of an odd width row is converted too
+    const auto last = row + (kWidth - 1) * ShmRows::kBytesPerPixel;
+    EXPECT_EQ(damaged ? 30 : 0xee, swapped[last]);
+    EXPECT_EQ(damaged ? 20 : 0xee, swapped[last + 1]);
+    EXPECT_EQ(damaged ? 10 : 0xee, swapped[last + 2]);
+    EXPECT_EQ(damaged ? 40 : 0xee, swapped[last + 3]);
+  }
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenShmRows_Lv1Abnormal001
+Use Case Name: Software backend row damage
+Test Summary：Test damage reaching past the frame is clipped to its rows
+***************************************************************/
+
+TEST(HomescreenShmRows, Lv1Abnormal001) {
+  const auto frame = Frame(1);
+  DamageRegion damage;
+  damage.Add(FlutterRect{0, -5, kWidth, 2});
+  damage.Add(FlutterRect{0, 8, kWidth, 12});
+
+  // call target API
+  auto copy = Frame(0);
+  ShmRows::Copy(frame.data(), kStride, copy.data(), kStride, kWidth, kHeight,
+                damage, ShmRows::kSwapRedBlue);
+
+  for (uint32_t y = 0; y < kHeight; y++) {
+    EXPECT_EQ(y < 2 || y >= 8 ? 1 : 0, copy[y * kStride]);
+  }
+}
@@ -0,0 +1,217 @@
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "backend/headless/software_compositor.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr uint32_t kWidth = 8;
+constexpr uint32_t kHeight = 6;
+constexpr size_t kStride = kWidth * SoftwareCompositor::kBytesPerPixel;
+
+/// software backing store layer, premultiplied RGBA top row first
+struct TestLayer {
+  std::vector<uint8_t> pixels;
+  FlutterBackingStore store{};
+  std::vector<FlutterRect> paint_rects;
+  FlutterRegion paint_region{};
+  FlutterBackingStorePresentInfo info{};
+  FlutterLayer layer{};
+
+  TestLayer(const uint32_t width,
+            const uint32_t height,
+            const uint32_t rgba,
+            const double x = 0,
+            const double y = 0)
+      : pixels(size_t{width} * height * SoftwareCompositor::kBytesPerPixel) {
+    Fill(rgba);
+    store.struct_size = sizeof(FlutterBackingStore);
+    store.type = kFlutterBackingStoreTypeSoftware2;
+    store.did_update = true;
+    store.software2.struct_size = sizeof(FlutterSoftwareBackingStore2);
+    store.software2.allocation = pixels.data();
+    store.software2.row_bytes = size_t{width} * 4;
+    store.software2.height = height;
+    store.software2.pixel_format = kFlutterSoftwarePixelFormatRGBA8888;
+    layer.struct_size = sizeof(FlutterLayer);
+    layer.type = kFlutterLayerContentTypeBackingStore;
+    layer.backing_store = &store;
+    layer.offset = {x, y};
+    layer.size = {static_cast<double>(width), static_cast<double>(height)};
+  }
+
+  void Fill(const uint32_t rgba) {
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+      pixels[i] = static_cast<uint8_t>(rgba >> 24);
+      pixels[i + 1] = static_cast<uint8_t>(rgba >> 16);
+      pixels[i + 2] = static_cast<uint8_t>(rgba >> 8);
+      pixels[i + 3] = static_cast<uint8_t>(rgba);
+    }
+  }
+
+  void SetPaintRect(const FlutterRect& rect) { SetPaintRects({rect}); }
+
+  void SetPaintRects(std::vector<FlutterRect> rects) {
+    paint_rects = std::move(rects);
+    paint_region = {sizeof(FlutterRegion), paint_rects.size(),
+                    paint_rects.data()};
+    info = {sizeof(FlutterBackingStorePresentInfo), &paint_region};
+    layer.backing_store_present_info = &info;
+  }
+};
+
+/// pixel of the composed frame, y counted from the top
+uint32_t Pixel(const SoftwareCompositor& compositor,
+               const uint32_t x,
+               const uint32_t y) {
+  const auto p = compositor.GetFrame() + (kHeight - 1 - y) * kStride +
+                 x * SoftwareCompositor::kBytesPerPixel;
+  return uint32_t{p[0]} << 24 | uint32_t{p[1]} << 16 | uint32_t{p[2]} << 8 |
+         p[3];
+}
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenSoftwareCompositor_Lv1Normal001
+Use Case Name: Headless layer composition
+Test Summary：Test layers are blended source over in order into a frame
+              stored bottom row first, the first frame in full
+***************************************************************/
+
+TEST(HomescreenSoftwareCompositor, Lv1Normal001) {
+  SoftwareCompositor compositor;
+  compositor.Resize(kWidth, kHeight);
+  TestLayer bottom(kWidth, kHeight, 0x204060ff);
+  TestLayer top(2, 2, 0x40000080, 3, 1);
+  std::vector<const FlutterLayer*> layers{&bottom.layer, &top.layer};
+
+  // call target API
+  const auto& damage = compositor.Composite(layers.data(), layers.size());
+
+  EXPECT_EQ(kWidth * kHeight * 1.0, damage.Area());
+  EXPECT_EQ(0x204060ffu, Pixel(compositor, 0, 0));
+  EXPECT_EQ(0x204060ffu, Pixel(compositor, 5, 1));
+  // 0x40 + 0x20 * 127 / 255, 0x40 * 127 / 255, ...
+  EXPECT_EQ(0x502030ffu, Pixel(compositor, 3, 1));
+  EXPECT_EQ(Pixel(compositor, 3, 1), Pixel(compositor, 4, 2));
+  EXPECT_EQ(0x204060ffu, Pixel(compositor, 4, 3));
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenSoftwareCompositor_Lv1Normal002
+Use Case Name: Headless layer composition
+Test Summary：Test only layers the engine updated or moved are composed
+              again, within their paint regions
+***************************************************************/
+
+TEST(HomescreenSoftwareCompositor, Lv1Normal002) {
+  SoftwareCompositor compositor;
+  compositor.Resize(kWidth, kHeight);
+  TestLayer bottom(kWidth, kHeight, 0x000000ff);
+  TestLayer top(kWidth, kHeight, 0);
+  top.SetPaintRect({1, 1, 3, 2});
+  std::vector<const FlutterLayer*> layers{&bottom.layer, &top.layer};
+  compositor.Composite(layers.data(), layers.size());
+
+  // call target API
+  bottom.store.did_update = false;
+  top.store.did_update = false;
+  EXPECT_TRUE(compositor.Composite(layers.data(), layers.size()).empty());
+
+  top.Fill(0xff0000ff);
+  top.store.did_update = true;
+  const auto& damage = compositor.Composite(layers.data(), layers.size());
+  ASSERT_EQ(1u, damage.size());
+  EXPECT_EQ(1, damage[0].left);
+  EXPECT_EQ(1, damage[0].top);
+  EXPECT_EQ(3, damage[0].right);
+  EXPECT_EQ(2, damage[0].bottom);
+  EXPECT_EQ(0xff0000ffu, Pixel(compositor, 2, 1));
+  // painted since, but outside the damage
+  EXPECT_EQ(0x000000ffu, Pixel(compositor, 3, 1));
+
+  top.store.did_update = false;
+  top.layer.offset = {0, 2};
+  const auto& moved = compositor.Composite(layers.data(), layers.size());
+  EXPECT_EQ(4.0, moved.Area());
+  EXPECT_EQ(0x000000ffu, Pixel(compositor, 2, 1));
+  EXPECT_EQ(0xff0000ffu, Pixel(compositor, 2, 3));
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenSoftwareCompositor_Lv1Normal003
+Use Case Name: Headless layer composition
+Test Summary：Test a paint region of more rectangles than the damage region
+              holds blends each pixel once
+***************************************************************/
+
+TEST(HomescreenSoftwareCompositor, Lv1Normal003) {
+  SoftwareCompositor compositor;
+  compositor.Resize(kWidth, kHeight);
+  TestLayer bottom(kWidth, kHeight, 0);
+  TestLayer top(kWidth, kHeight, 0x80404040);
+  // 11 disjoint pixels, every other column of rows 0, 2 and 4
+  std::vector<FlutterRect> rects;
+  for (uint32_t i = 0; i < 11; i++) {
+    const double x = (i % 4) * 2;
+    const double y = (i / 4) * 2;
+    rects.push_back({x, y, x + 1, y + 1});
+  }
+  top.SetPaintRects(rects);
+  std::vector<const FlutterLayer*> layers{&bottom.layer, &top.layer};
+
+  // call target API
+  compositor.Composite(layers.data(), layers.size());
+
+  for (const auto& rect : rects) {
+    const auto x = static_cast<uint32_t>(rect.left);
+    const auto y = static_cast<uint32_t>(rect.top);
+    EXPECT_EQ(0x80404040u, Pixel(compositor, x, y));
+    EXPECT_EQ(0u, Pixel(compositor, x + 1, y));
+  }
+  EXPECT_EQ(0u, Pixel(compositor, 6, 4));
+  EXPECT_EQ(0u, Pixel(compositor, 0, 1));
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenSoftwareCompositor_Lv1Abnormal001
+Use Case Name: Headless layer composition
+Test Summary：Test layers past the frame are clipped, platform views are
+              skipped and a removed layer damages where it was
+***************************************************************/
+
+TEST(HomescreenSoftwareCompositor, Lv1Abnormal001) {
+  SoftwareCompositor compositor;
+  compositor.Resize(kWidth, kHeight);
+  TestLayer bottom(kWidth, kHeight, 0x000000ff);
+  TestLayer edge(4, 4, 0x00ff00ff, -2, kHeight - 2);
+  FlutterPlatformView view{sizeof(FlutterPlatformView), 1, 0, nullptr};
+  FlutterLayer platform_view{};
+  platform_view.struct_size = sizeof(FlutterLayer);
+  platform_view.type = kFlutterLayerContentTypePlatformView;
+  platform_view.platform_view = &view;
+  platform_view.size = {kWidth, kHeight};
+  std::vector<const FlutterLayer*> layers{&bottom.layer, &platform_view,
+                                          &edge.layer};
+
+  // call target API
+  compositor.Composite(layers.data(), layers.size());
+  EXPECT_EQ(0x00ff00ffu, Pixel(compositor, 0, kHeight - 1));
+  EXPECT_EQ(0x00ff00ffu, Pixel(compositor, 1, kHeight - 2));
+  EXPECT_EQ(0x000000ffu, Pixel(compositor, 2, kHeight - 1));
+
+  bottom.store.did_update = false;
+  layers.pop_back();
+  const auto& damage = compositor.Composite(layers.data(), layers.size());
+  ASSERT_EQ(1u, damage.size());
+  EXPECT_EQ(-2, damage[0].left);
+  EXPECT_EQ(0x000000ffu, Pixel(compositor, 0, kHeight - 1));
+
+  const uint8_t src[8] = {0, 0, 0, 0, 10, 20, 30, 255};
+  uint8_t dst[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  SoftwareCompositor::BlendRow(src, dst, 2);
+  EXPECT_EQ(0, std::memcmp(dst, "\x01\x02\x03\x04\x0a\x14\x1e\xff", 8));
+}
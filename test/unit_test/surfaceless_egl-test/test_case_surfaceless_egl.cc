@@ -0,0 +1,113 @@
+#include <vector>
+
+#include <GLES2/gl2.h>
+
+#include "backend/headless/surfaceless_egl.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+const uint8_t* Pixel(const std::vector<uint8_t>& pixels,
+                     const size_t x,
+                     const size_t y,
+                     const size_t width) {
+  return pixels.data() + (y * width + x) * 4;
+}
+
+void ExpectPixel(const uint8_t* pixel,
+                 const uint8_t r,
+                 const uint8_t g,
+                 const uint8_t b) {
+  EXPECT_EQ(r, pixel[0]);
+  EXPECT_EQ(g, pixel[1]);
+  EXPECT_EQ(b, pixel[2]);
+  EXPECT_EQ(255, pixel[3]);
+}
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenSurfacelessEgl_Lv1Normal001
+Use Case Name: Headless rendering
+Test Summary：Test a rendered frame is read back as RGBA with the bottom row
+              first, as the OSMesa buffer was
+***************************************************************/
+
+TEST(HomescreenSurfacelessEgl, Lv1Normal001) {
+  constexpr int32_t kWidth = 64;
+  constexpr int32_t kHeight = 32;
+  SurfacelessEgl context(kWidth, kHeight);
+  ASSERT_TRUE(context.MakeCurrent());
+
+  glClearColor(1, 0, 0, 1);
+  glClear(GL_COLOR_BUFFER_BIT);
+  // top half green
+  glEnable(GL_SCISSOR_TEST);
+  glScissor(0, kHeight / 2, kWidth, kHeight / 2);
+  glClearColor(0, 1, 0, 1);
+  glClear(GL_COLOR_BUFFER_BIT);
+  glDisable(GL_SCISSOR_TEST);
+
+  // call target API
+  std::vector<uint8_t> pixels(kWidth * kHeight * 4);
+  EXPECT_TRUE(context.ReadPixels(pixels.data()));
+
+  ExpectPixel(Pixel(pixels, 0, 0, kWidth), 255, 0, 0);
+  ExpectPixel(Pixel(pixels, kWidth - 1, kHeight - 1, kWidth), 0, 255, 0);
+  EXPECT_TRUE(context.ClearCurrent());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenSurfacelessEgl_Lv1Normal002
+Use Case Name: Headless rendering
+Test Summary：Test the pbuffer follows a resize
+***************************************************************/
+
+TEST(HomescreenSurfacelessEgl, Lv1Normal002) {
+  SurfacelessEgl context(16, 16);
+
+  // call target API
+  context.ResizeBuffer(128, 40);
+
+  ASSERT_TRUE(context.MakeCurrent());
+  EGLint width, height;
+  eglQuerySurface(eglGetCurrentDisplay(), eglGetCurrentSurface(EGL_DRAW),
+                  EGL_WIDTH, &width);
+  eglQuerySurface(eglGetCurrentDisplay(), eglGetCurrentSurface(EGL_DRAW),
+                  EGL_HEIGHT, &height);
+  EXPECT_EQ(128, width);
+  EXPECT_EQ(40, height);
+
+  glClearColor(0, 0, 1, 1);
+  glClear(GL_COLOR_BUFFER_BIT);
+  std::vector<uint8_t> pixels(128 * 40 * 4);
+  EXPECT_TRUE(context.ReadPixels(pixels.data()));
+  ExpectPixel(Pixel(pixels, 127, 39, 128), 0, 0, 255);
+  EXPECT_TRUE(context.ClearCurrent());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenSurfacelessEgl_Lv1Abnormal001
+Use Case Name: Headless rendering
+Test Summary：Test destroying one view's context leaves another view on the
+              shared display current and rendering
+***************************************************************/
+
+TEST(HomescreenSurfacelessEgl, Lv1Abnormal001) {
+  SurfacelessEgl first(16, 16);
+  ASSERT_TRUE(first.MakeCurrent());
+  const auto context = eglGetCurrentContext();
+
+  // call target API
+  { SurfacelessEgl second(8, 8); }
+
+  EXPECT_EQ(context, eglGetCurrentContext());
+  glClearColor(0, 1, 0, 1);
+  glClear(GL_COLOR_BUFFER_BIT);
+  std::vector<uint8_t> pixels(16 * 16 * 4);
+  EXPECT_TRUE(first.ReadPixels(pixels.data()));
+  ExpectPixel(Pixel(pixels, 0, 0, 16), 0, 255, 0);
+  EXPECT_TRUE(first.ClearCurrent());
+  EXPECT_TRUE(first.MakeCurrent());
+  EXPECT_TRUE(first.ClearCurrent());
+}
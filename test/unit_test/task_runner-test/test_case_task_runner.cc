@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include <time.h>
+
+#include "gtest/gtest.h"
+#include "libflutter_engine.h"
+#include "task_runner.h"
+
+namespace {
+
+constexpr int kJitterSamples = 100;
+constexpr uint64_t kNsPerMs = 1'000'000;
+
+std::mutex lateness_mutex;
+std::vector<double> lateness_us;
+std::vector<uint64_t> target_times;
+/// targets of the tasks in the order they ran
+std::vector<uint64_t> run_targets;
+std::atomic<int> tasks_run{0};
+
+// Counting allocator; only allocations made while enabled are counted.
+std::atomic<bool> count_allocations{false};
+std::atomic<int> allocations{0};
+
+uint64_t StubGetCurrentTime() {
+  timespec ts{};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ull +
+         static_cast<uint64_t>(ts.tv_nsec);
+}
+
+FlutterEngineResult StubRunTask(FLUTTER_API_SYMBOL(FlutterEngine) /* engine */,
+                                const FlutterTask* task) {
+  const auto now = StubGetCurrentTime();
+  {
+    std::scoped_lock lock(lateness_mutex);
+    const auto target = target_times[task->task];
+    lateness_us.push_back(static_cast<double>(now - target) / 1000.0);
+    run_targets.push_back(target);
+  }
+  tasks_run++;
+  return kSuccess;
+}
+
+FlutterEngineResult StubRunTaskCount(
+    FLUTTER_API_SYMBOL(FlutterEngine) /* engine */,
+    const FlutterTask* /* task */) {
+  tasks_run++;
+  return kSuccess;
+}
+
+class HomescreenTaskRunnerDeadline : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    exports_.GetCurrentTime = StubGetCurrentTime;
+    exports_.RunTask = StubRunTask;
+    LibFlutterEngine::SetExports(&exports_);
+
+    lateness_us.clear();
+    run_targets.clear();
+    target_times.assign(kJitterSamples, 0);
+    tasks_run = 0;
+  }
+
+  void TearDown() override { LibFlutterEngine::SetExports(nullptr); }
+
+  // Queue delayed tasks 1..20 ms out; the runner is idle afterwards.
+  static void QueueDelayedTasks(TaskRunner& runner) {
+    for (int i = 0; i < kJitterSamples; i++) {
+      const auto delay = (1 + (i * 7) % 20) * kNsPerMs;
+      const auto target = StubGetCurrentTime() + delay;
+      {
+        std::scoped_lock lock(lateness_mutex);
+        target_times[static_cast<size_t>(i)] = target;
+      }
+      runner.QueueFlutterTask(0, target,
+                              FlutterTask{nullptr, static_cast<uint64_t>(i)},
+                              nullptr);
+    }
+  }
+
+  static bool WaitForTasks() {
+    for (int i = 0; i < 500 && tasks_run < kJitterSamples; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return tasks_run == kJitterSamples;
+  }
+
+  LibFlutterEngineExports exports_{};
+  FlutterEngine engine_{};
+};
+
+}  // namespace
+
+__attribute__((noinline)) void* operator new(const size_t size) {
+  if (count_allocations) {
+    allocations++;
+  }
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p,
+                                              size_t /* size */) noexcept {
+  std::free(p);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTaskRunnerDeadline_Lv1Normal001
+Use Case Name: Delayed task scheduling
+Test Summary：Test delayed tasks run on an idle runner without other traffic
+***************************************************************/
+
+TEST_F(HomescreenTaskRunnerDeadline, Lv1Normal001) {
+  TaskRunner runner("Test", engine_);
+
+  // call target API
+  const auto target = StubGetCurrentTime() + 5 * kNsPerMs;
+  target_times[0] = target;
+  runner.QueueFlutterTask(0, target, FlutterTask{nullptr, 0}, nullptr);
+
+  for (int i = 0; i < 100 && tasks_run == 0; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+
+  // nothing else was posted, so only the deadline timer could have run it
+  ASSERT_EQ(1, tasks_run);
+  EXPECT_GE(lateness_us[0], 0.0);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTaskRunnerDeadline_Lv1Normal002
+Use Case Name: Delayed task scheduling
+Test Summary：Test delayed tasks run in deadline order and never early
+***************************************************************/
+
+TEST_F(HomescreenTaskRunnerDeadline, Lv1Normal002) {
+  std::vector<double> lateness;
+  std::vector<uint64_t> targets;
+  {
+    TaskRunner runner("Test", engine_);
+
+    // call target API
+    QueueDelayedTasks(runner);
+    EXPECT_TRUE(WaitForTasks());
+
+    std::scoped_lock lock(lateness_mutex);
+    lateness.swap(lateness_us);
+    targets.swap(run_targets);
+  }
+
+  ASSERT_EQ(static_cast<size_t>(kJitterSamples), lateness.size());
+  // expired tasks run earliest deadline first, whenever the timer wakes up
+  EXPECT_TRUE(std::is_sorted(targets.begin(), targets.end()));
+  EXPECT_GE(*std::min_element(lateness.begin(), lateness.end()), 0.0);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTaskRunnerAllocation_Lv1Normal001
+Use Case Name: Task queue allocation
+Test Summary：Test queueing and running immediate and delayed tasks from a
+              foreign thread performs no heap allocation once warmed up
+***************************************************************/
+
+TEST(HomescreenTaskRunnerAllocation, Lv1Normal001) {
+  constexpr int kTasks = 64;
+  LibFlutterEngineExports exports{};
+  exports.GetCurrentTime = StubGetCurrentTime;
+  exports.RunTask = StubRunTaskCount;
+  LibFlutterEngine::SetExports(&exports);
+
+  FlutterEngine engine{};
+  TaskRunner runner("Test", engine);
+
+  const auto queue_tasks = [&runner]() {
+    tasks_run = 0;
+    for (int i = 0; i < kTasks; i++) {
+      const auto now = StubGetCurrentTime();
+      // alternate immediate tasks and tasks 1..3 ms out
+      const auto target = i % 2 ? now + (1 + i % 3) * kNsPerMs : now;
+      runner.QueueFlutterTask(0, target,
+                              FlutterTask{nullptr, static_cast<uint64_t>(i)},
+                              nullptr);
+      if (i % 8 == 7) {
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+      }
+    }
+    for (int i = 0; i < 500 && tasks_run < kTasks; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return tasks_run == kTasks;
+  };
+
+  // warm up the record pool and handler storage
+  ASSERT_TRUE(queue_tasks());
+
+  // call target API
+  allocations = 0;
+  count_allocations = true;
+  const auto ran = queue_tasks();
+  count_allocations = false;
+
+  EXPECT_TRUE(ran);
+  EXPECT_EQ(0, allocations);
+
+  LibFlutterEngine::SetExports(nullptr);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTaskRunnerPlatformMessage_Lv1Normal001
+Use Case Name: Platform message from a foreign thread
+Test Summary：Test a vector payload is handed to the engine without a copy,
+              with its response handle
+***************************************************************/
+
+TEST(HomescreenTaskRunnerPlatformMessage, Lv1Normal001) {
+  static const uint8_t* sent_message;
+  static const FlutterPlatformMessageResponseHandle* sent_handle;
+  LibFlutterEngineExports exports{};
+  exports.GetCurrentTime = StubGetCurrentTime;
+  exports.SendPlatformMessage =
+      [](FLUTTER_API_SYMBOL(FlutterEngine) /* engine */,
+         const FlutterPlatformMessage* message) {
+        sent_message = message->message;
+        sent_handle = message->response_handle;
+        return kSuccess;
+      };
+  LibFlutterEngine::SetExports(&exports);
+
+  FlutterEngine engine{};
+  TaskRunner runner("Test", engine);
+  auto message = std::make_unique<std::vector<uint8_t>>(64, 0x5a);
+  const auto data = message->data();
+  const auto handle =
+      reinterpret_cast<const FlutterPlatformMessageResponseHandle*>(&engine);
+
+  // call target API
+  auto f = runner.QueuePlatformMessage("test/channel", std::move(message),
+                                       handle);
+
+  EXPECT_EQ(kSuccess, f.get());
+  EXPECT_EQ(data, sent_message);
+  EXPECT_EQ(handle, sent_handle);
+
+  LibFlutterEngine::SetExports(nullptr);
+}
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "libflutter_engine.h"
+#include "texture_frame_queue.h"
+
+namespace {
+
+std::mutex marked_mutex;
+std::vector<int64_t> marked;
+
+FlutterEngineResult StubMarkExternalTextureFrameAvailable(
+    FLUTTER_API_SYMBOL(FlutterEngine) /* engine */,
+    const int64_t texture_id) {
+  std::scoped_lock lock(marked_mutex);
+  marked.push_back(texture_id);
+  return kSuccess;
+}
+
+class HomescreenTextureFrameQueue : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    exports_.MarkExternalTextureFrameAvailable =
+        StubMarkExternalTextureFrameAvailable;
+    LibFlutterEngine::SetExports(&exports_);
+    marked.clear();
+  }
+
+  void TearDown() override { LibFlutterEngine::SetExports(nullptr); }
+
+  LibFlutterEngineExports exports_{};
+  FLUTTER_API_SYMBOL(FlutterEngine)
+  engine_ = reinterpret_cast<FLUTTER_API_SYMBOL(FlutterEngine)>(1);
+};
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTextureFrameQueue_Lv1Normal001
+Use Case Name: Texture frame coalescing
+Test Summary：Test marks of a frame collapse to one engine call per texture
+***************************************************************/
+
+TEST_F(HomescreenTextureFrameQueue, Lv1Normal001) {
+  TextureFrameQueue queue;
+
+  // call target API
+  EXPECT_TRUE(queue.Mark(5));
+  EXPECT_FALSE(queue.Mark(5));
+  EXPECT_FALSE(queue.Mark(7));
+  EXPECT_FALSE(queue.Mark(5));
+  EXPECT_EQ(2u, queue.Flush(engine_));
+  EXPECT_EQ((std::vector<int64_t>{5, 7}), marked);
+
+  // the next frame starts with an empty set
+  EXPECT_TRUE(queue.Mark(7));
+  EXPECT_EQ(1u, queue.Flush(engine_));
+  EXPECT_EQ((std::vector<int64_t>{5, 7, 7}), marked);
+
+  const auto stats = queue.TakeStats();
+  EXPECT_EQ(5u, stats.marks);
+  EXPECT_EQ(3u, stats.sent);
+  EXPECT_EQ(2u, stats.coalesced);
+  EXPECT_EQ(2u, stats.flushes);
+  EXPECT_EQ(0u, queue.TakeStats().marks);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTextureFrameQueue_Lv1Normal002
+Use Case Name: Texture frame coalescing
+Test Summary：Test marks from several producer threads are each sent or
+              coalesced, and a texture marked after a flush is sent again
+***************************************************************/
+
+TEST_F(HomescreenTextureFrameQueue, Lv1Normal002) {
+  constexpr int kProducers = 3;
+  constexpr int kMarks = 2000;
+  TextureFrameQueue queue;
+  std::atomic<int> running{kProducers};
+
+  // call target API
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; p++) {
+    producers.emplace_back([&, p] {
+      for (int i = 0; i < kMarks; i++) {
+        queue.Mark(p);
+      }
+      running--;
+    });
+  }
+  while (running.load() != 0) {
+    queue.Flush(engine_);
+    std::this_thread::yield();
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  queue.Flush(engine_);
+
+  const auto stats = queue.TakeStats();
+  EXPECT_EQ(static_cast<uint64_t>(kProducers * kMarks), stats.marks);
+  EXPECT_EQ(stats.marks, stats.sent + stats.coalesced);
+  EXPECT_EQ(marked.size(), stats.sent);
+  for (int p = 0; p < kProducers; p++) {
+    EXPECT_NE(marked.end(), std::find(marked.begin(), marked.end(), p));
+  }
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTextureFrameQueue_Lv1Normal003
+Use Case Name: Texture frame coalescing
+Test Summary：Test the prepare step sees the batch before the engine and
+              the textures it removes are not sent
+***************************************************************/
+
+TEST_F(HomescreenTextureFrameQueue, Lv1Normal003) {
+  TextureFrameQueue queue;
+  queue.Mark(1);
+  queue.Mark(2);
+  queue.Mark(3);
+  std::vector<int64_t> prepared;
+
+  // call target API
+  EXPECT_EQ(2u, queue.Flush(
+                    engine_,
+                    [](std::vector<int64_t>& batch, void* user_data) {
+                      *static_cast<std::vector<int64_t>*>(user_data) = batch;
+                      EXPECT_TRUE(marked.empty());
+                      // no new pixel buffer for texture 2
+                      batch.erase(batch.begin() + 1);
+                    },
+                    &prepared));
+  EXPECT_EQ((std::vector<int64_t>{1, 2, 3}), prepared);
+  EXPECT_EQ((std::vector<int64_t>{1, 3}), marked);
+  EXPECT_EQ(2u, queue.TakeStats().sent);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTextureFrameQueue_Lv1Abnormal001
+Use Case Name: Texture frame coalescing
+Test Summary：Test an empty set or a missing engine sends nothing, and the
+              marks are kept for the engine
+***************************************************************/
+
+TEST_F(HomescreenTextureFrameQueue, Lv1Abnormal001) {
+  TextureFrameQueue queue;
+
+  // call target API
+  EXPECT_EQ(0u, queue.Flush(engine_));
+  EXPECT_TRUE(queue.Mark(3));
+  EXPECT_EQ(0u, queue.Flush(nullptr));
+  EXPECT_TRUE(marked.empty());
+  EXPECT_FALSE(queue.Mark(3));
+  EXPECT_EQ(1u, queue.Flush(engine_));
+  EXPECT_EQ((std::vector<int64_t>{3}), marked);
+  EXPECT_EQ(1u, queue.TakeStats().flushes);
+}
@@ -0,0 +1,164 @@
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "platform/homescreen/flutter_desktop_texture_registrar.h"
+#include "platform/homescreen/texture_registry.h"
+
+namespace {
+
+TextureRegistry::Entry MakeTexture(const int64_t id,
+                                   std::atomic<bool>* released = nullptr) {
+  auto desc = std::make_shared<GL_TEXTURE_2D_DESC>();
+  desc->name = static_cast<uint32_t>(id);
+  desc->target = GL_TEXTURE_2D;
+  desc->release_context = released;
+  return desc;
+}
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTextureRegistry_Lv1Normal001
+Use Case Name: External texture lookup
+Test Summary：Test registered textures are found, replaced and removed
+***************************************************************/
+
+TEST(HomescreenTextureRegistry, Lv1Normal001) {
+  TextureRegistry registry;
+
+  // call target API
+  EXPECT_EQ(nullptr, registry.Insert(1, MakeTexture(1)));
+  EXPECT_EQ(nullptr, registry.Insert(2, MakeTexture(2)));
+  EXPECT_EQ(2u, registry.size());
+  {
+    const TextureRegistry::Reader reader(registry);
+    ASSERT_NE(nullptr, reader.Find(1));
+    EXPECT_EQ(1u, reader.Find(1)->name);
+    EXPECT_EQ(2u, reader.Find(2)->name);
+    EXPECT_EQ(nullptr, reader.Find(3));
+  }
+
+  const auto replaced = registry.Insert(1, MakeTexture(11));
+  ASSERT_NE(nullptr, replaced);
+  EXPECT_EQ(1u, replaced->name);
+  EXPECT_EQ(11u, registry.Get(1)->name);
+
+  const auto removed = registry.Remove(2);
+  ASSERT_NE(nullptr, removed);
+  EXPECT_EQ(2u, removed->name);
+  EXPECT_EQ(nullptr, registry.Get(2));
+  EXPECT_EQ(1u, registry.size());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTextureRegistry_Lv1Normal002
+Use Case Name: External texture lookup
+Test Summary：Test a reader keeps its snapshot while textures are removed,
+              and the next reader no longer sees them
+***************************************************************/
+
+TEST(HomescreenTextureRegistry, Lv1Normal002) {
+  TextureRegistry registry;
+  registry.Insert(7, MakeTexture(7));
+
+  // call target API
+  std::atomic<bool> removed{false};
+  std::thread writer;
+  {
+    const TextureRegistry::Reader reader(registry);
+    const auto texture = reader.Find(7);
+    ASSERT_NE(nullptr, texture);
+    writer = std::thread([&] {
+      registry.Remove(7);
+      removed.store(true);
+    });
+    // the writer waits for this reader before it returns
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(removed.load());
+    EXPECT_EQ(7u, texture->name);
+  }
+  writer.join();
+  EXPECT_TRUE(removed.load());
+  const TextureRegistry::Reader reader(registry);
+  EXPECT_EQ(nullptr, reader.Find(7));
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTextureRegistry_Lv1Abnormal001
+Use Case Name: External texture lookup
+Test Summary：Test raster threads never see a texture released by a
+              concurrent unregister, under many concurrent writers
+***************************************************************/
+
+TEST(HomescreenTextureRegistry, Lv1Abnormal001) {
+  constexpr int kWriters = 4;
+  constexpr int kTexturesPerWriter = 32;
+  constexpr int kRounds = 20;
+  constexpr int kReaders = 2;
+  TextureRegistry registry;
+  std::atomic<bool> running{true};
+  std::atomic<uint64_t> found{};
+  std::atomic<uint64_t> released_seen{};
+
+  // call target API
+  std::vector<std::thread> readers;
+  for (int r = 0; r < kReaders; r++) {
+    readers.emplace_back([&] {
+      while (running.load()) {
+        {
+          const TextureRegistry::Reader reader(registry);
+          for (int64_t id = 0; id < kWriters * kTexturesPerWriter; id++) {
+            const auto texture = reader.Find(id);
+            if (texture == nullptr) {
+              continue;
+            }
+            found++;
+            if (texture->name != id ||
+                static_cast<std::atomic<bool>*>(texture->release_context)
+                    ->load()) {
+              released_seen++;
+            }
+          }
+        }
+        // a raster thread looks textures up once per frame
+        std::this_thread::yield();
+      }
+    });
+  }
+
+  std::vector<std::thread> writers;
+  for (int w = 0; w < kWriters; w++) {
+    writers.emplace_back([&, w] {
+      std::vector<std::atomic<bool>> released(kTexturesPerWriter);
+      for (int round = 0; round < kRounds; round++) {
+        for (int i = 0; i < kTexturesPerWriter; i++) {
+          const int64_t id = w * kTexturesPerWriter + i;
+          auto& flag = released[static_cast<size_t>(i)];
+          flag.store(false);
+          registry.Insert(id, MakeTexture(id, &flag));
+        }
+        for (int i = 0; i < kTexturesPerWriter; i++) {
+          const int64_t id = w * kTexturesPerWriter + i;
+          // as unregister does, released once no reader sees it
+          if (registry.Remove(id) != nullptr) {
+            released[static_cast<size_t>(i)].store(true);
+          }
+        }
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  running.store(false);
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_EQ(0u, released_seen.load());
+  EXPECT_GT(found.load(), 0u);
+  EXPECT_EQ(0u, registry.size());
+}
@@ -0,0 +1,115 @@
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "wayland/touch_frame.h"
+
+namespace {
+
+std::vector<TouchFrame::Event> Staged(const TouchFrame& frame) {
+  return {frame.events(), frame.events() + frame.size()};
+}
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTouchFrame_Lv1Normal001
+Use Case Name: Touch frame staging
+Test Summary：Test a five finger frame is staged as one group with one motion
+              per finger holding the latest position
+***************************************************************/
+
+TEST(HomescreenTouchFrame, Lv1Normal001) {
+  TouchFrame frame;
+  for (int32_t id = 0; id < 5; id++) {
+    frame.Down(id, id, 0);
+  }
+  frame.Clear();
+
+  // call target API
+  for (int step = 1; step <= 3; step++) {
+    for (int32_t id = 0; id < 5; id++) {
+      EXPECT_TRUE(frame.Motion(id, id, step));
+    }
+  }
+
+  const auto events = Staged(frame);
+  ASSERT_EQ(5u, events.size());
+  for (int32_t id = 0; id < 5; id++) {
+    EXPECT_EQ(kMove, events[id].phase);
+    EXPECT_EQ(id, events[id].device);
+    EXPECT_EQ(3, events[id].y);
+  }
+  EXPECT_EQ(5u, frame.ActiveContacts());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTouchFrame_Lv1Normal002
+Use Case Name: Touch frame staging
+Test Summary：Test large compositor ids map to table slots, up is reported at
+              the last position and a released slot is reused
+***************************************************************/
+
+TEST(HomescreenTouchFrame, Lv1Normal002) {
+  TouchFrame frame;
+
+  // call target API
+  EXPECT_TRUE(frame.Down(1000, 1, 1));
+  EXPECT_TRUE(frame.Down(-7, 2, 2));
+  EXPECT_TRUE(frame.Motion(1000, 5, 5));
+  EXPECT_TRUE(frame.Up(1000));
+  frame.Clear();
+  EXPECT_TRUE(frame.Down(42, 9, 9));
+
+  const auto events = Staged(frame);
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ(kDown, events[0].phase);
+  // slot 0 was freed by the up of id 1000
+  EXPECT_EQ(0, events[0].device);
+  EXPECT_EQ(2u, frame.ActiveContacts());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTouchFrame_Lv1Normal003
+Use Case Name: Touch frame staging
+Test Summary：Test cancel reports every active contact and clears the table
+***************************************************************/
+
+TEST(HomescreenTouchFrame, Lv1Normal003) {
+  TouchFrame frame;
+  frame.Down(3, 30, 30);
+  frame.Down(4, 40, 40);
+  frame.Clear();
+
+  // call target API
+  frame.Cancel();
+
+  const auto events = Staged(frame);
+  ASSERT_EQ(2u, events.size());
+  EXPECT_EQ(kCancel, events[0].phase);
+  EXPECT_EQ(30, events[0].x);
+  EXPECT_EQ(kCancel, events[1].phase);
+  EXPECT_EQ(40, events[1].x);
+  EXPECT_EQ(0u, frame.ActiveContacts());
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTouchFrame_Lv1Abnormal001
+Use Case Name: Touch frame staging
+Test Summary：Test contacts beyond kMaxTouchFinger and unknown ids are ignored
+***************************************************************/
+
+TEST(HomescreenTouchFrame, Lv1Abnormal001) {
+  TouchFrame frame;
+  for (int32_t id = 0; id < kMaxTouchFinger; id++) {
+    ASSERT_TRUE(frame.Down(id * 100, 0, 0));
+  }
+
+  // call target API
+  EXPECT_FALSE(frame.Down(12345, 0, 0));
+  EXPECT_FALSE(frame.Motion(12345, 1, 1));
+  EXPECT_FALSE(frame.Up(12345));
+  EXPECT_FALSE(frame.Down(0, 0, 0));
+
+  EXPECT_EQ(static_cast<size_t>(kMaxTouchFinger), frame.size());
+  EXPECT_EQ(static_cast<size_t>(kMaxTouchFinger), frame.ActiveContacts());
+}
@@ -0,0 +1,186 @@
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+#include "trace.h"
+
+namespace {
+
+class HomescreenTrace : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Trace::Instance().Configure("trace-test.json", false);
+    Trace::Instance().Clear();
+  }
+
+  void TearDown() override {
+    Trace::Instance().Configure("", false);
+    Trace::Instance().Clear();
+  }
+
+  /// the calling thread's events
+  static std::vector<Trace::Event> OwnEvents(
+      const std::vector<Trace::Thread>& threads) {
+    const auto tid = static_cast<int32_t>(gettid());
+    for (auto const& thread : threads) {
+      if (thread.tid == tid) {
+        return thread.events;
+      }
+    }
+    return {};
+  }
+};
+
+/// read a varint at |pos|, false if truncated
+bool ReadVarint(const std::string& data, size_t& pos, uint64_t& value) {
+  value = 0;
+  for (unsigned shift = 0; pos < data.size() && shift < 64; shift += 7) {
+    const auto byte = static_cast<uint8_t>(data[pos++]);
+    value |= uint64_t{byte & 0x7Fu} << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTrace_Lv1Normal001
+Use Case Name: Embedder trace events
+Test Summary：Test events are recorded per thread in order
+***************************************************************/
+
+TEST_F(HomescreenTrace, Lv1Normal001) {
+  // call target API
+  {
+    const TraceScope scope("outer");
+    Trace::Instance().Instant("mark");
+  }
+  std::thread([]() {
+    const TraceScope scope("worker");
+  }).join();
+
+  const auto threads = Trace::Instance().Snapshot();
+  const auto events = OwnEvents(threads);
+  ASSERT_EQ(3u, events.size());
+  EXPECT_STREQ("outer", events[0].name);
+  EXPECT_EQ(Trace::kBegin, events[0].phase);
+  EXPECT_EQ(Trace::kInstant, events[1].phase);
+  EXPECT_EQ(Trace::kEnd, events[2].phase);
+  EXPECT_LE(events[0].timestamp_ns, events[1].timestamp_ns);
+  EXPECT_LE(events[1].timestamp_ns, events[2].timestamp_ns);
+
+  size_t worker_events = 0;
+  for (auto const& thread : threads) {
+    for (auto const& event : thread.events) {
+      worker_events += std::string(event.name) == "worker";
+    }
+  }
+  EXPECT_EQ(2u, worker_events);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTrace_Lv1Normal002
+Use Case Name: Embedder trace events
+Test Summary：Test a full ring keeps the most recent kEventsPerThread events
+***************************************************************/
+
+TEST_F(HomescreenTrace, Lv1Normal002) {
+  // call target API
+  Trace::Instance().Begin("first");
+  for (size_t i = 0; i < Trace::kEventsPerThread; i++) {
+    Trace::Instance().Instant("fill");
+  }
+  Trace::Instance().End("last");
+
+  const auto events = OwnEvents(Trace::Instance().Snapshot());
+  ASSERT_EQ(Trace::kEventsPerThread, events.size());
+  EXPECT_STREQ("fill", events.front().name);
+  EXPECT_STREQ("last", events.back().name);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTrace_Lv1Normal003
+Use Case Name: Embedder trace events
+Test Summary：Test Chrome JSON carries thread names and microsecond
+              timestamps with nanosecond precision
+***************************************************************/
+
+TEST_F(HomescreenTrace, Lv1Normal003) {
+  const std::vector<Trace::Thread> threads{
+      {42, "raster", {{"present", 1'234'005, Trace::kBegin},
+                      {"present", 2'000'000, Trace::kEnd},
+                      {"say \"hi\"", 3'000'000, Trace::kInstant}}}};
+
+  // call target API
+  const auto json = Trace::ToChromeJson(threads, 7);
+
+  EXPECT_NE(std::string::npos,
+            json.find("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":7,"
+                      "\"tid\":42,\"args\":{\"name\":\"raster\"}}"));
+  EXPECT_NE(std::string::npos,
+            json.find("{\"name\":\"present\",\"ph\":\"B\",\"ts\":1234.005,"
+                      "\"pid\":7,\"tid\":42}"));
+  EXPECT_NE(std::string::npos, json.find("\"ts\":2000.000"));
+  EXPECT_NE(std::string::npos,
+            json.find("\"name\":\"say \\\"hi\\\"\",\"ph\":\"i\""));
+  EXPECT_EQ('}', json[json.size() - 2]);
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTrace_Lv1Normal004
+Use Case Name: Embedder trace events
+Test Summary：Test the Perfetto trace is a sequence of well formed packets: a
+              clock snapshot, one per track and one per event
+***************************************************************/
+
+TEST_F(HomescreenTrace, Lv1Normal004) {
+  const std::vector<Trace::Thread> threads{
+      {42, "raster", {{"present", 1'000, Trace::kBegin},
+                      {"present", 2'000, Trace::kEnd}}},
+      {43, "ui", {{"vsync", 3'000, Trace::kInstant}}}};
+
+  // call target API
+  const auto data = Trace::ToPerfetto(threads, 7);
+
+  size_t pos = 0;
+  size_t packets = 0;
+  while (pos < data.size()) {
+    uint64_t tag = 0;
+    uint64_t size = 0;
+    ASSERT_TRUE(ReadVarint(data, pos, tag));
+    // Trace.packet, length delimited
+    ASSERT_EQ((1u << 3) | 2u, tag);
+    ASSERT_TRUE(ReadVarint(data, pos, size));
+    ASSERT_LE(pos + size, data.size());
+    pos += size;
+    packets++;
+  }
+  // clock snapshot, process, 2 threads, 3 events
+  EXPECT_EQ(7u, packets);
+  EXPECT_NE(std::string::npos, data.find("raster"));
+  EXPECT_NE(std::string::npos, data.find("vsync"));
+}
+
+/****************************************************************
+Test Case Name.Test Name： HomescreenTrace_Lv1Abnormal001
+Use Case Name: Embedder trace events
+Test Summary：Test nothing is recorded or written without an output path
+***************************************************************/
+
+TEST_F(HomescreenTrace, Lv1Abnormal001) {
+  Trace::Instance().Configure("", false);
+
+  // call target API
+  Trace::Instance().Instant("dropped");
+
+  EXPECT_FALSE(Trace::Instance().IsRecording());
+  EXPECT_TRUE(OwnEvents(Trace::Instance().Snapshot()).empty());
+  EXPECT_FALSE(Trace::Instance().Write());
+}
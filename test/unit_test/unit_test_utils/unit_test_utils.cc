@@ -18,7 +18,7 @@ std::string utils_get_image_filename(uint8_t type, std::string idx) {
   return filename.str();
 }
 
-void utils_write_targa(uint8_t* buf, const char *filename, int width, int height)
+void utils_write_targa(const uint8_t* buf, const char *filename, int width, int height)
 {
   #pragma pack(push, 1)
   typedef struct {